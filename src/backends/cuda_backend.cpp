@@ -1,11 +1,21 @@
 #include "cuda_backend.hpp"
+#include "../shared/gemm.hpp"
+#include "../shared/host_memory.hpp"
+#include "../shared/ingest.hpp"
+#include "../shared/microbench.hpp"
 #include "../shared/shared.hpp"
+#include "../shared/suite.hpp"
+#include "../shared/sweep.hpp"
+#include "../shared/trace.hpp"
 #include "modules/cuda_kernels.hpp"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <utility>
 // #include "/opt/cuda/include/cuda_runtime.h"
 
 CudaBackend::cuInit_t CudaBackend::cuInit = nullptr;
@@ -36,9 +46,37 @@ CudaBackend::cuStreamDestroy_t CudaBackend::cuStreamDestroy = nullptr;
 CudaBackend::cuDeviceTotalMem_t CudaBackend::cuDeviceTotalMem = nullptr;
 CudaBackend::cuDeviceComputeCapability_t CudaBackend::cuDeviceComputeCapability = nullptr;
 CudaBackend::cuDeviceGetAttribute_t CudaBackend::cuDeviceGetAttribute = nullptr;
+CudaBackend::cuMemcpyHtoDAsync_t CudaBackend::cuMemcpyHtoDAsync = nullptr;
+CudaBackend::cuMemcpyDtoHAsync_t CudaBackend::cuMemcpyDtoHAsync = nullptr;
+CudaBackend::cuCtxSetCurrent_t CudaBackend::cuCtxSetCurrent = nullptr;
+CudaBackend::cuMemHostAlloc_t CudaBackend::cuMemHostAlloc = nullptr;
+CudaBackend::cuDeviceCanAccessPeer_t CudaBackend::cuDeviceCanAccessPeer = nullptr;
+CudaBackend::cuCtxEnablePeerAccess_t CudaBackend::cuCtxEnablePeerAccess = nullptr;
+CudaBackend::cuMemcpyPeer_t CudaBackend::cuMemcpyPeer = nullptr;
+CudaBackend::cuMemHostGetDevicePointer_t CudaBackend::cuMemHostGetDevicePointer = nullptr;
+CudaBackend::cuMemHostRegister_t CudaBackend::cuMemHostRegister = nullptr;
+CudaBackend::cuMemHostUnregister_t CudaBackend::cuMemHostUnregister = nullptr;
+CudaBackend::cuMemAllocManaged_t CudaBackend::cuMemAllocManaged = nullptr;
+CudaBackend::cuMemPrefetchAsync_t CudaBackend::cuMemPrefetchAsync = nullptr;
+CudaBackend::cuStreamSynchronize_t CudaBackend::cuStreamSynchronize = nullptr;
+CudaBackend::cuMemAllocAsync_t CudaBackend::cuMemAllocAsync = nullptr;
+CudaBackend::cuMemFreeAsync_t CudaBackend::cuMemFreeAsync = nullptr;
+CudaBackend::cuDeviceGetDefaultMemPool_t CudaBackend::cuDeviceGetDefaultMemPool = nullptr;
+CudaBackend::cuMemPoolSetAttribute_t CudaBackend::cuMemPoolSetAttribute = nullptr;
+CudaBackend::cuMemPoolGetAttribute_t CudaBackend::cuMemPoolGetAttribute = nullptr;
+CudaBackend::cuMemcpyDtoD_t CudaBackend::cuMemcpyDtoD = nullptr;
+CudaBackend::cuMemAllocPitch_t CudaBackend::cuMemAllocPitch = nullptr;
+CudaBackend::cuMemcpy2D_t CudaBackend::cuMemcpy2D = nullptr;
+CudaBackend::cuOccupancyMaxActiveBlocksPerMultiprocessor_t CudaBackend::cuOccupancyMaxActiveBlocksPerMultiprocessor = nullptr;
+CudaBackend::cuFuncGetAttribute_t CudaBackend::cuFuncGetAttribute = nullptr;
+CudaBackend::cuMemcpy3D_t CudaBackend::cuMemcpy3D = nullptr;
+CudaBackend::cuCtxGetCurrent_t CudaBackend::cuCtxGetCurrent = nullptr;
+CudaBackend::cuCtxPopCurrent_t CudaBackend::cuCtxPopCurrent = nullptr;
 
 CudaBackend::cuGetErrorString_t CudaBackend::cuGetErrorString = nullptr;
 
+CudaBackend::ExecutionContext CudaBackend::execContext;
+
 // NVML
 CudaBackend::nvmlInit_t CudaBackend::nvmlInit = nullptr;
 CudaBackend::nvmlShutdown_t CudaBackend::nvmlShutdown = nullptr;
@@ -54,10 +92,10 @@ CudaBackend::nvmlDeviceGetMemoryInfo_t CudaBackend::nvmlDeviceGetMemoryInfo = nu
   do {                                                                                                                                               \
     CUresult err = call;                                                                                                                             \
     if (err != 0) {                                                                                                                                  \
-      const char* msg;                                                                                                                               \
+      const char* msg = nullptr;                                                                                                                     \
       cuGetErrorString(err, &msg);                                                                                                                   \
-      std::cerr << "CUDA Driver API error in cuda_backend.cpp:" << __LINE__ << ": " << msg << " (" << err << ")\n";                                  \
-      exit(EXIT_FAILURE);                                                                                                                            \
+      throw GPUMark::Error("CUDA Driver API error in cuda_backend.cpp:" + std::to_string(__LINE__) + ": " + (msg ? msg : "unknown error") + " (" +    \
+                           std::to_string(err) + ")");                                                                                               \
     }                                                                                                                                                \
   } while (0)
 
@@ -65,8 +103,7 @@ CudaBackend::nvmlDeviceGetMemoryInfo_t CudaBackend::nvmlDeviceGetMemoryInfo = nu
   do {                                                                                                                                               \
     CudaBackend::nvmlReturn_t err = call;                                                                                                            \
     if (err != 0) {                                                                                                                                  \
-      std::cerr << "NVML error in cuda_backend.cpp:" << __LINE__ << ": " << err << "\n";                                                             \
-      exit(EXIT_FAILURE);                                                                                                                            \
+      throw GPUMark::Error("NVML error in cuda_backend.cpp:" + std::to_string(__LINE__) + ": " + std::to_string(err));                               \
     }                                                                                                                                                \
   } while (0)
 
@@ -97,6 +134,29 @@ bool getDeviceProperties(CudaBackend::CUdevice dev, CudaBackend::cudaDeviceProp*
   CudaBackend::cuDeviceGetAttribute(&multiProcessorCount, 16, dev);
   prop->multiProcessorCount = multiProcessorCount;
 
+  int warpSize = 32;
+  CudaBackend::cuDeviceGetAttribute(&warpSize, 10, dev);
+  prop->warpSize = warpSize;
+
+  // The occupancy sweep sizes its shared memory and resident threads from these two
+  int sharedMemPerBlock = 0, maxThreadsPerMultiProcessor = 0;
+  CudaBackend::cuDeviceGetAttribute(&sharedMemPerBlock, 8, dev);
+  CudaBackend::cuDeviceGetAttribute(&maxThreadsPerMultiProcessor, 39, dev);
+  prop->sharedMemPerBlock = sharedMemPerBlock;
+  prop->maxThreadsPerMultiProcessor = maxThreadsPerMultiProcessor;
+
+  int concurrentManagedAccess = 0;
+  CudaBackend::cuDeviceGetAttribute(&concurrentManagedAccess, 89, dev);
+  prop->concurrentManagedAccess = concurrentManagedAccess;
+
+  int pciBusID = 0, pciDeviceID = 0, pciDomainID = 0;
+  CudaBackend::cuDeviceGetAttribute(&pciBusID, 33, dev);
+  CudaBackend::cuDeviceGetAttribute(&pciDeviceID, 34, dev);
+  CudaBackend::cuDeviceGetAttribute(&pciDomainID, 50, dev);
+  prop->pciBusID = pciBusID;
+  prop->pciDeviceID = pciDeviceID;
+  prop->pciDomainID = pciDomainID;
+
   return true;
 }
 
@@ -105,6 +165,7 @@ bool CudaBackend::gpuUtilizationSafe(void* nvmlDevice) {
   NVML_ERR(nvmlDeviceGetUtilizationRates(nvmlDevice, &utilization));
   if (utilization.gpu > 7) {
     std::cout << CUDA << "Skipping benchmark on this device due to high utilization (" << RED << utilization.gpu << "%" << RESET << ")\n";
+    Suite::skipDevice("high GPU utilization (" + std::to_string(utilization.gpu) + "%)");
     return false;
   }
   return true;
@@ -118,6 +179,7 @@ bool CudaBackend::memUtilizationSafe(void* nvmlDevice) {
   if (memoryInfo.total < requiredMem) {
     std::cout << CUDA << "Skipping benchmark on this device due to insufficient total memory (" << RED << (memoryInfo.total / (1024 * 1024))
               << "mb/2048mb required total" << RESET << ")\n";
+    Suite::skipDevice("insufficient total memory");
     return false;
   }
   double usagePercent = (double)memoryInfo.used / (double)memoryInfo.total * 100.0;
@@ -125,6 +187,7 @@ bool CudaBackend::memUtilizationSafe(void* nvmlDevice) {
   if (usagePercent > 25.0) {
     std::cout << CUDA << "Skipping benchmark on this device due to high memory usage (" << RED << std::fixed << std::setprecision(2) << usagePercent
               << "% used, max 25% allowed" << RESET << ")\n";
+    Suite::skipDevice("high memory usage");
     return false;
   }
   std::string_view memColor;
@@ -158,6 +221,11 @@ unsigned int CudaBackend::getAndPrintTemperature(void* nvmlDevice) {
 bool CudaBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
   constexpr const float slowMSThreshold = 50.0f;
   if (linearSetTime > slowMSThreshold || linearMultiplyTime > slowMSThreshold) {
+    if (!Suite::interactive()) {
+      std::cout << CUDA << "The initial tests were slow. Skipping further benchmarks on this device.\n";
+      Suite::skipDevice("initial tests were slow");
+      return true;
+    }
     // These words are randomly selected to make sure that the user is paying attention! Seriously, these tests
     // may actually take forever, so the user better know what they're in for.
     const char* confirmWords[] = {"YES", "CUDA", "CONTINUE", "YEAH", "SURE", "GOAHEAD", "FINE", "WHYNOT", "AFFIRMATIVE", "LETSGO", "OKAY"};
@@ -172,6 +240,7 @@ bool CudaBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime)
     std::cin >> userInput;
     if (!stringsRoughlyMatch(userInput, confirmWords[randIdx])) {
       std::cout << CUDA << "Aborting further benchmarks on this device.\n";
+      Suite::skipDevice("aborted by user");
       return true;
     }
     return false;
@@ -179,15 +248,78 @@ bool CudaBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime)
   return false;
 }
 
+namespace {
+// Tears down the device's context, module and stream/event pool when a test throws or the device is skipped, so the
+// next device starts clean. Destroying the context also frees whatever the failed test had allocated. Driver errors are
+// ignored here, as one is usually already unwinding.
+struct DeviceGuard {
+  CudaBackend::CUcontext context = nullptr;
+  CudaBackend::CUmodule module = nullptr;
+
+  DeviceGuard() = default;
+  DeviceGuard(const DeviceGuard&) = delete;
+  DeviceGuard& operator=(const DeviceGuard&) = delete;
+  ~DeviceGuard() {
+    CudaBackend::ExecutionContext pool = std::exchange(CudaBackend::execContext, CudaBackend::ExecutionContext{});
+    for (CudaBackend::CUevent event : pool.events) {
+      CudaBackend::cuEventDestroy(event);
+    }
+    for (CudaBackend::CUstream stream : pool.streams) {
+      CudaBackend::cuStreamDestroy(stream);
+    }
+    if (module)
+      CudaBackend::cuModuleUnload(module);
+    if (context)
+      CudaBackend::cuCtxDestroy(context);
+  }
+};
+
+// Owns the peer-to-peer test's contexts. They are popped as soon as they are created, so the caller's context stack is
+// left as it was, and the caller's context is made current again however the test ends.
+struct PeerContexts {
+  std::vector<CudaBackend::CUcontext> contexts;
+  CudaBackend::CUcontext previous = nullptr;
+
+  PeerContexts() = default;
+  PeerContexts(const PeerContexts&) = delete;
+  PeerContexts& operator=(const PeerContexts&) = delete;
+  ~PeerContexts() {
+    for (CudaBackend::CUcontext context : contexts) {
+      if (context)
+        CudaBackend::cuCtxDestroy(context);
+    }
+    CudaBackend::cuCtxSetCurrent(previous);
+  }
+};
+
+// Frees the ingest test's pinned ring and its device copy if the test throws
+struct IngestRing {
+  char* host = nullptr;
+  CudaBackend::CUdeviceptr device = 0;
+
+  IngestRing() = default;
+  IngestRing(const IngestRing&) = delete;
+  IngestRing& operator=(const IngestRing&) = delete;
+  ~IngestRing() {
+    if (device)
+      CudaBackend::cuMemFree(device);
+    if (host)
+      CudaBackend::cuMemFreeHost(host);
+  }
+};
+} // namespace
+
 void CudaBackend::prepareDeviceForBenchmarking(int dev) {
   // Take the ptx file compiled at build time and load it.
-  CUcontext context;
-  CUDA_ERR(cuCtxCreate(&context, 0, dev));
-  CUmodule module;
+  Trace::Span setupSpan("Context + module load", "init");
+  DeviceGuard device;
+  CUDA_ERR(cuCtxCreate(&device.context, 0, dev));
   // Read from file
-  CUDA_ERR(cuModuleLoadData(&module, cudaKernels_ptx));
+  CUDA_ERR(cuModuleLoadData(&device.module, cudaKernels_ptx));
+  CUmodule module = device.module;
+  setupSpan.end();
 
-  cudaDeviceProp prop;
+  cudaDeviceProp prop{};
   getDeviceProperties(dev, &prop);
   std::cout << CUDA << "Running benches on '" << prop.name << "'\n";
   // Try getting GPU usage of this device, to see if running a benchmark is applicable
@@ -196,6 +328,7 @@ void CudaBackend::prepareDeviceForBenchmarking(int dev) {
   NVML_ERR(nvmlDeviceGetHandleByIndex(dev, &nvmlDevice));
   if (!nvmlDevice) {
     std::cout << CUDA << "Skipping benchmark on this device due to inability to get NVML handle.\n";
+    Suite::skipDevice("no NVML handle");
     return;
   }
 
@@ -207,6 +340,14 @@ void CudaBackend::prepareDeviceForBenchmarking(int dev) {
 
   // Temperature before (Fun metric, why not)
   getAndPrintTemperature(nvmlDevice);
+  // Host buffers go on the NUMA node the device hangs off, and so does this thread, for the rest of the device's tests
+  const int hostNode = HostMemory::deviceNode(prop.pciDomainID, prop.pciBusID, prop.pciDeviceID);
+  HostMemory::ThreadPin threadPin(hostNode);
+  if (hostNode >= 0)
+    std::cout << CUDA << "Device is on NUMA node " << hostNode << (threadPin.pinned() ? ", benchmark thread pinned to it\n" : "\n");
+
+  // Streams and events are shared by every test on this device
+  createExecutionContext(4, 8);
 
   // Get the kernel functions
   CUfunction linearSetKernel;
@@ -215,70 +356,258 @@ void CudaBackend::prepareDeviceForBenchmarking(int dev) {
   CUDA_ERR(cuModuleGetFunction(&linearMultiplyKernel, module, "linearMultiplyKernel"));
   unsigned int threadsPerBlock = std::clamp(prop.maxThreadsPerBlock, 128, 1024);
   std::cout << CUDA << "Running simple tests...\n";
-  float linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel);
-  float linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel);
+  float linearSetTime = 0.0f, linearMultiplyTime = 0.0f;
+  if (Suite::shouldRun("linear_set"))
+    linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel, hostNode);
+  if (Suite::shouldRun("linear_multiply"))
+    linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel, hostNode);
 
   // Check to see if those first two rather simple tests took a while.
   // They are only 16 million elements, so if the GPU is running these tests slowly,
   // prompt the user if they would really like to continune with the more intensive tests.
   // //! FOR REFERENCE: my 4060 TI completes both tests in ONE FIFTH of a ms. So if it seriously takes this long, something is up.
   if (slowBenchmarks(linearSetTime, linearMultiplyTime)) {
-    CUDA_ERR(cuModuleUnload(module));
-    CUDA_ERR(cuCtxDestroy(context));
+    destroyExecutionContext();
+    CUDA_ERR(cuModuleUnload(std::exchange(device.module, nullptr)));
+    CUDA_ERR(cuCtxDestroy(std::exchange(device.context, nullptr)));
     return;
   }
   std::cout << CUDA << "All set. Starting full test suite...\n";
-  CUfunction fmaKernel, intThroughputKernel, sharedMemoryKernel, sgemmKernel;
+  CUfunction fmaKernel, intThroughputKernel, sharedMemoryKernel, sgemmKernel, sgemmTiledKernel, sgemmRegisterKernel;
   CUDA_ERR(cuModuleGetFunction(&fmaKernel, module, "fmaKernel"));
   CUDA_ERR(cuModuleGetFunction(&intThroughputKernel, module, "integerThroughputKernel"));
   CUDA_ERR(cuModuleGetFunction(&sharedMemoryKernel, module, "sharedMemoryKernel"));
   CUDA_ERR(cuModuleGetFunction(&sgemmKernel, module, "sgemmKernel"));
-  runFmaBenchmark(threadsPerBlock, fmaKernel);
-  runIntegerThroughputBenchmark(threadsPerBlock, intThroughputKernel);
-  runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel);
-  runSgemmBenchmark(threadsPerBlock, sgemmKernel);
-  runPCIEThroughputBenchmark();
+  CUDA_ERR(cuModuleGetFunction(&sgemmTiledKernel, module, "sgemmTiledKernel"));
+  CUDA_ERR(cuModuleGetFunction(&sgemmRegisterKernel, module, "sgemmRegisterKernel"));
+  if (Suite::shouldRun("fma"))
+    runFmaBenchmark(threadsPerBlock, fmaKernel);
+  if (Suite::shouldRun("integer"))
+    runIntegerThroughputBenchmark(threadsPerBlock, intThroughputKernel);
+  if (Suite::shouldRun("shared_memory"))
+    runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel, dev, prop.multiProcessorCount);
+  if (Suite::shouldRun("sgemm"))
+    runSgemmBenchmark(sgemmKernel, sgemmTiledKernel, sgemmRegisterKernel);
+  if (Suite::shouldRun("pcie"))
+    runPCIEThroughputBenchmark(hostNode);
+  if (Suite::shouldRun("stream_overhead"))
+    runStreamEventOverheadBenchmark();
+  if (Suite::shouldRun("transfer_sweep"))
+    runTransferSweepBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("pcie_bidirectional"))
+    runBidirectionalPCIEBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("copy_compute_overlap"))
+    runCopyComputeOverlapBenchmark(threadsPerBlock, linearMultiplyKernel, prop.totalGlobalMem);
+  if (Suite::shouldRun("pointer_chase")) {
+    CUfunction pointerChaseInitKernel, pointerChaseKernel;
+    CUDA_ERR(cuModuleGetFunction(&pointerChaseInitKernel, module, "pointerChaseInitKernel"));
+    CUDA_ERR(cuModuleGetFunction(&pointerChaseKernel, module, "pointerChaseKernel"));
+    runPointerChaseBenchmark(pointerChaseInitKernel, pointerChaseKernel, prop.totalGlobalMem);
+  }
+  if (Suite::shouldRun("strided_access")) {
+    std::array<void*, 3> stridedReadKernels;
+    CUDA_ERR(cuModuleGetFunction(&stridedReadKernels[0], module, "stridedReadKernel4"));
+    CUDA_ERR(cuModuleGetFunction(&stridedReadKernels[1], module, "stridedReadKernel8"));
+    CUDA_ERR(cuModuleGetFunction(&stridedReadKernels[2], module, "stridedReadKernel16"));
+    runStridedAccessBenchmark(threadsPerBlock, stridedReadKernels, prop.totalGlobalMem, prop.warpSize);
+  }
+  if (Suite::shouldRun("stream")) {
+    CUfunction streamInitKernel;
+    std::array<void*, 12> streamKernels;
+    CUDA_ERR(cuModuleGetFunction(&streamInitKernel, module, "streamInitKernel"));
+    for (size_t k = 0; k < streamKernels.size(); ++k) {
+      CUDA_ERR(cuModuleGetFunction(&streamKernels[k], module, Sweep::streamKernelName(k).c_str()));
+    }
+    runStreamBenchmark(threadsPerBlock, streamInitKernel, streamKernels, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("zero_copy")) {
+    CUfunction scaleKernel;
+    CUDA_ERR(cuModuleGetFunction(&scaleKernel, module, "streamScaleKernel16"));
+    runZeroCopyBenchmark(threadsPerBlock, scaleKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("host_registration"))
+    runHostRegistrationBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("managed_memory")) {
+    CUfunction incrementKernel;
+    CUDA_ERR(cuModuleGetFunction(&incrementKernel, module, "managedIncrementKernel"));
+    runManagedMemoryBenchmark(threadsPerBlock, incrementKernel, dev, prop.totalGlobalMem, prop.multiProcessorCount, prop.concurrentManagedAccess);
+  }
+  if (Suite::shouldRun("allocation"))
+    runAllocationBenchmark(dev, prop.totalGlobalMem);
+  if (Suite::shouldRun("copy_engine")) {
+    CUfunction copyKernel, pitchedCopyKernel, volumeCopyKernel;
+    CUDA_ERR(cuModuleGetFunction(&copyKernel, module, "streamCopyKernel16"));
+    CUDA_ERR(cuModuleGetFunction(&pitchedCopyKernel, module, "pitchedCopyKernel"));
+    CUDA_ERR(cuModuleGetFunction(&volumeCopyKernel, module, "volumeCopyKernel"));
+    runCopyEngineBenchmark(threadsPerBlock, copyKernel, pitchedCopyKernel, volumeCopyKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("out_of_core")) {
+    CUfunction checksumKernel;
+    CUDA_ERR(cuModuleGetFunction(&checksumKernel, module, "chunkChecksumKernel"));
+    runOutOfCoreBenchmark(threadsPerBlock, checksumKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("ingest"))
+    runIngestBenchmark();
+  if (Suite::shouldRun("numa_placement"))
+    runNumaPlacementBenchmark(hostNode);
+  if (Suite::shouldRun("precision")) {
+    CUfunction targetKernel;
+    std::array<void*, 5> multiplyAddKernels, gemmKernels;
+    CUDA_ERR(cuModuleGetFunction(&targetKernel, module, "precisionTargetKernel"));
+    for (Gemm::Format format : Gemm::formats) {
+      CUDA_ERR(cuModuleGetFunction(&multiplyAddKernels[static_cast<size_t>(format)], module, Gemm::multiplyAddKernelName(format).c_str()));
+      CUDA_ERR(cuModuleGetFunction(&gemmKernels[static_cast<size_t>(format)], module, Gemm::gemmKernelName(format).c_str()));
+    }
+    runPrecisionBenchmark(threadsPerBlock, multiplyAddKernels, gemmKernels, targetKernel, dev, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("instruction_mix")) {
+    std::vector<void*> latencyKernels, throughputKernels;
+    for (const Microbench::Instruction& instruction : Microbench::instructions()) {
+      CUfunction latency, throughput;
+      CUDA_ERR(cuModuleGetFunction(&latency, module, ("latency" + std::string(instruction.kernel) + "Kernel").c_str()));
+      CUDA_ERR(cuModuleGetFunction(&throughput, module, ("throughput" + std::string(instruction.kernel) + "Kernel").c_str()));
+      latencyKernels.push_back(latency);
+      throughputKernels.push_back(throughput);
+    }
+    runInstructionMixBenchmark(threadsPerBlock, latencyKernels, throughputKernels, dev, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("occupancy")) {
+    std::vector<void*> occupancyKernels;
+    for (const Microbench::OccupancyKernel& kernel : Microbench::occupancyKernels()) {
+      CUfunction function;
+      CUDA_ERR(cuModuleGetFunction(&function, module, kernel.kernel));
+      occupancyKernels.push_back(function);
+    }
+    runOccupancyBenchmark(occupancyKernels, prop.totalGlobalMem, prop.sharedMemPerBlock, prop.maxThreadsPerMultiProcessor, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("divergence")) {
+    CUfunction divergenceKernel;
+    CUDA_ERR(cuModuleGetFunction(&divergenceKernel, module, "divergenceKernel"));
+    runDivergenceBenchmark(threadsPerBlock, divergenceKernel, prop.warpSize, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("atomics")) {
+    std::vector<void*> globalKernels, sharedKernels;
+    for (const Microbench::AtomicOperation& operation : Microbench::atomicOperations()) {
+      CUfunction globalKernel, sharedKernel;
+      CUDA_ERR(cuModuleGetFunction(&globalKernel, module, ("atomicGlobal" + std::string(operation.kernel) + "Kernel").c_str()));
+      CUDA_ERR(cuModuleGetFunction(&sharedKernel, module, ("atomicShared" + std::string(operation.kernel) + "Kernel").c_str()));
+      globalKernels.push_back(globalKernel);
+      sharedKernels.push_back(sharedKernel);
+    }
+    runAtomicsBenchmark(threadsPerBlock, globalKernels, sharedKernels, prop.multiProcessorCount);
+  }
   // Unload context, module, functions, free data, get ready for next device
-  CUDA_ERR(cuModuleUnload(module));
-  CUDA_ERR(cuCtxDestroy(context));
+  destroyExecutionContext();
+  CUDA_ERR(cuModuleUnload(std::exchange(device.module, nullptr)));
+  CUDA_ERR(cuCtxDestroy(std::exchange(device.context, nullptr)));
 }
 
-void CudaBackend::runBenchmark() {
+std::vector<GPUMark::Device> CudaBackend::enumerateDevices() {
+  std::vector<GPUMark::Device> devices;
   if (!cuMemAlloc) // Simple check to see if CUDA has been loaded. It SHOULD be, but you never know.
-    return;
+    return devices;
 
-  // List the name of each available CUDA-compliant device.
-  // Allocate and subsequently free 1 MB on the each.
   int deviceCount = 0;
   CUDA_ERR(cuDeviceGetCount(&deviceCount));
-
   for (int dev = 0; dev < deviceCount; ++dev) {
-    prepareDeviceForBenchmarking(dev);
+    cudaDeviceProp prop{};
+    if (!getDeviceProperties(dev, &prop))
+      continue;
+    devices.push_back({GPUMark::Backend::CUDA, dev, prop.name, prop.totalGlobalMem});
+  }
+  return devices;
+}
+
+void CudaBackend::createExecutionContext(unsigned int streamCount, unsigned int eventCount) {
+  // Handles left from an earlier device belong to its context, never to this one
+  execContext = ExecutionContext{};
+  for (unsigned int i = 0; i < streamCount; ++i) {
+    CUstream stream;
+    CUDA_ERR(cuStreamCreate(&stream, 0));
+    execContext.streams.push_back(stream);
+    execContext.freeStreams.push_back(stream);
+  }
+  for (unsigned int i = 0; i < eventCount; ++i) {
+    CUevent event;
+    CUDA_ERR(cuEventCreate(&event, 0));
+    execContext.events.push_back(event);
+    execContext.freeEvents.push_back(event);
+  }
+}
+
+void CudaBackend::destroyExecutionContext() {
+  // Emptied first, so an error part way through never leaves destroyed handles in the pool
+  ExecutionContext pool = std::exchange(execContext, ExecutionContext{});
+  for (CUevent event : pool.events) {
+    CUDA_ERR(cuEventDestroy(event));
+  }
+  for (CUstream stream : pool.streams) {
+    CUDA_ERR(cuStreamDestroy(stream));
+  }
+}
+
+// The pools only grow when a test holds more objects at once than were created up front.
+CudaBackend::CUstream CudaBackend::acquireStream() {
+  if (execContext.freeStreams.empty()) {
+    CUstream stream;
+    CUDA_ERR(cuStreamCreate(&stream, 0));
+    execContext.streams.push_back(stream);
+    return stream;
   }
+  CUstream stream = execContext.freeStreams.back();
+  execContext.freeStreams.pop_back();
+  return stream;
+}
+
+void CudaBackend::releaseStream(CUstream stream) { execContext.freeStreams.push_back(stream); }
+
+CudaBackend::CUevent CudaBackend::acquireEvent() {
+  if (execContext.freeEvents.empty()) {
+    CUevent event;
+    CUDA_ERR(cuEventCreate(&event, 0));
+    execContext.events.push_back(event);
+    return event;
+  }
+  CUevent event = execContext.freeEvents.back();
+  execContext.freeEvents.pop_back();
+  return event;
+}
+
+void CudaBackend::releaseEvent(CUevent event) { execContext.freeEvents.push_back(event); }
+
+// Trace track name for a pooled stream, e.g. "CUDA stream 0"
+static std::string streamTrack(CudaBackend::CUstream stream) {
+  const auto& streams = CudaBackend::execContext.streams;
+  return "CUDA stream " + std::to_string(std::find(streams.begin(), streams.end(), stream) - streams.begin());
 }
 
 #define CUDA_BENCHMARK_KERNEL(kernelFunc, blocks, threadsPerBlock, args, milliseconds)                                                               \
-  CUstream stream;                                                                                                                                   \
-  CUDA_ERR(cuStreamCreate(&stream, 0));                                                                                                              \
-  CUevent startEvent, stopEvent;                                                                                                                     \
-  CUDA_ERR(cuEventCreate(&startEvent, 0));                                                                                                           \
-  CUDA_ERR(cuEventCreate(&stopEvent, 0));                                                                                                            \
+  CUstream stream = acquireStream();                                                                                                                 \
+  CUevent startEvent = acquireEvent();                                                                                                               \
+  CUevent stopEvent = acquireEvent();                                                                                                                \
+  Trace::Span kernelSpan("Kernel launch + sync", "kernel");                                                                                          \
   CUDA_ERR(cuEventRecord(startEvent, stream));                                                                                                       \
   CUDA_ERR(cuLaunchKernel(kernelFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));                                               \
   CUDA_ERR(cuEventRecord(stopEvent, stream));                                                                                                        \
   CUDA_ERR(cuEventSynchronize(stopEvent));                                                                                                           \
   CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));                                                                                \
-  CUDA_ERR(cuEventDestroy(startEvent));                                                                                                              \
-  CUDA_ERR(cuEventDestroy(stopEvent));                                                                                                               \
-  CUDA_ERR(cuStreamDestroy(stream));
+  kernelSpan.end();                                                                                                                                  \
+  if (Trace::enabled())                                                                                                                              \
+    Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);                                            \
+  releaseEvent(startEvent);                                                                                                                          \
+  releaseEvent(stopEvent);                                                                                                                           \
+  releaseStream(stream);
 
-float CudaBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction linearSetFunc) {
+float CudaBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction linearSetFunc, int hostNode) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
+  TRACE_SCOPE("1) Linear Set", "test");
   std::cout << CUDA << "1) Linear Set (~" << N / 1000000 << "M elements)..." << std::flush;
 
-  float* h_data = new float[N];
+  Trace::Span allocSpan("Allocate", "alloc");
+  float* h_data = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
   CUdeviceptr d_data = 0;
   CUDA_ERR(cuMemAlloc(&d_data, N * sizeof(float)));
+  allocSpan.end();
 
   int blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_data};
@@ -286,8 +615,11 @@ float CudaBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, CudaBacke
   std::cout << "\r" << CUDA << "1) Linear Set (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   CUDA_BENCHMARK_KERNEL(linearSetFunc, blocks, threadsPerBlock, args, milliseconds);
   std::cout << "\r" << CUDA << "1) Linear Set (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   CUDA_ERR(cuMemcpyDtoH(h_data, d_data, N * sizeof(float)));
+  downloadSpan.end();
 
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     if (h_data[i] != static_cast<float>(i)) {
@@ -296,6 +628,7 @@ float CudaBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, CudaBacke
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << CUDA << "1) Linear Set (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -304,28 +637,36 @@ float CudaBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, CudaBacke
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
 
+  Suite::record("linear_set", milliseconds, valid);
   CUDA_ERR(cuMemFree(d_data));
-  delete[] h_data;
+  HostMemory::release(h_data, N * sizeof(float));
   return valid ? milliseconds : 0.0f;
 }
 
-float CudaBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction linearMultiplyFunc) {
+float CudaBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction linearMultiplyFunc, int hostNode) {
   constexpr const unsigned long long N = (1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats (since two inputs)
+  TRACE_SCOPE("2) Linear Multiply", "test");
   std::cout << CUDA << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Preparing..." << std::flush;
-  float* h_in1 = new float[N];
-  float* h_in2 = new float[N];
-  float* h_out = new float[N];
+  Trace::Span hostInitSpan("Host data init", "init");
+  float* h_in1 = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
+  float* h_in2 = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
+  float* h_out = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
   for (unsigned long long i = 0ull; i < N; ++i) {
     h_in1[i] = static_cast<float>(i);
     h_in2[i] = static_cast<float>(i) / 2;
   }
+  hostInitSpan.end();
+  Trace::Span allocSpan("Allocate", "alloc");
   CUdeviceptr d_in1 = 0, d_in2 = 0, d_out = 0;
   CUDA_ERR(cuMemAlloc(&d_in1, N * sizeof(float)));
   CUDA_ERR(cuMemAlloc(&d_in2, N * sizeof(float)));
   CUDA_ERR(cuMemAlloc(&d_out, N * sizeof(float)));
   CUDA_ERR(cuMemsetD8(d_out, 0, N * sizeof(float)));
+  allocSpan.end();
+  Trace::Span uploadSpan("Upload inputs", "transfer");
   CUDA_ERR(cuMemcpyHtoD(d_in1, h_in1, N * sizeof(float)));
   CUDA_ERR(cuMemcpyHtoD(d_in2, h_in2, N * sizeof(float)));
+  uploadSpan.end();
 
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_in1, &d_in2, &d_out};
@@ -333,8 +674,11 @@ float CudaBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, Cuda
   std::cout << "\r" << CUDA << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   CUDA_BENCHMARK_KERNEL(linearMultiplyFunc, blocks, threadsPerBlock, args, milliseconds);
   std::cout << "\r" << CUDA << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   CUDA_ERR(cuMemcpyDtoH(h_out, d_out, N * sizeof(float)));
+  downloadSpan.end();
 
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     float expected = static_cast<float>(i) * static_cast<float>(i) / 2;
@@ -345,6 +689,7 @@ float CudaBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, Cuda
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << CUDA << "2) Linear Multiply (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -353,23 +698,27 @@ float CudaBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, Cuda
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
 
+  Suite::record("linear_multiply", milliseconds, valid);
   CUDA_ERR(cuMemFree(d_in1));
   CUDA_ERR(cuMemFree(d_in2));
   CUDA_ERR(cuMemFree(d_out));
-  delete[] h_in1;
-  delete[] h_in2;
-  delete[] h_out;
+  HostMemory::release(h_in1, N * sizeof(float));
+  HostMemory::release(h_in2, N * sizeof(float));
+  HostMemory::release(h_out, N * sizeof(float));
   return valid ? milliseconds : 0.0f;
 }
 
 float CudaBackend::runFmaBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction fmaFunc) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
   constexpr const unsigned int totalIterations = 3000;
+  TRACE_SCOPE("3) FMA", "test");
   std::cout << CUDA << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Preparing..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
   float* h_out = new float[N];
   CUdeviceptr d_out = 0;
   CUDA_ERR(cuMemAlloc(&d_out, N * sizeof(float)));
   CUDA_ERR(cuMemsetD8(d_out, 0, N * sizeof(float)));
+  allocSpan.end();
 
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_out, (void*)&totalIterations};
@@ -379,6 +728,7 @@ float CudaBackend::runFmaBenchmark(unsigned int threadsPerBlock, CudaBackend::CU
   std::cout << "\r" << CUDA << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
   std::cout << GREEN << " PASSED" << RESET;
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("fma", milliseconds);
   CUDA_ERR(cuMemFree(d_out));
   delete[] h_out;
   return milliseconds;
@@ -387,11 +737,14 @@ float CudaBackend::runFmaBenchmark(unsigned int threadsPerBlock, CudaBackend::CU
 float CudaBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction intThroughputFunc) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(unsigned int); // 2GB worth of uints
   constexpr const unsigned int totalIterations = 5000;
+  TRACE_SCOPE("4) Integer Throughput", "test");
   std::cout << CUDA << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << std::flush;
   // No host side preparation needed.
+  Trace::Span allocSpan("Allocate", "alloc");
   CUdeviceptr d_out = 0;
   CUDA_ERR(cuMemAlloc(&d_out, N * sizeof(unsigned int)));
   CUDA_ERR(cuMemsetD8(d_out, 0, N * sizeof(unsigned int)));
+  allocSpan.end();
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_out, (void*)&totalIterations};
   float milliseconds = 0;
@@ -401,128 +754,211 @@ float CudaBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, C
   std::cout << "\r" << CUDA << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << GREEN
             << " PASSED" << RESET;
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("integer", milliseconds);
   CUDA_ERR(cuMemFree(d_out));
   return milliseconds;
 }
 
-float CudaBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction sharedMemoryFunc) {
-  constexpr const unsigned long long N = (1024 * 1024 * 1024) / sizeof(float); // 1GB worth of floats
-  constexpr const unsigned int totalIterations = 2000;
-  std::cout << CUDA << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << std::flush;
-  float* h_out = new float[N];
+// Shared memory reads and writes between threads at every stride of Microbench::sharedMemoryStrides(), from
+// conflict-free to every lane of a warp in the same bank. All strides run the iterations that take stride 1 20 ms.
+float CudaBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction sharedMemoryFunc, int dev,
+                                             int multiProcessorCount) {
+  const std::vector<unsigned int>& strides = Microbench::sharedMemoryStrides();
+  TRACE_SCOPE("5) Shared Memory Bandwidth", "test");
+  std::cout << CUDA << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
   CUdeviceptr d_out = 0;
-  CUDA_ERR(cuMemAlloc(&d_out, N * sizeof(float)));
-  CUDA_ERR(cuMemsetD8(d_out, 0, N * sizeof(float)));
+  CUDA_ERR(cuMemAlloc(&d_out, threads * sizeof(float)));
+  allocSpan.end();
 
-  unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
-  void* args[] = {&d_out, (void*)&totalIterations};
-  float milliseconds = 0;
-  std::cout << "\r" << CUDA << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Running..."
-            << std::flush;
-  CUDA_BENCHMARK_KERNEL(sharedMemoryFunc, blocks, threadsPerBlock, args, milliseconds);
-  std::cout << "\r" << CUDA << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
-  std::cout << GREEN << " PASSED" << RESET;
-  std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  auto timed = [&](unsigned int stride, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &stride, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(sharedMemoryFunc, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args,
+                            nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  unsigned int iterations = 256;
+  while (timed(1, iterations) < 20.0 && iterations < (1u << 24)) {
+    iterations *= 2;
+  }
+  std::vector<Microbench::SharedAccess> accesses;
+  for (unsigned int stride : strides) {
+    std::cout << "\r" << CUDA << "5) Shared Memory Bandwidth (stride " << stride << ")...   " << std::flush;
+    double bytes = static_cast<double>(threads) * iterations * Microbench::sharedMemoryBytesPerIteration;
+    accesses.push_back({stride, bytes, timed(stride, iterations)});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
   CUDA_ERR(cuMemFree(d_out));
-  delete[] h_out;
+
+  int clockKilohertz = 0;
+  CUDA_ERR(cuDeviceGetAttribute(&clockKilohertz, 13, dev)); // CU_DEVICE_ATTRIBUTE_CLOCK_RATE
+  std::cout << "\r" << CUDA << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportSharedMemory(CUDA, "shared_memory", accesses, clockKilohertz * 1e3, static_cast<unsigned int>(multiProcessorCount));
+  float milliseconds = static_cast<float>(Microbench::conflictFreeMilliseconds(accesses));
+  Suite::record("shared_memory", milliseconds);
   return milliseconds;
 }
 
-float CudaBackend::runSgemmBenchmark(unsigned int threadsPerBlock, void* kernel) {
-  constexpr const unsigned long long N = 1024; // 1024 x 1024 matrix (Pretty big! This will NOT be a 1gib test!)
-  constexpr const unsigned int totalIterations = 5000;
-  std::cout << CUDA << "6) SGEMM/Matrix mulitplication (" << N << "x" << N << " matrix, " << totalIterations << " iterations)..." << std::flush;
-  // Host side preparation
-  float* h_A = new float[N * N];
-  float* h_B = new float[N * N];
-  float* h_C = new float[N * N];
-  for (unsigned long long i = 0ull; i < N * N; ++i) {
-    h_A[i] = static_cast<float>(i % 100) / 10.0f;
-    h_B[i] = static_cast<float>((i + 3) % 100) / 10.0f;
-    h_C[i] = 0.0f;
-  }
-  CUdeviceptr d_A = 0, d_B = 0, d_C = 0;
-  CUDA_ERR(cuMemAlloc(&d_A, N * N * sizeof(float)));
-  CUDA_ERR(cuMemAlloc(&d_B, N * N * sizeof(float)));
-  CUDA_ERR(cuMemAlloc(&d_C, N * N * sizeof(float)));
-  CUDA_ERR(cuMemcpyHtoD(d_A, h_A, N * N * sizeof(float)));
-  CUDA_ERR(cuMemcpyHtoD(d_B, h_B, N * N * sizeof(float)));
-  CUDA_ERR(cuMemsetD8(d_C, 0, N * N * sizeof(float)));
-  unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
-  void* args[] = {&d_A, &d_B, &d_C, (void*)&N, (void*)&totalIterations};
-  float milliseconds = 0;
-  std::cout << "\r" << CUDA << "6) SGEMM/Matrix mulitplication (" << N << "x" << N << " matrix, " << totalIterations << " iterations)... Running..."
+// C = A * B with three kernels over a sweep of sizes: one thread per element straight from global memory, 16x16
+// tiles in shared memory, and 64x64 tiles with a 4x4 patch of C per thread in registers. Each kernel's result is checked
+// against the CPU on sampled elements at every size.
+float CudaBackend::runSgemmBenchmark(CudaBackend::CUfunction naiveFunc, CudaBackend::CUfunction tiledFunc, CudaBackend::CUfunction registerFunc) {
+  const std::vector<unsigned int>& sizes = Gemm::sizes();
+  const size_t maxBytes = static_cast<size_t>(sizes.back()) * sizes.back() * sizeof(float);
+  TRACE_SCOPE("6) SGEMM", "test");
+  std::cout << CUDA << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)..."
             << std::flush;
-  CUDA_BENCHMARK_KERNEL((CudaBackend::CUfunction)kernel, blocks, threadsPerBlock, args, milliseconds);
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_A = 0, d_B = 0, d_C = 0;
+  CUDA_ERR(cuMemAlloc(&d_A, maxBytes));
+  CUDA_ERR(cuMemAlloc(&d_B, maxBytes));
+  CUDA_ERR(cuMemAlloc(&d_C, maxBytes));
+  allocSpan.end();
 
-  // No verification after initial tests, because their entire purpose was to check for correctness.
-  // Now we just want performance! The verification is probably not necessary.
-  std::cout << "\r" << CUDA << "6) SGEMM/Matrix mulitplication (" << N << "x" << N << " matrix, " << totalIterations << " iterations)..." << GREEN
-            << " PASSED" << RESET;
-  std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  // One 2D launch of 16x16 blocks covering C, timed with events
+  auto launch = [&](CUfunction function, unsigned int tile, unsigned int n) {
+    void* args[] = {&d_A, &d_B, &d_C, &n};
+    unsigned int blocks = (n + tile - 1) / tile;
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(function, blocks, blocks, 1, 16, 16, 1, 0, stream, args, nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  struct Variant {
+    CUfunction function;
+    unsigned int tile; // Edge of the tile of C one block computes
+  };
+  const Variant variants[] = {{naiveFunc, 16}, {tiledFunc, 16}, {registerFunc, 64}};
+  std::vector<Gemm::Curve> curves = {{"Naive", "naive", {}}, {"Tiled 16x16", "tiled", {}}, {"Register 4x4", "register", {}}};
+  for (unsigned int n : sizes) {
+    TRACE_SCOPE("SGEMM size", "kernel");
+    const size_t bytes = static_cast<size_t>(n) * n * sizeof(float);
+    std::vector<float> h_A = Gemm::randomMatrix(n, 1), h_B = Gemm::randomMatrix(n, 2), h_C(static_cast<size_t>(n) * n);
+    CUDA_ERR(cuMemcpyHtoD(d_A, h_A.data(), bytes));
+    CUDA_ERR(cuMemcpyHtoD(d_B, h_B.data(), bytes));
+    for (size_t v = 0; v < std::size(variants); ++v) {
+      Gemm::Curve& curve = curves[v];
+      // Once a variant went over the budget (or was skipped), larger sizes are skipped too
+      if (!curve.milliseconds.empty() && (curve.milliseconds.back() == 0.0 || curve.milliseconds.back() > Gemm::timeBudgetMilliseconds)) {
+        curve.milliseconds.push_back(0.0);
+        continue;
+      }
+      std::cout << "\r" << CUDA << "6) SGEMM (" << n << "x" << n << ", " << curve.name << ")..." << std::flush;
+      CUDA_ERR(cuMemsetD8(d_C, 0, bytes));
+      double best = launch(variants[v].function, variants[v].tile, n);
+      CUDA_ERR(cuMemcpyDtoH(h_C.data(), d_C, bytes));
+      curve.valid = curve.valid && Gemm::verifySamples(h_A, h_B, h_C, n);
+      for (int run = 0; run < 2 && best < Gemm::timeBudgetMilliseconds; ++run) {
+        best = std::min(best, launch(variants[v].function, variants[v].tile, n));
+      }
+      curve.milliseconds.push_back(best);
+    }
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
   CUDA_ERR(cuMemFree(d_A));
   CUDA_ERR(cuMemFree(d_B));
   CUDA_ERR(cuMemFree(d_C));
-  delete[] h_A;
-  delete[] h_B;
-  delete[] h_C;
+
+  bool valid = std::all_of(curves.begin(), curves.end(), [](const Gemm::Curve& curve) { return curve.valid; });
+  std::cout << "\r" << CUDA << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  for (const Gemm::Curve& curve : curves) {
+    if (!curve.valid)
+      std::cout << CUDA << curve.name << " does not match the CPU result\n";
+  }
+  Gemm::report(CUDA, "sgemm", sizes, curves);
+  // The register-blocked kernel at 1024 (or the largest size it reached), as close as the sweep gets to the single
+  // 1024x1024 run this test used to time
+  float milliseconds = static_cast<float>(Gemm::millisecondsAt(sizes, curves.back(), 1024));
+  Suite::record("sgemm", milliseconds, valid);
   return milliseconds;
 }
 
-float CudaBackend::runPCIEThroughputBenchmark() {
+float CudaBackend::runPCIEThroughputBenchmark(int hostNode) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024); // 2GB
   constexpr int iterations = 5;
+  TRACE_SCOPE("7) PCIe Throughput", "test");
   std::cout << CUDA << "7) PCIe Throughput (2 GB transfer, avg of " << iterations << " runs)..." << std::flush;
-  char* h_data = nullptr;
-  CUDA_ERR(cuMemAllocHost((void**)&h_data, N * sizeof(char), 0));
+  Trace::Span allocSpan("Allocate", "alloc");
+  // Huge pages on the device's node, then pinned, rather than whatever cuMemAllocHost's first touch lands on
+  char* h_data = static_cast<char*>(HostMemory::allocate(N * sizeof(char), hostNode));
+  CUDA_ERR(cuMemHostRegister(h_data, N * sizeof(char), 0));
   for (unsigned long long i = 0ull; i < N; ++i) {
     h_data[i] = static_cast<char>(i % 256);
   }
   CUdeviceptr d_data = 0;
   CUDA_ERR(cuMemAlloc(&d_data, N * sizeof(char)));
+  allocSpan.end();
 
   float totalMillisecondsHtoD = 0;
   float totalMillisecondsDtoH = 0;
 
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
   for (int i = 0; i < iterations; ++i) {
     // Host to Device
     float millisecondsHtoD = 0;
-    {
-      CUstream stream;
-      CUDA_ERR(cuStreamCreate(&stream, 0));
-      CUevent startEvent, stopEvent;
-      CUDA_ERR(cuEventCreate(&startEvent, 0));
-      CUDA_ERR(cuEventCreate(&stopEvent, 0));
-      CUDA_ERR(cuEventRecord(startEvent, stream));
-      CUDA_ERR(cuMemcpyHtoD(d_data, h_data, N * sizeof(char)));
-      CUDA_ERR(cuEventRecord(stopEvent, stream));
-      CUDA_ERR(cuEventSynchronize(stopEvent));
-      CUDA_ERR(cuEventElapsedTime(&millisecondsHtoD, startEvent, stopEvent));
-      CUDA_ERR(cuEventDestroy(startEvent));
-      CUDA_ERR(cuEventDestroy(stopEvent));
-      CUDA_ERR(cuStreamDestroy(stream));
-    }
+    Trace::Span htodSpan("Host to Device", "transfer");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuMemcpyHtoD(d_data, h_data, N * sizeof(char)));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&millisecondsHtoD, startEvent, stopEvent));
+    htodSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Host to Device", "transfer", htodSpan.started(), millisecondsHtoD);
     totalMillisecondsHtoD += millisecondsHtoD;
 
     // Device to Host
     float millisecondsDtoH = 0;
-    {
-      CUstream stream;
-      CUDA_ERR(cuStreamCreate(&stream, 0));
-      CUevent startEvent, stopEvent;
-      CUDA_ERR(cuEventCreate(&startEvent, 0));
-      CUDA_ERR(cuEventCreate(&stopEvent, 0));
-      CUDA_ERR(cuEventRecord(startEvent, stream));
-      CUDA_ERR(cuMemcpyDtoH(h_data, d_data, N * sizeof(char)));
-      CUDA_ERR(cuEventRecord(stopEvent, stream));
-      CUDA_ERR(cuEventSynchronize(stopEvent));
-      CUDA_ERR(cuEventElapsedTime(&millisecondsDtoH, startEvent, stopEvent));
-      CUDA_ERR(cuEventDestroy(startEvent));
-      CUDA_ERR(cuEventDestroy(stopEvent));
-      CUDA_ERR(cuStreamDestroy(stream));
-    }
+    Trace::Span dtohSpan("Device to Host", "transfer");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuMemcpyDtoH(h_data, d_data, N * sizeof(char)));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&millisecondsDtoH, startEvent, stopEvent));
+    dtohSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Device to Host", "transfer", dtohSpan.started(), millisecondsDtoH);
     totalMillisecondsDtoH += millisecondsDtoH;
   }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
 
   float avgMillisecondsHtoD = totalMillisecondsHtoD / iterations;
   float avgMillisecondsDtoH = totalMillisecondsDtoH / iterations;
@@ -530,12 +966,1837 @@ float CudaBackend::runPCIEThroughputBenchmark() {
   std::cout << "\r" << CUDA << "7) PCIe Throughput (2 GB transfer, avg of " << iterations
             << " runs)... Host to Device: " << (N / (avgMillisecondsHtoD / 1000.0f) / (1024 * 1024))
             << " MB/s, Device to Host: " << (N / (avgMillisecondsDtoH / 1000.0f) / (1024 * 1024)) << " MB/s\n";
+  Suite::record("pcie", (avgMillisecondsHtoD + avgMillisecondsDtoH) / 2.0f);
+  Suite::metric("pcie", "htod_mb_per_s", N / (avgMillisecondsHtoD / 1000.0) / (1024 * 1024));
+  Suite::metric("pcie", "dtoh_mb_per_s", N / (avgMillisecondsDtoH / 1000.0) / (1024 * 1024));
 
   CUDA_ERR(cuMemFree(d_data));
-  CUDA_ERR(cuMemFreeHost(h_data));
+  CUDA_ERR(cuMemHostUnregister(h_data));
+  HostMemory::release(h_data, N * sizeof(char));
   return (avgMillisecondsHtoD + avgMillisecondsDtoH) / 2.0f;
 }
 
+// Measures what the pools save: the cost of creating and destroying the stream and two events that
+// every timed region used to set up, against taking the same objects from the execution context.
+float CudaBackend::runStreamEventOverheadBenchmark() {
+  constexpr int cycles = 1000;
+  TRACE_SCOPE("8) Stream/Event Overhead", "test");
+  std::cout << CUDA << "8) Stream/Event Overhead (" << cycles << " cycles)..." << std::flush;
+  using clock = std::chrono::steady_clock;
+
+  auto start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    CUstream stream;
+    CUDA_ERR(cuStreamCreate(&stream, 0));
+    CUDA_ERR(cuStreamDestroy(stream));
+  }
+  double streamMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    CUevent event;
+    CUDA_ERR(cuEventCreate(&event, 0));
+    CUDA_ERR(cuEventDestroy(event));
+  }
+  double eventMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    CUstream stream = acquireStream();
+    CUevent startEvent = acquireEvent();
+    CUevent stopEvent = acquireEvent();
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    releaseStream(stream);
+  }
+  double pooledMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  // One timed region needs a stream and two events
+  double unpooledMicroseconds = streamMicroseconds + 2 * eventMicroseconds;
+  std::cout << "\r" << CUDA << "8) Stream/Event Overhead (" << cycles << " cycles)... Stream create/destroy: " << std::fixed << std::setprecision(2)
+            << streamMicroseconds << " us, Event create/destroy: " << eventMicroseconds << " us, Per timed region: " << unpooledMicroseconds
+            << " us unpooled vs " << pooledMicroseconds << " us pooled\n";
+  Suite::record("stream_overhead", static_cast<float>(unpooledMicroseconds / 1000.0));
+  Suite::metric("stream_overhead", "stream_create_destroy_us", streamMicroseconds);
+  Suite::metric("stream_overhead", "event_create_destroy_us", eventMicroseconds);
+  Suite::metric("stream_overhead", "pooled_acquire_release_us", pooledMicroseconds);
+  return static_cast<float>(unpooledMicroseconds / 1000.0);
+}
+
+// Real workloads move many small buffers, often from pageable memory, so a single large pinned copy
+// overstates what they get. Copies are synchronous and timed on the host: for pageable memory the driver
+// stages through its own pinned buffer, and that cost is part of what is being measured.
+float CudaBackend::runTransferSweepBenchmark(size_t totalMemory) {
+  constexpr size_t minBytes = 4ull * 1024;                               // 4 KB
+  const size_t maxBytes = std::min<size_t>(1ull << 30, totalMemory / 4); // 1 GB, or a quarter of VRAM on small devices
+  TRACE_SCOPE("9) Transfer Size Sweep", "test");
+  std::cout << CUDA << "9) Transfer Size Sweep (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", pinned vs pageable)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char* h_pinned = nullptr;
+  CUDA_ERR(cuMemAllocHost((void**)&h_pinned, maxBytes, 0));
+  char* h_pageable = new char[maxBytes];
+  // Fault every page in up front, so first-touch cost is not charged to the first copy
+  std::memset(h_pinned, 1, maxBytes);
+  std::memset(h_pageable, 1, maxBytes);
+  CUdeviceptr d_data = 0;
+  CUDA_ERR(cuMemAlloc(&d_data, maxBytes));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  auto timeCopies = [&](char* host, bool toDevice, size_t bytes) {
+    int reps = Sweep::repetitions(bytes, 256ull * 1024 * 1024, 3, 1000);
+    // Warm up so lazy driver setup for this buffer is not timed
+    if (toDevice)
+      CUDA_ERR(cuMemcpyHtoD(d_data, host, bytes));
+    else
+      CUDA_ERR(cuMemcpyDtoH(host, d_data, bytes));
+    CUDA_ERR(cuCtxSynchronize());
+    auto start = clock::now();
+    for (int i = 0; i < reps; ++i) {
+      if (toDevice)
+        CUDA_ERR(cuMemcpyHtoD(d_data, host, bytes));
+      else
+        CUDA_ERR(cuMemcpyDtoH(host, d_data, bytes));
+    }
+    // A pageable cuMemcpyHtoD can return once the data is staged, before the DMA to the device has finished
+    CUDA_ERR(cuCtxSynchronize());
+    double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+    return Sweep::Point{static_cast<double>(bytes), milliseconds};
+  };
+
+  std::vector<Sweep::Point> pinnedHtoD, pinnedDtoH, pageableHtoD, pageableDtoH;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Transfer size step", "transfer");
+    pinnedHtoD.push_back(timeCopies(h_pinned, true, bytes));
+    pinnedDtoH.push_back(timeCopies(h_pinned, false, bytes));
+    pageableHtoD.push_back(timeCopies(h_pageable, true, bytes));
+    pageableDtoH.push_back(timeCopies(h_pageable, false, bytes));
+  }
+
+  std::cout << "\r" << CUDA << "9) Transfer Size Sweep (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", pinned vs pageable)... Done\n";
+  Sweep::printTable(CUDA, {"Pinned HtoD", "Pinned DtoH", "Pageable HtoD", "Pageable DtoH"},
+                    {pinnedHtoD, pinnedDtoH, pageableHtoD, pageableDtoH});
+  float milliseconds = static_cast<float>(pinnedHtoD.back().milliseconds);
+  Suite::record("transfer_sweep", milliseconds);
+  Sweep::record("transfer_sweep", "pinned_htod", pinnedHtoD);
+  Sweep::record("transfer_sweep", "pinned_dtoh", pinnedDtoH);
+  Sweep::record("transfer_sweep", "pageable_htod", pageableHtoD);
+  Sweep::record("transfer_sweep", "pageable_dtoh", pageableDtoH);
+
+  CUDA_ERR(cuMemFree(d_data));
+  CUDA_ERR(cuMemFreeHost(h_pinned));
+  delete[] h_pageable;
+  return milliseconds;
+}
+
+// Test 7 copies one direction at a time. This issues both directions at once on separate streams to find out
+// whether the device's copy engines can keep both directions busy, or whether they share one engine or the link.
+float CudaBackend::runBidirectionalPCIEBenchmark(size_t totalMemory) {
+  const size_t N = std::min<size_t>(256ull * 1024 * 1024, totalMemory / 8); // Per direction
+  constexpr int iterations = 5;
+  TRACE_SCOPE("10) Bidirectional PCIe", "test");
+  std::cout << CUDA << "10) Bidirectional PCIe (" << Sweep::formatBytes(N) << " each way, avg of " << iterations << " runs)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char* h_up = nullptr;
+  char* h_down = nullptr;
+  CUDA_ERR(cuMemAllocHost((void**)&h_up, N, 0));
+  CUDA_ERR(cuMemAllocHost((void**)&h_down, N, 0));
+  std::memset(h_up, 1, N);
+  std::memset(h_down, 0, N);
+  CUdeviceptr d_up = 0, d_down = 0;
+  CUDA_ERR(cuMemAlloc(&d_up, N));
+  CUDA_ERR(cuMemAlloc(&d_down, N));
+  allocSpan.end();
+
+  CUstream upStream = acquireStream();
+  CUstream downStream = acquireStream();
+  CUevent upStart = acquireEvent(), upStop = acquireEvent();
+  CUevent downStart = acquireEvent(), downStop = acquireEvent();
+
+  struct Timing {
+    float up = 0.0f;    // Host to Device
+    float down = 0.0f;  // Device to Host
+    float total = 0.0f; // First copy started to last copy finished
+  };
+  auto timeCopies = [&](bool up, bool down) {
+    Timing timing;
+    for (int i = 0; i < iterations; ++i) {
+      Trace::Span span(up && down ? "Both directions" : (up ? "Host to Device" : "Device to Host"), "transfer");
+      if (up) {
+        CUDA_ERR(cuEventRecord(upStart, upStream));
+        CUDA_ERR(cuMemcpyHtoDAsync(d_up, h_up, N, upStream));
+        CUDA_ERR(cuEventRecord(upStop, upStream));
+      }
+      if (down) {
+        CUDA_ERR(cuEventRecord(downStart, downStream));
+        CUDA_ERR(cuMemcpyDtoHAsync(h_down, d_down, N, downStream));
+        CUDA_ERR(cuEventRecord(downStop, downStream));
+      }
+      float upMilliseconds = 0.0f, downMilliseconds = 0.0f, totalMilliseconds = 0.0f;
+      if (up) {
+        CUDA_ERR(cuEventSynchronize(upStop));
+        CUDA_ERR(cuEventElapsedTime(&upMilliseconds, upStart, upStop));
+        totalMilliseconds = upMilliseconds;
+      }
+      if (down) {
+        CUDA_ERR(cuEventSynchronize(downStop));
+        CUDA_ERR(cuEventElapsedTime(&downMilliseconds, downStart, downStop));
+        totalMilliseconds = downMilliseconds;
+      }
+      if (up && down) {
+        // Both copies measured against the upload's start event, which may have been recorded second
+        float downStartOffset = 0.0f, downStopOffset = 0.0f;
+        CUDA_ERR(cuEventElapsedTime(&downStartOffset, upStart, downStart));
+        CUDA_ERR(cuEventElapsedTime(&downStopOffset, upStart, downStop));
+        totalMilliseconds = std::max(upMilliseconds, downStopOffset) - std::min(0.0f, downStartOffset);
+      }
+      span.end();
+      if (Trace::enabled()) {
+        if (up)
+          Trace::recordDeviceSpan(streamTrack(upStream), "Host to Device", "transfer", span.started(), upMilliseconds);
+        if (down)
+          Trace::recordDeviceSpan(streamTrack(downStream), "Device to Host", "transfer", span.started(), downMilliseconds);
+      }
+      timing.up += upMilliseconds / iterations;
+      timing.down += downMilliseconds / iterations;
+      timing.total += totalMilliseconds / iterations;
+    }
+    return timing;
+  };
+
+  Timing upOnly = timeCopies(true, false);
+  Timing downOnly = timeCopies(false, true);
+  Timing both = timeCopies(true, true);
+
+  releaseEvent(upStart);
+  releaseEvent(upStop);
+  releaseEvent(downStart);
+  releaseEvent(downStop);
+  releaseStream(upStream);
+  releaseStream(downStream);
+
+  auto megabytesPerSecond = [](double bytes, float milliseconds) {
+    return milliseconds > 0.0f ? bytes / (milliseconds / 1000.0) / (1024 * 1024) : 0.0;
+  };
+  double upAlone = megabytesPerSecond(N, upOnly.up);
+  double downAlone = megabytesPerSecond(N, downOnly.down);
+  double upShared = megabytesPerSecond(N, both.up);
+  double downShared = megabytesPerSecond(N, both.down);
+  double aggregate = megabytesPerSecond(2.0 * N, both.total);
+  std::cout << "\r" << CUDA << "10) Bidirectional PCIe (" << Sweep::formatBytes(N) << " each way, avg of " << iterations
+            << " runs)... Unidirectional: Host to Device " << upAlone << " MB/s, Device to Host " << downAlone << " MB/s\n";
+  std::cout << CUDA << "    Simultaneous: Host to Device " << upShared << " MB/s, Device to Host " << downShared << " MB/s, Aggregate "
+            << aggregate << " MB/s (" << std::setprecision(2) << aggregate / std::max(upAlone, downAlone) << "x the faster direction alone)\n";
+  Suite::record("pcie_bidirectional", both.total);
+  Suite::metric("pcie_bidirectional", "htod_mb_per_s", upAlone);
+  Suite::metric("pcie_bidirectional", "dtoh_mb_per_s", downAlone);
+  Suite::metric("pcie_bidirectional", "bidir_htod_mb_per_s", upShared);
+  Suite::metric("pcie_bidirectional", "bidir_dtoh_mb_per_s", downShared);
+  Suite::metric("pcie_bidirectional", "bidir_aggregate_mb_per_s", aggregate);
+
+  CUDA_ERR(cuMemFree(d_up));
+  CUDA_ERR(cuMemFree(d_down));
+  CUDA_ERR(cuMemFreeHost(h_up));
+  CUDA_ERR(cuMemFreeHost(h_down));
+  return both.total;
+}
+
+// Splits linearMultiplyKernel's work into chunks that each upload, multiply and download on their own stream, so one
+// chunk's copies can run while another chunk computes. A device or driver that serializes everything gets a factor of 1.
+float CudaBackend::runCopyComputeOverlapBenchmark(unsigned int threadsPerBlock, CUfunction linearMultiplyFunc, size_t totalMemory) {
+  constexpr unsigned int chunks = 16;
+  constexpr int iterations = 3;
+  constexpr unsigned int streamCounts[] = {1, 2, 4, 8};
+  // 256 MB per array (a sixteenth of VRAM on small devices), rounded so every chunk is a whole number of blocks
+  const size_t maxElements = std::min<size_t>(64ull * 1024 * 1024, totalMemory / 16 / sizeof(float));
+  const size_t chunkElements = maxElements / chunks / threadsPerBlock * threadsPerBlock;
+  const size_t N = chunkElements * chunks;
+  const size_t bytes = N * sizeof(float);
+  TRACE_SCOPE("11) Copy/Compute Overlap", "test");
+  std::cout << CUDA << "11) Copy/Compute Overlap (" << Sweep::formatBytes(bytes) << " per array, " << chunks << " chunks)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  float* h_A = nullptr;
+  float* h_B = nullptr;
+  float* h_out = nullptr;
+  CUDA_ERR(cuMemAllocHost((void**)&h_A, bytes, 0));
+  CUDA_ERR(cuMemAllocHost((void**)&h_B, bytes, 0));
+  CUDA_ERR(cuMemAllocHost((void**)&h_out, bytes, 0));
+  for (size_t i = 0; i < N; ++i) {
+    h_A[i] = static_cast<float>(i % 1024);
+    h_B[i] = 0.5f;
+  }
+  std::memset(h_out, 0, bytes);
+  CUdeviceptr d_A = 0, d_B = 0, d_out = 0;
+  CUDA_ERR(cuMemAlloc(&d_A, bytes));
+  CUDA_ERR(cuMemAlloc(&d_B, bytes));
+  CUDA_ERR(cuMemAlloc(&d_out, bytes));
+  allocSpan.end();
+
+  std::vector<CUstream> streams;
+  for (unsigned int i = 0; i < streamCounts[std::size(streamCounts) - 1]; ++i) {
+    streams.push_back(acquireStream());
+  }
+
+  // Host wall time of the best run, from the first enqueue until the device is idle
+  using clock = std::chrono::steady_clock;
+  auto bestWallTime = [&](const char* name, auto&& enqueue) {
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+      Trace::Span span(name, "transfer");
+      auto start = clock::now();
+      enqueue();
+      CUDA_ERR(cuCtxSynchronize());
+      double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+      if (i == 0 || milliseconds < best)
+        best = milliseconds;
+    }
+    return best;
+  };
+  auto enqueueChunk = [&](size_t offset, size_t elements, CUstream stream) {
+    CUdeviceptr a = d_A + offset * sizeof(float), b = d_B + offset * sizeof(float), out = d_out + offset * sizeof(float);
+    CUDA_ERR(cuMemcpyHtoDAsync(a, h_A + offset, elements * sizeof(float), stream));
+    CUDA_ERR(cuMemcpyHtoDAsync(b, h_B + offset, elements * sizeof(float), stream));
+    void* args[] = {&a, &b, &out};
+    CUDA_ERR(cuLaunchKernel(linearMultiplyFunc, elements / threadsPerBlock, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+    CUDA_ERR(cuMemcpyDtoHAsync(h_out + offset, out, elements * sizeof(float), stream));
+  };
+
+  // The same work with no chance of overlap: each stage over the whole buffer, one after the other
+  double uploadMilliseconds = bestWallTime("Upload", [&] {
+    CUDA_ERR(cuMemcpyHtoDAsync(d_A, h_A, bytes, streams[0]));
+    CUDA_ERR(cuMemcpyHtoDAsync(d_B, h_B, bytes, streams[0]));
+  });
+  double multiplyMilliseconds = bestWallTime("Multiply", [&] {
+    void* args[] = {&d_A, &d_B, &d_out};
+    CUDA_ERR(cuLaunchKernel(linearMultiplyFunc, N / threadsPerBlock, 1, 1, threadsPerBlock, 1, 1, 0, streams[0], args, nullptr));
+  });
+  double downloadMilliseconds = bestWallTime("Download", [&] {
+    CUDA_ERR(cuMemcpyDtoHAsync(h_out, d_out, bytes, streams[0]));
+  });
+  double serializedMilliseconds = uploadMilliseconds + multiplyMilliseconds + downloadMilliseconds;
+
+  std::vector<double> pipelinedMilliseconds;
+  for (unsigned int streamCount : streamCounts) {
+    std::memset(h_out, 0, bytes);
+    pipelinedMilliseconds.push_back(bestWallTime("Pipeline", [&] {
+      for (unsigned int c = 0; c < chunks; ++c) {
+        enqueueChunk(c * chunkElements, chunkElements, streams[c % streamCount]);
+      }
+    }));
+  }
+  for (CUstream stream : streams) {
+    releaseStream(stream);
+  }
+
+  bool valid = true;
+  for (size_t i = 0; i < N; i += 4099) {
+    if (h_out[i] != h_A[i] * h_B[i]) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected " << h_A[i] * h_B[i] << ", got " << h_out[i] << "\n";
+      break;
+    }
+  }
+
+  double bestMilliseconds = *std::min_element(pipelinedMilliseconds.begin(), pipelinedMilliseconds.end());
+  std::cout << "\r" << CUDA << "11) Copy/Compute Overlap (" << Sweep::formatBytes(bytes) << " per array, " << chunks << " chunks)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " Serialized: " << std::fixed << std::setprecision(3) << serializedMilliseconds << " ms (upload " << uploadMilliseconds
+            << " + multiply " << multiplyMilliseconds << " + download " << downloadMilliseconds << ")\n";
+  Suite::record("copy_compute_overlap", static_cast<float>(bestMilliseconds), valid);
+  Suite::metric("copy_compute_overlap", "serialized_ms", serializedMilliseconds);
+  for (size_t i = 0; i < pipelinedMilliseconds.size(); ++i) {
+    double overlap = serializedMilliseconds / pipelinedMilliseconds[i];
+    std::cout << CUDA << "    " << std::setw(2) << streamCounts[i] << (streamCounts[i] == 1 ? " stream:  " : " streams: ") << pipelinedMilliseconds[i]
+              << " ms, overlap factor " << std::setprecision(2) << overlap << "x\n"
+              << std::setprecision(3);
+    std::string suffix = "_" + std::to_string(streamCounts[i]) + "_streams";
+    Suite::metric("copy_compute_overlap", "pipelined_ms" + suffix, pipelinedMilliseconds[i]);
+    Suite::metric("copy_compute_overlap", "overlap_factor" + suffix, overlap);
+  }
+
+  CUDA_ERR(cuMemFree(d_A));
+  CUDA_ERR(cuMemFree(d_B));
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFreeHost(h_A));
+  CUDA_ERR(cuMemFreeHost(h_B));
+  CUDA_ERR(cuMemFreeHost(h_out));
+  return static_cast<float>(bestMilliseconds);
+}
+
+// Device-to-device copies between every ordered pair of devices. Pairs the driver reports as peer capable copy
+// directly (NVLink or PCIe P2P); the rest are staged through pinned host memory, which is what a framework falls back to.
+std::vector<GPUMark::PeerLink> CudaBackend::runPeerToPeerBenchmark(const std::vector<int>& devices) {
+  constexpr size_t N = 256ull * 1024 * 1024; // 256 MB
+  constexpr size_t latencyBytes = 4;
+  constexpr int iterations = 5;
+  constexpr int latencyIterations = 100;
+  TRACE_SCOPE("12) Peer-to-Peer Matrix", "test");
+  std::cout << CUDA << "12) Peer-to-Peer Matrix (" << devices.size() << " devices, " << Sweep::formatBytes(N) << " copies)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  PeerContexts peers;
+  CUDA_ERR(cuCtxGetCurrent(&peers.previous));
+  peers.contexts.resize(devices.size(), nullptr);
+  std::vector<CUcontext>& contexts = peers.contexts;
+  std::vector<CUdeviceptr> buffers(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    CUDA_ERR(cuCtxCreate(&contexts[i], 0, devices[i]));
+    CUDA_ERR(cuMemAlloc(&buffers[i], N));
+    CUDA_ERR(cuMemsetD8(buffers[i], static_cast<unsigned char>(i), N));
+    CUDA_ERR(cuCtxPopCurrent(nullptr));
+  }
+  // Portable, so every context can DMA from it
+  CUDA_ERR(cuCtxSetCurrent(contexts[0]));
+  char* h_staging = nullptr;
+  CUDA_ERR(cuMemHostAlloc((void**)&h_staging, N, CU_MEMHOSTALLOC_PORTABLE));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  std::vector<GPUMark::PeerLink> links;
+  for (size_t src = 0; src < devices.size(); ++src) {
+    for (size_t dst = 0; dst < devices.size(); ++dst) {
+      if (src == dst)
+        continue;
+      GPUMark::PeerLink link{devices[src], devices[dst]};
+      int canAccessPeer = 0;
+      CUDA_ERR(cuDeviceCanAccessPeer(&canAccessPeer, devices[src], devices[dst]));
+      CUDA_ERR(cuCtxSetCurrent(contexts[src]));
+      if (canAccessPeer) {
+        CUresult result = cuCtxEnablePeerAccess(contexts[dst], 0);
+        link.peerAccess = result == CUDA_SUCCESS || result == CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED;
+      }
+
+      auto copy = [&](size_t bytes) {
+        if (link.peerAccess) {
+          CUDA_ERR(cuMemcpyPeer(buffers[dst], contexts[dst], buffers[src], contexts[src], bytes));
+          CUDA_ERR(cuCtxSynchronize());
+        } else {
+          CUDA_ERR(cuMemcpyDtoH(h_staging, buffers[src], bytes));
+          CUDA_ERR(cuCtxSetCurrent(contexts[dst]));
+          CUDA_ERR(cuMemcpyHtoD(buffers[dst], h_staging, bytes));
+          CUDA_ERR(cuCtxSetCurrent(contexts[src]));
+        }
+      };
+      auto averageMilliseconds = [&](size_t bytes, int reps) {
+        copy(bytes); // Warm up
+        auto start = clock::now();
+        for (int i = 0; i < reps; ++i) {
+          copy(bytes);
+        }
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+      };
+
+      Trace::Span span(link.peerAccess ? "Peer copy" : "Staged copy", "transfer");
+      link.latencyMicroseconds = averageMilliseconds(latencyBytes, latencyIterations) * 1000.0;
+      link.gigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(N), averageMilliseconds(N, iterations)});
+      links.push_back(link);
+    }
+  }
+
+  CUDA_ERR(cuMemFreeHost(h_staging));
+  for (size_t i = 0; i < devices.size(); ++i) {
+    CUDA_ERR(cuCtxSetCurrent(contexts[i]));
+    CUDA_ERR(cuMemFree(buffers[i]));
+  }
+  for (CUcontext& context : contexts) {
+    CUDA_ERR(cuCtxDestroy(std::exchange(context, nullptr)));
+  }
+  CUDA_ERR(cuCtxSetCurrent(peers.previous));
+  std::cout << "\r" << CUDA << "12) Peer-to-Peer Matrix (" << devices.size() << " devices, " << Sweep::formatBytes(N) << " copies)... Done\n";
+  return links;
+}
+
+// Dependent loads over a pseudo-randomly linked working set, from 1 KB up to half of VRAM. Every link lands on a different
+// 64-byte slot, so latency steps up each time the working set outgrows a cache level (or, at the largest sizes, the TLB).
+float CudaBackend::runPointerChaseBenchmark(CUfunction initFunc, CUfunction chaseFunc, size_t totalMemory) {
+  constexpr size_t minBytes = 1024;
+  // Chain entries are 32-bit word offsets, so the largest working set is 16 GB
+  const size_t maxLimit = std::min<size_t>(totalMemory / 2, 16ull * 1024 * 1024 * 1024);
+  size_t maxBytes = minBytes;
+  while (maxBytes * 2 <= maxLimit) {
+    maxBytes *= 2;
+  }
+  // Kernel arguments, so not const
+  unsigned int slotWords = 64 / sizeof(unsigned int);
+  unsigned int steps = 1u << 18;
+  unsigned long long multiplier = 6364136223846793005ull; // % 4 == 1
+  unsigned long long increment = 1442695040888963407ull;  // Odd
+  TRACE_SCOPE("13) Pointer-Chase Latency", "test");
+  std::cout << CUDA << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", " << steps
+            << " dependent loads per size)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_chain = 0, d_out = 0;
+  CUDA_ERR(cuMemAlloc(&d_chain, maxBytes));
+  CUDA_ERR(cuMemAlloc(&d_out, sizeof(unsigned int)));
+  allocSpan.end();
+
+  std::vector<double> sizes, nanoseconds;
+  float milliseconds = 0;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    unsigned long long slots = bytes / (slotWords * sizeof(unsigned int));
+    void* initArgs[] = {&d_chain, &slots, &slotWords, &multiplier, &increment};
+    CUDA_ERR(cuLaunchKernel(initFunc, (slots + 255) / 256, 1, 1, 256, 1, 1, 0, nullptr, initArgs, nullptr));
+    void* chaseArgs[] = {&d_chain, &steps, &d_out};
+    // One untimed walk first, so the timed one starts with whatever part of the set fits already cached
+    CUDA_ERR(cuLaunchKernel(chaseFunc, 1, 1, 1, 1, 1, 1, 0, nullptr, chaseArgs, nullptr));
+    CUDA_ERR(cuCtxSynchronize());
+    CUDA_BENCHMARK_KERNEL(chaseFunc, 1, 1, chaseArgs, milliseconds);
+    sizes.push_back(static_cast<double>(bytes));
+    nanoseconds.push_back(milliseconds * 1e6 / steps);
+  }
+  std::cout << "\r" << CUDA << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", "
+            << steps << " dependent loads per size)... Done\n";
+  Sweep::reportLatencyCurve(CUDA, "pointer_chase", sizes, nanoseconds);
+  Suite::record("pointer_chase", milliseconds);
+
+  CUDA_ERR(cuMemFree(d_chain));
+  CUDA_ERR(cuMemFree(d_out));
+  return milliseconds;
+}
+
+// linearSetKernel and linearMultiplyKernel only read perfectly coalesced, unit-stride data. This sweeps stride, misalignment
+// and element width to show what gather-like data layouts cost.
+float CudaBackend::runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<void*, 3>& kernels, size_t totalMemory,
+                                             unsigned int warpSize) {
+  constexpr unsigned int widths[] = {4, 8, 16};
+  constexpr unsigned int strides[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+  constexpr unsigned int offsets[] = {0, 1};
+  constexpr unsigned long long maxElements = 16ull * 1024 * 1024;
+  const size_t bytes = std::min<size_t>(1ull << 30, totalMemory / 4);
+  TRACE_SCOPE("14) Strided Access", "test");
+  std::cout << CUDA << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_in = 0, d_out = 0;
+  CUDA_ERR(cuMemAlloc(&d_in, bytes));
+  CUDA_ERR(cuMemAlloc(&d_out, sizeof(float)));
+  CUDA_ERR(cuMemsetD8(d_in, 0, bytes));
+  allocSpan.end();
+
+  std::vector<Sweep::AccessPattern> patterns;
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(widths); ++w) {
+    {
+      // The first launch of each kernel pays for loading it, keep that out of the table
+      unsigned long long n = threadsPerBlock;
+      unsigned int stride = 1, offset = 0;
+      void* args[] = {&d_in, &d_out, &n, &stride, &offset};
+      float milliseconds = 0;
+      CUDA_BENCHMARK_KERNEL(kernels[w], 1, threadsPerBlock, args, milliseconds);
+    }
+    for (unsigned int stride : strides) {
+      for (unsigned int offset : offsets) {
+        unsigned long long n = std::min<unsigned long long>(maxElements, (bytes / widths[w] - offset) / stride);
+        void* args[] = {&d_in, &d_out, &n, &stride, &offset};
+        unsigned long long blocks = (n + threadsPerBlock - 1) / threadsPerBlock;
+        float milliseconds = 0;
+        CUDA_BENCHMARK_KERNEL(kernels[w], blocks, threadsPerBlock, args, milliseconds);
+        patterns.push_back({widths[w], stride, offset, static_cast<double>(n), milliseconds});
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  std::cout << "\r" << CUDA << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)... Done\n";
+  Sweep::reportAccessPatterns(CUDA, "strided_access", patterns, warpSize, 32);
+  Suite::record("strided_access", totalMilliseconds);
+
+  CUDA_ERR(cuMemFree(d_in));
+  CUDA_ERR(cuMemFree(d_out));
+  return totalMilliseconds;
+}
+
+// STREAM (McCalpin): Copy, Scale, Add and Triad over arrays far larger than any cache, each repeated and reported by its
+// fastest run, in scalar, float2 and float4 loads/stores to show how much wider accesses help.
+float CudaBackend::runStreamBenchmark(unsigned int threadsPerBlock, void* initFunc, const std::array<void*, 12>& kernels, size_t totalMemory,
+                                      int multiProcessorCount) {
+  constexpr int trials = 10; // STREAM's NTIMES, the first run of every kernel is a warm-up
+  constexpr const char* functions[] = {"Copy", "Scale", "Add", "Triad"};
+  constexpr unsigned int arrays[] = {2, 2, 3, 3}; // Arrays each function reads plus writes
+  constexpr const char* types[] = {"float", "float2", "float4"};
+  constexpr unsigned int widths[] = {4, 8, 16};
+  // STREAM asks for arrays at least 4x the last-level cache. 256 MB is far past that on any GPU.
+  const size_t bytes = std::min<size_t>(256ull << 20, totalMemory / 8) / 16 * 16;
+  unsigned long long floats = bytes / sizeof(float);
+  float scalar = 3.0f;
+  TRACE_SCOPE("15) STREAM", "test");
+  std::cout << CUDA << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")..." << std::flush;
+
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_a = 0, d_b = 0, d_c = 0;
+  CUDA_ERR(cuMemAlloc(&d_a, bytes));
+  CUDA_ERR(cuMemAlloc(&d_b, bytes));
+  CUDA_ERR(cuMemAlloc(&d_c, bytes));
+  allocSpan.end();
+  {
+    void* args[] = {&d_a, &d_b, &d_c, &floats};
+    unsigned int blocks = multiProcessorCount * 32;
+    float milliseconds = 0;
+    CUDA_BENCHMARK_KERNEL(initFunc, blocks, threadsPerBlock, args, milliseconds);
+  }
+
+  std::vector<Sweep::Trials> results(std::size(functions) * std::size(types));
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(types); ++w) {
+    unsigned long long n = bytes / widths[w];
+    // Enough blocks to fill the device, the grid-stride loop covers the rest
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    for (size_t f = 0; f < std::size(functions); ++f) {
+      Sweep::Trials& result = results[f * std::size(types) + w];
+      result.name = std::string(functions[f]) + " " + types[w];
+      result.key = tolower(functions[f]) + "_" + types[w];
+      result.bytes = static_cast<double>(arrays[f]) * bytes;
+    }
+    // STREAM runs the four functions in turn on every trial, so each one starts with the others' data out of cache
+    for (int trial = 0; trial < trials; ++trial) {
+      for (size_t f = 0; f < std::size(functions); ++f) {
+        void* args[] = {&d_a, &d_b, &d_c, &scalar, &n};
+        float milliseconds = 0;
+        CUDA_BENCHMARK_KERNEL(kernels[w * std::size(functions) + f], blocks, threadsPerBlock, args, milliseconds);
+        if (trial > 0)
+          results[f * std::size(types) + w].milliseconds.push_back(milliseconds);
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  // Triad ran last: c = a + scalar * b = 1 + 3 * 2
+  bool valid = true;
+  for (unsigned long long i : {0ull, floats / 2, floats - 1}) {
+    float value = 0.0f;
+    CUDA_ERR(cuMemcpyDtoH(&value, d_c + i * sizeof(float), sizeof(float)));
+    if (value != 7.0f) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected 7, got " << value << "\n";
+      break;
+    }
+  }
+  std::cout << "\r" << CUDA << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::reportBestOfN(CUDA, "stream", results);
+  Suite::record("stream", totalMilliseconds, valid);
+
+  CUDA_ERR(cuMemFree(d_a));
+  CUDA_ERR(cuMemFree(d_b));
+  CUDA_ERR(cuMemFree(d_c));
+  return valid ? totalMilliseconds : 0.0f;
+}
+
+// Kernels that read and write mapped pinned host memory directly, with no copies, against the usual upload, kernel and
+// download. Zero-copy wins while the copies' fixed costs dominate, and loses once every byte crossing the bus twice
+// at kernel access granularity costs more than bulk DMA.
+float CudaBackend::runZeroCopyBenchmark(unsigned int threadsPerBlock, void* scaleFunc, size_t totalMemory, int multiProcessorCount) {
+  constexpr size_t minBytes = 4ull * 1024;                                // 4 KB
+  const size_t maxBytes = std::min<size_t>(256ull << 20, totalMemory / 8); // 256 MB, or an eighth of VRAM on small devices
+  float scalar = 3.0f;
+  TRACE_SCOPE("16) Zero-Copy", "test");
+  std::cout << CUDA << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  float *h_in = nullptr, *h_out = nullptr;
+  CUDA_ERR(cuMemHostAlloc((void**)&h_in, maxBytes, CU_MEMHOSTALLOC_DEVICEMAP));
+  CUDA_ERR(cuMemHostAlloc((void**)&h_out, maxBytes, CU_MEMHOSTALLOC_DEVICEMAP));
+  std::fill(h_in, h_in + maxBytes / sizeof(float), 1.0f);
+  CUdeviceptr m_in = 0, m_out = 0, d_in = 0, d_out = 0;
+  CUDA_ERR(cuMemHostGetDevicePointer(&m_in, h_in, 0));
+  CUDA_ERR(cuMemHostGetDevicePointer(&m_out, h_out, 0));
+  CUDA_ERR(cuMemAlloc(&d_in, maxBytes));
+  CUDA_ERR(cuMemAlloc(&d_out, maxBytes));
+  allocSpan.end();
+
+  // streamScaleKernel16: out = scalar * in, as float4 so every bus transaction is as wide as a thread can make it
+  auto launch = [&](CUdeviceptr in, CUdeviceptr out, size_t bytes) {
+    unsigned long long n = bytes / 16;
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    void* args[] = {&in, &in, &out, &scalar, &n};
+    CUDA_ERR(cuLaunchKernel(scaleFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+  };
+  auto runZeroCopy = [&](size_t bytes) {
+    launch(m_in, m_out, bytes);
+    CUDA_ERR(cuCtxSynchronize());
+  };
+  // Synchronous copies on the default stream also wait for the kernel
+  auto runExplicitCopy = [&](size_t bytes) {
+    CUDA_ERR(cuMemcpyHtoD(d_in, h_in, bytes));
+    launch(d_in, d_out, bytes);
+    CUDA_ERR(cuMemcpyDtoH(h_out, d_out, bytes));
+  };
+
+  using clock = std::chrono::steady_clock;
+  auto timeRuns = [&](size_t bytes, auto&& run) {
+    int reps = Sweep::repetitions(bytes, 256ull * 1024 * 1024, 3, 1000);
+    // Warm up so lazy driver setup for this size is not timed
+    run(bytes);
+    auto start = clock::now();
+    for (int i = 0; i < reps; ++i) {
+      run(bytes);
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+    return Sweep::Point{static_cast<double>(bytes), milliseconds};
+  };
+
+  std::vector<Sweep::Point> zeroCopy, explicitCopy;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Zero-copy size step", "transfer");
+    zeroCopy.push_back(timeRuns(bytes, runZeroCopy));
+    explicitCopy.push_back(timeRuns(bytes, runExplicitCopy));
+  }
+
+  std::fill(h_out, h_out + maxBytes / sizeof(float), 0.0f);
+  runZeroCopy(maxBytes);
+  bool valid = std::all_of(h_out, h_out + maxBytes / sizeof(float), [](float value) { return value == 3.0f; });
+  std::cout << "\r" << CUDA << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::printTable(CUDA, {"Zero-copy", "Copy + kernel"}, {zeroCopy, explicitCopy});
+  double crossover = Sweep::crossoverBytes(zeroCopy, explicitCopy);
+  if (crossover == 0.0) {
+    std::cout << CUDA << "Zero-copy is faster at every size measured\n";
+  } else if (crossover == zeroCopy.front().bytes) {
+    std::cout << CUDA << "Copy + kernel is faster at every size measured\n";
+  } else {
+    std::cout << CUDA << "Zero-copy stops winning at " << Sweep::formatBytes(crossover) << "\n";
+  }
+  float milliseconds = static_cast<float>(zeroCopy.back().milliseconds);
+  Suite::record("zero_copy", milliseconds, valid);
+  Suite::metric("zero_copy", "crossover_bytes", crossover);
+  Sweep::record("zero_copy", "zero_copy", zeroCopy);
+  Sweep::record("zero_copy", "explicit_copy", explicitCopy);
+
+  CUDA_ERR(cuMemFree(d_in));
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFreeHost(h_in));
+  CUDA_ERR(cuMemFreeHost(h_out));
+  return milliseconds;
+}
+
+// Test 7 allocates its pinned buffers once and never times that. Services that pin existing buffers on the fly pay for
+// it on every buffer, so this measures what pinning costs and how many copies it takes to earn it back.
+float CudaBackend::runHostRegistrationBenchmark(size_t totalMemory) {
+  constexpr size_t minBytes = 4ull * 1024; // 4 KB
+  // 8 GB, or a quarter of RAM so the pinned pages do not push everything else out
+  const size_t maxBytes = std::min<size_t>(8ull << 30, std::max<size_t>(getPhysicalMemory() / 4, 64ull << 20));
+  // Larger sizes are copied through this much device memory in pieces
+  const size_t deviceBytes = std::min<size_t>(maxBytes, totalMemory / 4);
+  TRACE_SCOPE("17) Host Registration", "test");
+  std::cout << CUDA << "17) Host Registration (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", register vs alloc-host)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  // Page-aligned with default pages, the way a service's own buffers are. Every page is faulted in up front, so
+  // first-touch cost is not charged to registration.
+  char* h_pageable = static_cast<char*>(HostMemory::allocate(maxBytes, -1, false));
+  std::memset(h_pageable, 1, maxBytes);
+  CUdeviceptr d_data = 0;
+  CUDA_ERR(cuMemAlloc(&d_data, deviceBytes));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+  auto copyToDevice = [&](size_t bytes) {
+    for (size_t offset = 0; offset < bytes; offset += deviceBytes) {
+      CUDA_ERR(cuMemcpyHtoD(d_data, h_pageable + offset, std::min(deviceBytes, bytes - offset)));
+    }
+  };
+
+  std::vector<Sweep::PinningCost> costs;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Registration size step", "transfer");
+    int reps = Sweep::repetitions(bytes, 1ull << 30, 1, 100);
+    Sweep::PinningCost cost{static_cast<double>(bytes), 0, 0, 0, 0, 0, 0};
+    // Warm up so lazy driver setup is not timed
+    copyToDevice(bytes);
+    for (int i = 0; i < reps; ++i) {
+      auto start = clock::now();
+      copyToDevice(bytes);
+      cost.pageableMilliseconds += elapsed(start) / reps;
+
+      start = clock::now();
+      CUDA_ERR(cuMemHostRegister(h_pageable, bytes, 0));
+      cost.registerMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      copyToDevice(bytes);
+      cost.pinnedMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      CUDA_ERR(cuMemHostUnregister(h_pageable));
+      cost.unregisterMilliseconds += elapsed(start) / reps;
+
+      start = clock::now();
+      void* h_pinned = nullptr;
+      CUDA_ERR(cuMemAllocHost(&h_pinned, bytes, 0));
+      cost.allocMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      CUDA_ERR(cuMemFreeHost(h_pinned));
+      cost.freeMilliseconds += elapsed(start) / reps;
+    }
+    costs.push_back(cost);
+  }
+
+  std::cout << "\r" << CUDA << "17) Host Registration (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", register vs alloc-host)... Done\n";
+  Sweep::reportPinningCosts(CUDA, "host_registration", costs);
+  float milliseconds = static_cast<float>(costs.back().registerMilliseconds);
+  Suite::record("host_registration", milliseconds);
+
+  CUDA_ERR(cuMemFree(d_data));
+  HostMemory::release(h_pageable, maxBytes);
+  return milliseconds;
+}
+
+// Managed memory lets a model larger than VRAM run unchanged, at the cost of page faults and migrations. Moves one
+// allocation back and forth between host and device, by faulting and by prefetching, then oversubscribes VRAM by half.
+float CudaBackend::runManagedMemoryBenchmark(unsigned int threadsPerBlock, void* incrementFunc, int dev, size_t totalMemory, int multiProcessorCount,
+                                             bool concurrentManagedAccess) {
+  constexpr int reps = 3;
+  const size_t bytes = std::min<size_t>(512ull << 20, totalMemory / 4);
+  TRACE_SCOPE("18) Managed Memory", "test");
+  std::cout << CUDA << "18) Managed Memory (" << Sweep::formatBytes(bytes) << ", faulting vs prefetching)..." << std::flush;
+
+  using clock = std::chrono::steady_clock;
+  auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+  auto devicePass = [&](CUdeviceptr data, size_t size) {
+    unsigned long long n = size / sizeof(float);
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    void* args[] = {&data, &n};
+    auto start = clock::now();
+    CUDA_ERR(cuLaunchKernel(incrementFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+    CUDA_ERR(cuCtxSynchronize());
+    return elapsed(start);
+  };
+  auto hostPass = [&](float* data, size_t size) {
+    auto start = clock::now();
+    for (size_t i = 0; i < size / sizeof(float); ++i) {
+      data[i] += 1.0f;
+    }
+    return elapsed(start);
+  };
+  auto prefetch = [&](CUdeviceptr data, size_t size, int destination) {
+    auto start = clock::now();
+    CUDA_ERR(cuMemPrefetchAsync(data, size, destination, nullptr));
+    CUDA_ERR(cuCtxSynchronize());
+    return elapsed(start);
+  };
+
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_data = 0;
+  CUDA_ERR(cuMemAllocManaged(&d_data, bytes, CU_MEM_ATTACH_GLOBAL));
+  float* h_data = reinterpret_cast<float*>(d_data);
+  allocSpan.end();
+  Sweep::ManagedMemoryTimes times{static_cast<double>(bytes), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  float expected = 0.0f;
+  times.firstTouchMilliseconds = devicePass(d_data, bytes);
+  times.residentMilliseconds = devicePass(d_data, bytes);
+  expected += 2.0f;
+  for (int i = 0; i < reps; ++i) {
+    times.hostFaultMilliseconds += hostPass(h_data, bytes) / reps;
+    times.hostResidentMilliseconds += hostPass(h_data, bytes) / reps;
+    times.deviceFaultMilliseconds += devicePass(d_data, bytes) / reps;
+    expected += 3.0f;
+  }
+  // Without concurrent access the driver migrates whole allocations at launch and sync, and cannot prefetch or oversubscribe
+  if (concurrentManagedAccess) {
+    for (int i = 0; i < reps; ++i) {
+      times.prefetchToHostMilliseconds += prefetch(d_data, bytes, CU_DEVICE_CPU) / reps;
+      times.prefetchToDeviceMilliseconds += prefetch(d_data, bytes, dev) / reps;
+    }
+  }
+  bool valid = true;
+  for (size_t i : {size_t(0), bytes / sizeof(float) / 2, bytes / sizeof(float) - 1}) {
+    if (h_data[i] != expected) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected " << expected << ", got " << h_data[i] << "\n";
+      break;
+    }
+  }
+  CUDA_ERR(cuMemFree(d_data));
+
+  // The pages evicted to make room land in host memory, so only oversubscribe if the host can hold all of them
+  const size_t oversubscribedBytes = totalMemory / 2 * 3;
+  if (concurrentManagedAccess && getPhysicalMemory() >= oversubscribedBytes) {
+    TRACE_SCOPE("Oversubscription", "transfer");
+    CUDA_ERR(cuMemAllocManaged(&d_data, oversubscribedBytes, CU_MEM_ATTACH_GLOBAL));
+    times.oversubscribedBytes = static_cast<double>(oversubscribedBytes);
+    times.oversubscribedFirstMilliseconds = devicePass(d_data, oversubscribedBytes);
+    times.oversubscribedSecondMilliseconds = devicePass(d_data, oversubscribedBytes);
+    CUDA_ERR(cuMemFree(d_data));
+  }
+
+  std::cout << "\r" << CUDA << "18) Managed Memory (" << Sweep::formatBytes(bytes) << ", faulting vs prefetching)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  if (!concurrentManagedAccess)
+    std::cout << CUDA << "No concurrent managed access on this device, skipping prefetch and oversubscription\n";
+  Sweep::reportManagedMemory(CUDA, "managed_memory", times);
+  float milliseconds = static_cast<float>(times.deviceFaultMilliseconds);
+  Suite::record("managed_memory", milliseconds, valid);
+  return milliseconds;
+}
+
+// Frameworks allocate and free thousands of temporaries per second. Replays one churn of allocations and frees drawn
+// from the configured size mix (RunOptions::allocationSizes) with synchronous allocation and with the device's
+// stream-ordered pool, and reports per-call latency and how much memory the pool holds beyond what is live.
+float CudaBackend::runAllocationBenchmark(int dev, size_t totalMemory) {
+  constexpr size_t steps = 4000;
+  std::vector<Sweep::AllocationOp> ops = Sweep::allocationChurn(Suite::allocationSizes(), steps, totalMemory / 4);
+  if (ops.empty()) {
+    std::cout << CUDA << "19) Allocation skipped, no allocation size fits in a quarter of device memory\n";
+    return 0.0f;
+  }
+  TRACE_SCOPE("19) Allocation", "test");
+  std::cout << CUDA << "19) Allocation (" << ops.size() << " allocations and frees, synchronous vs stream-ordered pool)..." << std::flush;
+  std::vector<CUdeviceptr> slots(Sweep::allocationSlots(ops));
+  using clock = std::chrono::steady_clock;
+  auto microseconds = [](clock::time_point start) { return std::chrono::duration<double, std::micro>(clock::now() - start).count(); };
+
+  Sweep::LatencySamples syncAlloc{"cuMemAlloc", "sync_alloc", {}}, syncFree{"cuMemFree", "sync_free", {}};
+  Trace::Span syncSpan("Synchronous churn", "alloc");
+  auto syncStart = clock::now();
+  for (const Sweep::AllocationOp& op : ops) {
+    auto start = clock::now();
+    if (op.allocate) {
+      CUDA_ERR(cuMemAlloc(&slots[op.slot], op.bytes));
+      syncAlloc.microseconds.push_back(microseconds(start));
+    } else {
+      CUDA_ERR(cuMemFree(slots[op.slot]));
+      syncFree.microseconds.push_back(microseconds(start));
+    }
+  }
+  float milliseconds = static_cast<float>(microseconds(syncStart) / 1000.0);
+  syncSpan.end();
+
+  Sweep::LatencySamples poolAlloc{"cuMemAllocAsync", "pool_alloc", {}}, poolFree{"cuMemFreeAsync", "pool_free", {}};
+  unsigned long long reserved = 0, used = 0;
+  // Older drivers lack the stream-ordered allocator, and some devices do not support it
+  int poolsSupported = 0;
+  if (cuDeviceGetDefaultMemPool && cuMemAllocAsync)
+    CUDA_ERR(cuDeviceGetAttribute(&poolsSupported, CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED, dev));
+  if (poolsSupported) {
+    // By default the pool hands everything back at each synchronization. Keep it, like a framework's caching allocator would.
+    CUmemoryPool pool = nullptr;
+    CUDA_ERR(cuDeviceGetDefaultMemPool(&pool, dev));
+    // The pool is shared with the rest of the process, so the caller's threshold goes back afterwards and nothing is trimmed:
+    // the caller's cached blocks are in there too, and the pool releases ours down to that threshold on its own
+    unsigned long long previousThreshold = 0, threshold = ~0ull;
+    CUDA_ERR(cuMemPoolGetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &previousThreshold));
+    CUDA_ERR(cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold));
+    CUstream stream = acquireStream();
+    // The first pass grows the pool, the second runs from it
+    for (const Sweep::AllocationOp& op : ops) {
+      if (op.allocate)
+        CUDA_ERR(cuMemAllocAsync(&slots[op.slot], op.bytes, stream));
+      else
+        CUDA_ERR(cuMemFreeAsync(slots[op.slot], stream));
+    }
+    CUDA_ERR(cuStreamSynchronize(stream));
+
+    Trace::Span poolSpan("Pooled churn", "alloc");
+    for (size_t i = 0; i < ops.size(); ++i) {
+      const Sweep::AllocationOp& op = ops[i];
+      auto start = clock::now();
+      if (op.allocate) {
+        CUDA_ERR(cuMemAllocAsync(&slots[op.slot], op.bytes, stream));
+        poolAlloc.microseconds.push_back(microseconds(start));
+      } else {
+        CUDA_ERR(cuMemFreeAsync(slots[op.slot], stream));
+        poolFree.microseconds.push_back(microseconds(start));
+      }
+      // After the churn and before the trailing frees, the pool holds the live buffers and the holes between them
+      if (i + 1 == steps) {
+        CUDA_ERR(cuStreamSynchronize(stream));
+        CUDA_ERR(cuMemPoolGetAttribute(pool, CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT, &reserved));
+        CUDA_ERR(cuMemPoolGetAttribute(pool, CU_MEMPOOL_ATTR_USED_MEM_CURRENT, &used));
+      }
+    }
+    CUDA_ERR(cuStreamSynchronize(stream));
+    poolSpan.end();
+    releaseStream(stream);
+    CUDA_ERR(cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &previousThreshold));
+  }
+
+  std::cout << "\r" << CUDA << "19) Allocation (" << ops.size() << " allocations and frees, synchronous vs stream-ordered pool)... Done\n";
+  Suite::record("allocation", milliseconds);
+  if (!poolsSupported) {
+    Sweep::reportLatencyPercentiles(CUDA, "allocation", {syncAlloc, syncFree});
+    std::cout << CUDA << "Stream-ordered pool not supported by this driver or device, skipped\n";
+    return milliseconds;
+  }
+  Sweep::reportLatencyPercentiles(CUDA, "allocation", {syncAlloc, syncFree, poolAlloc, poolFree});
+  double fragmentation = reserved > 0 ? 1.0 - static_cast<double>(used) / reserved : 0.0;
+  std::cout << CUDA << "Pool after churn: " << Sweep::formatBytes(reserved) << " reserved for " << Sweep::formatBytes(used) << " live ("
+            << std::setprecision(1) << fragmentation * 100.0 << "% held but unused)\n";
+  Suite::metric("allocation", "pool_reserved_bytes", reserved);
+  Suite::metric("allocation", "pool_used_bytes", used);
+  Suite::metric("allocation", "pool_fragmentation", fragmentation);
+  return milliseconds;
+}
+
+// The copy engine and fill paths image pipelines lean on: device-to-device copies and memsets across sizes, and 2D and
+// 3D copies between pitched buffers across row alignments, each next to a hand-written kernel doing the same copy.
+float CudaBackend::runCopyEngineBenchmark(unsigned int threadsPerBlock, void* copyFunc, void* pitchedCopyFunc, void* volumeCopyFunc,
+                                          size_t totalMemory, int multiProcessorCount) {
+  constexpr size_t minBytes = 4ull * 1024;                               // 4 KB
+  const size_t maxBytes = std::min<size_t>(1ull << 30, totalMemory / 8); // 1 GB, or an eighth of VRAM on small devices
+  constexpr unsigned int widths[] = {1000, 4000, 7680};                  // Odd, unaligned and 1920-pixel RGBA rows
+  constexpr unsigned int height = 4096;
+  constexpr unsigned int alignments[] = {4, 64, 256, 512, 0};           // 0 lets the driver pick the pitch
+  constexpr unsigned int sliceRows = 256, haloRows = 8, depth = 64;     // 3D box, cut from slices with a halo
+  TRACE_SCOPE("20) Copy Engine", "test");
+  std::cout << CUDA << "20) Copy Engine (device copies, memset and 2D and 3D pitched copies vs kernels)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_src = 0, d_dst = 0;
+  CUDA_ERR(cuMemAlloc(&d_src, maxBytes));
+  CUDA_ERR(cuMemAlloc(&d_dst, maxBytes));
+  CUDA_ERR(cuMemsetD8(d_src, 1, maxBytes));
+  allocSpan.end();
+
+  // Every repetition goes into one event pair, so short operations are not dominated by timing overhead
+  auto timeRepeated = [&](size_t bytes, auto&& enqueue) {
+    int reps = Sweep::repetitions(bytes, 1ull << 30, 3, 1000);
+    enqueue();
+    CUevent startEvent = acquireEvent();
+    CUevent stopEvent = acquireEvent();
+    CUDA_ERR(cuEventRecord(startEvent, nullptr));
+    for (int i = 0; i < reps; ++i) {
+      enqueue();
+    }
+    CUDA_ERR(cuEventRecord(stopEvent, nullptr));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    float milliseconds = 0;
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    return static_cast<double>(milliseconds) / reps;
+  };
+
+  std::vector<Sweep::Point> copies, kernelCopies, memsets;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Copy engine size step", "transfer");
+    unsigned long long n = bytes / 16;
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    float scalar = 1.0f;
+    copies.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      CUDA_ERR(cuMemcpyDtoD(d_dst, d_src, bytes));
+    })});
+    kernelCopies.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      // streamCopyKernel16: dst = src as float4
+      void* args[] = {&d_src, &d_src, &d_dst, &scalar, &n};
+      CUDA_ERR(cuLaunchKernel(copyFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+    })});
+    memsets.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      CUDA_ERR(cuMemsetD8(d_dst, 0, bytes));
+    })});
+  }
+  CUDA_ERR(cuMemFree(d_src));
+  CUDA_ERR(cuMemFree(d_dst));
+
+  std::vector<Sweep::PitchedCopy> pitched;
+  for (unsigned int width : widths) {
+    for (unsigned int alignment : alignments) {
+      TRACE_SCOPE("Pitched copy step", "transfer");
+      CUdeviceptr p_src = 0, p_dst = 0;
+      size_t pitch = 0;
+      if (alignment == 0) {
+        CUDA_ERR(cuMemAllocPitch(&p_src, &pitch, width, height, 4));
+        CUDA_ERR(cuMemAllocPitch(&p_dst, &pitch, width, height, 4));
+      } else {
+        pitch = (width + alignment - 1) / alignment * alignment;
+        CUDA_ERR(cuMemAlloc(&p_src, pitch * height));
+        CUDA_ERR(cuMemAlloc(&p_dst, pitch * height));
+      }
+      unsigned long long srcPitch = pitch, dstPitch = pitch;
+      unsigned int widthWords = width / 4, rows = height;
+      Sweep::PitchedCopy copy{width, height, alignment, pitch, 0, 0};
+      copy.copyMilliseconds = timeRepeated(static_cast<size_t>(width) * height, [&] {
+        CUDA_MEMCPY2D params = {};
+        params.srcMemoryType = CU_MEMORYTYPE_DEVICE;
+        params.srcDevice = p_src;
+        params.srcPitch = pitch;
+        params.dstMemoryType = CU_MEMORYTYPE_DEVICE;
+        params.dstDevice = p_dst;
+        params.dstPitch = pitch;
+        params.WidthInBytes = width;
+        params.Height = height;
+        CUDA_ERR(cuMemcpy2D(&params));
+      });
+      copy.kernelMilliseconds = timeRepeated(static_cast<size_t>(width) * height, [&] {
+        void* args[] = {&p_src, &srcPitch, &p_dst, &dstPitch, &widthWords, &rows};
+        CUDA_ERR(cuLaunchKernel(pitchedCopyFunc, (widthWords + threadsPerBlock - 1) / threadsPerBlock, height, 1, threadsPerBlock, 1, 1, 0, nullptr,
+                                args, nullptr));
+      });
+      pitched.push_back(copy);
+      CUDA_ERR(cuMemFree(p_src));
+      CUDA_ERR(cuMemFree(p_dst));
+    }
+  }
+
+  // The same rows as a 3D copy: a box of depth slices cut out of a volume whose slices carry halo rows, into a packed
+  // volume, the way stencil codes exchange sub-volumes
+  for (unsigned int width : widths) {
+    for (unsigned int alignment : alignments) {
+      TRACE_SCOPE("Volume copy step", "transfer");
+      CUdeviceptr v_src = 0, v_dst = 0;
+      size_t pitch = 0;
+      if (alignment == 0) {
+        CUDA_ERR(cuMemAllocPitch(&v_src, &pitch, width, (sliceRows + haloRows) * depth, 4));
+        CUDA_ERR(cuMemAllocPitch(&v_dst, &pitch, width, sliceRows * depth, 4));
+      } else {
+        pitch = (width + alignment - 1) / alignment * alignment;
+        CUDA_ERR(cuMemAlloc(&v_src, pitch * (sliceRows + haloRows) * depth));
+        CUDA_ERR(cuMemAlloc(&v_dst, pitch * sliceRows * depth));
+      }
+      unsigned long long srcPitch = pitch, dstPitch = pitch;
+      unsigned int widthWords = width / 4, srcSliceRows = sliceRows + haloRows, dstSliceRows = sliceRows;
+      size_t bytes = static_cast<size_t>(width) * sliceRows * depth;
+      Sweep::PitchedCopy copy{width, sliceRows, alignment, pitch, 0, 0, depth};
+      copy.copyMilliseconds = timeRepeated(bytes, [&] {
+        CUDA_MEMCPY3D params = {};
+        params.srcMemoryType = CU_MEMORYTYPE_DEVICE;
+        params.srcDevice = v_src;
+        params.srcPitch = pitch;
+        params.srcHeight = srcSliceRows;
+        params.dstMemoryType = CU_MEMORYTYPE_DEVICE;
+        params.dstDevice = v_dst;
+        params.dstPitch = pitch;
+        params.dstHeight = dstSliceRows;
+        params.WidthInBytes = width;
+        params.Height = sliceRows;
+        params.Depth = depth;
+        CUDA_ERR(cuMemcpy3D(&params));
+      });
+      copy.kernelMilliseconds = timeRepeated(bytes, [&] {
+        void* args[] = {&v_src, &srcPitch, &srcSliceRows, &v_dst, &dstPitch, &dstSliceRows, &widthWords};
+        CUDA_ERR(cuLaunchKernel(volumeCopyFunc, (widthWords + threadsPerBlock - 1) / threadsPerBlock, sliceRows, depth, threadsPerBlock, 1, 1, 0,
+                                nullptr, args, nullptr));
+      });
+      pitched.push_back(copy);
+      CUDA_ERR(cuMemFree(v_src));
+      CUDA_ERR(cuMemFree(v_dst));
+    }
+  }
+
+  std::cout << "\r" << CUDA << "20) Copy Engine (device copies, memset and 2D and 3D pitched copies vs kernels)... Done\n";
+  Sweep::printTable(CUDA, {"cuMemcpyDtoD", "Copy kernel", "cuMemsetD8"}, {copies, kernelCopies, memsets});
+  Sweep::reportPitchedCopies(CUDA, "copy_engine", pitched);
+  float milliseconds = static_cast<float>(copies.back().milliseconds);
+  Suite::record("copy_engine", milliseconds);
+  Sweep::record("copy_engine", "dtod", copies);
+  Sweep::record("copy_engine", "copy_kernel", kernelCopies);
+  Sweep::record("copy_engine", "memset", memsets);
+  return milliseconds;
+}
+
+// Streams a dataset three times the size of VRAM through a ring of chunk-sized device buffers, uploading one chunk while
+// the previous ones are checksummed, the way out-of-core jobs walk data that does not fit. The host side cycles through a
+// small pinned window, so the test needs no more host memory than a few chunks.
+float CudaBackend::runOutOfCoreBenchmark(unsigned int threadsPerBlock, CUfunction checksumFunc, size_t totalMemory, int multiProcessorCount) {
+  constexpr unsigned int windowChunks = 4;
+  constexpr unsigned int ringDepths[] = {2, 3}; // Double and triple buffering
+  // 64 MB chunks (a sixty-fourth of VRAM on small devices), a whole number of 32-bit words
+  const size_t chunkBytes = std::min<size_t>(64ull * 1024 * 1024, totalMemory / 64) / sizeof(unsigned int) * sizeof(unsigned int);
+  const size_t chunks = totalMemory * 3 / chunkBytes;
+  const size_t datasetBytes = chunks * chunkBytes;
+  unsigned long long n = chunkBytes / sizeof(unsigned int);
+  unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+  TRACE_SCOPE("21) Out-of-Core Streaming", "test");
+  std::cout << CUDA << "21) Out-of-Core Streaming (" << Sweep::formatBytes(datasetBytes) << " in " << Sweep::formatBytes(chunkBytes) << " chunks)..."
+            << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  unsigned int* h_window = nullptr;
+  CUDA_ERR(cuMemAllocHost((void**)&h_window, chunkBytes * windowChunks, 0));
+  // Every window chunk holds different values, so a chunk that is skipped or uploaded twice changes the checksum
+  std::vector<unsigned long long> windowSums(windowChunks, 0);
+  for (unsigned int w = 0; w < windowChunks; ++w) {
+    for (size_t i = 0; i < n; ++i) {
+      h_window[w * n + i] = static_cast<unsigned int>((i + w * 7) % 251);
+      windowSums[w] += h_window[w * n + i];
+    }
+  }
+  unsigned long long expected = 0;
+  for (size_t c = 0; c < chunks; ++c) {
+    expected += windowSums[c % windowChunks];
+  }
+  std::vector<CUdeviceptr> d_ring(ringDepths[std::size(ringDepths) - 1]);
+  for (CUdeviceptr& slot : d_ring) {
+    CUDA_ERR(cuMemAlloc(&slot, chunkBytes));
+  }
+  CUdeviceptr d_checksum = 0;
+  CUDA_ERR(cuMemAlloc(&d_checksum, sizeof(unsigned long long)));
+  allocSpan.end();
+
+  std::vector<CUstream> streams;
+  for (unsigned int i = 0; i < ringDepths[std::size(ringDepths) - 1]; ++i) {
+    streams.push_back(acquireStream());
+  }
+  using clock = std::chrono::steady_clock;
+  auto wallTime = [&](const char* name, auto&& enqueue) {
+    Trace::Span span(name, "transfer");
+    auto start = clock::now();
+    enqueue();
+    CUDA_ERR(cuCtxSynchronize());
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  };
+  auto launchChecksum = [&](CUdeviceptr chunk, CUstream stream) {
+    void* args[] = {&chunk, &d_checksum, &n};
+    CUDA_ERR(cuLaunchKernel(checksumFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+  };
+
+  // The two limits the pipeline runs into: back-to-back uploads of one window, and checksums of a resident chunk
+  constexpr int referenceChunks = 16;
+  wallTime("Warm-up", [&] {
+    CUDA_ERR(cuMemcpyHtoDAsync(d_ring[0], h_window, chunkBytes, streams[0]));
+    launchChecksum(d_ring[0], streams[0]);
+  });
+  double uploadMilliseconds = wallTime("Upload", [&] {
+    for (int c = 0; c < referenceChunks; ++c) {
+      CUDA_ERR(cuMemcpyHtoDAsync(d_ring[0], h_window + (c % windowChunks) * n, chunkBytes, streams[0]));
+    }
+  });
+  double checksumMilliseconds = wallTime("Checksum", [&] {
+    for (int c = 0; c < referenceChunks; ++c) {
+      launchChecksum(d_ring[0], streams[0]);
+    }
+  });
+  double pcieGigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(chunkBytes * referenceChunks), uploadMilliseconds});
+  double checksumGigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(chunkBytes * referenceChunks), checksumMilliseconds});
+
+  // Chunk c goes to ring slot c % depth on that slot's stream, so its upload waits for the slot's previous checksum
+  // while the other slots keep the copy engine and the SMs busy
+  std::vector<double> pipelinedMilliseconds;
+  bool valid = true;
+  for (unsigned int depth : ringDepths) {
+    CUDA_ERR(cuMemsetD8(d_checksum, 0, sizeof(unsigned long long)));
+    pipelinedMilliseconds.push_back(wallTime("Pipeline", [&] {
+      for (size_t c = 0; c < chunks; ++c) {
+        CUstream stream = streams[c % depth];
+        CUDA_ERR(cuMemcpyHtoDAsync(d_ring[c % depth], h_window + (c % windowChunks) * n, chunkBytes, stream));
+        launchChecksum(d_ring[c % depth], stream);
+      }
+    }));
+    unsigned long long checksum = 0;
+    CUDA_ERR(cuMemcpyDtoH(&checksum, d_checksum, sizeof(checksum)));
+    if (checksum != expected) {
+      valid = false;
+      std::cerr << " Checksum mismatch with " << depth << " buffers: expected " << expected << ", got " << checksum << "\n";
+    }
+  }
+  for (CUstream stream : streams) {
+    releaseStream(stream);
+  }
+
+  double bestMilliseconds = *std::min_element(pipelinedMilliseconds.begin(), pipelinedMilliseconds.end());
+  std::cout << "\r" << CUDA << "21) Out-of-Core Streaming (" << Sweep::formatBytes(datasetBytes) << " in " << Sweep::formatBytes(chunkBytes)
+            << " chunks)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " Upload limit: " << std::fixed << std::setprecision(2) << pcieGigabytesPerSecond << " GB/s, checksum: " << checksumGigabytesPerSecond
+            << " GB/s\n";
+  Suite::record("out_of_core", static_cast<float>(bestMilliseconds), valid);
+  Suite::metric("out_of_core", "pcie_gb_per_s", pcieGigabytesPerSecond);
+  Suite::metric("out_of_core", "checksum_gb_per_s", checksumGigabytesPerSecond);
+  for (size_t i = 0; i < pipelinedMilliseconds.size(); ++i) {
+    double sustained = Sweep::gigabytesPerSecond({static_cast<double>(datasetBytes), pipelinedMilliseconds[i]});
+    std::cout << CUDA << "    " << ringDepths[i] << " buffers: " << sustained << " GB/s sustained, " << std::setprecision(1)
+              << 100.0 * sustained / pcieGigabytesPerSecond << "% of the upload limit\n"
+              << std::setprecision(2);
+    std::string suffix = "_" + std::to_string(ringDepths[i]) + "_buffers";
+    Suite::metric("out_of_core", "sustained_gb_per_s" + suffix, sustained);
+    Suite::metric("out_of_core", "pcie_fraction" + suffix, sustained / pcieGigabytesPerSecond);
+  }
+
+  for (CUdeviceptr slot : d_ring) {
+    CUDA_ERR(cuMemFree(slot));
+  }
+  CUDA_ERR(cuMemFree(d_checksum));
+  CUDA_ERR(cuMemFreeHost(h_window));
+  return static_cast<float>(bestMilliseconds);
+}
+
+// Reads a file into device memory through a ring of pinned buffers, each read uploaded as soon as it lands while the
+// next reads are in flight. Disk, staging and PCIe are also timed on their own to show which one the pipeline runs into.
+float CudaBackend::runIngestBenchmark() {
+  constexpr size_t chunkBytes = 8ull << 20; // 8 MB
+  constexpr unsigned int ringSlots = 4;
+  std::string path = Suite::ingestFile();
+  const bool temporary = path.empty();
+  TRACE_SCOPE("22) File Ingest", "test");
+  std::cout << CUDA << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  if (temporary)
+    path = Suite::temporaryIngestFile();
+  const unsigned long long fileBytes = Ingest::fileSize(path);
+  if (fileBytes == 0)
+    throw GPUMark::Error(path + " is empty");
+  IngestRing buffers;
+  CUDA_ERR(cuMemAllocHost((void**)&buffers.host, chunkBytes * ringSlots, 0));
+  CUDA_ERR(cuMemAlloc(&buffers.device, chunkBytes * ringSlots));
+  char* h_ring = buffers.host;
+  CUdeviceptr d_ring = buffers.device;
+  std::vector<void*> ring;
+  for (unsigned int slot = 0; slot < ringSlots; ++slot) {
+    ring.push_back(h_ring + slot * chunkBytes);
+  }
+  allocSpan.end();
+
+  std::vector<CUstream> streams;
+  for (unsigned int slot = 0; slot < ringSlots; ++slot) {
+    streams.push_back(acquireStream());
+  }
+  auto upload = [&](unsigned int slot, size_t bytes, unsigned long long) {
+    CUDA_ERR(cuMemcpyHtoDAsync(d_ring + slot * chunkBytes, ring[slot], bytes, streams[slot]));
+  };
+  auto waitUpload = [&](unsigned int slot) { CUDA_ERR(cuStreamSynchronize(streams[slot])); };
+
+  using clock = std::chrono::steady_clock;
+  Ingest::Stages stages{};
+  stages.bytes = fileBytes;
+  {
+    Trace::Span span("Disk", "transfer");
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, true);
+    stages.method = reader->method();
+    stages.direct = reader->direct();
+    stages.diskMilliseconds = Ingest::readMilliseconds(*reader, ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Staging", "transfer");
+    stages.stagingMilliseconds = Ingest::stagingMilliseconds(ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Upload", "transfer");
+    auto start = clock::now();
+    unsigned int slot = 0;
+    for (unsigned long long offset = 0; offset < fileBytes; offset += chunkBytes) {
+      upload(slot, static_cast<size_t>(std::min<unsigned long long>(chunkBytes, fileBytes - offset)), offset);
+      slot = (slot + 1) % ringSlots;
+    }
+    CUDA_ERR(cuCtxSynchronize());
+    stages.uploadMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+  unsigned int lastSlot = 0;
+  {
+    Trace::Span span("Pipeline", "transfer");
+    // Opened again so no pages from the disk pass are left in the cache
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, true);
+    auto start = clock::now();
+    lastSlot = Ingest::pipeline(*reader, ring, chunkBytes, fileBytes, upload, waitUpload);
+    stages.pipelineMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+  // The last chunk is still in its device slot, and has to match the end of the file
+  const unsigned long long lastOffset = (fileBytes - 1) / chunkBytes * chunkBytes;
+  std::vector<char> lastChunk(static_cast<size_t>(fileBytes - lastOffset));
+  CUDA_ERR(cuMemcpyDtoH(lastChunk.data(), d_ring + lastSlot * chunkBytes, lastChunk.size()));
+  bool valid = Ingest::matchesFile(path, lastOffset, lastChunk.data(), lastChunk.size());
+  std::cout << "\r" << CUDA << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " " << Sweep::formatBytes(static_cast<double>(fileBytes)) << " in " << Sweep::formatBytes(chunkBytes) << " chunks, " << ringSlots
+            << " pinned buffers\n";
+  Ingest::reportStages(CUDA, "ingest", stages);
+  Suite::record("ingest", static_cast<float>(stages.pipelineMilliseconds), valid);
+
+  for (CUstream stream : streams) {
+    releaseStream(stream);
+  }
+  CUDA_ERR(cuMemFree(std::exchange(buffers.device, 0)));
+  CUDA_ERR(cuMemFreeHost(std::exchange(buffers.host, nullptr)));
+  return static_cast<float>(stages.pipelineMilliseconds);
+}
+
+// Host-to-device and device-to-host bandwidth from buffers on the device's own NUMA node and on every other node, with
+// huge and default pages. On hosts with one node only the page sizes are compared.
+float CudaBackend::runNumaPlacementBenchmark(int hostNode) {
+  constexpr size_t bytes = 512ull << 20; // 512 MB
+  constexpr int iterations = 5;
+  TRACE_SCOPE("23) Host NUMA Placement", "test");
+  std::cout << CUDA << "23) Host NUMA Placement (" << Sweep::formatBytes(bytes) << ", local vs remote node, huge vs 4 KB pages)..." << std::flush;
+  struct Candidate {
+    std::string name, key;
+    int node;
+    bool hugePages;
+  };
+  std::vector<Candidate> candidates;
+  if (hostNode >= 0) {
+    candidates.push_back({"Local node " + std::to_string(hostNode), "local_huge", hostNode, true});
+    candidates.push_back({"Local node " + std::to_string(hostNode), "local_small", hostNode, false});
+    for (int node : HostMemory::nodes()) {
+      if (node != hostNode)
+        candidates.push_back({"Remote node " + std::to_string(node), "node" + std::to_string(node) + "_huge", node, true});
+    }
+  } else {
+    candidates.push_back({"Any node", "huge", -1, true});
+    candidates.push_back({"Any node", "small", -1, false});
+  }
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_data = 0;
+  CUDA_ERR(cuMemAlloc(&d_data, bytes));
+  allocSpan.end();
+
+  // Best of a few copies on the legacy stream, timed with events
+  auto bestMilliseconds = [&](auto&& copy) {
+    copy();
+    CUevent startEvent = acquireEvent();
+    CUevent stopEvent = acquireEvent();
+    float best = 0.0f;
+    for (int i = 0; i < iterations; ++i) {
+      float milliseconds = 0.0f;
+      CUDA_ERR(cuEventRecord(startEvent, nullptr));
+      copy();
+      CUDA_ERR(cuEventRecord(stopEvent, nullptr));
+      CUDA_ERR(cuEventSynchronize(stopEvent));
+      CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+      if (i == 0 || milliseconds < best)
+        best = milliseconds;
+    }
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    return static_cast<double>(best);
+  };
+
+  std::vector<Sweep::HostPlacement> placements;
+  for (const Candidate& candidate : candidates) {
+    TRACE_SCOPE("Placement step", "transfer");
+    Sweep::HostPlacement host{candidate.name, candidate.key, candidate.node == hostNode, {}, static_cast<double>(bytes), 0, 0};
+    char* h_data = static_cast<char*>(HostMemory::allocate(bytes, candidate.node, candidate.hugePages, &host.placement));
+    CUDA_ERR(cuMemHostRegister(h_data, bytes, 0));
+    host.htodMilliseconds = bestMilliseconds([&] { CUDA_ERR(cuMemcpyHtoD(d_data, h_data, bytes)); });
+    host.dtohMilliseconds = bestMilliseconds([&] { CUDA_ERR(cuMemcpyDtoH(h_data, d_data, bytes)); });
+    CUDA_ERR(cuMemHostUnregister(h_data));
+    HostMemory::release(h_data, bytes);
+    placements.push_back(host);
+  }
+  CUDA_ERR(cuMemFree(d_data));
+
+  std::cout << "\r" << CUDA << "23) Host NUMA Placement (" << Sweep::formatBytes(bytes) << ", local vs remote node, huge vs 4 KB pages)... Done\n";
+  if (hostNode < 0)
+    std::cout << CUDA << "The device's NUMA node is unknown or the host has one node, comparing page sizes only\n";
+  Sweep::reportHostPlacements(CUDA, "numa_placement", placements);
+  float milliseconds = static_cast<float>(placements[0].htodMilliseconds);
+  Suite::record("numa_placement", milliseconds);
+  return milliseconds;
+}
+
+// Multiply-add and GEMM throughput in every format: fp16 (half2), bf16 (pairs), fp32, fp64 and int8 (4-way dot products).
+// The GEMMs multiply small integers, which every format holds exactly, so their results are compared exactly.
+float CudaBackend::runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<void*, 5>& multiplyAddFuncs,
+                                          const std::array<void*, 5>& gemmFuncs, CudaBackend::CUfunction targetFunc, int dev,
+                                          int multiProcessorCount) {
+  constexpr unsigned int n = 2048;
+  TRACE_SCOPE("24) Precision", "test");
+  std::cout << CUDA << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  const size_t matrixBytes = static_cast<size_t>(n) * n * sizeof(double);
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_out = 0, d_A = 0, d_B = 0, d_C = 0;
+  CUDA_ERR(cuMemAlloc(&d_out, threads * sizeof(double)));
+  CUDA_ERR(cuMemAlloc(&d_A, matrixBytes));
+  CUDA_ERR(cuMemAlloc(&d_B, matrixBytes));
+  CUDA_ERR(cuMemAlloc(&d_C, matrixBytes));
+  allocSpan.end();
+
+  // Packed formats are only native if the PTX was built for an architecture that has their instructions
+  int target = 0;
+  void* targetArgs[] = {&d_out};
+  CUDA_ERR(cuLaunchKernel(targetFunc, 1, 1, 1, 1, 1, 1, 0, nullptr, targetArgs, nullptr));
+  CUDA_ERR(cuMemcpyDtoH(&target, d_out, sizeof(target)));
+  const int requiredTarget[] = {530, 800, 0, 0, 610};
+
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  auto timed = [&](CUfunction function, unsigned int blocks, unsigned int blockSize, unsigned int gridY, unsigned int blockY, void** args) {
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(function, blocks, gridY, 1, blockSize, blockY, 1, 0, stream, args, nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+  auto multiplyAdd = [&](CUfunction function, unsigned int iterations) {
+    void* args[] = {&d_out, &iterations};
+    return timed(function, static_cast<unsigned int>(threads / threadsPerBlock), threadsPerBlock, 1, 1, args);
+  };
+  auto gemm = [&](CUfunction function) {
+    unsigned int size = n;
+    void* args[] = {&d_A, &d_B, &d_C, &size};
+    return timed(function, n / 16, 16, n / 16, 16, args);
+  };
+
+  const std::vector<int> A = Gemm::integerMatrix(n, 1), B = Gemm::integerMatrix(n, 2);
+  std::vector<Gemm::FormatRate> rates;
+  for (Gemm::Format format : Gemm::formats) {
+    TRACE_SCOPE("Precision format", "kernel");
+    const size_t f = static_cast<size_t>(format);
+    Gemm::FormatRate rate{format, 0.0, 0.0, n, 0.0};
+
+    std::cout << "\r" << CUDA << "24) Precision (" << Gemm::formatName(format) << ")..." << std::flush;
+    // Double the iterations until one launch takes 20 ms, so the slow formats stay short
+    unsigned int iterations = 256;
+    double milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    }
+    rate.multiplyAddOps = static_cast<double>(threads) * iterations * 8 * Gemm::opsPerMultiplyAdd(format);
+    rate.multiplyAddMilliseconds = milliseconds;
+
+    const std::vector<unsigned char> h_A = Gemm::encode(format, A), h_B = Gemm::encode(format, B);
+    std::vector<unsigned char> h_C(static_cast<size_t>(n) * n * Gemm::outputBytes(format));
+    CUDA_ERR(cuMemcpyHtoD(d_A, h_A.data(), h_A.size()));
+    CUDA_ERR(cuMemcpyHtoD(d_B, h_B.data(), h_B.size()));
+    CUDA_ERR(cuMemsetD8(d_C, 0, h_C.size()));
+    rate.gemmMilliseconds = gemm(gemmFuncs[f]);
+    CUDA_ERR(cuMemcpyDtoH(h_C.data(), d_C, h_C.size()));
+    rate.valid = Gemm::verifyExact(format, A, B, h_C, n);
+    for (int run = 0; run < 2; ++run) {
+      rate.gemmMilliseconds = std::min(rate.gemmMilliseconds, gemm(gemmFuncs[f]));
+    }
+    if (target < requiredTarget[f])
+      rate.note = "emulated, PTX built for sm_" + std::to_string(target / 10);
+    rates.push_back(rate);
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFree(d_A));
+  CUDA_ERR(cuMemFree(d_B));
+  CUDA_ERR(cuMemFree(d_C));
+
+  bool valid = std::all_of(rates.begin(), rates.end(), [](const Gemm::FormatRate& rate) { return rate.valid; });
+  std::cout << "\r" << CUDA << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Gemm::reportFormats(CUDA, "precision", rates);
+  int ratio = 0;
+  CUDA_ERR(cuDeviceGetAttribute(&ratio, 87, dev)); // CU_DEVICE_ATTRIBUTE_SINGLE_TO_DOUBLE_PRECISION_PERF_RATIO
+  if (ratio > 0)
+    std::cout << CUDA << "The driver reports fp64 at 1/" << ratio << " of the fp32 rate\n";
+  float milliseconds = static_cast<float>(rates[static_cast<size_t>(Gemm::Format::Float)].gemmMilliseconds);
+  Suite::record("precision", milliseconds, valid);
+  return milliseconds;
+}
+
+// Latency and throughput of transcendental, integer and conversion instructions. Latency is read from the SM clock
+// around one dependent chain in a single thread; throughput comes from eight independent chains per thread on every SM.
+float CudaBackend::runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<void*>& latencyFuncs,
+                                               const std::vector<void*>& throughputFuncs, int dev, int multiProcessorCount) {
+  constexpr unsigned int latencyIterations = 4096;
+  TRACE_SCOPE("25) Instruction Mix", "test");
+  std::cout << CUDA << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_out = 0, d_cycles = 0;
+  CUDA_ERR(cuMemAlloc(&d_out, threads * sizeof(unsigned long long)));
+  CUDA_ERR(cuMemAlloc(&d_cycles, sizeof(long long)));
+  allocSpan.end();
+
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  unsigned int seed = 1;
+  auto throughput = [&](CUfunction function, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &seed, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(function, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  const std::vector<Microbench::Instruction>& instructions = Microbench::instructions();
+  std::vector<Microbench::InstructionRate> rates;
+  double totalMilliseconds = 0.0;
+  bool valid = true;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    TRACE_SCOPE("Instruction", "kernel");
+    std::cout << "\r" << CUDA << "25) Instruction Mix (" << instructions[i].name << ")..." << std::flush;
+    // The first launch warms the instruction cache, the second is the one measured
+    long long cycles = 0;
+    unsigned int iterations = latencyIterations;
+    void* latencyArgs[] = {&d_out, &d_cycles, &seed, &iterations};
+    for (int run = 0; run < 2; ++run) {
+      CUDA_ERR(cuLaunchKernel(latencyFuncs[i], 1, 1, 1, 1, 1, 1, 0, stream, latencyArgs, nullptr));
+      CUDA_ERR(cuStreamSynchronize(stream));
+    }
+    CUDA_ERR(cuMemcpyDtoH(&cycles, d_cycles, sizeof(cycles)));
+
+    // Double the iterations until one launch takes 20 ms, so the slow instructions stay short
+    iterations = 256;
+    double milliseconds = throughput(throughputFuncs[i], iterations);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = throughput(throughputFuncs[i], iterations);
+    }
+    totalMilliseconds += milliseconds;
+    double latency = static_cast<double>(cycles) / latencyIterations;
+    valid = valid && latency > 0.0 && milliseconds > 0.0;
+    rates.push_back({instructions[i].name, instructions[i].key, latency, static_cast<double>(threads) * iterations * 8, milliseconds});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFree(d_cycles));
+
+  int clockKilohertz = 0;
+  CUDA_ERR(cuDeviceGetAttribute(&clockKilohertz, 13, dev)); // CU_DEVICE_ATTRIBUTE_CLOCK_RATE
+  std::cout << "\r" << CUDA << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Microbench::reportInstructionMix(CUDA, "instruction_mix", rates, clockKilohertz * 1e3, static_cast<unsigned int>(multiProcessorCount));
+  Suite::record("instruction_mix", static_cast<float>(totalMilliseconds), valid);
+  return static_cast<float>(totalMilliseconds);
+}
+
+// A copy and an FMA loop, each plain and with high register pressure, at every block size and dynamic shared memory
+// reservation, next to the occupancy the driver calculates for that configuration
+float CudaBackend::runOccupancyBenchmark(const std::vector<void*>& funcs, size_t totalMemory, size_t sharedMemPerBlock,
+                                         int maxThreadsPerMultiProcessor, int multiProcessorCount) {
+  const std::vector<Microbench::OccupancyKernel>& kernels = Microbench::occupancyKernels();
+  TRACE_SCOPE("26) Occupancy", "test");
+  std::cout << CUDA << "26) Occupancy (" << kernels.size() << " kernels, block size and shared memory sweep)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 2048;
+  unsigned long long elements = std::min<size_t>(256 << 20, totalMemory / 8) / 16;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_in = 0, d_out = 0, d_results = 0;
+  CUDA_ERR(cuMemAlloc(&d_in, elements * 16));
+  CUDA_ERR(cuMemAlloc(&d_out, elements * 16));
+  CUDA_ERR(cuMemAlloc(&d_results, threads * sizeof(float)));
+  CUDA_ERR(cuMemsetD8(d_in, 0, elements * 16));
+  allocSpan.end();
+
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  auto timed = [&](CUfunction function, unsigned int blockSize, size_t sharedBytes, void** args) {
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(function, static_cast<unsigned int>(threads / blockSize), 1, 1, blockSize, 1, 1, static_cast<unsigned int>(sharedBytes),
+                            stream, args, nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::OccupancyCurve> curves;
+  double totalMilliseconds = 0.0;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    TRACE_SCOPE("Occupancy kernel", "kernel");
+    int registers = 0, maxBlockSize = 0;
+    CUDA_ERR(cuFuncGetAttribute(&registers, 4, funcs[k]));    // CU_FUNC_ATTRIBUTE_NUM_REGS
+    CUDA_ERR(cuFuncGetAttribute(&maxBlockSize, 0, funcs[k])); // CU_FUNC_ATTRIBUTE_MAX_THREADS_PER_BLOCK
+    Microbench::OccupancyCurve curve{&kernels[k], registers, static_cast<size_t>(maxBlockSize), {}};
+    unsigned int iterations = Microbench::occupancyFmasPerThread / kernels[k].perThread;
+    void* computeArgs[] = {&d_results, &iterations};
+    void* memoryArgs[] = {&d_in, &d_out, &elements};
+    const double work = kernels[k].compute ? static_cast<double>(threads) * Microbench::occupancyFmasPerThread * 2 : elements * 16.0 * 2;
+    for (unsigned int blockSize : Microbench::occupancyBlockSizes()) {
+      if (blockSize > static_cast<unsigned int>(maxBlockSize))
+        continue;
+      std::cout << "\r" << CUDA << "26) Occupancy (" << kernels[k].name << ", blocks of " << blockSize << ")...          " << std::flush;
+      for (size_t sharedBytes : Microbench::occupancySharedBytes()) {
+        int residentBlocks = 0;
+        if (sharedBytes <= sharedMemPerBlock)
+          CUDA_ERR(cuOccupancyMaxActiveBlocksPerMultiprocessor(&residentBlocks, funcs[k], static_cast<int>(blockSize), sharedBytes));
+        if (residentBlocks == 0)
+          continue;
+        // Best of two, the first also warms up the configuration
+        double milliseconds = timed(funcs[k], blockSize, sharedBytes, kernels[k].compute ? computeArgs : memoryArgs);
+        milliseconds = std::min(milliseconds, timed(funcs[k], blockSize, sharedBytes, kernels[k].compute ? computeArgs : memoryArgs));
+        totalMilliseconds += milliseconds;
+        double occupancy = static_cast<double>(residentBlocks) * blockSize / maxThreadsPerMultiProcessor;
+        curve.points.push_back({blockSize, sharedBytes, occupancy, work, milliseconds});
+      }
+    }
+    curves.push_back(curve);
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  CUDA_ERR(cuMemFree(d_in));
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFree(d_results));
+
+  std::cout << "\r" << CUDA << "26) Occupancy (" << kernels.size() << " kernels, block size and shared memory sweep)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportOccupancy(CUDA, "occupancy", curves);
+  Suite::record("occupancy", static_cast<float>(totalMilliseconds));
+  return static_cast<float>(totalMilliseconds);
+}
+
+// divergenceKernel with the threads split over its four paths in every pattern of Microbench::divergencePatterns().
+// Every pattern runs the rounds that take the uniform one 20 ms.
+float CudaBackend::runDivergenceBenchmark(unsigned int threadsPerBlock, CudaBackend::CUfunction divergenceFunc, int warpSize,
+                                           int multiProcessorCount) {
+  const std::vector<Microbench::DivergencePattern>& patterns = Microbench::divergencePatterns();
+  TRACE_SCOPE("27) Divergence", "test");
+  std::cout << CUDA << "27) Divergence (" << patterns.size() << " patterns, warps of " << warpSize << ")..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_out = 0, d_paths = 0;
+  CUDA_ERR(cuMemAlloc(&d_out, threads * sizeof(float)));
+  CUDA_ERR(cuMemAlloc(&d_paths, threads * sizeof(unsigned int)));
+  allocSpan.end();
+
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  unsigned int rounds = 16;
+  auto timed = [&]() {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &d_paths, &rounds};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(divergenceFunc, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args,
+                            nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::DivergenceResult> results;
+  for (size_t p = 0; p < patterns.size(); ++p) {
+    std::cout << "\r" << CUDA << "27) Divergence (" << patterns[p].name << ")...          " << std::flush;
+    const std::vector<unsigned int> paths = Microbench::divergencePaths(p, threads, static_cast<unsigned int>(warpSize));
+    CUDA_ERR(cuMemcpyHtoD(d_paths, paths.data(), paths.size() * sizeof(unsigned int)));
+    double milliseconds = timed();
+    while (p == 0 && milliseconds < 20.0 && rounds < (1u << 20)) {
+      rounds *= 2;
+      milliseconds = timed();
+    }
+    double fmas = static_cast<double>(threads) * rounds * Microbench::divergenceFmasPerRound;
+    results.push_back({&patterns[p], Microbench::pathsPerWarp(paths, static_cast<unsigned int>(warpSize)), fmas, milliseconds});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  CUDA_ERR(cuMemFree(d_out));
+  CUDA_ERR(cuMemFree(d_paths));
+
+  std::cout << "\r" << CUDA << "27) Divergence (" << patterns.size() << " patterns, warps of " << warpSize << ")...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportDivergence(CUDA, "divergence", results, static_cast<unsigned int>(warpSize));
+  float milliseconds = static_cast<float>(results[0].milliseconds);
+  Suite::record("divergence", milliseconds);
+  return milliseconds;
+}
+
+// Every operation of Microbench::atomicOperations() on global and on shared memory counters, at every contention of
+// Microbench::atomicContentions(), with two blocks per SM. A compare-and-swap loop costs about the square of the threads
+// contending for its address, so global ones on few addresses run as one block.
+float CudaBackend::runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<void*>& globalFuncs, const std::vector<void*>& sharedFuncs,
+                                       int multiProcessorCount) {
+  const std::vector<Microbench::AtomicOperation>& operations = Microbench::atomicOperations();
+  const std::vector<Microbench::AtomicContention>& contentions = Microbench::atomicContentions();
+  TRACE_SCOPE("28) Atomics", "test");
+  std::cout << CUDA << "28) Atomics (" << operations.size() << " operations, global and shared)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 2 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  CUdeviceptr d_counters = 0;
+  CUDA_ERR(cuMemAlloc(&d_counters, threads * sizeof(unsigned long long)));
+  CUDA_ERR(cuMemsetD8(d_counters, 0, threads * sizeof(unsigned long long)));
+  allocSpan.end();
+
+  CUstream stream = acquireStream();
+  CUevent startEvent = acquireEvent();
+  CUevent stopEvent = acquireEvent();
+  auto timed = [&](CUfunction func, size_t launched, unsigned int addresses, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_counters, &addresses, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CUDA_ERR(cuEventRecord(startEvent, stream));
+    CUDA_ERR(cuLaunchKernel(func, static_cast<unsigned int>(launched / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+    CUDA_ERR(cuEventRecord(stopEvent, stream));
+    CUDA_ERR(cuEventSynchronize(stopEvent));
+    CUDA_ERR(cuEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::AtomicResult> results;
+  for (bool shared : {false, true}) {
+    for (size_t o = 0; o < operations.size(); ++o) {
+      for (const Microbench::AtomicContention& contention : contentions) {
+        // A block has at most threadsPerBlock shared counters, so larger counts repeat "1 per thread"
+        if (shared && contention.addresses >= threadsPerBlock) {
+          results.push_back({&operations[o], shared, &contention, 0.0, 0.0, false});
+          continue;
+        }
+        std::cout << "\r" << CUDA << "28) Atomics (" << (shared ? "shared " : "global ") << operations[o].name << ", " << contention.name
+                  << ")...          " << std::flush;
+        CUfunction func = shared ? sharedFuncs[o] : globalFuncs[o];
+        const bool oneBlock = !shared && operations[o].casLoop && contention.addresses != 0 &&
+                              contention.addresses <= Microbench::casLoopBlockAddresses;
+        const size_t launched = oneBlock ? threadsPerBlock : threads;
+        unsigned int iterations = 1;
+        double milliseconds = timed(func, launched, contention.addresses, iterations);
+        while (milliseconds < 20.0 && iterations < (1u << 16)) {
+          iterations *= 2;
+          milliseconds = timed(func, launched, contention.addresses, iterations);
+        }
+        results.push_back({&operations[o], shared, &contention, static_cast<double>(launched) * iterations, milliseconds, oneBlock});
+      }
+    }
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  CUDA_ERR(cuMemFree(d_counters));
+
+  std::cout << "\r" << CUDA << "28) Atomics (" << operations.size() << " operations, global and shared)...";
+  std::cout << GREEN << " PASSED" << RESET << "                    \n";
+  Microbench::reportAtomics(CUDA, "atomics", results);
+  float milliseconds = static_cast<float>(Microbench::histogramMilliseconds(results));
+  Suite::record("atomics", milliseconds);
+  return milliseconds;
+}
+
 void CudaBackend::shutdown() {
   if (nvmlShutdown != nullptr)
     nvmlShutdown();
@@ -566,6 +2827,32 @@ void CudaBackend::shutdown() {
   cuDeviceComputeCapability = nullptr;
   cuDeviceGetAttribute = nullptr;
   cuGetErrorString = nullptr;
+  cuMemcpyHtoDAsync = nullptr;
+  cuMemcpyDtoHAsync = nullptr;
+  cuCtxSetCurrent = nullptr;
+  cuMemHostAlloc = nullptr;
+  cuDeviceCanAccessPeer = nullptr;
+  cuCtxEnablePeerAccess = nullptr;
+  cuMemcpyPeer = nullptr;
+  cuMemHostGetDevicePointer = nullptr;
+  cuMemHostRegister = nullptr;
+  cuMemHostUnregister = nullptr;
+  cuMemAllocManaged = nullptr;
+  cuMemPrefetchAsync = nullptr;
+  cuStreamSynchronize = nullptr;
+  cuMemAllocAsync = nullptr;
+  cuMemFreeAsync = nullptr;
+  cuDeviceGetDefaultMemPool = nullptr;
+  cuMemPoolSetAttribute = nullptr;
+  cuMemPoolGetAttribute = nullptr;
+  cuMemcpyDtoD = nullptr;
+  cuMemAllocPitch = nullptr;
+  cuMemcpy2D = nullptr;
+  cuOccupancyMaxActiveBlocksPerMultiprocessor = nullptr;
+  cuFuncGetAttribute = nullptr;
+  cuMemcpy3D = nullptr;
+  cuCtxGetCurrent = nullptr;
+  cuCtxPopCurrent = nullptr;
 
   nvmlInit = nullptr;
   nvmlShutdown = nullptr;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "../gpumark.hpp"
+#include <array>
 #include <cstddef>
+#include <vector>
 namespace CudaBackend {
 static void* cudaHandle = nullptr;
 static void* nvmlHandle = nullptr;
@@ -11,26 +14,80 @@ bool memUtilizationSafe(void* nvmlDevice);
 unsigned int getAndPrintTemperature(void* nvmlDevice);
 bool slowBenchmarks(float linearSetTime, float linearMultiplyTime);
 void prepareDeviceForBenchmarking(int dev);
-void runBenchmark();
+std::vector<GPUMark::Device> enumerateDevices();
+std::vector<GPUMark::PeerLink> runPeerToPeerBenchmark(const std::vector<int>& devices);
 void shutdown();
 
-float runLinearSetBenchmark(unsigned int threadsPerBlock, void* kernel);
-float runLinearMultiplyBenchmark(unsigned int threadsPerBlock, void* kernel);
+float runLinearSetBenchmark(unsigned int threadsPerBlock, void* kernel, int hostNode);
+float runLinearMultiplyBenchmark(unsigned int threadsPerBlock, void* kernel, int hostNode);
 float runFmaBenchmark(unsigned int threadsPerBlock, void* fmaFunc);
 float runIntegerThroughputBenchmark(unsigned int threadsPerBlock, void* kernel);
-float runSharedMemoryBenchmark(unsigned int threadsPerBlock, void* kernel);
-float runSgemmBenchmark(unsigned int threadsPerBlock, void* kernel);
-float runPCIEThroughputBenchmark();
+float runSharedMemoryBenchmark(unsigned int threadsPerBlock, void* kernel, int dev, int multiProcessorCount);
+float runSgemmBenchmark(void* naiveFunc, void* tiledFunc, void* registerFunc);
+float runPCIEThroughputBenchmark(int hostNode);
+float runStreamEventOverheadBenchmark();
+float runTransferSweepBenchmark(size_t totalMemory);
+float runBidirectionalPCIEBenchmark(size_t totalMemory);
+float runCopyComputeOverlapBenchmark(unsigned int threadsPerBlock, void* linearMultiplyFunc, size_t totalMemory);
+float runPointerChaseBenchmark(void* initFunc, void* chaseFunc, size_t totalMemory);
+float runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<void*, 3>& kernels, size_t totalMemory, unsigned int warpSize);
+float runStreamBenchmark(unsigned int threadsPerBlock, void* initFunc, const std::array<void*, 12>& kernels, size_t totalMemory,
+                         int multiProcessorCount);
+float runZeroCopyBenchmark(unsigned int threadsPerBlock, void* scaleFunc, size_t totalMemory, int multiProcessorCount);
+float runHostRegistrationBenchmark(size_t totalMemory);
+float runManagedMemoryBenchmark(unsigned int threadsPerBlock, void* incrementFunc, int dev, size_t totalMemory, int multiProcessorCount,
+                                bool concurrentManagedAccess);
+float runAllocationBenchmark(int dev, size_t totalMemory);
+float runCopyEngineBenchmark(unsigned int threadsPerBlock, void* copyFunc, void* pitchedCopyFunc, void* volumeCopyFunc, size_t totalMemory,
+                             int multiProcessorCount);
+float runOutOfCoreBenchmark(unsigned int threadsPerBlock, void* checksumFunc, size_t totalMemory, int multiProcessorCount);
+float runIngestBenchmark();
+float runNumaPlacementBenchmark(int hostNode);
+float runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<void*, 5>& multiplyAddFuncs, const std::array<void*, 5>& gemmFuncs,
+                            void* targetFunc, int dev, int multiProcessorCount);
+float runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<void*>& latencyFuncs, const std::vector<void*>& throughputFuncs,
+                                 int dev, int multiProcessorCount);
+float runOccupancyBenchmark(const std::vector<void*>& funcs, size_t totalMemory, size_t sharedMemPerBlock, int maxThreadsPerMultiProcessor,
+                            int multiProcessorCount);
+float runDivergenceBenchmark(unsigned int threadsPerBlock, void* divergenceFunc, int warpSize, int multiProcessorCount);
+float runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<void*>& globalFuncs, const std::vector<void*>& sharedFuncs,
+                          int multiProcessorCount);
 
 typedef void* CUfunction;
 typedef void* CUmodule;
 typedef void* CUcontext;
 typedef void* CUstream;
 typedef void* CUevent;
+typedef void* CUmemoryPool;
 typedef size_t CUdeviceptr;
 typedef int CUdevice;
+
+// Per-device execution context. Streams and timing events are created once per device
+// and recycled across tests, so driver object creation stays out of the timed regions.
+struct ExecutionContext {
+  std::vector<CUstream> streams; // Every stream owned by the pool
+  std::vector<CUstream> freeStreams;
+  std::vector<CUevent> events; // Every event owned by the pool
+  std::vector<CUevent> freeEvents;
+};
+extern ExecutionContext execContext;
+
+void createExecutionContext(unsigned int streamCount, unsigned int eventCount);
+void destroyExecutionContext();
+CUstream acquireStream();
+void releaseStream(CUstream stream);
+CUevent acquireEvent();
+void releaseEvent(CUevent event);
 typedef enum { nvmlSuccess = 0 } nvmlReturn_t;
-typedef enum { CUDA_SUCCESS = 0 } CUresult;
+typedef enum { CUDA_SUCCESS = 0, CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED = 704 } CUresult;
+#define CU_MEMHOSTALLOC_PORTABLE 0x01
+#define CU_MEMHOSTALLOC_DEVICEMAP 0x02
+#define CU_MEM_ATTACH_GLOBAL 0x1
+#define CU_DEVICE_CPU -1
+#define CU_MEMPOOL_ATTR_RELEASE_THRESHOLD 4
+#define CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT 5
+#define CU_MEMPOOL_ATTR_USED_MEM_CURRENT 7
+#define CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED 115
 typedef enum {
   cudaMemcpyHostToHost = 0,
   cudaMemcpyHostToDevice = 1,
@@ -38,6 +95,52 @@ typedef enum {
   cudaMemcpyDeviceToDevice = 3,
   cudaMemcpyDefault = 4
 } cudaMemcpyKind;
+typedef enum { CU_MEMORYTYPE_HOST = 1, CU_MEMORYTYPE_DEVICE = 2, CU_MEMORYTYPE_ARRAY = 3, CU_MEMORYTYPE_UNIFIED = 4 } CUmemorytype;
+struct CUDA_MEMCPY2D {
+  size_t srcXInBytes;
+  size_t srcY;
+  CUmemorytype srcMemoryType;
+  const void* srcHost;
+  CUdeviceptr srcDevice;
+  void* srcArray;
+  size_t srcPitch;
+  size_t dstXInBytes;
+  size_t dstY;
+  CUmemorytype dstMemoryType;
+  void* dstHost;
+  CUdeviceptr dstDevice;
+  void* dstArray;
+  size_t dstPitch;
+  size_t WidthInBytes;
+  size_t Height;
+};
+struct CUDA_MEMCPY3D {
+  size_t srcXInBytes;
+  size_t srcY;
+  size_t srcZ;
+  size_t srcLOD;
+  CUmemorytype srcMemoryType;
+  const void* srcHost;
+  CUdeviceptr srcDevice;
+  void* srcArray;
+  void* reserved0;
+  size_t srcPitch;
+  size_t srcHeight; // Rows per slice
+  size_t dstXInBytes;
+  size_t dstY;
+  size_t dstZ;
+  size_t dstLOD;
+  CUmemorytype dstMemoryType;
+  void* dstHost;
+  CUdeviceptr dstDevice;
+  void* dstArray;
+  void* reserved1;
+  size_t dstPitch;
+  size_t dstHeight;
+  size_t WidthInBytes;
+  size_t Height;
+  size_t Depth;
+};
 typedef void* nvmlDevice_t;
 struct nvmlUtilization_t {
   unsigned int gpu;
@@ -177,6 +280,32 @@ typedef CUresult (*cuStreamDestroy_t)(CUstream);
 typedef CUresult (*cuDeviceTotalMem_t)(size_t*, CUdevice);
 typedef CUresult (*cuDeviceComputeCapability_t)(int*, int*, CUdevice);
 typedef CUresult (*cuDeviceGetAttribute_t)(int*, int, CUdevice);
+typedef CUresult (*cuMemcpyHtoDAsync_t)(CUdeviceptr dst, const void* src, size_t, CUstream);
+typedef CUresult (*cuMemcpyDtoHAsync_t)(void* dst, CUdeviceptr src, size_t, CUstream);
+typedef CUresult (*cuCtxSetCurrent_t)(CUcontext);
+typedef CUresult (*cuMemHostAlloc_t)(void**, size_t, unsigned int);
+typedef CUresult (*cuDeviceCanAccessPeer_t)(int*, CUdevice, CUdevice);
+typedef CUresult (*cuCtxEnablePeerAccess_t)(CUcontext, unsigned int);
+typedef CUresult (*cuMemcpyPeer_t)(CUdeviceptr, CUcontext, CUdeviceptr, CUcontext, size_t);
+typedef CUresult (*cuMemHostGetDevicePointer_t)(CUdeviceptr*, void*, unsigned int);
+typedef CUresult (*cuMemHostRegister_t)(void*, size_t, unsigned int);
+typedef CUresult (*cuMemHostUnregister_t)(void*);
+typedef CUresult (*cuMemAllocManaged_t)(CUdeviceptr*, size_t, unsigned int);
+typedef CUresult (*cuMemPrefetchAsync_t)(CUdeviceptr, size_t, CUdevice, CUstream);
+typedef CUresult (*cuStreamSynchronize_t)(CUstream);
+typedef CUresult (*cuMemAllocAsync_t)(CUdeviceptr*, size_t, CUstream);
+typedef CUresult (*cuMemFreeAsync_t)(CUdeviceptr, CUstream);
+typedef CUresult (*cuDeviceGetDefaultMemPool_t)(CUmemoryPool*, CUdevice);
+typedef CUresult (*cuMemPoolSetAttribute_t)(CUmemoryPool, int, void*);
+typedef CUresult (*cuMemPoolGetAttribute_t)(CUmemoryPool, int, void*);
+typedef CUresult (*cuMemcpyDtoD_t)(CUdeviceptr, CUdeviceptr, size_t);
+typedef CUresult (*cuMemAllocPitch_t)(CUdeviceptr*, size_t*, size_t, size_t, unsigned int);
+typedef CUresult (*cuMemcpy2D_t)(const CUDA_MEMCPY2D*);
+typedef CUresult (*cuOccupancyMaxActiveBlocksPerMultiprocessor_t)(int*, CUfunction, int, size_t);
+typedef CUresult (*cuFuncGetAttribute_t)(int*, int, CUfunction);
+typedef CUresult (*cuMemcpy3D_t)(const CUDA_MEMCPY3D*);
+typedef CUresult (*cuCtxGetCurrent_t)(CUcontext*);
+typedef CUresult (*cuCtxPopCurrent_t)(CUcontext*);
 typedef const char* (*cuGetErrorString_t)(CUresult, const char**);
 
 // ------------------------
@@ -217,6 +346,32 @@ extern cuStreamDestroy_t cuStreamDestroy;
 extern cuDeviceTotalMem_t cuDeviceTotalMem;
 extern cuDeviceComputeCapability_t cuDeviceComputeCapability;
 extern cuDeviceGetAttribute_t cuDeviceGetAttribute;
+extern cuMemcpyHtoDAsync_t cuMemcpyHtoDAsync;
+extern cuMemcpyDtoHAsync_t cuMemcpyDtoHAsync;
+extern cuCtxSetCurrent_t cuCtxSetCurrent;
+extern cuMemHostAlloc_t cuMemHostAlloc;
+extern cuDeviceCanAccessPeer_t cuDeviceCanAccessPeer;
+extern cuCtxEnablePeerAccess_t cuCtxEnablePeerAccess;
+extern cuMemcpyPeer_t cuMemcpyPeer;
+extern cuMemHostGetDevicePointer_t cuMemHostGetDevicePointer;
+extern cuMemHostRegister_t cuMemHostRegister;
+extern cuMemHostUnregister_t cuMemHostUnregister;
+extern cuMemAllocManaged_t cuMemAllocManaged;
+extern cuMemPrefetchAsync_t cuMemPrefetchAsync;
+extern cuStreamSynchronize_t cuStreamSynchronize;
+extern cuMemAllocAsync_t cuMemAllocAsync;
+extern cuMemFreeAsync_t cuMemFreeAsync;
+extern cuDeviceGetDefaultMemPool_t cuDeviceGetDefaultMemPool;
+extern cuMemPoolSetAttribute_t cuMemPoolSetAttribute;
+extern cuMemPoolGetAttribute_t cuMemPoolGetAttribute;
+extern cuMemcpyDtoD_t cuMemcpyDtoD;
+extern cuMemAllocPitch_t cuMemAllocPitch;
+extern cuMemcpy2D_t cuMemcpy2D;
+extern cuOccupancyMaxActiveBlocksPerMultiprocessor_t cuOccupancyMaxActiveBlocksPerMultiprocessor;
+extern cuFuncGetAttribute_t cuFuncGetAttribute;
+extern cuMemcpy3D_t cuMemcpy3D;
+extern cuCtxGetCurrent_t cuCtxGetCurrent;
+extern cuCtxPopCurrent_t cuCtxPopCurrent;
 
 extern cuGetErrorString_t cuGetErrorString;
 
@@ -1,9 +1,21 @@
 #include "hip_backend.hpp"
+#include "../shared/gemm.hpp"
+#include "../shared/host_memory.hpp"
+#include "../shared/ingest.hpp"
+#include "../shared/microbench.hpp"
 #include "../shared/shared.hpp"
+#include "../shared/suite.hpp"
+#include "../shared/sweep.hpp"
+#include "../shared/trace.hpp"
 #include "modules/hip_kernels.hpp"
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 HIPBackend::hipInit_t HIPBackend::hipInit = nullptr;
@@ -31,6 +43,29 @@ HIPBackend::hipModuleLoadData_t HIPBackend::hipModuleLoadData = nullptr;
 HIPBackend::hipModuleUnload_t HIPBackend::hipModuleUnload = nullptr;
 HIPBackend::hipModuleGetFunction_t HIPBackend::hipModuleGetFunction = nullptr;
 HIPBackend::hipModuleLaunchKernel_t HIPBackend::hipModuleLaunchKernel = nullptr;
+HIPBackend::hipMemcpyAsync_t HIPBackend::hipMemcpyAsync = nullptr;
+HIPBackend::hipDeviceSynchronize_t HIPBackend::hipDeviceSynchronize = nullptr;
+HIPBackend::hipDeviceCanAccessPeer_t HIPBackend::hipDeviceCanAccessPeer = nullptr;
+HIPBackend::hipDeviceEnablePeerAccess_t HIPBackend::hipDeviceEnablePeerAccess = nullptr;
+HIPBackend::hipDeviceDisablePeerAccess_t HIPBackend::hipDeviceDisablePeerAccess = nullptr;
+HIPBackend::hipMemcpyPeer_t HIPBackend::hipMemcpyPeer = nullptr;
+HIPBackend::hipHostGetDevicePointer_t HIPBackend::hipHostGetDevicePointer = nullptr;
+HIPBackend::hipHostRegister_t HIPBackend::hipHostRegister = nullptr;
+HIPBackend::hipHostUnregister_t HIPBackend::hipHostUnregister = nullptr;
+HIPBackend::hipMallocManaged_t HIPBackend::hipMallocManaged = nullptr;
+HIPBackend::hipMemPrefetchAsync_t HIPBackend::hipMemPrefetchAsync = nullptr;
+HIPBackend::hipStreamSynchronize_t HIPBackend::hipStreamSynchronize = nullptr;
+HIPBackend::hipMallocAsync_t HIPBackend::hipMallocAsync = nullptr;
+HIPBackend::hipFreeAsync_t HIPBackend::hipFreeAsync = nullptr;
+HIPBackend::hipDeviceGetDefaultMemPool_t HIPBackend::hipDeviceGetDefaultMemPool = nullptr;
+HIPBackend::hipMemPoolSetAttribute_t HIPBackend::hipMemPoolSetAttribute = nullptr;
+HIPBackend::hipMemPoolGetAttribute_t HIPBackend::hipMemPoolGetAttribute = nullptr;
+HIPBackend::hipMallocPitch_t HIPBackend::hipMallocPitch = nullptr;
+HIPBackend::hipMemcpy2D_t HIPBackend::hipMemcpy2D = nullptr;
+HIPBackend::hipModuleOccupancyMaxActiveBlocksPerMultiprocessor_t HIPBackend::hipModuleOccupancyMaxActiveBlocksPerMultiprocessor = nullptr;
+HIPBackend::hipFuncGetAttribute_t HIPBackend::hipFuncGetAttribute = nullptr;
+HIPBackend::hipDeviceGetAttribute_t HIPBackend::hipDeviceGetAttribute = nullptr;
+HIPBackend::hipMemcpy3D_t HIPBackend::hipMemcpy3D = nullptr;
 // Error
 HIPBackend::hipGetErrorString_t HIPBackend::hipGetErrorString = nullptr;
 // RSMI
@@ -42,12 +77,13 @@ HIPBackend::rsmi_dev_memory_usage_get_t HIPBackend::rsmi_dev_memory_usage_get =
 HIPBackend::rsmi_dev_name_get_t HIPBackend::rsmi_dev_name_get = nullptr;
 HIPBackend::rsmi_dev_busy_percent_get_t HIPBackend::rsmi_dev_busy_percent_get = nullptr;
 
+HIPBackend::ExecutionContext HIPBackend::execContext;
+
 #define HIP_ERR(call)                                                                                                                                \
   do {                                                                                                                                               \
     hipError_t err = call;                                                                                                                           \
     if (err != hipSuccess) {                                                                                                                         \
-      std::cerr << HIP << "HIP error at hip_backend.cpp:" << __LINE__ << ": " << hipGetErrorString(err) << "\n";                                     \
-      exit(EXIT_FAILURE);                                                                                                                            \
+      throw GPUMark::Error("HIP error at hip_backend.cpp:" + std::to_string(__LINE__) + ": " + hipGetErrorString(err));                             \
     }                                                                                                                                                \
   } while (0)
 
@@ -55,8 +91,7 @@ HIPBackend::rsmi_dev_busy_percent_get_t HIPBackend::rsmi_dev_busy_percent_get =
   do {                                                                                                                                               \
     HIPBackend::rsmi_status_t err = call;                                                                                                            \
     if (err != 0) {                                                                                                                                  \
-      std::cerr << HIP << "RSMI error at hip_backend.cpp:" << __LINE__ << ": " << err << "\n";                                                       \
-      exit(EXIT_FAILURE);                                                                                                                            \
+      throw GPUMark::Error("RSMI error at hip_backend.cpp:" + std::to_string(__LINE__) + ": " + std::to_string(err));                               \
     }                                                                                                                                                \
   } while (0)
 
@@ -65,6 +100,7 @@ bool HIPBackend::gpuUtilizationSafe(int dev) {
   RSMI_ERR(rsmi_dev_busy_percent_get(dev, &utilization));
   if (utilization > 7) {
     std::cout << HIP << "Skipping benchmark on this device due to high utilization (" << RED << utilization << "%" << RESET << ")\n";
+    Suite::skipDevice("high GPU utilization (" + std::to_string(utilization) + "%)");
     return false;
   }
   return true;
@@ -81,12 +117,14 @@ bool HIPBackend::memUtilizationSafe(int dev) {
   if (totalMemory < requiredMem) {
     std::cout << HIP << "Skipping benchmark on this device due to insufficient total memory (" << RED << (totalMemory / (1024 * 1024))
               << "mb/2048mb required" << RESET << ")\n";
+    Suite::skipDevice("insufficient total memory");
     return false;
   }
   double usagePercent = (double)usedMemory / (double)totalMemory * 100.0;
   if (usagePercent > 25) {
     std::cout << HIP << "Skipping benchmark on this device due to high memory usage (" << RED << std::fixed << std::setprecision(2) << usagePercent
               << "%" << RESET << ")\n";
+    Suite::skipDevice("high memory usage");
     return false;
   }
   std::string_view memColor;
@@ -122,6 +160,11 @@ int64_t HIPBackend::getAndPrintTemperature(int dev) {
 bool HIPBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
   constexpr static const float slowMSThreshold = 50.0f;
   if (linearSetTime > slowMSThreshold || linearMultiplyTime > slowMSThreshold) {
+    if (!Suite::interactive()) {
+      std::cout << HIP << "The initial tests were slow. Skipping further benchmarks on this device.\n";
+      Suite::skipDevice("initial tests were slow");
+      return true;
+    }
     // These words are randomly selected to make sure that the user is paying attention! Seriously, these tests
     // may actually take forever, so the user better know what they're in for.
     static const char* confirmWords[] = {"YES", "HIP", "CONTINUE", "YEAH", "SURE", "GOAHEAD", "FINE", "WHYNOT", "AFFIRMATIVE", "LETSGO", "OKAY"};
@@ -136,6 +179,7 @@ bool HIPBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
     std::cin >> userInput;
     if (!stringsRoughlyMatch(userInput, confirmWords[randIdx])) {
       std::cout << HIP << "Aborting further benchmarks on this device.\n";
+      Suite::skipDevice("aborted by user");
       return true;
     }
     return false;
@@ -143,6 +187,49 @@ bool HIPBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
   return false;
 }
 
+namespace {
+// Tears down the device's module, stream/event pool and state when a test throws or the device is skipped, so the next
+// device starts clean. hipDeviceReset also frees whatever the failed test had allocated. Errors are ignored here, as
+// one is usually already unwinding.
+struct DeviceGuard {
+  HIPBackend::hipModule_t module = nullptr;
+  bool reset = true;
+
+  DeviceGuard() = default;
+  DeviceGuard(const DeviceGuard&) = delete;
+  DeviceGuard& operator=(const DeviceGuard&) = delete;
+  ~DeviceGuard() {
+    HIPBackend::ExecutionContext pool = std::exchange(HIPBackend::execContext, HIPBackend::ExecutionContext{});
+    for (HIPBackend::hipEvent_t event : pool.events) {
+      HIPBackend::hipEventDestroy(event);
+    }
+    for (HIPBackend::hipStream_t stream : pool.streams) {
+      HIPBackend::hipStreamDestroy(stream);
+    }
+    if (module)
+      HIPBackend::hipModuleUnload(module);
+    if (reset)
+      HIPBackend::hipDeviceReset();
+  }
+};
+
+// Frees the ingest test's pinned ring and its device copy if the test throws
+struct IngestRing {
+  char* host = nullptr;
+  char* device = nullptr;
+
+  IngestRing() = default;
+  IngestRing(const IngestRing&) = delete;
+  IngestRing& operator=(const IngestRing&) = delete;
+  ~IngestRing() {
+    if (device)
+      HIPBackend::hipFree(device);
+    if (host)
+      HIPBackend::hipHostFree(host);
+  }
+};
+} // namespace
+
 void HIPBackend::prepareDeviceForBenchmarking(int dev) {
   // Take the ptx file compiled at build time and load it.
   HIP_ERR(hipSetDevice(dev));
@@ -158,9 +245,19 @@ void HIPBackend::prepareDeviceForBenchmarking(int dev) {
 
   // Temperature before (Fun metric, why not)
   getAndPrintTemperature(dev);
+  // Host buffers go on the NUMA node the device hangs off, and so does this thread, for the rest of the device's tests
+  const int hostNode = HostMemory::deviceNode(prop.pciDomainID, prop.pciBusID, prop.pciDeviceID);
+  HostMemory::ThreadPin threadPin(hostNode);
+  if (hostNode >= 0)
+    std::cout << HIP << "Device is on NUMA node " << hostNode << (threadPin.pinned() ? ", benchmark thread pinned to it\n" : "\n");
   // All is well. Let's go!
-  hipModule_t module = nullptr;
-  HIP_ERR(hipModuleLoadData(&module, (void*)hip_kernels_hsaco));
+  Trace::Span setupSpan("Module load", "init");
+  DeviceGuard device;
+  HIP_ERR(hipModuleLoadData(&device.module, (void*)hip_kernels_hsaco));
+  hipModule_t module = device.module;
+  setupSpan.end();
+  // Streams and events are shared by every test on this device
+  createExecutionContext(4, 8);
   // Get the kernel functions
   hipFunction_t linearSetKernel;
   hipFunction_t linearMultiplyKernel;
@@ -168,67 +265,258 @@ void HIPBackend::prepareDeviceForBenchmarking(int dev) {
   HIP_ERR(hipModuleGetFunction(&linearMultiplyKernel, module, "linearMultiplyKernel"));
   unsigned int threadsPerBlock = std::clamp(prop.maxThreadsPerBlock, 128, 1024);
   std::cout << HIP << "Running simple tests...\n";
-  float linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel);
-  float linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel);
+  float linearSetTime = 0.0f, linearMultiplyTime = 0.0f;
+  if (Suite::shouldRun("linear_set"))
+    linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel, hostNode);
+  if (Suite::shouldRun("linear_multiply"))
+    linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel, hostNode);
 
   // Check to see if those first two rather simple tests took a while.
   // If the GPU is running these tests slowly,
   // prompt the user if they would really like to continune with the more intensive tests.
   // ! FOR REFERENCE: my 9070 XT completes both tests in 6 ms. So if it seriously takes this long, something is up.
   if (slowBenchmarks(linearSetTime, linearMultiplyTime)) {
-    HIP_ERR(hipModuleUnload(module));
+    destroyExecutionContext();
+    HIP_ERR(hipModuleUnload(std::exchange(device.module, nullptr)));
+    device.reset = false;
     HIP_ERR(hipDeviceReset());
     return;
   }
   std::cout << HIP << "All set. Starting full test suite...\n";
-  hipFunction_t fmaKernel, intThroughputKernel, sharedMemoryKernel, sgemmKernel;
+  hipFunction_t fmaKernel, intThroughputKernel, sharedMemoryKernel, sgemmKernel, sgemmTiledKernel, sgemmRegisterKernel;
   HIP_ERR(hipModuleGetFunction(&fmaKernel, module, "fmaKernel"));
   HIP_ERR(hipModuleGetFunction(&intThroughputKernel, module, "integerThroughputKernel"));
   HIP_ERR(hipModuleGetFunction(&sharedMemoryKernel, module, "sharedMemoryKernel"));
   HIP_ERR(hipModuleGetFunction(&sgemmKernel, module, "sgemmKernel"));
-  runFmaBenchmark(threadsPerBlock, fmaKernel);
-  runIntegerThroughputBenchmark(threadsPerBlock, intThroughputKernel);
-  runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel);
-  runSgemmBenchmark(threadsPerBlock, sgemmKernel);
-  runPCIEThroughputBenchmark();
+  HIP_ERR(hipModuleGetFunction(&sgemmTiledKernel, module, "sgemmTiledKernel"));
+  HIP_ERR(hipModuleGetFunction(&sgemmRegisterKernel, module, "sgemmRegisterKernel"));
+  if (Suite::shouldRun("fma"))
+    runFmaBenchmark(threadsPerBlock, fmaKernel);
+  if (Suite::shouldRun("integer"))
+    runIntegerThroughputBenchmark(threadsPerBlock, intThroughputKernel);
+  if (Suite::shouldRun("shared_memory"))
+    runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel, prop.clockRate, prop.multiProcessorCount);
+  if (Suite::shouldRun("sgemm"))
+    runSgemmBenchmark(sgemmKernel, sgemmTiledKernel, sgemmRegisterKernel);
+  if (Suite::shouldRun("pcie"))
+    runPCIEThroughputBenchmark(hostNode);
+  if (Suite::shouldRun("stream_overhead"))
+    runStreamEventOverheadBenchmark();
+  if (Suite::shouldRun("transfer_sweep"))
+    runTransferSweepBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("pcie_bidirectional"))
+    runBidirectionalPCIEBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("copy_compute_overlap"))
+    runCopyComputeOverlapBenchmark(threadsPerBlock, linearMultiplyKernel, prop.totalGlobalMem);
+  if (Suite::shouldRun("pointer_chase")) {
+    hipFunction_t pointerChaseInitKernel, pointerChaseKernel;
+    HIP_ERR(hipModuleGetFunction(&pointerChaseInitKernel, module, "pointerChaseInitKernel"));
+    HIP_ERR(hipModuleGetFunction(&pointerChaseKernel, module, "pointerChaseKernel"));
+    runPointerChaseBenchmark(pointerChaseInitKernel, pointerChaseKernel, prop.totalGlobalMem);
+  }
+  if (Suite::shouldRun("strided_access")) {
+    std::array<hipFunction_t, 3> stridedReadKernels;
+    HIP_ERR(hipModuleGetFunction(&stridedReadKernels[0], module, "stridedReadKernel4"));
+    HIP_ERR(hipModuleGetFunction(&stridedReadKernels[1], module, "stridedReadKernel8"));
+    HIP_ERR(hipModuleGetFunction(&stridedReadKernels[2], module, "stridedReadKernel16"));
+    runStridedAccessBenchmark(threadsPerBlock, stridedReadKernels, prop.totalGlobalMem, prop.warpSize);
+  }
+  if (Suite::shouldRun("stream")) {
+    hipFunction_t streamInitKernel;
+    std::array<hipFunction_t, 12> streamKernels;
+    HIP_ERR(hipModuleGetFunction(&streamInitKernel, module, "streamInitKernel"));
+    for (size_t k = 0; k < streamKernels.size(); ++k) {
+      HIP_ERR(hipModuleGetFunction(&streamKernels[k], module, Sweep::streamKernelName(k).c_str()));
+    }
+    runStreamBenchmark(threadsPerBlock, streamInitKernel, streamKernels, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("zero_copy")) {
+    hipFunction_t scaleKernel;
+    HIP_ERR(hipModuleGetFunction(&scaleKernel, module, "streamScaleKernel16"));
+    runZeroCopyBenchmark(threadsPerBlock, scaleKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("host_registration"))
+    runHostRegistrationBenchmark(prop.totalGlobalMem);
+  if (Suite::shouldRun("managed_memory")) {
+    hipFunction_t incrementKernel;
+    HIP_ERR(hipModuleGetFunction(&incrementKernel, module, "managedIncrementKernel"));
+    runManagedMemoryBenchmark(threadsPerBlock, incrementKernel, dev, prop.totalGlobalMem, prop.multiProcessorCount, prop.concurrentManagedAccess);
+  }
+  if (Suite::shouldRun("allocation"))
+    runAllocationBenchmark(dev, prop.totalGlobalMem);
+  if (Suite::shouldRun("copy_engine")) {
+    hipFunction_t copyKernel, pitchedCopyKernel, volumeCopyKernel;
+    HIP_ERR(hipModuleGetFunction(&copyKernel, module, "streamCopyKernel16"));
+    HIP_ERR(hipModuleGetFunction(&pitchedCopyKernel, module, "pitchedCopyKernel"));
+    HIP_ERR(hipModuleGetFunction(&volumeCopyKernel, module, "volumeCopyKernel"));
+    runCopyEngineBenchmark(threadsPerBlock, copyKernel, pitchedCopyKernel, volumeCopyKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("out_of_core")) {
+    hipFunction_t checksumKernel;
+    HIP_ERR(hipModuleGetFunction(&checksumKernel, module, "chunkChecksumKernel"));
+    runOutOfCoreBenchmark(threadsPerBlock, checksumKernel, prop.totalGlobalMem, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("ingest"))
+    runIngestBenchmark();
+  if (Suite::shouldRun("numa_placement"))
+    runNumaPlacementBenchmark(hostNode);
+  if (Suite::shouldRun("precision")) {
+    std::array<hipFunction_t, 5> multiplyAddKernels, gemmKernels;
+    for (Gemm::Format format : Gemm::formats) {
+      HIP_ERR(hipModuleGetFunction(&multiplyAddKernels[static_cast<size_t>(format)], module, Gemm::multiplyAddKernelName(format).c_str()));
+      HIP_ERR(hipModuleGetFunction(&gemmKernels[static_cast<size_t>(format)], module, Gemm::gemmKernelName(format).c_str()));
+    }
+    runPrecisionBenchmark(threadsPerBlock, multiplyAddKernels, gemmKernels, prop.multiProcessorCount, prop.arch.hasDoubles,
+                          prop.singleToDoublePrecisionPerfRatio);
+  }
+  if (Suite::shouldRun("instruction_mix")) {
+    std::vector<hipFunction_t> latencyKernels, throughputKernels;
+    for (const Microbench::Instruction& instruction : Microbench::instructions()) {
+      hipFunction_t latency, throughput;
+      HIP_ERR(hipModuleGetFunction(&latency, module, ("latency" + std::string(instruction.kernel) + "Kernel").c_str()));
+      HIP_ERR(hipModuleGetFunction(&throughput, module, ("throughput" + std::string(instruction.kernel) + "Kernel").c_str()));
+      latencyKernels.push_back(latency);
+      throughputKernels.push_back(throughput);
+    }
+    runInstructionMixBenchmark(threadsPerBlock, latencyKernels, throughputKernels, prop.clockRate, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("occupancy")) {
+    std::vector<hipFunction_t> occupancyKernels;
+    for (const Microbench::OccupancyKernel& kernel : Microbench::occupancyKernels()) {
+      hipFunction_t function;
+      HIP_ERR(hipModuleGetFunction(&function, module, kernel.kernel));
+      occupancyKernels.push_back(function);
+    }
+    runOccupancyBenchmark(occupancyKernels, prop.totalGlobalMem, prop.sharedMemPerBlock, prop.maxThreadsPerMultiProcessor, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("divergence")) {
+    hipFunction_t divergenceKernel;
+    HIP_ERR(hipModuleGetFunction(&divergenceKernel, module, "divergenceKernel"));
+    runDivergenceBenchmark(threadsPerBlock, divergenceKernel, prop.warpSize, prop.multiProcessorCount);
+  }
+  if (Suite::shouldRun("atomics")) {
+    std::vector<hipFunction_t> globalKernels, sharedKernels;
+    for (const Microbench::AtomicOperation& operation : Microbench::atomicOperations()) {
+      hipFunction_t globalKernel, sharedKernel;
+      HIP_ERR(hipModuleGetFunction(&globalKernel, module, ("atomicGlobal" + std::string(operation.kernel) + "Kernel").c_str()));
+      HIP_ERR(hipModuleGetFunction(&sharedKernel, module, ("atomicShared" + std::string(operation.kernel) + "Kernel").c_str()));
+      globalKernels.push_back(globalKernel);
+      sharedKernels.push_back(sharedKernel);
+    }
+    runAtomicsBenchmark(threadsPerBlock, globalKernels, sharedKernels, prop.multiProcessorCount);
+  }
 
-  HIP_ERR(hipModuleUnload(module));
+  destroyExecutionContext();
+  HIP_ERR(hipModuleUnload(std::exchange(device.module, nullptr)));
+  device.reset = false;
   HIP_ERR(hipDeviceReset());
 }
 
-void HIPBackend::runBenchmark() {
-  hipInit(0);
-  rsmi_init(0);
+std::vector<GPUMark::Device> HIPBackend::enumerateDevices() {
+  std::vector<GPUMark::Device> devices;
+  if (!hipMalloc)
+    return devices;
 
   int deviceCount = 0;
   HIP_ERR(hipGetDeviceCount(&deviceCount));
   for (int dev = 0; dev < deviceCount; ++dev) {
-    prepareDeviceForBenchmarking(dev);
+    hipDeviceProp_t prop;
+    HIP_ERR(hipGetDeviceProperties(&prop, dev));
+    devices.push_back({GPUMark::Backend::HIP, dev, prop.name, prop.totalGlobalMem});
+  }
+  return devices;
+}
+
+void HIPBackend::createExecutionContext(unsigned int streamCount, unsigned int eventCount) {
+  // Handles left from an earlier device belong to it, never to this one
+  execContext = ExecutionContext{};
+  for (unsigned int i = 0; i < streamCount; ++i) {
+    hipStream_t stream;
+    HIP_ERR(hipStreamCreate(&stream));
+    execContext.streams.push_back(stream);
+    execContext.freeStreams.push_back(stream);
+  }
+  for (unsigned int i = 0; i < eventCount; ++i) {
+    hipEvent_t event;
+    HIP_ERR(hipEventCreate(&event));
+    execContext.events.push_back(event);
+    execContext.freeEvents.push_back(event);
+  }
+}
+
+void HIPBackend::destroyExecutionContext() {
+  // Emptied first, so an error part way through never leaves destroyed handles in the pool
+  ExecutionContext pool = std::exchange(execContext, ExecutionContext{});
+  for (hipEvent_t event : pool.events) {
+    HIP_ERR(hipEventDestroy(event));
+  }
+  for (hipStream_t stream : pool.streams) {
+    HIP_ERR(hipStreamDestroy(stream));
   }
 }
 
+// The pools only grow when a test holds more objects at once than were created up front.
+HIPBackend::hipStream_t HIPBackend::acquireStream() {
+  if (execContext.freeStreams.empty()) {
+    hipStream_t stream;
+    HIP_ERR(hipStreamCreate(&stream));
+    execContext.streams.push_back(stream);
+    return stream;
+  }
+  hipStream_t stream = execContext.freeStreams.back();
+  execContext.freeStreams.pop_back();
+  return stream;
+}
+
+void HIPBackend::releaseStream(hipStream_t stream) { execContext.freeStreams.push_back(stream); }
+
+HIPBackend::hipEvent_t HIPBackend::acquireEvent() {
+  if (execContext.freeEvents.empty()) {
+    hipEvent_t event;
+    HIP_ERR(hipEventCreate(&event));
+    execContext.events.push_back(event);
+    return event;
+  }
+  hipEvent_t event = execContext.freeEvents.back();
+  execContext.freeEvents.pop_back();
+  return event;
+}
+
+void HIPBackend::releaseEvent(hipEvent_t event) { execContext.freeEvents.push_back(event); }
+
+// Trace track name for a pooled stream, e.g. "HIP stream 0"
+static std::string streamTrack(HIPBackend::hipStream_t stream) {
+  const auto& streams = HIPBackend::execContext.streams;
+  return "HIP stream " + std::to_string(std::find(streams.begin(), streams.end(), stream) - streams.begin());
+}
+
 #define HIP_BENCHMARK_KERNEL(kernelFunc, blocks, threadsPerBlock, args, milliseconds)                                                                \
-  hipStream_t stream;                                                                                                                                \
-  HIP_ERR(hipStreamCreate(&stream));                                                                                                                 \
-  hipEvent_t startEvent, stopEvent;                                                                                                                  \
-  HIP_ERR(hipEventCreate(&startEvent));                                                                                                              \
-  HIP_ERR(hipEventCreate(&stopEvent));                                                                                                               \
+  hipStream_t stream = acquireStream();                                                                                                              \
+  hipEvent_t startEvent = acquireEvent();                                                                                                            \
+  hipEvent_t stopEvent = acquireEvent();                                                                                                             \
+  Trace::Span kernelSpan("Kernel launch + sync", "kernel");                                                                                          \
   HIP_ERR(hipEventRecord(startEvent, stream));                                                                                                       \
   HIP_ERR(hipModuleLaunchKernel(kernelFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));                                         \
   HIP_ERR(hipEventRecord(stopEvent, stream));                                                                                                        \
   HIP_ERR(hipEventSynchronize(stopEvent));                                                                                                           \
   HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));                                                                                \
-  HIP_ERR(hipEventDestroy(startEvent));                                                                                                              \
-  HIP_ERR(hipEventDestroy(stopEvent));                                                                                                               \
-  HIP_ERR(hipStreamDestroy(stream));
+  kernelSpan.end();                                                                                                                                  \
+  if (Trace::enabled())                                                                                                                              \
+    Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);                                            \
+  releaseEvent(startEvent);                                                                                                                          \
+  releaseEvent(stopEvent);                                                                                                                           \
+  releaseStream(stream);
 
-float HIPBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t linearSetFunc) {
+float HIPBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t linearSetFunc, int hostNode) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
+  TRACE_SCOPE("1) Linear Set", "test");
   std::cout << HIP << "1) Linear Set (~" << N / 1000000 << "M elements)..." << std::flush;
 
-  float* h_data = new float[N];
+  Trace::Span allocSpan("Allocate", "alloc");
+  float* h_data = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
   hipDeviceptr_t d_data = 0;
   HIP_ERR(hipMalloc(&d_data, N * sizeof(float)));
+  allocSpan.end();
 
   int blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_data};
@@ -236,8 +524,11 @@ float HIPBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, HIPBackend
   std::cout << "\r" << HIP << "1) Linear Set (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   HIP_BENCHMARK_KERNEL(linearSetFunc, blocks, threadsPerBlock, args, milliseconds);
   std::cout << "\r" << HIP << "1) Linear Set (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   HIP_ERR(hipMemcpy(h_data, d_data, N * sizeof(float), hipMemcpyDeviceToHost));
+  downloadSpan.end();
 
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     if (h_data[i] != static_cast<float>(i)) {
@@ -246,6 +537,7 @@ float HIPBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, HIPBackend
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << HIP << "1) Linear Set (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -254,37 +546,48 @@ float HIPBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, HIPBackend
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
 
+  Suite::record("linear_set", milliseconds, valid);
   HIP_ERR(hipFree(d_data));
-  delete[] h_data;
+  HostMemory::release(h_data, N * sizeof(float));
   return valid ? milliseconds : 0.0f;
 }
 
-float HIPBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t linearMultiplyFunc) {
+float HIPBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t linearMultiplyFunc, int hostNode) {
   constexpr const unsigned long long N = (1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats (since two inputs)
+  TRACE_SCOPE("2) Linear Multiply", "test");
   std::cout << HIP << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Preparing..." << std::flush;
-  float* h_in1 = new float[N];
-  float* h_in2 = new float[N];
-  float* h_out = new float[N];
+  Trace::Span hostInitSpan("Host data init", "init");
+  float* h_in1 = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
+  float* h_in2 = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
+  float* h_out = static_cast<float*>(HostMemory::allocate(N * sizeof(float), hostNode));
   for (unsigned long long i = 0ull; i < N; ++i) {
     h_in1[i] = static_cast<float>(i);
     h_in2[i] = static_cast<float>(i) / 2;
   }
+  hostInitSpan.end();
+  Trace::Span allocSpan("Allocate", "alloc");
   hipDeviceptr_t d_in1 = 0, d_in2 = 0, d_out = 0;
   HIP_ERR(hipMalloc(&d_in1, N * sizeof(float)));
   HIP_ERR(hipMalloc(&d_in2, N * sizeof(float)));
   HIP_ERR(hipMalloc(&d_out, N * sizeof(float)));
+  allocSpan.end();
 
+  Trace::Span uploadSpan("Upload inputs", "transfer");
   HIP_ERR(hipMemcpy(d_in1, h_in1, N * sizeof(float), hipMemcpyHostToDevice));
   HIP_ERR(hipMemcpy(d_in2, h_in2, N * sizeof(float), hipMemcpyHostToDevice));
   HIP_ERR(hipMemset(d_out, 0, N * sizeof(float)));
+  uploadSpan.end();
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_in1, &d_in2, &d_out};
   float milliseconds = 0;
   std::cout << "\r" << HIP << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   HIP_BENCHMARK_KERNEL(linearMultiplyFunc, blocks, threadsPerBlock, args, milliseconds);
   std::cout << "\r" << HIP << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   HIP_ERR(hipMemcpy(h_out, d_out, N * sizeof(float), hipMemcpyDeviceToHost));
+  downloadSpan.end();
 
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     float expected = static_cast<float>(i) * static_cast<float>(i) / 2;
@@ -295,6 +598,7 @@ float HIPBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, HIPBa
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << HIP << "2) Linear Multiply (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -302,23 +606,27 @@ float HIPBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, HIPBa
     std::cout << RED << " FAILED" << RESET;
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("linear_multiply", milliseconds, valid);
   HIP_ERR(hipFree(d_in1));
   HIP_ERR(hipFree(d_in2));
   HIP_ERR(hipFree(d_out));
-  delete[] h_in1;
-  delete[] h_in2;
-  delete[] h_out;
+  HostMemory::release(h_in1, N * sizeof(float));
+  HostMemory::release(h_in2, N * sizeof(float));
+  HostMemory::release(h_out, N * sizeof(float));
   return valid ? milliseconds : 0.0f;
 }
 
 float HIPBackend::runFmaBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t fmaFunc) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
   constexpr const unsigned int totalIterations = 3000;
+  TRACE_SCOPE("3) FMA", "test");
   std::cout << HIP << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Preparing..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
   float* h_out = new float[N];
   hipDeviceptr_t d_out = 0;
   HIP_ERR(hipMalloc(&d_out, N * sizeof(float)));
   HIP_ERR(hipMemset(d_out, 0, N * sizeof(float)));
+  allocSpan.end();
 
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_out, (void*)&totalIterations};
@@ -329,6 +637,7 @@ float HIPBackend::runFmaBenchmark(unsigned int threadsPerBlock, HIPBackend::hipF
   std::cout << "\r" << HIP << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
   std::cout << GREEN << " PASSED" << RESET;
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("fma", milliseconds);
   HIP_ERR(hipFree(d_out));
   delete[] h_out;
   return milliseconds;
@@ -337,11 +646,14 @@ float HIPBackend::runFmaBenchmark(unsigned int threadsPerBlock, HIPBackend::hipF
 float HIPBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t intThroughputFunc) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(unsigned int); // 2GB worth of uints
   constexpr const unsigned int totalIterations = 5000;
+  TRACE_SCOPE("4) Integer Throughput", "test");
   std::cout << HIP << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << std::flush;
   // No host side preparation needed.
+  Trace::Span allocSpan("Allocate", "alloc");
   hipDeviceptr_t d_out = 0;
   HIP_ERR(hipMalloc(&d_out, N * sizeof(unsigned int)));
   HIP_ERR(hipMemset(d_out, 0, N * sizeof(unsigned int)));
+  allocSpan.end();
   unsigned long long blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
   void* args[] = {&d_out, (void*)&totalIterations};
   float milliseconds = 0;
@@ -353,128 +665,209 @@ float HIPBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, HI
   std::cout << "\r" << HIP << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << GREEN
             << " PASSED" << RESET;
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("integer", milliseconds);
   HIP_ERR(hipFree(d_out));
   return milliseconds;
 }
 
-float HIPBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t sharedMemoryFunc) {
-  constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
-  constexpr const unsigned int totalIterations = 2000;
-  std::cout << HIP << "5) Shared Memory Benchmark (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)..." << std::flush;
-
-  float* h_data = new float[N];
-  hipDeviceptr_t d_data = 0;
-  HIP_ERR(hipMalloc(&d_data, N * sizeof(float)));
+// Shared memory reads and writes between threads at every stride of Microbench::sharedMemoryStrides(), from
+// conflict-free to every lane of a group of 32 in the same bank. All strides run the iterations that take stride 1 20 ms.
+float HIPBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t sharedMemoryFunc, int clockKilohertz,
+                                            int multiProcessorCount) {
+  const std::vector<unsigned int>& strides = Microbench::sharedMemoryStrides();
+  TRACE_SCOPE("5) Shared Memory Bandwidth", "test");
+  std::cout << HIP << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_out = 0;
+  HIP_ERR(hipMalloc(&d_out, threads * sizeof(float)));
+  allocSpan.end();
 
-  int blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
-  void* args[] = {&d_data, (void*)&totalIterations};
-  float milliseconds = 0;
-  std::cout << "\r" << HIP << "5) Shared Memory Benchmark (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Running..."
-            << std::flush;
-  HIP_BENCHMARK_KERNEL(sharedMemoryFunc, blocks, threadsPerBlock, args, milliseconds);
-  std::cout << "\r" << HIP << "5) Shared Memory Benchmark (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Verifying..."
-            << std::flush;
-  HIP_ERR(hipMemcpy(h_data, d_data, N * sizeof(float), hipMemcpyDeviceToHost));
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  auto timed = [&](unsigned int stride, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &stride, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(sharedMemoryFunc, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream,
+                                  args, nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
 
-  std::cout << "\r" << HIP << "5) Shared Memory Benchmark (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
-  std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  unsigned int iterations = 256;
+  while (timed(1, iterations) < 20.0 && iterations < (1u << 24)) {
+    iterations *= 2;
+  }
+  std::vector<Microbench::SharedAccess> accesses;
+  for (unsigned int stride : strides) {
+    std::cout << "\r" << HIP << "5) Shared Memory Bandwidth (stride " << stride << ")...   " << std::flush;
+    double bytes = static_cast<double>(threads) * iterations * Microbench::sharedMemoryBytesPerIteration;
+    accesses.push_back({stride, bytes, timed(stride, iterations)});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_out));
 
-  HIP_ERR(hipFree(d_data));
-  delete[] h_data;
+  std::cout << "\r" << HIP << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportSharedMemory(HIP, "shared_memory", accesses, clockKilohertz * 1e3, static_cast<unsigned int>(multiProcessorCount));
+  float milliseconds = static_cast<float>(Microbench::conflictFreeMilliseconds(accesses));
+  Suite::record("shared_memory", milliseconds);
   return milliseconds;
 }
 
-float HIPBackend::runSgemmBenchmark(unsigned int threadsPerBlock, hipFunction_t sgemmFunc) {
-  constexpr const unsigned long long N = 1024; // 1024*1024 matrices
-  constexpr const unsigned int totalIterations = 5000;
-  std::cout << HIP << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations << " iterations)..." << std::flush;
-  float* h_A = new float[N * N];
-  float* h_B = new float[N * N];
-  float* h_C = new float[N * N];
-  for (unsigned long long i = 0; i < N * N; ++i) {
-    h_A[i] = static_cast<float>(i % 100) / 100.0f;
-    h_B[i] = static_cast<float>((i + 50) % 100) / 100.0f;
-    h_C[i] = 0.0f;
-  }
-  hipDeviceptr_t d_A = 0, d_B = 0, d_C = 0;
-  HIP_ERR(hipMalloc(&d_A, N * N * sizeof(float)));
-  HIP_ERR(hipMalloc(&d_B, N * N * sizeof(float)));
-  HIP_ERR(hipMalloc(&d_C, N * N * sizeof(float)));
-  HIP_ERR(hipMemcpy(d_A, h_A, N * N * sizeof(float), hipMemcpyHostToDevice));
-  HIP_ERR(hipMemcpy(d_B, h_B, N * N * sizeof(float), hipMemcpyHostToDevice));
-  HIP_ERR(hipMemset(d_C, 0, N * N * sizeof(float)));
-  unsigned int blocks = (N + threadsPerBlock - 1) / threadsPerBlock;
-  void* args[] = {&d_A, &d_B, &d_C, (void*)&N, (void*)&totalIterations};
-  float milliseconds = 0;
-  std::cout << "\r" << HIP << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations << " iterations)... Running..."
+// C = A * B with three kernels over a sweep of sizes: one thread per element straight from global memory, 16x16
+// tiles in shared memory, and 64x64 tiles with a 4x4 patch of C per thread in registers. Each kernel's result is checked
+// against the CPU on sampled elements at every size.
+float HIPBackend::runSgemmBenchmark(hipFunction_t naiveFunc, hipFunction_t tiledFunc, hipFunction_t registerFunc) {
+  const std::vector<unsigned int>& sizes = Gemm::sizes();
+  const size_t maxBytes = static_cast<size_t>(sizes.back()) * sizes.back() * sizeof(float);
+  TRACE_SCOPE("6) SGEMM", "test");
+  std::cout << HIP << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)..."
             << std::flush;
-  HIP_BENCHMARK_KERNEL(sgemmFunc, blocks, threadsPerBlock, args, milliseconds);
-  std::cout << "\r" << HIP << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations << " iterations)...";
-  std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_A = 0, d_B = 0, d_C = 0;
+  HIP_ERR(hipMalloc(&d_A, maxBytes));
+  HIP_ERR(hipMalloc(&d_B, maxBytes));
+  HIP_ERR(hipMalloc(&d_C, maxBytes));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  // One 2D launch of 16x16 blocks covering C, timed with events
+  auto launch = [&](hipFunction_t function, unsigned int tile, unsigned int n) {
+    void* args[] = {&d_A, &d_B, &d_C, &n};
+    unsigned int blocks = (n + tile - 1) / tile;
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(function, blocks, blocks, 1, 16, 16, 1, 0, stream, args, nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
 
+  struct Variant {
+    hipFunction_t function;
+    unsigned int tile; // Edge of the tile of C one block computes
+  };
+  const Variant variants[] = {{naiveFunc, 16}, {tiledFunc, 16}, {registerFunc, 64}};
+  std::vector<Gemm::Curve> curves = {{"Naive", "naive", {}}, {"Tiled 16x16", "tiled", {}}, {"Register 4x4", "register", {}}};
+  for (unsigned int n : sizes) {
+    TRACE_SCOPE("SGEMM size", "kernel");
+    const size_t bytes = static_cast<size_t>(n) * n * sizeof(float);
+    std::vector<float> h_A = Gemm::randomMatrix(n, 1), h_B = Gemm::randomMatrix(n, 2), h_C(static_cast<size_t>(n) * n);
+    HIP_ERR(hipMemcpy(d_A, h_A.data(), bytes, hipMemcpyHostToDevice));
+    HIP_ERR(hipMemcpy(d_B, h_B.data(), bytes, hipMemcpyHostToDevice));
+    for (size_t v = 0; v < std::size(variants); ++v) {
+      Gemm::Curve& curve = curves[v];
+      // Once a variant went over the budget (or was skipped), larger sizes are skipped too
+      if (!curve.milliseconds.empty() && (curve.milliseconds.back() == 0.0 || curve.milliseconds.back() > Gemm::timeBudgetMilliseconds)) {
+        curve.milliseconds.push_back(0.0);
+        continue;
+      }
+      std::cout << "\r" << HIP << "6) SGEMM (" << n << "x" << n << ", " << curve.name << ")..." << std::flush;
+      HIP_ERR(hipMemset(d_C, 0, bytes));
+      double best = launch(variants[v].function, variants[v].tile, n);
+      HIP_ERR(hipMemcpy(h_C.data(), d_C, bytes, hipMemcpyDeviceToHost));
+      curve.valid = curve.valid && Gemm::verifySamples(h_A, h_B, h_C, n);
+      for (int run = 0; run < 2 && best < Gemm::timeBudgetMilliseconds; ++run) {
+        best = std::min(best, launch(variants[v].function, variants[v].tile, n));
+      }
+      curve.milliseconds.push_back(best);
+    }
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
   HIP_ERR(hipFree(d_A));
   HIP_ERR(hipFree(d_B));
   HIP_ERR(hipFree(d_C));
-  delete[] h_A;
-  delete[] h_B;
-  delete[] h_C;
+
+  bool valid = std::all_of(curves.begin(), curves.end(), [](const Gemm::Curve& curve) { return curve.valid; });
+  std::cout << "\r" << HIP << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  for (const Gemm::Curve& curve : curves) {
+    if (!curve.valid)
+      std::cout << HIP << curve.name << " does not match the CPU result\n";
+  }
+  Gemm::report(HIP, "sgemm", sizes, curves);
+  // The register-blocked kernel at 1024 (or the largest size it reached), as close as the sweep gets to the single
+  // 1024x1024 run this test used to time
+  float milliseconds = static_cast<float>(Gemm::millisecondsAt(sizes, curves.back(), 1024));
+  Suite::record("sgemm", milliseconds, valid);
   return milliseconds;
 }
 
-float HIPBackend::runPCIEThroughputBenchmark() {
+float HIPBackend::runPCIEThroughputBenchmark(int hostNode) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024); // 2GB
   constexpr int iterations = 5;
+  TRACE_SCOPE("7) PCIe Throughput", "test");
   std::cout << HIP << "7) PCIe Throughput (2 GB transfer, avg of " << iterations << " runs)..." << std::flush;
-  char* h_data = nullptr;
-  HIP_ERR(hipHostMalloc((void**)&h_data, N * sizeof(char), 0));
+  Trace::Span allocSpan("Allocate", "alloc");
+  // Huge pages on the device's node, then pinned, rather than whatever hipHostMalloc's first touch lands on
+  char* h_data = static_cast<char*>(HostMemory::allocate(N * sizeof(char), hostNode));
+  HIP_ERR(hipHostRegister(h_data, N * sizeof(char), 0));
   for (unsigned long long i = 0ull; i < N; ++i) {
     h_data[i] = static_cast<char>(i % 256);
   }
   hipDeviceptr_t d_data = 0;
   HIP_ERR(hipMalloc(&d_data, N * sizeof(char)));
+  allocSpan.end();
 
   float totalMillisecondsHtoD = 0;
   float totalMillisecondsDtoH = 0;
 
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
   for (int i = 0; i < iterations; ++i) {
     // Host to Device
     float millisecondsHtoD = 0;
-    {
-      hipStream_t stream;
-      HIP_ERR(hipStreamCreate(&stream));
-      hipEvent_t startEvent, stopEvent;
-      HIP_ERR(hipEventCreate(&startEvent));
-      HIP_ERR(hipEventCreate(&stopEvent));
-      HIP_ERR(hipEventRecord(startEvent, stream));
-      HIP_ERR(hipMemcpy(d_data, h_data, N * sizeof(char), hipMemcpyHostToDevice));
-      HIP_ERR(hipEventRecord(stopEvent, stream));
-      HIP_ERR(hipEventSynchronize(stopEvent));
-      HIP_ERR(hipEventElapsedTime(&millisecondsHtoD, startEvent, stopEvent));
-      HIP_ERR(hipEventDestroy(startEvent));
-      HIP_ERR(hipEventDestroy(stopEvent));
-      HIP_ERR(hipStreamDestroy(stream));
-    }
+    Trace::Span htodSpan("Host to Device", "transfer");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipMemcpy(d_data, h_data, N * sizeof(char), hipMemcpyHostToDevice));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&millisecondsHtoD, startEvent, stopEvent));
+    htodSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Host to Device", "transfer", htodSpan.started(), millisecondsHtoD);
     totalMillisecondsHtoD += millisecondsHtoD;
 
     // Device to Host
     float millisecondsDtoH = 0;
-    {
-      hipStream_t stream;
-      HIP_ERR(hipStreamCreate(&stream));
-      hipEvent_t startEvent, stopEvent;
-      HIP_ERR(hipEventCreate(&startEvent));
-      HIP_ERR(hipEventCreate(&stopEvent));
-      HIP_ERR(hipEventRecord(startEvent, stream));
-      HIP_ERR(hipMemcpy(h_data, d_data, N * sizeof(char), hipMemcpyDeviceToHost));
-      HIP_ERR(hipEventRecord(stopEvent, stream));
-      HIP_ERR(hipEventSynchronize(stopEvent));
-      HIP_ERR(hipEventElapsedTime(&millisecondsDtoH, startEvent, stopEvent));
-      HIP_ERR(hipEventDestroy(startEvent));
-      HIP_ERR(hipEventDestroy(stopEvent));
-      HIP_ERR(hipStreamDestroy(stream));
-    }
+    Trace::Span dtohSpan("Device to Host", "transfer");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipMemcpy(h_data, d_data, N * sizeof(char), hipMemcpyDeviceToHost));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&millisecondsDtoH, startEvent, stopEvent));
+    dtohSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Device to Host", "transfer", dtohSpan.started(), millisecondsDtoH);
     totalMillisecondsDtoH += millisecondsDtoH;
   }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
 
   float avgMillisecondsHtoD = totalMillisecondsHtoD / iterations;
   float avgMillisecondsDtoH = totalMillisecondsDtoH / iterations;
@@ -482,12 +875,1814 @@ float HIPBackend::runPCIEThroughputBenchmark() {
   std::cout << "\r" << HIP << "7) PCIe Throughput (2 GB transfer, avg of " << iterations
             << " runs)... Host to Device: " << (N / (avgMillisecondsHtoD / 1000.0f) / (1024 * 1024))
             << " MB/s, Device to Host: " << (N / (avgMillisecondsDtoH / 1000.0f) / (1024 * 1024)) << " MB/s\n";
+  Suite::record("pcie", (avgMillisecondsHtoD + avgMillisecondsDtoH) / 2.0f);
+  Suite::metric("pcie", "htod_mb_per_s", N / (avgMillisecondsHtoD / 1000.0) / (1024 * 1024));
+  Suite::metric("pcie", "dtoh_mb_per_s", N / (avgMillisecondsDtoH / 1000.0) / (1024 * 1024));
 
   HIP_ERR(hipFree(d_data));
-  HIP_ERR(hipHostFree(h_data));
+  HIP_ERR(hipHostUnregister(h_data));
+  HostMemory::release(h_data, N * sizeof(char));
   return (avgMillisecondsHtoD + avgMillisecondsDtoH) / 2.0f;
 }
 
+// Measures what the pools save: the cost of creating and destroying the stream and two events that
+// every timed region used to set up, against taking the same objects from the execution context.
+float HIPBackend::runStreamEventOverheadBenchmark() {
+  constexpr int cycles = 1000;
+  TRACE_SCOPE("8) Stream/Event Overhead", "test");
+  std::cout << HIP << "8) Stream/Event Overhead (" << cycles << " cycles)..." << std::flush;
+  using clock = std::chrono::steady_clock;
+
+  auto start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    hipStream_t stream;
+    HIP_ERR(hipStreamCreate(&stream));
+    HIP_ERR(hipStreamDestroy(stream));
+  }
+  double streamMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    hipEvent_t event;
+    HIP_ERR(hipEventCreate(&event));
+    HIP_ERR(hipEventDestroy(event));
+  }
+  double eventMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  start = clock::now();
+  for (int i = 0; i < cycles; ++i) {
+    hipStream_t stream = acquireStream();
+    hipEvent_t startEvent = acquireEvent();
+    hipEvent_t stopEvent = acquireEvent();
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    releaseStream(stream);
+  }
+  double pooledMicroseconds = std::chrono::duration<double, std::micro>(clock::now() - start).count() / cycles;
+
+  // One timed region needs a stream and two events
+  double unpooledMicroseconds = streamMicroseconds + 2 * eventMicroseconds;
+  std::cout << "\r" << HIP << "8) Stream/Event Overhead (" << cycles << " cycles)... Stream create/destroy: " << std::fixed << std::setprecision(2)
+            << streamMicroseconds << " us, Event create/destroy: " << eventMicroseconds << " us, Per timed region: " << unpooledMicroseconds
+            << " us unpooled vs " << pooledMicroseconds << " us pooled\n";
+  Suite::record("stream_overhead", static_cast<float>(unpooledMicroseconds / 1000.0));
+  Suite::metric("stream_overhead", "stream_create_destroy_us", streamMicroseconds);
+  Suite::metric("stream_overhead", "event_create_destroy_us", eventMicroseconds);
+  Suite::metric("stream_overhead", "pooled_acquire_release_us", pooledMicroseconds);
+  return static_cast<float>(unpooledMicroseconds / 1000.0);
+}
+
+// Real workloads move many small buffers, often from pageable memory, so a single large pinned copy
+// overstates what they get. Copies are synchronous and timed on the host: for pageable memory the runtime
+// stages through its own pinned buffer, and that cost is part of what is being measured.
+float HIPBackend::runTransferSweepBenchmark(size_t totalMemory) {
+  constexpr size_t minBytes = 4ull * 1024;                               // 4 KB
+  const size_t maxBytes = std::min<size_t>(1ull << 30, totalMemory / 4); // 1 GB, or a quarter of VRAM on small devices
+  TRACE_SCOPE("9) Transfer Size Sweep", "test");
+  std::cout << HIP << "9) Transfer Size Sweep (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", pinned vs pageable)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char* h_pinned = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_pinned, maxBytes, 0));
+  char* h_pageable = new char[maxBytes];
+  // Fault every page in up front, so first-touch cost is not charged to the first copy
+  std::memset(h_pinned, 1, maxBytes);
+  std::memset(h_pageable, 1, maxBytes);
+  char* d_data = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_data, maxBytes));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  auto timeCopies = [&](char* host, bool toDevice, size_t bytes) {
+    int reps = Sweep::repetitions(bytes, 256ull * 1024 * 1024, 3, 1000);
+    // Warm up so lazy runtime setup for this buffer is not timed
+    if (toDevice)
+      HIP_ERR(hipMemcpy(d_data, host, bytes, hipMemcpyHostToDevice));
+    else
+      HIP_ERR(hipMemcpy(host, d_data, bytes, hipMemcpyDeviceToHost));
+    HIP_ERR(hipDeviceSynchronize());
+    auto start = clock::now();
+    for (int i = 0; i < reps; ++i) {
+      if (toDevice)
+        HIP_ERR(hipMemcpy(d_data, host, bytes, hipMemcpyHostToDevice));
+      else
+        HIP_ERR(hipMemcpy(host, d_data, bytes, hipMemcpyDeviceToHost));
+    }
+    // A pageable hipMemcpy can return once the data is staged, before the DMA to the device has finished
+    HIP_ERR(hipDeviceSynchronize());
+    double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+    return Sweep::Point{static_cast<double>(bytes), milliseconds};
+  };
+
+  std::vector<Sweep::Point> pinnedHtoD, pinnedDtoH, pageableHtoD, pageableDtoH;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Transfer size step", "transfer");
+    pinnedHtoD.push_back(timeCopies(h_pinned, true, bytes));
+    pinnedDtoH.push_back(timeCopies(h_pinned, false, bytes));
+    pageableHtoD.push_back(timeCopies(h_pageable, true, bytes));
+    pageableDtoH.push_back(timeCopies(h_pageable, false, bytes));
+  }
+
+  std::cout << "\r" << HIP << "9) Transfer Size Sweep (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", pinned vs pageable)... Done\n";
+  Sweep::printTable(HIP, {"Pinned HtoD", "Pinned DtoH", "Pageable HtoD", "Pageable DtoH"},
+                    {pinnedHtoD, pinnedDtoH, pageableHtoD, pageableDtoH});
+  float milliseconds = static_cast<float>(pinnedHtoD.back().milliseconds);
+  Suite::record("transfer_sweep", milliseconds);
+  Sweep::record("transfer_sweep", "pinned_htod", pinnedHtoD);
+  Sweep::record("transfer_sweep", "pinned_dtoh", pinnedDtoH);
+  Sweep::record("transfer_sweep", "pageable_htod", pageableHtoD);
+  Sweep::record("transfer_sweep", "pageable_dtoh", pageableDtoH);
+
+  HIP_ERR(hipFree(d_data));
+  HIP_ERR(hipHostFree(h_pinned));
+  delete[] h_pageable;
+  return milliseconds;
+}
+
+// Test 7 copies one direction at a time. This issues both directions at once on separate streams to find out
+// whether the device's DMA engines can keep both directions busy, or whether they share one engine or the link.
+float HIPBackend::runBidirectionalPCIEBenchmark(size_t totalMemory) {
+  const size_t N = std::min<size_t>(256ull * 1024 * 1024, totalMemory / 8); // Per direction
+  constexpr int iterations = 5;
+  TRACE_SCOPE("10) Bidirectional PCIe", "test");
+  std::cout << HIP << "10) Bidirectional PCIe (" << Sweep::formatBytes(N) << " each way, avg of " << iterations << " runs)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char* h_up = nullptr;
+  char* h_down = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_up, N, 0));
+  HIP_ERR(hipHostMalloc((void**)&h_down, N, 0));
+  std::memset(h_up, 1, N);
+  std::memset(h_down, 0, N);
+  char* d_up = nullptr;
+  char* d_down = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_up, N));
+  HIP_ERR(hipMalloc((void**)&d_down, N));
+  allocSpan.end();
+
+  hipStream_t upStream = acquireStream();
+  hipStream_t downStream = acquireStream();
+  hipEvent_t upStart = acquireEvent(), upStop = acquireEvent();
+  hipEvent_t downStart = acquireEvent(), downStop = acquireEvent();
+
+  struct Timing {
+    float up = 0.0f;    // Host to Device
+    float down = 0.0f;  // Device to Host
+    float total = 0.0f; // First copy started to last copy finished
+  };
+  auto timeCopies = [&](bool up, bool down) {
+    Timing timing;
+    for (int i = 0; i < iterations; ++i) {
+      Trace::Span span(up && down ? "Both directions" : (up ? "Host to Device" : "Device to Host"), "transfer");
+      if (up) {
+        HIP_ERR(hipEventRecord(upStart, upStream));
+        HIP_ERR(hipMemcpyAsync(d_up, h_up, N, hipMemcpyHostToDevice, upStream));
+        HIP_ERR(hipEventRecord(upStop, upStream));
+      }
+      if (down) {
+        HIP_ERR(hipEventRecord(downStart, downStream));
+        HIP_ERR(hipMemcpyAsync(h_down, d_down, N, hipMemcpyDeviceToHost, downStream));
+        HIP_ERR(hipEventRecord(downStop, downStream));
+      }
+      float upMilliseconds = 0.0f, downMilliseconds = 0.0f, totalMilliseconds = 0.0f;
+      if (up) {
+        HIP_ERR(hipEventSynchronize(upStop));
+        HIP_ERR(hipEventElapsedTime(&upMilliseconds, upStart, upStop));
+        totalMilliseconds = upMilliseconds;
+      }
+      if (down) {
+        HIP_ERR(hipEventSynchronize(downStop));
+        HIP_ERR(hipEventElapsedTime(&downMilliseconds, downStart, downStop));
+        totalMilliseconds = downMilliseconds;
+      }
+      if (up && down) {
+        // Both copies measured against the upload's start event, which may have been recorded second
+        float downStartOffset = 0.0f, downStopOffset = 0.0f;
+        HIP_ERR(hipEventElapsedTime(&downStartOffset, upStart, downStart));
+        HIP_ERR(hipEventElapsedTime(&downStopOffset, upStart, downStop));
+        totalMilliseconds = std::max(upMilliseconds, downStopOffset) - std::min(0.0f, downStartOffset);
+      }
+      span.end();
+      if (Trace::enabled()) {
+        if (up)
+          Trace::recordDeviceSpan(streamTrack(upStream), "Host to Device", "transfer", span.started(), upMilliseconds);
+        if (down)
+          Trace::recordDeviceSpan(streamTrack(downStream), "Device to Host", "transfer", span.started(), downMilliseconds);
+      }
+      timing.up += upMilliseconds / iterations;
+      timing.down += downMilliseconds / iterations;
+      timing.total += totalMilliseconds / iterations;
+    }
+    return timing;
+  };
+
+  Timing upOnly = timeCopies(true, false);
+  Timing downOnly = timeCopies(false, true);
+  Timing both = timeCopies(true, true);
+
+  releaseEvent(upStart);
+  releaseEvent(upStop);
+  releaseEvent(downStart);
+  releaseEvent(downStop);
+  releaseStream(upStream);
+  releaseStream(downStream);
+
+  auto megabytesPerSecond = [](double bytes, float milliseconds) {
+    return milliseconds > 0.0f ? bytes / (milliseconds / 1000.0) / (1024 * 1024) : 0.0;
+  };
+  double upAlone = megabytesPerSecond(N, upOnly.up);
+  double downAlone = megabytesPerSecond(N, downOnly.down);
+  double upShared = megabytesPerSecond(N, both.up);
+  double downShared = megabytesPerSecond(N, both.down);
+  double aggregate = megabytesPerSecond(2.0 * N, both.total);
+  std::cout << "\r" << HIP << "10) Bidirectional PCIe (" << Sweep::formatBytes(N) << " each way, avg of " << iterations
+            << " runs)... Unidirectional: Host to Device " << upAlone << " MB/s, Device to Host " << downAlone << " MB/s\n";
+  std::cout << HIP << "    Simultaneous: Host to Device " << upShared << " MB/s, Device to Host " << downShared << " MB/s, Aggregate "
+            << aggregate << " MB/s (" << std::setprecision(2) << aggregate / std::max(upAlone, downAlone) << "x the faster direction alone)\n";
+  Suite::record("pcie_bidirectional", both.total);
+  Suite::metric("pcie_bidirectional", "htod_mb_per_s", upAlone);
+  Suite::metric("pcie_bidirectional", "dtoh_mb_per_s", downAlone);
+  Suite::metric("pcie_bidirectional", "bidir_htod_mb_per_s", upShared);
+  Suite::metric("pcie_bidirectional", "bidir_dtoh_mb_per_s", downShared);
+  Suite::metric("pcie_bidirectional", "bidir_aggregate_mb_per_s", aggregate);
+
+  HIP_ERR(hipFree(d_up));
+  HIP_ERR(hipFree(d_down));
+  HIP_ERR(hipHostFree(h_up));
+  HIP_ERR(hipHostFree(h_down));
+  return both.total;
+}
+
+// Splits linearMultiplyKernel's work into chunks that each upload, multiply and download on their own stream, so one
+// chunk's copies can run while another chunk computes. A device or driver that serializes everything gets a factor of 1.
+float HIPBackend::runCopyComputeOverlapBenchmark(unsigned int threadsPerBlock, hipFunction_t linearMultiplyFunc, size_t totalMemory) {
+  constexpr unsigned int chunks = 16;
+  constexpr int iterations = 3;
+  constexpr unsigned int streamCounts[] = {1, 2, 4, 8};
+  // 256 MB per array (a sixteenth of VRAM on small devices), rounded so every chunk is a whole number of blocks
+  const size_t maxElements = std::min<size_t>(64ull * 1024 * 1024, totalMemory / 16 / sizeof(float));
+  const size_t chunkElements = maxElements / chunks / threadsPerBlock * threadsPerBlock;
+  const size_t N = chunkElements * chunks;
+  const size_t bytes = N * sizeof(float);
+  TRACE_SCOPE("11) Copy/Compute Overlap", "test");
+  std::cout << HIP << "11) Copy/Compute Overlap (" << Sweep::formatBytes(bytes) << " per array, " << chunks << " chunks)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  float* h_A = nullptr;
+  float* h_B = nullptr;
+  float* h_out = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_A, bytes, 0));
+  HIP_ERR(hipHostMalloc((void**)&h_B, bytes, 0));
+  HIP_ERR(hipHostMalloc((void**)&h_out, bytes, 0));
+  for (size_t i = 0; i < N; ++i) {
+    h_A[i] = static_cast<float>(i % 1024);
+    h_B[i] = 0.5f;
+  }
+  std::memset(h_out, 0, bytes);
+  float* d_A = nullptr;
+  float* d_B = nullptr;
+  float* d_out = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_A, bytes));
+  HIP_ERR(hipMalloc((void**)&d_B, bytes));
+  HIP_ERR(hipMalloc((void**)&d_out, bytes));
+  allocSpan.end();
+
+  std::vector<hipStream_t> streams;
+  for (unsigned int i = 0; i < streamCounts[std::size(streamCounts) - 1]; ++i) {
+    streams.push_back(acquireStream());
+  }
+
+  // Host wall time of the best run, from the first enqueue until the device is idle
+  using clock = std::chrono::steady_clock;
+  auto bestWallTime = [&](const char* name, auto&& enqueue) {
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+      Trace::Span span(name, "transfer");
+      auto start = clock::now();
+      enqueue();
+      HIP_ERR(hipDeviceSynchronize());
+      double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+      if (i == 0 || milliseconds < best)
+        best = milliseconds;
+    }
+    return best;
+  };
+  auto enqueueChunk = [&](size_t offset, size_t elements, hipStream_t stream) {
+    float* a = d_A + offset;
+    float* b = d_B + offset;
+    float* out = d_out + offset;
+    HIP_ERR(hipMemcpyAsync(a, h_A + offset, elements * sizeof(float), hipMemcpyHostToDevice, stream));
+    HIP_ERR(hipMemcpyAsync(b, h_B + offset, elements * sizeof(float), hipMemcpyHostToDevice, stream));
+    void* args[] = {&a, &b, &out};
+    HIP_ERR(hipModuleLaunchKernel(linearMultiplyFunc, elements / threadsPerBlock, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+    HIP_ERR(hipMemcpyAsync(h_out + offset, out, elements * sizeof(float), hipMemcpyDeviceToHost, stream));
+  };
+
+  // The same work with no chance of overlap: each stage over the whole buffer, one after the other
+  double uploadMilliseconds = bestWallTime("Upload", [&] {
+    HIP_ERR(hipMemcpyAsync(d_A, h_A, bytes, hipMemcpyHostToDevice, streams[0]));
+    HIP_ERR(hipMemcpyAsync(d_B, h_B, bytes, hipMemcpyHostToDevice, streams[0]));
+  });
+  double multiplyMilliseconds = bestWallTime("Multiply", [&] {
+    void* args[] = {&d_A, &d_B, &d_out};
+    HIP_ERR(hipModuleLaunchKernel(linearMultiplyFunc, N / threadsPerBlock, 1, 1, threadsPerBlock, 1, 1, 0, streams[0], args, nullptr));
+  });
+  double downloadMilliseconds = bestWallTime("Download", [&] {
+    HIP_ERR(hipMemcpyAsync(h_out, d_out, bytes, hipMemcpyDeviceToHost, streams[0]));
+  });
+  double serializedMilliseconds = uploadMilliseconds + multiplyMilliseconds + downloadMilliseconds;
+
+  std::vector<double> pipelinedMilliseconds;
+  for (unsigned int streamCount : streamCounts) {
+    std::memset(h_out, 0, bytes);
+    pipelinedMilliseconds.push_back(bestWallTime("Pipeline", [&] {
+      for (unsigned int c = 0; c < chunks; ++c) {
+        enqueueChunk(c * chunkElements, chunkElements, streams[c % streamCount]);
+      }
+    }));
+  }
+  for (hipStream_t stream : streams) {
+    releaseStream(stream);
+  }
+
+  bool valid = true;
+  for (size_t i = 0; i < N; i += 4099) {
+    if (h_out[i] != h_A[i] * h_B[i]) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected " << h_A[i] * h_B[i] << ", got " << h_out[i] << "\n";
+      break;
+    }
+  }
+
+  double bestMilliseconds = *std::min_element(pipelinedMilliseconds.begin(), pipelinedMilliseconds.end());
+  std::cout << "\r" << HIP << "11) Copy/Compute Overlap (" << Sweep::formatBytes(bytes) << " per array, " << chunks << " chunks)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " Serialized: " << std::fixed << std::setprecision(3) << serializedMilliseconds << " ms (upload " << uploadMilliseconds
+            << " + multiply " << multiplyMilliseconds << " + download " << downloadMilliseconds << ")\n";
+  Suite::record("copy_compute_overlap", static_cast<float>(bestMilliseconds), valid);
+  Suite::metric("copy_compute_overlap", "serialized_ms", serializedMilliseconds);
+  for (size_t i = 0; i < pipelinedMilliseconds.size(); ++i) {
+    double overlap = serializedMilliseconds / pipelinedMilliseconds[i];
+    std::cout << HIP << "    " << std::setw(2) << streamCounts[i] << (streamCounts[i] == 1 ? " stream:  " : " streams: ") << pipelinedMilliseconds[i]
+              << " ms, overlap factor " << std::setprecision(2) << overlap << "x\n"
+              << std::setprecision(3);
+    std::string suffix = "_" + std::to_string(streamCounts[i]) + "_streams";
+    Suite::metric("copy_compute_overlap", "pipelined_ms" + suffix, pipelinedMilliseconds[i]);
+    Suite::metric("copy_compute_overlap", "overlap_factor" + suffix, overlap);
+  }
+
+  HIP_ERR(hipFree(d_A));
+  HIP_ERR(hipFree(d_B));
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipHostFree(h_A));
+  HIP_ERR(hipHostFree(h_B));
+  HIP_ERR(hipHostFree(h_out));
+  return static_cast<float>(bestMilliseconds);
+}
+
+// Device-to-device copies between every ordered pair of devices. Pairs the runtime reports as peer capable copy
+// directly (xGMI or PCIe P2P); the rest are staged through pinned host memory, which is what a framework falls back to.
+std::vector<GPUMark::PeerLink> HIPBackend::runPeerToPeerBenchmark(const std::vector<int>& devices) {
+  constexpr size_t N = 256ull * 1024 * 1024; // 256 MB
+  constexpr size_t latencyBytes = 4;
+  constexpr int iterations = 5;
+  constexpr int latencyIterations = 100;
+  TRACE_SCOPE("12) Peer-to-Peer Matrix", "test");
+  std::cout << HIP << "12) Peer-to-Peer Matrix (" << devices.size() << " devices, " << Sweep::formatBytes(N) << " copies)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  std::vector<char*> buffers(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    HIP_ERR(hipSetDevice(devices[i]));
+    HIP_ERR(hipMalloc((void**)&buffers[i], N));
+    HIP_ERR(hipMemset(buffers[i], static_cast<int>(i), N));
+  }
+  // Portable, so every device can DMA from it
+  char* h_staging = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_staging, N, hipHostMallocPortable));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  std::vector<GPUMark::PeerLink> links;
+  for (size_t src = 0; src < devices.size(); ++src) {
+    for (size_t dst = 0; dst < devices.size(); ++dst) {
+      if (src == dst)
+        continue;
+      GPUMark::PeerLink link{devices[src], devices[dst]};
+      int canAccessPeer = 0;
+      HIP_ERR(hipDeviceCanAccessPeer(&canAccessPeer, devices[src], devices[dst]));
+      HIP_ERR(hipSetDevice(devices[src]));
+      if (canAccessPeer) {
+        hipError_t result = hipDeviceEnablePeerAccess(devices[dst], 0);
+        link.peerAccess = result == hipSuccess || result == hipErrorPeerAccessAlreadyEnabled;
+      }
+
+      auto copy = [&](size_t bytes) {
+        if (link.peerAccess) {
+          HIP_ERR(hipMemcpyPeer(buffers[dst], devices[dst], buffers[src], devices[src], bytes));
+          HIP_ERR(hipDeviceSynchronize());
+        } else {
+          HIP_ERR(hipMemcpy(h_staging, buffers[src], bytes, hipMemcpyDeviceToHost));
+          HIP_ERR(hipSetDevice(devices[dst]));
+          HIP_ERR(hipMemcpy(buffers[dst], h_staging, bytes, hipMemcpyHostToDevice));
+          HIP_ERR(hipSetDevice(devices[src]));
+        }
+      };
+      auto averageMilliseconds = [&](size_t bytes, int reps) {
+        copy(bytes); // Warm up
+        auto start = clock::now();
+        for (int i = 0; i < reps; ++i) {
+          copy(bytes);
+        }
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+      };
+
+      Trace::Span span(link.peerAccess ? "Peer copy" : "Staged copy", "transfer");
+      link.latencyMicroseconds = averageMilliseconds(latencyBytes, latencyIterations) * 1000.0;
+      link.gigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(N), averageMilliseconds(N, iterations)});
+      // Peer mappings outlive this test otherwise, and would change what later tests on this device measure
+      if (link.peerAccess)
+        HIP_ERR(hipDeviceDisablePeerAccess(devices[dst]));
+      links.push_back(link);
+    }
+  }
+
+  HIP_ERR(hipHostFree(h_staging));
+  for (size_t i = 0; i < devices.size(); ++i) {
+    HIP_ERR(hipSetDevice(devices[i]));
+    HIP_ERR(hipFree(buffers[i]));
+  }
+  std::cout << "\r" << HIP << "12) Peer-to-Peer Matrix (" << devices.size() << " devices, " << Sweep::formatBytes(N) << " copies)... Done\n";
+  return links;
+}
+
+// Dependent loads over a pseudo-randomly linked working set, from 1 KB up to half of VRAM. Every link lands on a different
+// 64-byte slot, so latency steps up each time the working set outgrows a cache level (or, at the largest sizes, the TLB).
+float HIPBackend::runPointerChaseBenchmark(hipFunction_t initFunc, hipFunction_t chaseFunc, size_t totalMemory) {
+  constexpr size_t minBytes = 1024;
+  // Chain entries are 32-bit word offsets, so the largest working set is 16 GB
+  const size_t maxLimit = std::min<size_t>(totalMemory / 2, 16ull * 1024 * 1024 * 1024);
+  size_t maxBytes = minBytes;
+  while (maxBytes * 2 <= maxLimit) {
+    maxBytes *= 2;
+  }
+  // Kernel arguments, so not const
+  unsigned int slotWords = 64 / sizeof(unsigned int);
+  unsigned int steps = 1u << 18;
+  unsigned long long multiplier = 6364136223846793005ull; // % 4 == 1
+  unsigned long long increment = 1442695040888963407ull;  // Odd
+  TRACE_SCOPE("13) Pointer-Chase Latency", "test");
+  std::cout << HIP << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", " << steps
+            << " dependent loads per size)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  unsigned int* d_chain = nullptr;
+  unsigned int* d_out = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_chain, maxBytes));
+  HIP_ERR(hipMalloc((void**)&d_out, sizeof(unsigned int)));
+  allocSpan.end();
+
+  std::vector<double> sizes, nanoseconds;
+  float milliseconds = 0;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    unsigned long long slots = bytes / (slotWords * sizeof(unsigned int));
+    void* initArgs[] = {&d_chain, &slots, &slotWords, &multiplier, &increment};
+    HIP_ERR(hipModuleLaunchKernel(initFunc, (slots + 255) / 256, 1, 1, 256, 1, 1, 0, nullptr, initArgs, nullptr));
+    void* chaseArgs[] = {&d_chain, &steps, &d_out};
+    // One untimed walk first, so the timed one starts with whatever part of the set fits already cached
+    HIP_ERR(hipModuleLaunchKernel(chaseFunc, 1, 1, 1, 1, 1, 1, 0, nullptr, chaseArgs, nullptr));
+    HIP_ERR(hipDeviceSynchronize());
+    HIP_BENCHMARK_KERNEL(chaseFunc, 1, 1, chaseArgs, milliseconds);
+    sizes.push_back(static_cast<double>(bytes));
+    nanoseconds.push_back(milliseconds * 1e6 / steps);
+  }
+  std::cout << "\r" << HIP << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", "
+            << steps << " dependent loads per size)... Done\n";
+  Sweep::reportLatencyCurve(HIP, "pointer_chase", sizes, nanoseconds);
+  Suite::record("pointer_chase", milliseconds);
+
+  HIP_ERR(hipFree(d_chain));
+  HIP_ERR(hipFree(d_out));
+  return milliseconds;
+}
+
+// linearSetKernel and linearMultiplyKernel only read perfectly coalesced, unit-stride data. This sweeps stride, misalignment
+// and element width to show what gather-like data layouts cost.
+float HIPBackend::runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<hipFunction_t, 3>& kernels, size_t totalMemory,
+                                            unsigned int warpSize) {
+  constexpr unsigned int widths[] = {4, 8, 16};
+  constexpr unsigned int strides[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+  constexpr unsigned int offsets[] = {0, 1};
+  constexpr unsigned long long maxElements = 16ull * 1024 * 1024;
+  const size_t bytes = std::min<size_t>(1ull << 30, totalMemory / 4);
+  TRACE_SCOPE("14) Strided Access", "test");
+  std::cout << HIP << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char* d_in = nullptr;
+  float* d_out = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_in, bytes));
+  HIP_ERR(hipMalloc((void**)&d_out, sizeof(float)));
+  HIP_ERR(hipMemset(d_in, 0, bytes));
+  allocSpan.end();
+
+  std::vector<Sweep::AccessPattern> patterns;
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(widths); ++w) {
+    {
+      // The first launch of each kernel pays for loading it, keep that out of the table
+      unsigned long long n = threadsPerBlock;
+      unsigned int stride = 1, offset = 0;
+      void* args[] = {&d_in, &d_out, &n, &stride, &offset};
+      float milliseconds = 0;
+      HIP_BENCHMARK_KERNEL(kernels[w], 1, threadsPerBlock, args, milliseconds);
+    }
+    for (unsigned int stride : strides) {
+      for (unsigned int offset : offsets) {
+        unsigned long long n = std::min<unsigned long long>(maxElements, (bytes / widths[w] - offset) / stride);
+        void* args[] = {&d_in, &d_out, &n, &stride, &offset};
+        unsigned long long blocks = (n + threadsPerBlock - 1) / threadsPerBlock;
+        float milliseconds = 0;
+        HIP_BENCHMARK_KERNEL(kernels[w], blocks, threadsPerBlock, args, milliseconds);
+        patterns.push_back({widths[w], stride, offset, static_cast<double>(n), milliseconds});
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  std::cout << "\r" << HIP << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)... Done\n";
+  Sweep::reportAccessPatterns(HIP, "strided_access", patterns, warpSize, 64);
+  Suite::record("strided_access", totalMilliseconds);
+
+  HIP_ERR(hipFree(d_in));
+  HIP_ERR(hipFree(d_out));
+  return totalMilliseconds;
+}
+
+// STREAM (McCalpin): Copy, Scale, Add and Triad over arrays far larger than any cache, each repeated and reported by its
+// fastest run, in scalar, float2 and float4 loads/stores to show how much wider accesses help.
+float HIPBackend::runStreamBenchmark(unsigned int threadsPerBlock, hipFunction_t initFunc, const std::array<hipFunction_t, 12>& kernels,
+                                     size_t totalMemory, int multiProcessorCount) {
+  constexpr int trials = 10; // STREAM's NTIMES, the first run of every kernel is a warm-up
+  constexpr const char* functions[] = {"Copy", "Scale", "Add", "Triad"};
+  constexpr unsigned int arrays[] = {2, 2, 3, 3}; // Arrays each function reads plus writes
+  constexpr const char* types[] = {"float", "float2", "float4"};
+  constexpr unsigned int widths[] = {4, 8, 16};
+  // STREAM asks for arrays at least 4x the last-level cache. 256 MB is far past that on any GPU.
+  const size_t bytes = std::min<size_t>(256ull << 20, totalMemory / 8) / 16 * 16;
+  unsigned long long floats = bytes / sizeof(float);
+  float scalar = 3.0f;
+  TRACE_SCOPE("15) STREAM", "test");
+  std::cout << HIP << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")..." << std::flush;
+
+  Trace::Span allocSpan("Allocate", "alloc");
+  float *d_a = nullptr, *d_b = nullptr, *d_c = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_a, bytes));
+  HIP_ERR(hipMalloc((void**)&d_b, bytes));
+  HIP_ERR(hipMalloc((void**)&d_c, bytes));
+  allocSpan.end();
+  {
+    void* args[] = {&d_a, &d_b, &d_c, &floats};
+    unsigned int blocks = multiProcessorCount * 32;
+    float milliseconds = 0;
+    HIP_BENCHMARK_KERNEL(initFunc, blocks, threadsPerBlock, args, milliseconds);
+  }
+
+  std::vector<Sweep::Trials> results(std::size(functions) * std::size(types));
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(types); ++w) {
+    unsigned long long n = bytes / widths[w];
+    // Enough blocks to fill the device, the grid-stride loop covers the rest
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    for (size_t f = 0; f < std::size(functions); ++f) {
+      Sweep::Trials& result = results[f * std::size(types) + w];
+      result.name = std::string(functions[f]) + " " + types[w];
+      result.key = tolower(functions[f]) + "_" + types[w];
+      result.bytes = static_cast<double>(arrays[f]) * bytes;
+    }
+    // STREAM runs the four functions in turn on every trial, so each one starts with the others' data out of cache
+    for (int trial = 0; trial < trials; ++trial) {
+      for (size_t f = 0; f < std::size(functions); ++f) {
+        void* args[] = {&d_a, &d_b, &d_c, &scalar, &n};
+        float milliseconds = 0;
+        HIP_BENCHMARK_KERNEL(kernels[w * std::size(functions) + f], blocks, threadsPerBlock, args, milliseconds);
+        if (trial > 0)
+          results[f * std::size(types) + w].milliseconds.push_back(milliseconds);
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  // Triad ran last: c = a + scalar * b = 1 + 3 * 2
+  bool valid = true;
+  for (unsigned long long i : {0ull, floats / 2, floats - 1}) {
+    float value = 0.0f;
+    HIP_ERR(hipMemcpy(&value, d_c + i, sizeof(float), hipMemcpyDeviceToHost));
+    if (value != 7.0f) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected 7, got " << value << "\n";
+      break;
+    }
+  }
+  std::cout << "\r" << HIP << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::reportBestOfN(HIP, "stream", results);
+  Suite::record("stream", totalMilliseconds, valid);
+
+  HIP_ERR(hipFree(d_a));
+  HIP_ERR(hipFree(d_b));
+  HIP_ERR(hipFree(d_c));
+  return valid ? totalMilliseconds : 0.0f;
+}
+
+// Kernels that read and write mapped pinned host memory directly, with no copies, against the usual upload, kernel and
+// download. Zero-copy wins while the copies' fixed costs dominate, and loses once every byte crossing the bus twice
+// at kernel access granularity costs more than bulk DMA.
+float HIPBackend::runZeroCopyBenchmark(unsigned int threadsPerBlock, hipFunction_t scaleFunc, size_t totalMemory, int multiProcessorCount) {
+  constexpr size_t minBytes = 4ull * 1024;                                // 4 KB
+  const size_t maxBytes = std::min<size_t>(256ull << 20, totalMemory / 8); // 256 MB, or an eighth of VRAM on small devices
+  float scalar = 3.0f;
+  TRACE_SCOPE("16) Zero-Copy", "test");
+  std::cout << HIP << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  float *h_in = nullptr, *h_out = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_in, maxBytes, hipHostMallocMapped));
+  HIP_ERR(hipHostMalloc((void**)&h_out, maxBytes, hipHostMallocMapped));
+  std::fill(h_in, h_in + maxBytes / sizeof(float), 1.0f);
+  float *m_in = nullptr, *m_out = nullptr, *d_in = nullptr, *d_out = nullptr;
+  HIP_ERR(hipHostGetDevicePointer((void**)&m_in, h_in, 0));
+  HIP_ERR(hipHostGetDevicePointer((void**)&m_out, h_out, 0));
+  HIP_ERR(hipMalloc((void**)&d_in, maxBytes));
+  HIP_ERR(hipMalloc((void**)&d_out, maxBytes));
+  allocSpan.end();
+
+  // streamScaleKernel16: out = scalar * in, as float4 so every bus transaction is as wide as a thread can make it
+  auto launch = [&](float* in, float* out, size_t bytes) {
+    unsigned long long n = bytes / 16;
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    void* args[] = {&in, &in, &out, &scalar, &n};
+    HIP_ERR(hipModuleLaunchKernel(scaleFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+  };
+  auto runZeroCopy = [&](size_t bytes) {
+    launch(m_in, m_out, bytes);
+    HIP_ERR(hipDeviceSynchronize());
+  };
+  // Synchronous copies on the null stream also wait for the kernel
+  auto runExplicitCopy = [&](size_t bytes) {
+    HIP_ERR(hipMemcpy(d_in, h_in, bytes, hipMemcpyHostToDevice));
+    launch(d_in, d_out, bytes);
+    HIP_ERR(hipMemcpy(h_out, d_out, bytes, hipMemcpyDeviceToHost));
+  };
+
+  using clock = std::chrono::steady_clock;
+  auto timeRuns = [&](size_t bytes, auto&& run) {
+    int reps = Sweep::repetitions(bytes, 256ull * 1024 * 1024, 3, 1000);
+    // Warm up so lazy driver setup for this size is not timed
+    run(bytes);
+    auto start = clock::now();
+    for (int i = 0; i < reps; ++i) {
+      run(bytes);
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+    return Sweep::Point{static_cast<double>(bytes), milliseconds};
+  };
+
+  std::vector<Sweep::Point> zeroCopy, explicitCopy;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Zero-copy size step", "transfer");
+    zeroCopy.push_back(timeRuns(bytes, runZeroCopy));
+    explicitCopy.push_back(timeRuns(bytes, runExplicitCopy));
+  }
+
+  std::fill(h_out, h_out + maxBytes / sizeof(float), 0.0f);
+  runZeroCopy(maxBytes);
+  bool valid = std::all_of(h_out, h_out + maxBytes / sizeof(float), [](float value) { return value == 3.0f; });
+  std::cout << "\r" << HIP << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::printTable(HIP, {"Zero-copy", "Copy + kernel"}, {zeroCopy, explicitCopy});
+  double crossover = Sweep::crossoverBytes(zeroCopy, explicitCopy);
+  if (crossover == 0.0) {
+    std::cout << HIP << "Zero-copy is faster at every size measured\n";
+  } else if (crossover == zeroCopy.front().bytes) {
+    std::cout << HIP << "Copy + kernel is faster at every size measured\n";
+  } else {
+    std::cout << HIP << "Zero-copy stops winning at " << Sweep::formatBytes(crossover) << "\n";
+  }
+  float milliseconds = static_cast<float>(zeroCopy.back().milliseconds);
+  Suite::record("zero_copy", milliseconds, valid);
+  Suite::metric("zero_copy", "crossover_bytes", crossover);
+  Sweep::record("zero_copy", "zero_copy", zeroCopy);
+  Sweep::record("zero_copy", "explicit_copy", explicitCopy);
+
+  HIP_ERR(hipFree(d_in));
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipHostFree(h_in));
+  HIP_ERR(hipHostFree(h_out));
+  return milliseconds;
+}
+
+// Test 7 allocates its pinned buffers once and never times that. Services that pin existing buffers on the fly pay for
+// it on every buffer, so this measures what pinning costs and how many copies it takes to earn it back.
+float HIPBackend::runHostRegistrationBenchmark(size_t totalMemory) {
+  constexpr size_t minBytes = 4ull * 1024; // 4 KB
+  // 8 GB, or a quarter of RAM so the pinned pages do not push everything else out
+  const size_t maxBytes = std::min<size_t>(8ull << 30, std::max<size_t>(getPhysicalMemory() / 4, 64ull << 20));
+  // Larger sizes are copied through this much device memory in pieces
+  const size_t deviceBytes = std::min<size_t>(maxBytes, totalMemory / 4);
+  TRACE_SCOPE("17) Host Registration", "test");
+  std::cout << HIP << "17) Host Registration (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", register vs alloc-host)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  // Page-aligned with default pages, the way a service's own buffers are. Every page is faulted in up front, so
+  // first-touch cost is not charged to registration.
+  char* h_pageable = static_cast<char*>(HostMemory::allocate(maxBytes, -1, false));
+  std::memset(h_pageable, 1, maxBytes);
+  char* d_data = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_data, deviceBytes));
+  allocSpan.end();
+
+  using clock = std::chrono::steady_clock;
+  auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+  auto copyToDevice = [&](size_t bytes) {
+    for (size_t offset = 0; offset < bytes; offset += deviceBytes) {
+      HIP_ERR(hipMemcpy(d_data, h_pageable + offset, std::min(deviceBytes, bytes - offset), hipMemcpyHostToDevice));
+    }
+  };
+
+  std::vector<Sweep::PinningCost> costs;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Registration size step", "transfer");
+    int reps = Sweep::repetitions(bytes, 1ull << 30, 1, 100);
+    Sweep::PinningCost cost{static_cast<double>(bytes), 0, 0, 0, 0, 0, 0};
+    // Warm up so lazy driver setup is not timed
+    copyToDevice(bytes);
+    for (int i = 0; i < reps; ++i) {
+      auto start = clock::now();
+      copyToDevice(bytes);
+      cost.pageableMilliseconds += elapsed(start) / reps;
+
+      start = clock::now();
+      HIP_ERR(hipHostRegister(h_pageable, bytes, 0));
+      cost.registerMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      copyToDevice(bytes);
+      cost.pinnedMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      HIP_ERR(hipHostUnregister(h_pageable));
+      cost.unregisterMilliseconds += elapsed(start) / reps;
+
+      start = clock::now();
+      void* h_pinned = nullptr;
+      HIP_ERR(hipHostMalloc(&h_pinned, bytes, 0));
+      cost.allocMilliseconds += elapsed(start) / reps;
+      start = clock::now();
+      HIP_ERR(hipHostFree(h_pinned));
+      cost.freeMilliseconds += elapsed(start) / reps;
+    }
+    costs.push_back(cost);
+  }
+
+  std::cout << "\r" << HIP << "17) Host Registration (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", register vs alloc-host)... Done\n";
+  Sweep::reportPinningCosts(HIP, "host_registration", costs);
+  float milliseconds = static_cast<float>(costs.back().registerMilliseconds);
+  Suite::record("host_registration", milliseconds);
+
+  HIP_ERR(hipFree(d_data));
+  HostMemory::release(h_pageable, maxBytes);
+  return milliseconds;
+}
+
+// Managed memory lets a model larger than VRAM run unchanged, at the cost of page faults and migrations. Moves one
+// allocation back and forth between host and device, by faulting and by prefetching, then oversubscribes VRAM by half.
+float HIPBackend::runManagedMemoryBenchmark(unsigned int threadsPerBlock, hipFunction_t incrementFunc, int dev, size_t totalMemory,
+                                            int multiProcessorCount, bool concurrentManagedAccess) {
+  constexpr int reps = 3;
+  const size_t bytes = std::min<size_t>(512ull << 20, totalMemory / 4);
+  TRACE_SCOPE("18) Managed Memory", "test");
+  std::cout << HIP << "18) Managed Memory (" << Sweep::formatBytes(bytes) << ", faulting vs prefetching)..." << std::flush;
+
+  using clock = std::chrono::steady_clock;
+  auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+  auto devicePass = [&](float* data, size_t size) {
+    unsigned long long n = size / sizeof(float);
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    void* args[] = {&data, &n};
+    auto start = clock::now();
+    HIP_ERR(hipModuleLaunchKernel(incrementFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+    HIP_ERR(hipDeviceSynchronize());
+    return elapsed(start);
+  };
+  auto hostPass = [&](float* data, size_t size) {
+    auto start = clock::now();
+    for (size_t i = 0; i < size / sizeof(float); ++i) {
+      data[i] += 1.0f;
+    }
+    return elapsed(start);
+  };
+  auto prefetch = [&](float* data, size_t size, int destination) {
+    auto start = clock::now();
+    HIP_ERR(hipMemPrefetchAsync(data, size, destination, nullptr));
+    HIP_ERR(hipDeviceSynchronize());
+    return elapsed(start);
+  };
+
+  Trace::Span allocSpan("Allocate", "alloc");
+  float* d_data = nullptr;
+  HIP_ERR(hipMallocManaged((void**)&d_data, bytes, hipMemAttachGlobal));
+  float* h_data = d_data;
+  allocSpan.end();
+  Sweep::ManagedMemoryTimes times{static_cast<double>(bytes), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  float expected = 0.0f;
+  times.firstTouchMilliseconds = devicePass(d_data, bytes);
+  times.residentMilliseconds = devicePass(d_data, bytes);
+  expected += 2.0f;
+  for (int i = 0; i < reps; ++i) {
+    times.hostFaultMilliseconds += hostPass(h_data, bytes) / reps;
+    times.hostResidentMilliseconds += hostPass(h_data, bytes) / reps;
+    times.deviceFaultMilliseconds += devicePass(d_data, bytes) / reps;
+    expected += 3.0f;
+  }
+  // Without concurrent access the driver migrates whole allocations at launch and sync, and cannot prefetch or oversubscribe
+  if (concurrentManagedAccess) {
+    for (int i = 0; i < reps; ++i) {
+      times.prefetchToHostMilliseconds += prefetch(d_data, bytes, hipCpuDeviceId) / reps;
+      times.prefetchToDeviceMilliseconds += prefetch(d_data, bytes, dev) / reps;
+    }
+  }
+  bool valid = true;
+  for (size_t i : {size_t(0), bytes / sizeof(float) / 2, bytes / sizeof(float) - 1}) {
+    if (h_data[i] != expected) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected " << expected << ", got " << h_data[i] << "\n";
+      break;
+    }
+  }
+  HIP_ERR(hipFree(d_data));
+
+  // The pages evicted to make room land in host memory, so only oversubscribe if the host can hold all of them
+  const size_t oversubscribedBytes = totalMemory / 2 * 3;
+  if (concurrentManagedAccess && getPhysicalMemory() >= oversubscribedBytes) {
+    TRACE_SCOPE("Oversubscription", "transfer");
+    HIP_ERR(hipMallocManaged((void**)&d_data, oversubscribedBytes, hipMemAttachGlobal));
+    times.oversubscribedBytes = static_cast<double>(oversubscribedBytes);
+    times.oversubscribedFirstMilliseconds = devicePass(d_data, oversubscribedBytes);
+    times.oversubscribedSecondMilliseconds = devicePass(d_data, oversubscribedBytes);
+    HIP_ERR(hipFree(d_data));
+  }
+
+  std::cout << "\r" << HIP << "18) Managed Memory (" << Sweep::formatBytes(bytes) << ", faulting vs prefetching)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  if (!concurrentManagedAccess)
+    std::cout << HIP << "No concurrent managed access on this device, skipping prefetch and oversubscription\n";
+  Sweep::reportManagedMemory(HIP, "managed_memory", times);
+  float milliseconds = static_cast<float>(times.deviceFaultMilliseconds);
+  Suite::record("managed_memory", milliseconds, valid);
+  return milliseconds;
+}
+
+// Frameworks allocate and free thousands of temporaries per second. Replays one churn of allocations and frees drawn
+// from the configured size mix (RunOptions::allocationSizes) with synchronous allocation and with the device's
+// stream-ordered pool, and reports per-call latency and how much memory the pool holds beyond what is live.
+float HIPBackend::runAllocationBenchmark(int dev, size_t totalMemory) {
+  constexpr size_t steps = 4000;
+  std::vector<Sweep::AllocationOp> ops = Sweep::allocationChurn(Suite::allocationSizes(), steps, totalMemory / 4);
+  if (ops.empty()) {
+    std::cout << HIP << "19) Allocation skipped, no allocation size fits in a quarter of device memory\n";
+    return 0.0f;
+  }
+  TRACE_SCOPE("19) Allocation", "test");
+  std::cout << HIP << "19) Allocation (" << ops.size() << " allocations and frees, synchronous vs stream-ordered pool)..." << std::flush;
+  std::vector<void*> slots(Sweep::allocationSlots(ops));
+  using clock = std::chrono::steady_clock;
+  auto microseconds = [](clock::time_point start) { return std::chrono::duration<double, std::micro>(clock::now() - start).count(); };
+
+  Sweep::LatencySamples syncAlloc{"hipMalloc", "sync_alloc", {}}, syncFree{"hipFree", "sync_free", {}};
+  Trace::Span syncSpan("Synchronous churn", "alloc");
+  auto syncStart = clock::now();
+  for (const Sweep::AllocationOp& op : ops) {
+    auto start = clock::now();
+    if (op.allocate) {
+      HIP_ERR(hipMalloc(&slots[op.slot], op.bytes));
+      syncAlloc.microseconds.push_back(microseconds(start));
+    } else {
+      HIP_ERR(hipFree(slots[op.slot]));
+      syncFree.microseconds.push_back(microseconds(start));
+    }
+  }
+  float milliseconds = static_cast<float>(microseconds(syncStart) / 1000.0);
+  syncSpan.end();
+
+  Sweep::LatencySamples poolAlloc{"hipMallocAsync", "pool_alloc", {}}, poolFree{"hipFreeAsync", "pool_free", {}};
+  unsigned long long reserved = 0, used = 0;
+  // Older drivers lack the stream-ordered allocator, and some devices do not support it
+  int poolsSupported = 0;
+  if (hipDeviceGetDefaultMemPool && hipMallocAsync)
+    HIP_ERR(hipDeviceGetAttribute(&poolsSupported, hipDeviceAttributeMemoryPoolsSupported, dev));
+  if (poolsSupported) {
+    // By default the pool hands everything back at each synchronization. Keep it, like a framework's caching allocator would.
+    hipMemPool_t pool = nullptr;
+    HIP_ERR(hipDeviceGetDefaultMemPool(&pool, dev));
+    // The pool is shared with the rest of the process, so the caller's threshold goes back afterwards and nothing is trimmed:
+    // the caller's cached blocks are in there too, and the pool releases ours down to that threshold on its own
+    unsigned long long previousThreshold = 0, threshold = ~0ull;
+    HIP_ERR(hipMemPoolGetAttribute(pool, hipMemPoolAttrReleaseThreshold, &previousThreshold));
+    HIP_ERR(hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold, &threshold));
+    hipStream_t stream = acquireStream();
+    // The first pass grows the pool, the second runs from it
+    for (const Sweep::AllocationOp& op : ops) {
+      if (op.allocate)
+        HIP_ERR(hipMallocAsync(&slots[op.slot], op.bytes, stream));
+      else
+        HIP_ERR(hipFreeAsync(slots[op.slot], stream));
+    }
+    HIP_ERR(hipStreamSynchronize(stream));
+
+    Trace::Span poolSpan("Pooled churn", "alloc");
+    for (size_t i = 0; i < ops.size(); ++i) {
+      const Sweep::AllocationOp& op = ops[i];
+      auto start = clock::now();
+      if (op.allocate) {
+        HIP_ERR(hipMallocAsync(&slots[op.slot], op.bytes, stream));
+        poolAlloc.microseconds.push_back(microseconds(start));
+      } else {
+        HIP_ERR(hipFreeAsync(slots[op.slot], stream));
+        poolFree.microseconds.push_back(microseconds(start));
+      }
+      // After the churn and before the trailing frees, the pool holds the live buffers and the holes between them
+      if (i + 1 == steps) {
+        HIP_ERR(hipStreamSynchronize(stream));
+        HIP_ERR(hipMemPoolGetAttribute(pool, hipMemPoolAttrReservedMemCurrent, &reserved));
+        HIP_ERR(hipMemPoolGetAttribute(pool, hipMemPoolAttrUsedMemCurrent, &used));
+      }
+    }
+    HIP_ERR(hipStreamSynchronize(stream));
+    poolSpan.end();
+    releaseStream(stream);
+    HIP_ERR(hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold, &previousThreshold));
+  }
+
+  std::cout << "\r" << HIP << "19) Allocation (" << ops.size() << " allocations and frees, synchronous vs stream-ordered pool)... Done\n";
+  Suite::record("allocation", milliseconds);
+  if (!poolsSupported) {
+    Sweep::reportLatencyPercentiles(HIP, "allocation", {syncAlloc, syncFree});
+    std::cout << HIP << "Stream-ordered pool not supported by this driver or device, skipped\n";
+    return milliseconds;
+  }
+  Sweep::reportLatencyPercentiles(HIP, "allocation", {syncAlloc, syncFree, poolAlloc, poolFree});
+  double fragmentation = reserved > 0 ? 1.0 - static_cast<double>(used) / reserved : 0.0;
+  std::cout << HIP << "Pool after churn: " << Sweep::formatBytes(reserved) << " reserved for " << Sweep::formatBytes(used) << " live ("
+            << std::setprecision(1) << fragmentation * 100.0 << "% held but unused)\n";
+  Suite::metric("allocation", "pool_reserved_bytes", reserved);
+  Suite::metric("allocation", "pool_used_bytes", used);
+  Suite::metric("allocation", "pool_fragmentation", fragmentation);
+  return milliseconds;
+}
+
+// The copy engine and fill paths image pipelines lean on: device-to-device copies and memsets across sizes, and 2D and
+// 3D copies between pitched buffers across row alignments, each next to a hand-written kernel doing the same copy.
+float HIPBackend::runCopyEngineBenchmark(unsigned int threadsPerBlock, hipFunction_t copyFunc, hipFunction_t pitchedCopyFunc,
+                                         hipFunction_t volumeCopyFunc, size_t totalMemory, int multiProcessorCount) {
+  constexpr size_t minBytes = 4ull * 1024;                               // 4 KB
+  const size_t maxBytes = std::min<size_t>(1ull << 30, totalMemory / 8); // 1 GB, or an eighth of VRAM on small devices
+  constexpr unsigned int widths[] = {1000, 4000, 7680};                  // Odd, unaligned and 1920-pixel RGBA rows
+  constexpr unsigned int height = 4096;
+  constexpr unsigned int alignments[] = {4, 64, 256, 512, 0};           // 0 lets the driver pick the pitch
+  constexpr unsigned int sliceRows = 256, haloRows = 8, depth = 64;     // 3D box, cut from slices with a halo
+  TRACE_SCOPE("20) Copy Engine", "test");
+  std::cout << HIP << "20) Copy Engine (device copies, memset and 2D and 3D pitched copies vs kernels)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  char *d_src = nullptr, *d_dst = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_src, maxBytes));
+  HIP_ERR(hipMalloc((void**)&d_dst, maxBytes));
+  HIP_ERR(hipMemset(d_src, 1, maxBytes));
+  allocSpan.end();
+
+  // Every repetition goes into one event pair, so short operations are not dominated by timing overhead
+  auto timeRepeated = [&](size_t bytes, auto&& enqueue) {
+    int reps = Sweep::repetitions(bytes, 1ull << 30, 3, 1000);
+    enqueue();
+    hipEvent_t startEvent = acquireEvent();
+    hipEvent_t stopEvent = acquireEvent();
+    HIP_ERR(hipEventRecord(startEvent, nullptr));
+    for (int i = 0; i < reps; ++i) {
+      enqueue();
+    }
+    HIP_ERR(hipEventRecord(stopEvent, nullptr));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    float milliseconds = 0;
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    return static_cast<double>(milliseconds) / reps;
+  };
+
+  std::vector<Sweep::Point> copies, kernelCopies, memsets;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Copy engine size step", "transfer");
+    unsigned long long n = bytes / 16;
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+    float scalar = 1.0f;
+    copies.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      HIP_ERR(hipMemcpy(d_dst, d_src, bytes, hipMemcpyDeviceToDevice));
+    })});
+    kernelCopies.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      // streamCopyKernel16: dst = src as float4
+      void* args[] = {&d_src, &d_src, &d_dst, &scalar, &n};
+      HIP_ERR(hipModuleLaunchKernel(copyFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, nullptr, args, nullptr));
+    })});
+    memsets.push_back({static_cast<double>(bytes), timeRepeated(bytes, [&] {
+      HIP_ERR(hipMemset(d_dst, 0, bytes));
+    })});
+  }
+  HIP_ERR(hipFree(d_src));
+  HIP_ERR(hipFree(d_dst));
+
+  std::vector<Sweep::PitchedCopy> pitched;
+  for (unsigned int width : widths) {
+    for (unsigned int alignment : alignments) {
+      TRACE_SCOPE("Pitched copy step", "transfer");
+      void *p_src = nullptr, *p_dst = nullptr;
+      size_t pitch = 0;
+      if (alignment == 0) {
+        HIP_ERR(hipMallocPitch(&p_src, &pitch, width, height));
+        HIP_ERR(hipMallocPitch(&p_dst, &pitch, width, height));
+      } else {
+        pitch = (width + alignment - 1) / alignment * alignment;
+        HIP_ERR(hipMalloc(&p_src, pitch * height));
+        HIP_ERR(hipMalloc(&p_dst, pitch * height));
+      }
+      unsigned long long srcPitch = pitch, dstPitch = pitch;
+      unsigned int widthWords = width / 4, rows = height;
+      Sweep::PitchedCopy copy{width, height, alignment, pitch, 0, 0};
+      copy.copyMilliseconds = timeRepeated(static_cast<size_t>(width) * height, [&] {
+        HIP_ERR(hipMemcpy2D(p_dst, pitch, p_src, pitch, width, height, hipMemcpyDeviceToDevice));
+      });
+      copy.kernelMilliseconds = timeRepeated(static_cast<size_t>(width) * height, [&] {
+        void* args[] = {&p_src, &srcPitch, &p_dst, &dstPitch, &widthWords, &rows};
+        HIP_ERR(hipModuleLaunchKernel(pitchedCopyFunc, (widthWords + threadsPerBlock - 1) / threadsPerBlock, height, 1, threadsPerBlock, 1, 1, 0,
+                                      nullptr, args, nullptr));
+      });
+      pitched.push_back(copy);
+      HIP_ERR(hipFree(p_src));
+      HIP_ERR(hipFree(p_dst));
+    }
+  }
+
+  // The same rows as a 3D copy: a box of depth slices cut out of a volume whose slices carry halo rows, into a packed
+  // volume, the way stencil codes exchange sub-volumes
+  for (unsigned int width : widths) {
+    for (unsigned int alignment : alignments) {
+      TRACE_SCOPE("Volume copy step", "transfer");
+      void *v_src = nullptr, *v_dst = nullptr;
+      size_t pitch = 0;
+      if (alignment == 0) {
+        HIP_ERR(hipMallocPitch(&v_src, &pitch, width, (sliceRows + haloRows) * depth));
+        HIP_ERR(hipMallocPitch(&v_dst, &pitch, width, sliceRows * depth));
+      } else {
+        pitch = (width + alignment - 1) / alignment * alignment;
+        HIP_ERR(hipMalloc(&v_src, pitch * (sliceRows + haloRows) * depth));
+        HIP_ERR(hipMalloc(&v_dst, pitch * sliceRows * depth));
+      }
+      unsigned long long srcPitch = pitch, dstPitch = pitch;
+      unsigned int widthWords = width / 4, srcSliceRows = sliceRows + haloRows, dstSliceRows = sliceRows;
+      size_t bytes = static_cast<size_t>(width) * sliceRows * depth;
+      Sweep::PitchedCopy copy{width, sliceRows, alignment, pitch, 0, 0, depth};
+      copy.copyMilliseconds = timeRepeated(bytes, [&] {
+        hipMemcpy3DParms params = {};
+        params.srcPtr = {v_src, pitch, width, srcSliceRows};
+        params.dstPtr = {v_dst, pitch, width, dstSliceRows};
+        params.extent = {width, sliceRows, depth};
+        params.kind = hipMemcpyDeviceToDevice;
+        HIP_ERR(hipMemcpy3D(&params));
+      });
+      copy.kernelMilliseconds = timeRepeated(bytes, [&] {
+        void* args[] = {&v_src, &srcPitch, &srcSliceRows, &v_dst, &dstPitch, &dstSliceRows, &widthWords};
+        HIP_ERR(hipModuleLaunchKernel(volumeCopyFunc, (widthWords + threadsPerBlock - 1) / threadsPerBlock, sliceRows, depth, threadsPerBlock, 1, 1,
+                                      0, nullptr, args, nullptr));
+      });
+      pitched.push_back(copy);
+      HIP_ERR(hipFree(v_src));
+      HIP_ERR(hipFree(v_dst));
+    }
+  }
+
+  std::cout << "\r" << HIP << "20) Copy Engine (device copies, memset and 2D and 3D pitched copies vs kernels)... Done\n";
+  Sweep::printTable(HIP, {"hipMemcpy DtoD", "Copy kernel", "hipMemset"}, {copies, kernelCopies, memsets});
+  Sweep::reportPitchedCopies(HIP, "copy_engine", pitched);
+  float milliseconds = static_cast<float>(copies.back().milliseconds);
+  Suite::record("copy_engine", milliseconds);
+  Sweep::record("copy_engine", "dtod", copies);
+  Sweep::record("copy_engine", "copy_kernel", kernelCopies);
+  Sweep::record("copy_engine", "memset", memsets);
+  return milliseconds;
+}
+
+// Streams a dataset three times the size of VRAM through a ring of chunk-sized device buffers, uploading one chunk while
+// the previous ones are checksummed, the way out-of-core jobs walk data that does not fit. The host side cycles through a
+// small pinned window, so the test needs no more host memory than a few chunks.
+float HIPBackend::runOutOfCoreBenchmark(unsigned int threadsPerBlock, hipFunction_t checksumFunc, size_t totalMemory, int multiProcessorCount) {
+  constexpr unsigned int windowChunks = 4;
+  constexpr unsigned int ringDepths[] = {2, 3}; // Double and triple buffering
+  // 64 MB chunks (a sixty-fourth of VRAM on small devices), a whole number of 32-bit words
+  const size_t chunkBytes = std::min<size_t>(64ull * 1024 * 1024, totalMemory / 64) / sizeof(unsigned int) * sizeof(unsigned int);
+  const size_t chunks = totalMemory * 3 / chunkBytes;
+  const size_t datasetBytes = chunks * chunkBytes;
+  unsigned long long n = chunkBytes / sizeof(unsigned int);
+  unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, multiProcessorCount * 32ull);
+  TRACE_SCOPE("21) Out-of-Core Streaming", "test");
+  std::cout << HIP << "21) Out-of-Core Streaming (" << Sweep::formatBytes(datasetBytes) << " in " << Sweep::formatBytes(chunkBytes) << " chunks)..."
+            << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  unsigned int* h_window = nullptr;
+  HIP_ERR(hipHostMalloc((void**)&h_window, chunkBytes * windowChunks, 0));
+  // Every window chunk holds different values, so a chunk that is skipped or uploaded twice changes the checksum
+  std::vector<unsigned long long> windowSums(windowChunks, 0);
+  for (unsigned int w = 0; w < windowChunks; ++w) {
+    for (size_t i = 0; i < n; ++i) {
+      h_window[w * n + i] = static_cast<unsigned int>((i + w * 7) % 251);
+      windowSums[w] += h_window[w * n + i];
+    }
+  }
+  unsigned long long expected = 0;
+  for (size_t c = 0; c < chunks; ++c) {
+    expected += windowSums[c % windowChunks];
+  }
+  std::vector<unsigned int*> d_ring(ringDepths[std::size(ringDepths) - 1]);
+  for (unsigned int*& slot : d_ring) {
+    HIP_ERR(hipMalloc((void**)&slot, chunkBytes));
+  }
+  unsigned long long* d_checksum = nullptr;
+  HIP_ERR(hipMalloc((void**)&d_checksum, sizeof(unsigned long long)));
+  allocSpan.end();
+
+  std::vector<hipStream_t> streams;
+  for (unsigned int i = 0; i < ringDepths[std::size(ringDepths) - 1]; ++i) {
+    streams.push_back(acquireStream());
+  }
+  using clock = std::chrono::steady_clock;
+  auto wallTime = [&](const char* name, auto&& enqueue) {
+    Trace::Span span(name, "transfer");
+    auto start = clock::now();
+    enqueue();
+    HIP_ERR(hipDeviceSynchronize());
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  };
+  auto launchChecksum = [&](unsigned int* chunk, hipStream_t stream) {
+    void* args[] = {&chunk, &d_checksum, &n};
+    HIP_ERR(hipModuleLaunchKernel(checksumFunc, blocks, 1, 1, threadsPerBlock, 1, 1, 0, stream, args, nullptr));
+  };
+
+  // The two limits the pipeline runs into: back-to-back uploads of one window, and checksums of a resident chunk
+  constexpr int referenceChunks = 16;
+  wallTime("Warm-up", [&] {
+    HIP_ERR(hipMemcpyAsync(d_ring[0], h_window, chunkBytes, hipMemcpyHostToDevice, streams[0]));
+    launchChecksum(d_ring[0], streams[0]);
+  });
+  double uploadMilliseconds = wallTime("Upload", [&] {
+    for (int c = 0; c < referenceChunks; ++c) {
+      HIP_ERR(hipMemcpyAsync(d_ring[0], h_window + (c % windowChunks) * n, chunkBytes, hipMemcpyHostToDevice, streams[0]));
+    }
+  });
+  double checksumMilliseconds = wallTime("Checksum", [&] {
+    for (int c = 0; c < referenceChunks; ++c) {
+      launchChecksum(d_ring[0], streams[0]);
+    }
+  });
+  double pcieGigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(chunkBytes * referenceChunks), uploadMilliseconds});
+  double checksumGigabytesPerSecond = Sweep::gigabytesPerSecond({static_cast<double>(chunkBytes * referenceChunks), checksumMilliseconds});
+
+  // Chunk c goes to ring slot c % depth on that slot's stream, so its upload waits for the slot's previous checksum
+  // while the other slots keep the copy engine and the SMs busy
+  std::vector<double> pipelinedMilliseconds;
+  bool valid = true;
+  for (unsigned int depth : ringDepths) {
+    HIP_ERR(hipMemset(d_checksum, 0, sizeof(unsigned long long)));
+    pipelinedMilliseconds.push_back(wallTime("Pipeline", [&] {
+      for (size_t c = 0; c < chunks; ++c) {
+        hipStream_t stream = streams[c % depth];
+        HIP_ERR(hipMemcpyAsync(d_ring[c % depth], h_window + (c % windowChunks) * n, chunkBytes, hipMemcpyHostToDevice, stream));
+        launchChecksum(d_ring[c % depth], stream);
+      }
+    }));
+    unsigned long long checksum = 0;
+    HIP_ERR(hipMemcpy(&checksum, d_checksum, sizeof(checksum), hipMemcpyDeviceToHost));
+    if (checksum != expected) {
+      valid = false;
+      std::cerr << " Checksum mismatch with " << depth << " buffers: expected " << expected << ", got " << checksum << "\n";
+    }
+  }
+  for (hipStream_t stream : streams) {
+    releaseStream(stream);
+  }
+
+  double bestMilliseconds = *std::min_element(pipelinedMilliseconds.begin(), pipelinedMilliseconds.end());
+  std::cout << "\r" << HIP << "21) Out-of-Core Streaming (" << Sweep::formatBytes(datasetBytes) << " in " << Sweep::formatBytes(chunkBytes)
+            << " chunks)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " Upload limit: " << std::fixed << std::setprecision(2) << pcieGigabytesPerSecond << " GB/s, checksum: " << checksumGigabytesPerSecond
+            << " GB/s\n";
+  Suite::record("out_of_core", static_cast<float>(bestMilliseconds), valid);
+  Suite::metric("out_of_core", "pcie_gb_per_s", pcieGigabytesPerSecond);
+  Suite::metric("out_of_core", "checksum_gb_per_s", checksumGigabytesPerSecond);
+  for (size_t i = 0; i < pipelinedMilliseconds.size(); ++i) {
+    double sustained = Sweep::gigabytesPerSecond({static_cast<double>(datasetBytes), pipelinedMilliseconds[i]});
+    std::cout << HIP << "    " << ringDepths[i] << " buffers: " << sustained << " GB/s sustained, " << std::setprecision(1)
+              << 100.0 * sustained / pcieGigabytesPerSecond << "% of the upload limit\n"
+              << std::setprecision(2);
+    std::string suffix = "_" + std::to_string(ringDepths[i]) + "_buffers";
+    Suite::metric("out_of_core", "sustained_gb_per_s" + suffix, sustained);
+    Suite::metric("out_of_core", "pcie_fraction" + suffix, sustained / pcieGigabytesPerSecond);
+  }
+
+  for (unsigned int* slot : d_ring) {
+    HIP_ERR(hipFree(slot));
+  }
+  HIP_ERR(hipFree(d_checksum));
+  HIP_ERR(hipHostFree(h_window));
+  return static_cast<float>(bestMilliseconds);
+}
+
+// Reads a file into device memory through a ring of pinned buffers, each read uploaded as soon as it lands while the
+// next reads are in flight. Disk, staging and PCIe are also timed on their own to show which one the pipeline runs into.
+float HIPBackend::runIngestBenchmark() {
+  constexpr size_t chunkBytes = 8ull << 20; // 8 MB
+  constexpr unsigned int ringSlots = 4;
+  std::string path = Suite::ingestFile();
+  const bool temporary = path.empty();
+  TRACE_SCOPE("22) File Ingest", "test");
+  std::cout << HIP << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  if (temporary)
+    path = Suite::temporaryIngestFile();
+  const unsigned long long fileBytes = Ingest::fileSize(path);
+  if (fileBytes == 0)
+    throw GPUMark::Error(path + " is empty");
+  IngestRing buffers;
+  HIP_ERR(hipHostMalloc((void**)&buffers.host, chunkBytes * ringSlots, 0));
+  HIP_ERR(hipMalloc((void**)&buffers.device, chunkBytes * ringSlots));
+  char* h_ring = buffers.host;
+  char* d_ring = buffers.device;
+  std::vector<void*> ring;
+  for (unsigned int slot = 0; slot < ringSlots; ++slot) {
+    ring.push_back(h_ring + slot * chunkBytes);
+  }
+  allocSpan.end();
+
+  std::vector<hipStream_t> streams;
+  for (unsigned int slot = 0; slot < ringSlots; ++slot) {
+    streams.push_back(acquireStream());
+  }
+  auto upload = [&](unsigned int slot, size_t bytes, unsigned long long) {
+    HIP_ERR(hipMemcpyAsync(d_ring + slot * chunkBytes, ring[slot], bytes, hipMemcpyHostToDevice, streams[slot]));
+  };
+  auto waitUpload = [&](unsigned int slot) { HIP_ERR(hipStreamSynchronize(streams[slot])); };
+
+  using clock = std::chrono::steady_clock;
+  Ingest::Stages stages{};
+  stages.bytes = fileBytes;
+  {
+    Trace::Span span("Disk", "transfer");
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, true);
+    stages.method = reader->method();
+    stages.direct = reader->direct();
+    stages.diskMilliseconds = Ingest::readMilliseconds(*reader, ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Staging", "transfer");
+    stages.stagingMilliseconds = Ingest::stagingMilliseconds(ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Upload", "transfer");
+    auto start = clock::now();
+    unsigned int slot = 0;
+    for (unsigned long long offset = 0; offset < fileBytes; offset += chunkBytes) {
+      upload(slot, static_cast<size_t>(std::min<unsigned long long>(chunkBytes, fileBytes - offset)), offset);
+      slot = (slot + 1) % ringSlots;
+    }
+    HIP_ERR(hipDeviceSynchronize());
+    stages.uploadMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+  unsigned int lastSlot = 0;
+  {
+    Trace::Span span("Pipeline", "transfer");
+    // Opened again so no pages from the disk pass are left in the cache
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, true);
+    auto start = clock::now();
+    lastSlot = Ingest::pipeline(*reader, ring, chunkBytes, fileBytes, upload, waitUpload);
+    stages.pipelineMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+  // The last chunk is still in its device slot, and has to match the end of the file
+  const unsigned long long lastOffset = (fileBytes - 1) / chunkBytes * chunkBytes;
+  std::vector<char> lastChunk(static_cast<size_t>(fileBytes - lastOffset));
+  HIP_ERR(hipMemcpy(lastChunk.data(), d_ring + lastSlot * chunkBytes, lastChunk.size(), hipMemcpyDeviceToHost));
+  bool valid = Ingest::matchesFile(path, lastOffset, lastChunk.data(), lastChunk.size());
+  std::cout << "\r" << HIP << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " " << Sweep::formatBytes(static_cast<double>(fileBytes)) << " in " << Sweep::formatBytes(chunkBytes) << " chunks, " << ringSlots
+            << " pinned buffers\n";
+  Ingest::reportStages(HIP, "ingest", stages);
+  Suite::record("ingest", static_cast<float>(stages.pipelineMilliseconds), valid);
+
+  for (hipStream_t stream : streams) {
+    releaseStream(stream);
+  }
+  HIP_ERR(hipFree(std::exchange(buffers.device, nullptr)));
+  HIP_ERR(hipHostFree(std::exchange(buffers.host, nullptr)));
+  return static_cast<float>(stages.pipelineMilliseconds);
+}
+
+// Host-to-device and device-to-host bandwidth from buffers on the device's own NUMA node and on every other node, with
+// huge and default pages. On hosts with one node only the page sizes are compared.
+float HIPBackend::runNumaPlacementBenchmark(int hostNode) {
+  constexpr size_t bytes = 512ull << 20; // 512 MB
+  constexpr int iterations = 5;
+  TRACE_SCOPE("23) Host NUMA Placement", "test");
+  std::cout << HIP << "23) Host NUMA Placement (" << Sweep::formatBytes(bytes) << ", local vs remote node, huge vs 4 KB pages)..." << std::flush;
+  struct Candidate {
+    std::string name, key;
+    int node;
+    bool hugePages;
+  };
+  std::vector<Candidate> candidates;
+  if (hostNode >= 0) {
+    candidates.push_back({"Local node " + std::to_string(hostNode), "local_huge", hostNode, true});
+    candidates.push_back({"Local node " + std::to_string(hostNode), "local_small", hostNode, false});
+    for (int node : HostMemory::nodes()) {
+      if (node != hostNode)
+        candidates.push_back({"Remote node " + std::to_string(node), "node" + std::to_string(node) + "_huge", node, true});
+    }
+  } else {
+    candidates.push_back({"Any node", "huge", -1, true});
+    candidates.push_back({"Any node", "small", -1, false});
+  }
+  Trace::Span allocSpan("Allocate", "alloc");
+  void* d_data = nullptr;
+  HIP_ERR(hipMalloc(&d_data, bytes));
+  allocSpan.end();
+
+  // Best of a few copies on the legacy stream, timed with events
+  auto bestMilliseconds = [&](auto&& copy) {
+    copy();
+    hipEvent_t startEvent = acquireEvent();
+    hipEvent_t stopEvent = acquireEvent();
+    float best = 0.0f;
+    for (int i = 0; i < iterations; ++i) {
+      float milliseconds = 0.0f;
+      HIP_ERR(hipEventRecord(startEvent, nullptr));
+      copy();
+      HIP_ERR(hipEventRecord(stopEvent, nullptr));
+      HIP_ERR(hipEventSynchronize(stopEvent));
+      HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+      if (i == 0 || milliseconds < best)
+        best = milliseconds;
+    }
+    releaseEvent(startEvent);
+    releaseEvent(stopEvent);
+    return static_cast<double>(best);
+  };
+
+  std::vector<Sweep::HostPlacement> placements;
+  for (const Candidate& candidate : candidates) {
+    TRACE_SCOPE("Placement step", "transfer");
+    Sweep::HostPlacement host{candidate.name, candidate.key, candidate.node == hostNode, {}, static_cast<double>(bytes), 0, 0};
+    char* h_data = static_cast<char*>(HostMemory::allocate(bytes, candidate.node, candidate.hugePages, &host.placement));
+    HIP_ERR(hipHostRegister(h_data, bytes, 0));
+    host.htodMilliseconds = bestMilliseconds([&] { HIP_ERR(hipMemcpy(d_data, h_data, bytes, hipMemcpyHostToDevice)); });
+    host.dtohMilliseconds = bestMilliseconds([&] { HIP_ERR(hipMemcpy(h_data, d_data, bytes, hipMemcpyDeviceToHost)); });
+    HIP_ERR(hipHostUnregister(h_data));
+    HostMemory::release(h_data, bytes);
+    placements.push_back(host);
+  }
+  HIP_ERR(hipFree(d_data));
+
+  std::cout << "\r" << HIP << "23) Host NUMA Placement (" << Sweep::formatBytes(bytes) << ", local vs remote node, huge vs 4 KB pages)... Done\n";
+  if (hostNode < 0)
+    std::cout << HIP << "The device's NUMA node is unknown or the host has one node, comparing page sizes only\n";
+  Sweep::reportHostPlacements(HIP, "numa_placement", placements);
+  float milliseconds = static_cast<float>(placements[0].htodMilliseconds);
+  Suite::record("numa_placement", milliseconds);
+  return milliseconds;
+}
+
+// Multiply-add and GEMM throughput in every format: fp16 (half2), bf16 (pairs), fp32, fp64 and int8 (4-way dot products).
+// The GEMMs multiply small integers, which every format holds exactly, so their results are compared exactly.
+float HIPBackend::runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<hipFunction_t, 5>& multiplyAddFuncs,
+                                         const std::array<hipFunction_t, 5>& gemmFuncs, int multiProcessorCount, bool hasDoubles, int doubleRatio) {
+  constexpr unsigned int n = 2048;
+  TRACE_SCOPE("24) Precision", "test");
+  std::cout << HIP << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  const size_t matrixBytes = static_cast<size_t>(n) * n * sizeof(double);
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_out = 0, d_A = 0, d_B = 0, d_C = 0;
+  HIP_ERR(hipMalloc(&d_out, threads * sizeof(double)));
+  HIP_ERR(hipMalloc(&d_A, matrixBytes));
+  HIP_ERR(hipMalloc(&d_B, matrixBytes));
+  HIP_ERR(hipMalloc(&d_C, matrixBytes));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  auto timed = [&](hipFunction_t function, unsigned int blocks, unsigned int blockSize, unsigned int gridY, unsigned int blockY, void** args) {
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(function, blocks, gridY, 1, blockSize, blockY, 1, 0, stream, args, nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+  auto multiplyAdd = [&](hipFunction_t function, unsigned int iterations) {
+    void* args[] = {&d_out, &iterations};
+    return timed(function, static_cast<unsigned int>(threads / threadsPerBlock), threadsPerBlock, 1, 1, args);
+  };
+  auto gemm = [&](hipFunction_t function) {
+    unsigned int size = n;
+    void* args[] = {&d_A, &d_B, &d_C, &size};
+    return timed(function, n / 16, 16, n / 16, 16, args);
+  };
+
+  const std::vector<int> A = Gemm::integerMatrix(n, 1), B = Gemm::integerMatrix(n, 2);
+  std::vector<Gemm::FormatRate> rates;
+  for (Gemm::Format format : Gemm::formats) {
+    TRACE_SCOPE("Precision format", "kernel");
+    const size_t f = static_cast<size_t>(format);
+    Gemm::FormatRate rate{format, 0.0, 0.0, n, 0.0};
+
+    std::cout << "\r" << HIP << "24) Precision (" << Gemm::formatName(format) << ")..." << std::flush;
+    // Double the iterations until one launch takes 20 ms, so the slow formats stay short
+    unsigned int iterations = 256;
+    double milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    }
+    rate.multiplyAddOps = static_cast<double>(threads) * iterations * 8 * Gemm::opsPerMultiplyAdd(format);
+    rate.multiplyAddMilliseconds = milliseconds;
+
+    const std::vector<unsigned char> h_A = Gemm::encode(format, A), h_B = Gemm::encode(format, B);
+    std::vector<unsigned char> h_C(static_cast<size_t>(n) * n * Gemm::outputBytes(format));
+    HIP_ERR(hipMemcpy(d_A, h_A.data(), h_A.size(), hipMemcpyHostToDevice));
+    HIP_ERR(hipMemcpy(d_B, h_B.data(), h_B.size(), hipMemcpyHostToDevice));
+    HIP_ERR(hipMemset(d_C, 0, h_C.size()));
+    rate.gemmMilliseconds = gemm(gemmFuncs[f]);
+    HIP_ERR(hipMemcpy(h_C.data(), d_C, h_C.size(), hipMemcpyDeviceToHost));
+    rate.valid = Gemm::verifyExact(format, A, B, h_C, n);
+    for (int run = 0; run < 2; ++run) {
+      rate.gemmMilliseconds = std::min(rate.gemmMilliseconds, gemm(gemmFuncs[f]));
+    }
+    if (format == Gemm::Format::Bfloat16)
+      rate.note = "through fp32";
+    rates.push_back(rate);
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipFree(d_A));
+  HIP_ERR(hipFree(d_B));
+  HIP_ERR(hipFree(d_C));
+
+  bool valid = std::all_of(rates.begin(), rates.end(), [](const Gemm::FormatRate& rate) { return rate.valid; });
+  std::cout << "\r" << HIP << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Gemm::reportFormats(HIP, "precision", rates);
+  if (!hasDoubles)
+    std::cout << HIP << "The driver reports no fp64 support\n";
+  else if (doubleRatio > 0)
+    std::cout << HIP << "The driver reports fp64 at 1/" << doubleRatio << " of the fp32 rate\n";
+  float milliseconds = static_cast<float>(rates[static_cast<size_t>(Gemm::Format::Float)].gemmMilliseconds);
+  Suite::record("precision", milliseconds, valid);
+  return milliseconds;
+}
+
+// Latency and throughput of transcendental, integer and conversion instructions. Latency is read from clock64()
+// around one dependent chain in a single thread; throughput comes from eight independent chains per thread on every CU.
+float HIPBackend::runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<hipFunction_t>& latencyFuncs,
+                                              const std::vector<hipFunction_t>& throughputFuncs, int clockKilohertz, int multiProcessorCount) {
+  constexpr unsigned int latencyIterations = 4096;
+  TRACE_SCOPE("25) Instruction Mix", "test");
+  std::cout << HIP << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_out = 0, d_cycles = 0;
+  HIP_ERR(hipMalloc(&d_out, threads * sizeof(unsigned long long)));
+  HIP_ERR(hipMalloc(&d_cycles, sizeof(long long)));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  unsigned int seed = 1;
+  auto throughput = [&](hipFunction_t function, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &seed, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(function, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args,
+                                  nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  const std::vector<Microbench::Instruction>& instructions = Microbench::instructions();
+  std::vector<Microbench::InstructionRate> rates;
+  double totalMilliseconds = 0.0;
+  bool valid = true;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    TRACE_SCOPE("Instruction", "kernel");
+    std::cout << "\r" << HIP << "25) Instruction Mix (" << instructions[i].name << ")..." << std::flush;
+    // The first launch warms the instruction cache, the second is the one measured
+    long long cycles = 0;
+    unsigned int iterations = latencyIterations;
+    void* latencyArgs[] = {&d_out, &d_cycles, &seed, &iterations};
+    for (int run = 0; run < 2; ++run) {
+      HIP_ERR(hipModuleLaunchKernel(latencyFuncs[i], 1, 1, 1, 1, 1, 1, 0, stream, latencyArgs, nullptr));
+      HIP_ERR(hipStreamSynchronize(stream));
+    }
+    HIP_ERR(hipMemcpy(&cycles, d_cycles, sizeof(cycles), hipMemcpyDeviceToHost));
+
+    // Double the iterations until one launch takes 20 ms, so the slow instructions stay short
+    iterations = 256;
+    double milliseconds = throughput(throughputFuncs[i], iterations);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = throughput(throughputFuncs[i], iterations);
+    }
+    totalMilliseconds += milliseconds;
+    double latency = static_cast<double>(cycles) / latencyIterations;
+    valid = valid && latency > 0.0 && milliseconds > 0.0;
+    rates.push_back({instructions[i].name, instructions[i].key, latency, static_cast<double>(threads) * iterations * 8, milliseconds});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipFree(d_cycles));
+
+  std::cout << "\r" << HIP << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Microbench::reportInstructionMix(HIP, "instruction_mix", rates, clockKilohertz * 1e3, static_cast<unsigned int>(multiProcessorCount));
+  Suite::record("instruction_mix", static_cast<float>(totalMilliseconds), valid);
+  return static_cast<float>(totalMilliseconds);
+}
+
+// A copy and an FMA loop, each plain and with high register pressure, at every block size and dynamic shared memory
+// reservation, next to the occupancy the driver calculates for that configuration
+float HIPBackend::runOccupancyBenchmark(const std::vector<hipFunction_t>& funcs, size_t totalMemory, size_t sharedMemPerBlock,
+                                        int maxThreadsPerMultiProcessor, int multiProcessorCount) {
+  const std::vector<Microbench::OccupancyKernel>& kernels = Microbench::occupancyKernels();
+  TRACE_SCOPE("26) Occupancy", "test");
+  std::cout << HIP << "26) Occupancy (" << kernels.size() << " kernels, block size and shared memory sweep)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 2048;
+  unsigned long long elements = std::min<size_t>(256 << 20, totalMemory / 8) / 16;
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_in = 0, d_out = 0, d_results = 0;
+  HIP_ERR(hipMalloc(&d_in, elements * 16));
+  HIP_ERR(hipMalloc(&d_out, elements * 16));
+  HIP_ERR(hipMalloc(&d_results, threads * sizeof(float)));
+  HIP_ERR(hipMemset(d_in, 0, elements * 16));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  auto timed = [&](hipFunction_t function, unsigned int blockSize, size_t sharedBytes, void** args) {
+    float milliseconds = 0.0f;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(function, static_cast<unsigned int>(threads / blockSize), 1, 1, blockSize, 1, 1,
+                                  static_cast<unsigned int>(sharedBytes), stream, args, nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::OccupancyCurve> curves;
+  double totalMilliseconds = 0.0;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    TRACE_SCOPE("Occupancy kernel", "kernel");
+    int registers = 0, maxBlockSize = 0;
+    HIP_ERR(hipFuncGetAttribute(&registers, 4, funcs[k]));    // HIP_FUNC_ATTRIBUTE_NUM_REGS
+    HIP_ERR(hipFuncGetAttribute(&maxBlockSize, 0, funcs[k])); // HIP_FUNC_ATTRIBUTE_MAX_THREADS_PER_BLOCK
+    Microbench::OccupancyCurve curve{&kernels[k], registers, static_cast<size_t>(maxBlockSize), {}};
+    unsigned int iterations = Microbench::occupancyFmasPerThread / kernels[k].perThread;
+    void* computeArgs[] = {&d_results, &iterations};
+    void* memoryArgs[] = {&d_in, &d_out, &elements};
+    const double work = kernels[k].compute ? static_cast<double>(threads) * Microbench::occupancyFmasPerThread * 2 : elements * 16.0 * 2;
+    for (unsigned int blockSize : Microbench::occupancyBlockSizes()) {
+      if (blockSize > static_cast<unsigned int>(maxBlockSize))
+        continue;
+      std::cout << "\r" << HIP << "26) Occupancy (" << kernels[k].name << ", blocks of " << blockSize << ")...          " << std::flush;
+      for (size_t sharedBytes : Microbench::occupancySharedBytes()) {
+        int residentBlocks = 0;
+        if (sharedBytes <= sharedMemPerBlock)
+          HIP_ERR(hipModuleOccupancyMaxActiveBlocksPerMultiprocessor(&residentBlocks, funcs[k], static_cast<int>(blockSize),
+                                                                     sharedBytes));
+        if (residentBlocks == 0)
+          continue;
+        // Best of two, the first also warms up the configuration
+        double milliseconds = timed(funcs[k], blockSize, sharedBytes, kernels[k].compute ? computeArgs : memoryArgs);
+        milliseconds = std::min(milliseconds, timed(funcs[k], blockSize, sharedBytes, kernels[k].compute ? computeArgs : memoryArgs));
+        totalMilliseconds += milliseconds;
+        double occupancy = static_cast<double>(residentBlocks) * blockSize / maxThreadsPerMultiProcessor;
+        curve.points.push_back({blockSize, sharedBytes, occupancy, work, milliseconds});
+      }
+    }
+    curves.push_back(curve);
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_in));
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipFree(d_results));
+
+  std::cout << "\r" << HIP << "26) Occupancy (" << kernels.size() << " kernels, block size and shared memory sweep)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportOccupancy(HIP, "occupancy", curves);
+  Suite::record("occupancy", static_cast<float>(totalMilliseconds));
+  return static_cast<float>(totalMilliseconds);
+}
+
+// divergenceKernel with the threads split over its four paths in every pattern of Microbench::divergencePatterns().
+// Every pattern runs the rounds that take the uniform one 20 ms.
+float HIPBackend::runDivergenceBenchmark(unsigned int threadsPerBlock, HIPBackend::hipFunction_t divergenceFunc, int warpSize,
+                                          int multiProcessorCount) {
+  const std::vector<Microbench::DivergencePattern>& patterns = Microbench::divergencePatterns();
+  TRACE_SCOPE("27) Divergence", "test");
+  std::cout << HIP << "27) Divergence (" << patterns.size() << " patterns, wavefronts of " << warpSize << ")..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_out = 0, d_paths = 0;
+  HIP_ERR(hipMalloc(&d_out, threads * sizeof(float)));
+  HIP_ERR(hipMalloc(&d_paths, threads * sizeof(unsigned int)));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  unsigned int rounds = 16;
+  auto timed = [&]() {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_out, &d_paths, &rounds};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(divergenceFunc, static_cast<unsigned int>(threads / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream,
+                                  args, nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::DivergenceResult> results;
+  for (size_t p = 0; p < patterns.size(); ++p) {
+    std::cout << "\r" << HIP << "27) Divergence (" << patterns[p].name << ")...          " << std::flush;
+    const std::vector<unsigned int> paths = Microbench::divergencePaths(p, threads, static_cast<unsigned int>(warpSize));
+    HIP_ERR(hipMemcpy(d_paths, paths.data(), paths.size() * sizeof(unsigned int), hipMemcpyHostToDevice));
+    double milliseconds = timed();
+    while (p == 0 && milliseconds < 20.0 && rounds < (1u << 20)) {
+      rounds *= 2;
+      milliseconds = timed();
+    }
+    double fmas = static_cast<double>(threads) * rounds * Microbench::divergenceFmasPerRound;
+    results.push_back({&patterns[p], Microbench::pathsPerWarp(paths, static_cast<unsigned int>(warpSize)), fmas, milliseconds});
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_out));
+  HIP_ERR(hipFree(d_paths));
+
+  std::cout << "\r" << HIP << "27) Divergence (" << patterns.size() << " patterns, wavefronts of " << warpSize << ")...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportDivergence(HIP, "divergence", results, static_cast<unsigned int>(warpSize));
+  float milliseconds = static_cast<float>(results[0].milliseconds);
+  Suite::record("divergence", milliseconds);
+  return milliseconds;
+}
+
+// Every operation of Microbench::atomicOperations() on global and on shared memory counters, at every contention of
+// Microbench::atomicContentions(), with two blocks per CU. A compare-and-swap loop costs about the square of the threads
+// contending for its address, so global ones on few addresses run as one block.
+float HIPBackend::runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<hipFunction_t>& globalFuncs,
+                                      const std::vector<hipFunction_t>& sharedFuncs, int multiProcessorCount) {
+  const std::vector<Microbench::AtomicOperation>& operations = Microbench::atomicOperations();
+  const std::vector<Microbench::AtomicContention>& contentions = Microbench::atomicContentions();
+  TRACE_SCOPE("28) Atomics", "test");
+  std::cout << HIP << "28) Atomics (" << operations.size() << " operations, global and shared)..." << std::flush;
+  const size_t threads = static_cast<size_t>(multiProcessorCount) * 2 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  hipDeviceptr_t d_counters = 0;
+  HIP_ERR(hipMalloc(&d_counters, threads * sizeof(unsigned long long)));
+  HIP_ERR(hipMemset(d_counters, 0, threads * sizeof(unsigned long long)));
+  allocSpan.end();
+
+  hipStream_t stream = acquireStream();
+  hipEvent_t startEvent = acquireEvent();
+  hipEvent_t stopEvent = acquireEvent();
+  auto timed = [&](hipFunction_t func, size_t launched, unsigned int addresses, unsigned int iterations) {
+    float milliseconds = 0.0f;
+    void* args[] = {&d_counters, &addresses, &iterations};
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    HIP_ERR(hipEventRecord(startEvent, stream));
+    HIP_ERR(hipModuleLaunchKernel(func, static_cast<unsigned int>(launched / threadsPerBlock), 1, 1, threadsPerBlock, 1, 1, 0, stream, args,
+                                  nullptr));
+    HIP_ERR(hipEventRecord(stopEvent, stream));
+    HIP_ERR(hipEventSynchronize(stopEvent));
+    HIP_ERR(hipEventElapsedTime(&milliseconds, startEvent, stopEvent));
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan(streamTrack(stream), "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return static_cast<double>(milliseconds);
+  };
+
+  std::vector<Microbench::AtomicResult> results;
+  for (bool shared : {false, true}) {
+    for (size_t o = 0; o < operations.size(); ++o) {
+      for (const Microbench::AtomicContention& contention : contentions) {
+        // A block has at most threadsPerBlock shared counters, so larger counts repeat "1 per thread"
+        if (shared && contention.addresses >= threadsPerBlock) {
+          results.push_back({&operations[o], shared, &contention, 0.0, 0.0, false});
+          continue;
+        }
+        std::cout << "\r" << HIP << "28) Atomics (" << (shared ? "shared " : "global ") << operations[o].name << ", " << contention.name
+                  << ")...          " << std::flush;
+        hipFunction_t func = shared ? sharedFuncs[o] : globalFuncs[o];
+        const bool oneBlock = !shared && operations[o].casLoop && contention.addresses != 0 &&
+                              contention.addresses <= Microbench::casLoopBlockAddresses;
+        const size_t launched = oneBlock ? threadsPerBlock : threads;
+        unsigned int iterations = 1;
+        double milliseconds = timed(func, launched, contention.addresses, iterations);
+        while (milliseconds < 20.0 && iterations < (1u << 16)) {
+          iterations *= 2;
+          milliseconds = timed(func, launched, contention.addresses, iterations);
+        }
+        results.push_back({&operations[o], shared, &contention, static_cast<double>(launched) * iterations, milliseconds, oneBlock});
+      }
+    }
+  }
+  releaseEvent(startEvent);
+  releaseEvent(stopEvent);
+  releaseStream(stream);
+  HIP_ERR(hipFree(d_counters));
+
+  std::cout << "\r" << HIP << "28) Atomics (" << operations.size() << " operations, global and shared)...";
+  std::cout << GREEN << " PASSED" << RESET << "                    \n";
+  Microbench::reportAtomics(HIP, "atomics", results);
+  float milliseconds = static_cast<float>(Microbench::histogramMilliseconds(results));
+  Suite::record("atomics", milliseconds);
+  return milliseconds;
+}
+
 void HIPBackend::shutdown() {
   if (rsmi_shut_down != nullptr)
     rsmi_shut_down();
@@ -520,6 +2715,29 @@ void HIPBackend::shutdown() {
   hipModuleLaunchKernel = nullptr;
   hipMemset = nullptr;
   hipGetErrorString = nullptr;
+  hipMemcpyAsync = nullptr;
+  hipDeviceSynchronize = nullptr;
+  hipDeviceCanAccessPeer = nullptr;
+  hipDeviceEnablePeerAccess = nullptr;
+  hipDeviceDisablePeerAccess = nullptr;
+  hipMemcpyPeer = nullptr;
+  hipHostGetDevicePointer = nullptr;
+  hipHostRegister = nullptr;
+  hipHostUnregister = nullptr;
+  hipMallocManaged = nullptr;
+  hipMemPrefetchAsync = nullptr;
+  hipStreamSynchronize = nullptr;
+  hipMallocAsync = nullptr;
+  hipFreeAsync = nullptr;
+  hipDeviceGetDefaultMemPool = nullptr;
+  hipMemPoolSetAttribute = nullptr;
+  hipMemPoolGetAttribute = nullptr;
+  hipMallocPitch = nullptr;
+  hipMemcpy2D = nullptr;
+  hipModuleOccupancyMaxActiveBlocksPerMultiprocessor = nullptr;
+  hipFuncGetAttribute = nullptr;
+  hipDeviceGetAttribute = nullptr;
+  hipMemcpy3D = nullptr;
 
   closeLibrary(hipHandle);
   closeLibrary(rsmiHandle);
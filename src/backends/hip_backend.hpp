@@ -1,7 +1,10 @@
 #pragma once
 
+#include "../gpumark.hpp"
+#include <array>
 #include <cstdint>
 #include <stddef.h>
+#include <vector>
 
 namespace HIPBackend {
 static void* hipHandle = nullptr;
@@ -13,22 +16,68 @@ bool memUtilizationSafe(int dev);
 int64_t getAndPrintTemperature(int dev);
 bool slowBenchmarks(float linearSetTime, float linearMultiplyTime);
 void prepareDeviceForBenchmarking(int dev);
-void runBenchmark();
+std::vector<GPUMark::Device> enumerateDevices();
+std::vector<GPUMark::PeerLink> runPeerToPeerBenchmark(const std::vector<int>& devices);
 void shutdown();
 
 typedef struct hipEvent* hipEvent_t;
 typedef struct hipStream* hipStream_t;
+typedef struct ihipMemPoolHandle_t* hipMemPool_t;
 typedef struct hipModule* hipModule_t;
 typedef struct hipFunction* hipFunction_t;
 typedef void* hipDeviceptr_t;
 
-float runLinearSetBenchmark(unsigned int threadsPerBlock, hipFunction_t linearSetFunc);
-float runLinearMultiplyBenchmark(unsigned int threadsPerBlock, hipFunction_t linearMultiplyFunc);
+float runLinearSetBenchmark(unsigned int threadsPerBlock, hipFunction_t linearSetFunc, int hostNode);
+float runLinearMultiplyBenchmark(unsigned int threadsPerBlock, hipFunction_t linearMultiplyFunc, int hostNode);
 float runFmaBenchmark(unsigned int threadsPerBlock, hipFunction_t fmaFunc);
 float runIntegerThroughputBenchmark(unsigned int threadsPerBlock, hipFunction_t integerThroughputFunc);
-float runSharedMemoryBenchmark(unsigned int threadsPerBlock, hipFunction_t sharedMemoryFunc);
-float runSgemmBenchmark(unsigned int threadsPerBlock, hipFunction_t sgemmFunc);
-float runPCIEThroughputBenchmark();
+float runSharedMemoryBenchmark(unsigned int threadsPerBlock, hipFunction_t sharedMemoryFunc, int clockKilohertz, int multiProcessorCount);
+float runSgemmBenchmark(hipFunction_t naiveFunc, hipFunction_t tiledFunc, hipFunction_t registerFunc);
+float runPCIEThroughputBenchmark(int hostNode);
+float runStreamEventOverheadBenchmark();
+float runTransferSweepBenchmark(size_t totalMemory);
+float runBidirectionalPCIEBenchmark(size_t totalMemory);
+float runCopyComputeOverlapBenchmark(unsigned int threadsPerBlock, hipFunction_t linearMultiplyFunc, size_t totalMemory);
+float runPointerChaseBenchmark(hipFunction_t initFunc, hipFunction_t chaseFunc, size_t totalMemory);
+float runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<hipFunction_t, 3>& kernels, size_t totalMemory, unsigned int warpSize);
+float runStreamBenchmark(unsigned int threadsPerBlock, hipFunction_t initFunc, const std::array<hipFunction_t, 12>& kernels, size_t totalMemory,
+                         int multiProcessorCount);
+float runZeroCopyBenchmark(unsigned int threadsPerBlock, hipFunction_t scaleFunc, size_t totalMemory, int multiProcessorCount);
+float runHostRegistrationBenchmark(size_t totalMemory);
+float runManagedMemoryBenchmark(unsigned int threadsPerBlock, hipFunction_t incrementFunc, int dev, size_t totalMemory, int multiProcessorCount,
+                                bool concurrentManagedAccess);
+float runAllocationBenchmark(int dev, size_t totalMemory);
+float runCopyEngineBenchmark(unsigned int threadsPerBlock, hipFunction_t copyFunc, hipFunction_t pitchedCopyFunc, hipFunction_t volumeCopyFunc,
+                             size_t totalMemory, int multiProcessorCount);
+float runOutOfCoreBenchmark(unsigned int threadsPerBlock, hipFunction_t checksumFunc, size_t totalMemory, int multiProcessorCount);
+float runIngestBenchmark();
+float runNumaPlacementBenchmark(int hostNode);
+float runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<hipFunction_t, 5>& multiplyAddFuncs,
+                            const std::array<hipFunction_t, 5>& gemmFuncs, int multiProcessorCount, bool hasDoubles, int doubleRatio);
+float runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<hipFunction_t>& latencyFuncs,
+                                 const std::vector<hipFunction_t>& throughputFuncs, int clockKilohertz, int multiProcessorCount);
+float runOccupancyBenchmark(const std::vector<hipFunction_t>& funcs, size_t totalMemory, size_t sharedMemPerBlock, int maxThreadsPerMultiProcessor,
+                            int multiProcessorCount);
+float runDivergenceBenchmark(unsigned int threadsPerBlock, hipFunction_t divergenceFunc, int warpSize, int multiProcessorCount);
+float runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<hipFunction_t>& globalFuncs, const std::vector<hipFunction_t>& sharedFuncs,
+                          int multiProcessorCount);
+
+// Per-device execution context. Streams and timing events are created once per device
+// and recycled across tests, so driver object creation stays out of the timed regions.
+struct ExecutionContext {
+  std::vector<hipStream_t> streams; // Every stream owned by the pool
+  std::vector<hipStream_t> freeStreams;
+  std::vector<hipEvent_t> events; // Every event owned by the pool
+  std::vector<hipEvent_t> freeEvents;
+};
+extern ExecutionContext execContext;
+
+void createExecutionContext(unsigned int streamCount, unsigned int eventCount);
+void destroyExecutionContext();
+hipStream_t acquireStream();
+void releaseStream(hipStream_t stream);
+hipEvent_t acquireEvent();
+void releaseEvent(hipEvent_t event);
 
 // ------------------------
 // HIP typedefs
@@ -40,8 +89,17 @@ typedef enum hipError_t {
   hipErrorNotInitialized = 3,
   hipErrorDeinitialized = 4,
   /* ... MANY MORE ... */
+  hipErrorPeerAccessAlreadyEnabled = 704,
   hipErrorUnknown = 999
 } hipError_t;
+#define hipHostMallocPortable 0x1
+#define hipHostMallocMapped 0x2
+#define hipMemAttachGlobal 0x1
+#define hipCpuDeviceId -1
+#define hipMemPoolAttrReleaseThreshold 4
+#define hipMemPoolAttrReservedMemCurrent 5
+#define hipMemPoolAttrUsedMemCurrent 7
+#define hipDeviceAttributeMemoryPoolsSupported 88
 typedef enum hipMemcpyKind {
   hipMemcpyHostToHost = 0,
   hipMemcpyHostToDevice = 1,
@@ -49,6 +107,28 @@ typedef enum hipMemcpyKind {
   hipMemcpyDeviceToDevice = 3,
   hipMemcpyDefault = 4
 } hipMemcpyKind;
+struct hipPos {
+  size_t x, y, z;
+};
+struct hipPitchedPtr {
+  void* ptr;
+  size_t pitch;
+  size_t xsize;
+  size_t ysize; // Rows per slice
+};
+struct hipExtent {
+  size_t width, height, depth;
+};
+struct hipMemcpy3DParms {
+  void* srcArray;
+  hipPos srcPos;
+  hipPitchedPtr srcPtr;
+  void* dstArray;
+  hipPos dstPos;
+  hipPitchedPtr dstPtr;
+  hipExtent extent;
+  hipMemcpyKind kind;
+};
 typedef struct hipUUID {
   char bytes[16];
 } hipUUID;
@@ -243,6 +323,29 @@ typedef hipError_t (*hipModuleUnload_t)(hipModule_t);
 typedef hipError_t (*hipModuleGetFunction_t)(hipFunction_t*, hipModule_t, const char*);
 typedef hipError_t (*hipModuleLaunchKernel_t)(hipFunction_t, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int,
                                               unsigned int, hipStream_t, void**, void**);
+typedef hipError_t (*hipMemcpyAsync_t)(void*, const void*, size_t, hipMemcpyKind, hipStream_t);
+typedef hipError_t (*hipDeviceSynchronize_t)();
+typedef hipError_t (*hipDeviceCanAccessPeer_t)(int*, int, int);
+typedef hipError_t (*hipDeviceEnablePeerAccess_t)(int, unsigned int);
+typedef hipError_t (*hipDeviceDisablePeerAccess_t)(int);
+typedef hipError_t (*hipMemcpyPeer_t)(void*, int, const void*, int, size_t);
+typedef hipError_t (*hipHostGetDevicePointer_t)(void**, void*, unsigned int);
+typedef hipError_t (*hipHostRegister_t)(void*, size_t, unsigned int);
+typedef hipError_t (*hipHostUnregister_t)(void*);
+typedef hipError_t (*hipMallocManaged_t)(void**, size_t, unsigned int);
+typedef hipError_t (*hipMemPrefetchAsync_t)(const void*, size_t, int, hipStream_t);
+typedef hipError_t (*hipStreamSynchronize_t)(hipStream_t);
+typedef hipError_t (*hipMallocAsync_t)(void**, size_t, hipStream_t);
+typedef hipError_t (*hipFreeAsync_t)(void*, hipStream_t);
+typedef hipError_t (*hipDeviceGetDefaultMemPool_t)(hipMemPool_t*, int);
+typedef hipError_t (*hipMemPoolSetAttribute_t)(hipMemPool_t, int, void*);
+typedef hipError_t (*hipMemPoolGetAttribute_t)(hipMemPool_t, int, void*);
+typedef hipError_t (*hipMallocPitch_t)(void**, size_t*, size_t, size_t);
+typedef hipError_t (*hipMemcpy2D_t)(void*, size_t, const void*, size_t, size_t, size_t, hipMemcpyKind);
+typedef hipError_t (*hipModuleOccupancyMaxActiveBlocksPerMultiprocessor_t)(int*, hipFunction_t, int, size_t);
+typedef hipError_t (*hipFuncGetAttribute_t)(int*, int, hipFunction_t);
+typedef hipError_t (*hipDeviceGetAttribute_t)(int*, int, int);
+typedef hipError_t (*hipMemcpy3D_t)(const hipMemcpy3DParms*);
 // Error
 typedef const char* (*hipGetErrorString_t)(hipError_t);
 
@@ -285,6 +388,29 @@ extern hipModuleLoadData_t hipModuleLoadData;
 extern hipModuleUnload_t hipModuleUnload;
 extern hipModuleGetFunction_t hipModuleGetFunction;
 extern hipModuleLaunchKernel_t hipModuleLaunchKernel;
+extern hipMemcpyAsync_t hipMemcpyAsync;
+extern hipDeviceSynchronize_t hipDeviceSynchronize;
+extern hipDeviceCanAccessPeer_t hipDeviceCanAccessPeer;
+extern hipDeviceEnablePeerAccess_t hipDeviceEnablePeerAccess;
+extern hipDeviceDisablePeerAccess_t hipDeviceDisablePeerAccess;
+extern hipMemcpyPeer_t hipMemcpyPeer;
+extern hipHostGetDevicePointer_t hipHostGetDevicePointer;
+extern hipHostRegister_t hipHostRegister;
+extern hipHostUnregister_t hipHostUnregister;
+extern hipMallocManaged_t hipMallocManaged;
+extern hipMemPrefetchAsync_t hipMemPrefetchAsync;
+extern hipStreamSynchronize_t hipStreamSynchronize;
+extern hipMallocAsync_t hipMallocAsync;
+extern hipFreeAsync_t hipFreeAsync;
+extern hipDeviceGetDefaultMemPool_t hipDeviceGetDefaultMemPool;
+extern hipMemPoolSetAttribute_t hipMemPoolSetAttribute;
+extern hipMemPoolGetAttribute_t hipMemPoolGetAttribute;
+extern hipMallocPitch_t hipMallocPitch;
+extern hipMemcpy2D_t hipMemcpy2D;
+extern hipModuleOccupancyMaxActiveBlocksPerMultiprocessor_t hipModuleOccupancyMaxActiveBlocksPerMultiprocessor;
+extern hipFuncGetAttribute_t hipFuncGetAttribute;
+extern hipDeviceGetAttribute_t hipDeviceGetAttribute;
+extern hipMemcpy3D_t hipMemcpy3D;
 // Error
 extern hipGetErrorString_t hipGetErrorString;
 // RSMI
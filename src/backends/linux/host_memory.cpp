@@ -0,0 +1,129 @@
+#include "../../shared/host_memory.hpp"
+#include "../../gpumark.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t hugePageBytes = 2ull << 20;
+constexpr int MPOL_BIND = 2; // From linux/mempolicy.h, kept here so libnuma's headers are not needed
+
+std::string readLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// "0-3,8,10-11" as used by sysfs cpulist and node lists
+std::vector<int> parseList(const std::string& text) {
+  std::vector<int> values;
+  std::istringstream ranges(text);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    int first = 0, last = 0;
+    int matched = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+    if (matched < 1)
+      continue;
+    if (matched == 1)
+      last = first;
+    for (int value = first; value <= last; ++value) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+size_t freeHugePages(int node) {
+  std::string path = node >= 0 ? "/sys/devices/system/node/node" + std::to_string(node) + "/hugepages/hugepages-2048kB/free_hugepages"
+                               : "/sys/kernel/mm/hugepages/hugepages-2048kB/free_hugepages";
+  std::string line = readLine(path);
+  return line.empty() ? 0 : std::stoull(line);
+}
+} // namespace
+
+int HostMemory::deviceNode(int pciDomain, int pciBus, int pciDevice) {
+  char address[32];
+  std::snprintf(address, sizeof(address), "%04x:%02x:%02x.0", pciDomain, pciBus, pciDevice);
+  std::string line = readLine(std::string("/sys/bus/pci/devices/") + address + "/numa_node");
+  return line.empty() ? -1 : std::stoi(line);
+}
+
+std::vector<int> HostMemory::nodes() {
+  std::vector<int> online = parseList(readLine("/sys/devices/system/node/online"));
+  return online.empty() ? std::vector<int>{0} : online;
+}
+
+void* HostMemory::allocate(size_t bytes, int node, bool hugePages, Placement* placement) {
+  const size_t rounded = (bytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes;
+  Pages got = Pages::Small;
+  void* data = MAP_FAILED;
+  // Only ask for explicit huge pages the node has free, as a bound mapping that runs out faults with SIGBUS
+  if (hugePages && freeHugePages(node) >= rounded / hugePageBytes) {
+    data = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED)
+      got = Pages::Huge;
+  }
+  if (data == MAP_FAILED) {
+    data = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED)
+      throw GPUMark::Error("Cannot map " + std::to_string(bytes) + " bytes of host memory: " + std::strerror(errno));
+    if (hugePages && madvise(data, rounded, MADV_HUGEPAGE) == 0)
+      got = Pages::Transparent;
+    else if (!hugePages)
+      madvise(data, rounded, MADV_NOHUGEPAGE);
+  }
+  bool bound = false;
+  if (node >= 0) {
+    std::vector<unsigned long> mask(node / 64 + 1, 0);
+    mask[node / 64] = 1ul << (node % 64);
+    // The kernel reads one bit less than maxnode says. Containers without CAP_SYS_NICE may refuse this.
+    bound = syscall(__NR_mbind, data, rounded, MPOL_BIND, mask.data(), mask.size() * 64 + 1, 0) == 0;
+  }
+  // First touch places every page under the policy above
+  const size_t stride = got == Pages::Huge ? hugePageBytes : 4096;
+  for (size_t offset = 0; offset < rounded; offset += stride) {
+    static_cast<volatile char*>(data)[offset] = 0;
+  }
+  if (placement)
+    *placement = {got, bound};
+  return data;
+}
+
+void HostMemory::release(void* data, size_t bytes) {
+  if (data)
+    munmap(data, (bytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes);
+}
+
+HostMemory::ThreadPin::ThreadPin(int node) {
+  if (node < 0)
+    return;
+  std::vector<int> cpus = parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+  if (cpus.empty())
+    return;
+  cpu_set_t current, wanted;
+  if (sched_getaffinity(0, sizeof(current), &current) != 0)
+    return;
+  CPU_ZERO(&wanted);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &current))
+      CPU_SET(cpu, &wanted);
+  }
+  // A cgroup or taskset that leaves none of the node's CPUs wins over placement
+  if (CPU_COUNT(&wanted) == 0 || sched_setaffinity(0, sizeof(wanted), &wanted) != 0)
+    return;
+  previous.assign(reinterpret_cast<unsigned char*>(&current), reinterpret_cast<unsigned char*>(&current) + sizeof(current));
+  active = true;
+}
+
+HostMemory::ThreadPin::~ThreadPin() {
+  if (active)
+    sched_setaffinity(0, previous.size(), reinterpret_cast<const cpu_set_t*>(previous.data()));
+}
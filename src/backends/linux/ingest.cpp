@@ -0,0 +1,220 @@
+#include "../../shared/ingest.hpp"
+#include "../../gpumark.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+std::string systemError(const std::string& what, int error) { return what + ": " + std::strerror(error); }
+
+// One synchronous pread per submit, for kernels without io_uring or where it is blocked (seccomp, containers)
+class PreadReader : public Ingest::FileReader {
+public:
+  PreadReader(int fd, bool directIo) : fd(fd), directIo(directIo) {}
+  ~PreadReader() override { close(fd); }
+
+  void submit(void* buffer, size_t bytes, unsigned long long offset, unsigned int tag) override {
+    size_t done = 0;
+    while (done < bytes) {
+      ssize_t result = pread(fd, static_cast<char*>(buffer) + done, bytes - done, static_cast<off_t>(offset + done));
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result < 0)
+        throw GPUMark::Error(systemError("pread failed", errno));
+      if (result == 0)
+        break;
+      done += static_cast<size_t>(result);
+    }
+    finished.push_back({tag, done});
+  }
+
+  unsigned int wait(size_t& bytesRead) override {
+    auto [tag, bytes] = finished.front();
+    finished.pop_front();
+    bytesRead = bytes;
+    return tag;
+  }
+
+  std::string method() const override { return directIo ? "pread, O_DIRECT" : "pread"; }
+  bool direct() const override { return directIo; }
+
+private:
+  int fd;
+  bool directIo;
+  std::deque<std::pair<unsigned int, size_t>> finished;
+};
+
+// Talks to io_uring through the raw system calls so there is no liburing dependency. Reads are queued on the
+// submission ring and reaped from the completion ring; a read that comes back short before the end of the file is
+// queued again for the rest.
+class UringReader : public Ingest::FileReader {
+public:
+  UringReader(int fd, bool directIo) : fd(fd), directIo(directIo) {}
+
+  // The file descriptor is only closed once setup() succeeded, otherwise it is handed on to a PreadReader
+  ~UringReader() override {
+    if (ringFd >= 0) {
+      release();
+      close(fd);
+    }
+  }
+
+  // False if this kernel cannot do IORING_OP_READ
+  bool setup(unsigned int depth) {
+    io_uring_params params = {};
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    // IORING_FEAT_RW_CUR_POS arrived in the same release (5.6) as IORING_OP_READ
+    if (ringFd < 0 || !(params.features & IORING_FEAT_RW_CUR_POS)) {
+      release();
+      return false;
+    }
+    sqBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+      sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+    sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqRing = map(sqBytes, IORING_OFF_SQ_RING);
+    cqRing = singleMap ? sqRing : map(cqBytes, IORING_OFF_CQ_RING);
+    sqes = static_cast<io_uring_sqe*>(map(sqeBytes, IORING_OFF_SQES));
+    if (!sqRing || !cqRing || !sqes) {
+      release();
+      return false;
+    }
+    char* sq = static_cast<char*>(sqRing);
+    char* cq = static_cast<char*>(cqRing);
+    sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sqMask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void submit(void* buffer, size_t bytes, unsigned long long offset, unsigned int tag) override {
+    if (tag >= requests.size())
+      requests.resize(tag + 1);
+    requests[tag] = {static_cast<char*>(buffer), bytes, offset, 0};
+    enqueue(tag);
+  }
+
+  unsigned int wait(size_t& bytesRead) override {
+    while (true) {
+      unsigned int head = *cqHead;
+      if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        enter(0, 1, IORING_ENTER_GETEVENTS);
+        continue;
+      }
+      io_uring_cqe cqe = cqes[head & cqMask];
+      __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+      unsigned int tag = static_cast<unsigned int>(cqe.user_data);
+      if (cqe.res < 0)
+        throw GPUMark::Error(systemError("io_uring read failed", -cqe.res));
+      Request& request = requests[tag];
+      request.done += static_cast<size_t>(cqe.res);
+      if (cqe.res > 0 && request.done < request.bytes) {
+        enqueue(tag);
+        continue;
+      }
+      bytesRead = request.done;
+      return tag;
+    }
+  }
+
+  std::string method() const override { return directIo ? "io_uring, O_DIRECT" : "io_uring"; }
+  bool direct() const override { return directIo; }
+
+private:
+  struct Request {
+    char* buffer;
+    size_t bytes;
+    unsigned long long offset;
+    size_t done;
+  };
+
+  void* map(size_t bytes, unsigned long long offset) {
+    void* ring = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, static_cast<off_t>(offset));
+    return ring == MAP_FAILED ? nullptr : ring;
+  }
+
+  void release() {
+    if (sqes)
+      munmap(sqes, sqeBytes);
+    if (cqRing && cqRing != sqRing)
+      munmap(cqRing, cqBytes);
+    if (sqRing)
+      munmap(sqRing, sqBytes);
+    if (ringFd >= 0)
+      close(ringFd);
+    sqes = nullptr;
+    sqRing = cqRing = nullptr;
+    ringFd = -1;
+  }
+
+  void enqueue(unsigned int tag) {
+    const Request& request = requests[tag];
+    unsigned int tail = *sqTail;
+    unsigned int index = tail & sqMask;
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<unsigned long long>(request.buffer + request.done);
+    sqe.len = static_cast<unsigned int>(request.bytes - request.done);
+    sqe.off = request.offset + request.done;
+    sqe.user_data = tag;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    enter(1, 0, 0);
+  }
+
+  void enter(unsigned int toSubmit, unsigned int minComplete, unsigned int flags) {
+    while (syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0) < 0) {
+      if (errno != EINTR)
+        throw GPUMark::Error(systemError("io_uring_enter failed", errno));
+    }
+  }
+
+  int fd;
+  bool directIo;
+  int ringFd = -1;
+  void* sqRing = nullptr;
+  void* cqRing = nullptr;
+  io_uring_sqe* sqes = nullptr;
+  size_t sqBytes = 0, cqBytes = 0, sqeBytes = 0;
+  unsigned int* sqTail = nullptr;
+  unsigned int* sqArray = nullptr;
+  unsigned int sqMask = 0;
+  unsigned int* cqHead = nullptr;
+  unsigned int* cqTail = nullptr;
+  unsigned int cqMask = 0;
+  io_uring_cqe* cqes = nullptr;
+  std::vector<Request> requests;
+};
+} // namespace
+
+std::unique_ptr<Ingest::FileReader> Ingest::openReader(const std::string& path, unsigned int depth, bool direct) {
+  int fd = direct ? open(path.c_str(), O_RDONLY | O_DIRECT) : -1;
+  // tmpfs and some network file systems refuse O_DIRECT
+  if (fd < 0) {
+    direct = false;
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw GPUMark::Error(systemError("Cannot open " + path, errno));
+    // Pages still dirty from writing the file cannot be dropped, so flush them first
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  }
+  auto uring = std::make_unique<UringReader>(fd, direct);
+  if (uring->setup(depth))
+    return uring;
+  return std::make_unique<PreadReader>(fd, direct);
+}
@@ -1,6 +1,7 @@
 #include "../../shared/shared.hpp"
 #include <dlfcn.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 
 void closeLibrary(void* handle) {
   if (handle) {
@@ -14,3 +15,11 @@ int get_terminal_width() {
     return 80; // fallback
   return w.ws_col;
 }
+
+unsigned long long getPhysicalMemory() {
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || pageSize <= 0)
+    return 0;
+  return static_cast<unsigned long long>(pages) * pageSize;
+}
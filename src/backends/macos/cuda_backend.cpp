@@ -26,6 +26,9 @@ bool CudaBackend::init() {
     return false;
   }
 
+// Entry points only newer drivers have. The tests that use them check for nullptr and skip what is missing.
+#define LOAD_OPTIONAL_CUDA_SYMBOL(sym) sym = (sym##_t)dlsym(cudaHandle, #sym)
+
 #define LOAD_CUDA_SYMBOL(sym)                                                                                                                        \
   sym = (sym##_t)dlsym(cudaHandle, #sym);                                                                                                            \
   if (!sym) {                                                                                                                                        \
@@ -34,6 +37,15 @@ bool CudaBackend::init() {
     return false;                                                                                                                                    \
   }
 
+// cuda.h maps these names to their _v2 entry points. The unversioned ones are the legacy ABI with 32-bit sizes.
+#define LOAD_CUDA_SYMBOL_V2(sym)                                                                                                                     \
+  sym = (sym##_t)dlsym(cudaHandle, #sym "_v2");                                                                                                      \
+  if (!sym) {                                                                                                                                        \
+    std::cerr << "Failed to load symbol for CUDA dylib " #sym "_v2: " << dlerror() << "\n";                                                          \
+    shutdown();                                                                                                                                      \
+    return false;                                                                                                                                    \
+  }
+
 #define LOAD_NVML_SYMBOL(sym)                                                                                                                        \
   sym = (sym##_t)dlsym(nvmlHandle, #sym);                                                                                                            \
   if (!sym) {                                                                                                                                        \
@@ -71,6 +83,32 @@ bool CudaBackend::init() {
   LOAD_CUDA_SYMBOL(cuDeviceTotalMem);
   LOAD_CUDA_SYMBOL(cuDeviceComputeCapability);
   LOAD_CUDA_SYMBOL(cuDeviceGetAttribute);
+  LOAD_CUDA_SYMBOL_V2(cuMemcpyHtoDAsync);
+  LOAD_CUDA_SYMBOL_V2(cuMemcpyDtoHAsync);
+  LOAD_CUDA_SYMBOL(cuCtxSetCurrent);
+  LOAD_CUDA_SYMBOL(cuMemHostAlloc);
+  LOAD_CUDA_SYMBOL(cuDeviceCanAccessPeer);
+  LOAD_CUDA_SYMBOL(cuCtxEnablePeerAccess);
+  LOAD_CUDA_SYMBOL(cuMemcpyPeer);
+  LOAD_CUDA_SYMBOL_V2(cuMemHostGetDevicePointer);
+  LOAD_CUDA_SYMBOL_V2(cuMemHostRegister);
+  LOAD_CUDA_SYMBOL(cuMemHostUnregister);
+  LOAD_CUDA_SYMBOL(cuMemAllocManaged);
+  LOAD_CUDA_SYMBOL(cuMemPrefetchAsync);
+  LOAD_CUDA_SYMBOL(cuStreamSynchronize);
+  LOAD_OPTIONAL_CUDA_SYMBOL(cuMemAllocAsync);
+  LOAD_OPTIONAL_CUDA_SYMBOL(cuMemFreeAsync);
+  LOAD_OPTIONAL_CUDA_SYMBOL(cuDeviceGetDefaultMemPool);
+  LOAD_OPTIONAL_CUDA_SYMBOL(cuMemPoolSetAttribute);
+  LOAD_OPTIONAL_CUDA_SYMBOL(cuMemPoolGetAttribute);
+  LOAD_CUDA_SYMBOL_V2(cuMemcpyDtoD);
+  LOAD_CUDA_SYMBOL_V2(cuMemAllocPitch);
+  LOAD_CUDA_SYMBOL_V2(cuMemcpy2D);
+  LOAD_CUDA_SYMBOL(cuOccupancyMaxActiveBlocksPerMultiprocessor);
+  LOAD_CUDA_SYMBOL(cuFuncGetAttribute);
+  LOAD_CUDA_SYMBOL(cuCtxGetCurrent);
+  LOAD_CUDA_SYMBOL_V2(cuCtxPopCurrent);
+  LOAD_CUDA_SYMBOL_V2(cuMemcpy3D);
 
   LOAD_CUDA_SYMBOL(cuGetErrorString);
 
@@ -83,6 +121,8 @@ bool CudaBackend::init() {
   LOAD_NVML_SYMBOL(nvmlDeviceGetMemoryInfo);
 
 #undef LOAD_CUDA_SYMBOL
+#undef LOAD_CUDA_SYMBOL_V2
+#undef LOAD_OPTIONAL_CUDA_SYMBOL
 #undef LOAD_NVML_SYMBOL
 
   if (cuInit(0) != 0) {
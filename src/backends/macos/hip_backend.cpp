@@ -27,6 +27,9 @@ bool HIPBackend::init() {
     return false;
   }
 
+// Entry points only newer drivers have. The tests that use them check for nullptr and skip what is missing.
+#define LOAD_OPTIONAL_HIP_SYMBOL(sym) sym = (sym##_t)dlsym(hipHandle, #sym);
+
 #define LOAD_HIP_SYMBOL(sym)                                                                                                                         \
   sym = (sym##_t)dlsym(hipHandle, #sym);                                                                                                             \
   if (!sym) {                                                                                                                                        \
@@ -66,6 +69,29 @@ bool HIPBackend::init() {
   LOAD_HIP_SYMBOL(hipModuleUnload)
   LOAD_HIP_SYMBOL(hipModuleGetFunction)
   LOAD_HIP_SYMBOL(hipModuleLaunchKernel)
+  LOAD_HIP_SYMBOL(hipMemcpyAsync)
+  LOAD_HIP_SYMBOL(hipDeviceSynchronize)
+  LOAD_HIP_SYMBOL(hipDeviceCanAccessPeer)
+  LOAD_HIP_SYMBOL(hipDeviceEnablePeerAccess)
+  LOAD_HIP_SYMBOL(hipDeviceDisablePeerAccess)
+  LOAD_HIP_SYMBOL(hipMemcpyPeer)
+  LOAD_HIP_SYMBOL(hipHostGetDevicePointer)
+  LOAD_HIP_SYMBOL(hipHostRegister)
+  LOAD_HIP_SYMBOL(hipHostUnregister)
+  LOAD_HIP_SYMBOL(hipMallocManaged)
+  LOAD_HIP_SYMBOL(hipMemPrefetchAsync)
+  LOAD_HIP_SYMBOL(hipStreamSynchronize)
+  LOAD_OPTIONAL_HIP_SYMBOL(hipMallocAsync)
+  LOAD_OPTIONAL_HIP_SYMBOL(hipFreeAsync)
+  LOAD_OPTIONAL_HIP_SYMBOL(hipDeviceGetDefaultMemPool)
+  LOAD_OPTIONAL_HIP_SYMBOL(hipMemPoolSetAttribute)
+  LOAD_OPTIONAL_HIP_SYMBOL(hipMemPoolGetAttribute)
+  LOAD_HIP_SYMBOL(hipMallocPitch)
+  LOAD_HIP_SYMBOL(hipMemcpy2D)
+  LOAD_HIP_SYMBOL(hipModuleOccupancyMaxActiveBlocksPerMultiprocessor)
+  LOAD_HIP_SYMBOL(hipFuncGetAttribute)
+  LOAD_HIP_SYMBOL(hipDeviceGetAttribute)
+  LOAD_HIP_SYMBOL(hipMemcpy3D)
   LOAD_HIP_SYMBOL(hipGetErrorString)
 
   LOAD_RSMI_SYMBOL(rsmi_init)
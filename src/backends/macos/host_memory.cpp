@@ -0,0 +1,33 @@
+#include "../../shared/host_memory.hpp"
+#include "../../gpumark.hpp"
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+
+// Macs have a single memory node and no way to ask for huge pages from user space, so this is plain page-aligned memory
+
+int HostMemory::deviceNode(int, int, int) { return -1; }
+
+std::vector<int> HostMemory::nodes() { return {0}; }
+
+void* HostMemory::allocate(size_t bytes, int, bool, Placement* placement) {
+  void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (data == MAP_FAILED)
+    throw GPUMark::Error("Cannot map " + std::to_string(bytes) + " bytes of host memory: " + std::strerror(errno));
+  for (size_t offset = 0; offset < bytes; offset += 4096) {
+    static_cast<volatile char*>(data)[offset] = 0;
+  }
+  if (placement)
+    *placement = {};
+  return data;
+}
+
+void HostMemory::release(void* data, size_t bytes) {
+  if (data)
+    munmap(data, bytes);
+}
+
+HostMemory::ThreadPin::ThreadPin(int) {}
+
+HostMemory::ThreadPin::~ThreadPin() {}
@@ -0,0 +1,54 @@
+#include "../../shared/ingest.hpp"
+#include "../../gpumark.hpp"
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+// macOS has no io_uring, so every submit is one synchronous pread. F_NOCACHE is the closest thing to O_DIRECT.
+class PreadReader : public Ingest::FileReader {
+public:
+  PreadReader(int fd, bool directIo) : fd(fd), directIo(directIo) {}
+  ~PreadReader() override { close(fd); }
+
+  void submit(void* buffer, size_t bytes, unsigned long long offset, unsigned int tag) override {
+    size_t done = 0;
+    while (done < bytes) {
+      ssize_t result = pread(fd, static_cast<char*>(buffer) + done, bytes - done, static_cast<off_t>(offset + done));
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result < 0)
+        throw GPUMark::Error(std::string("pread failed: ") + std::strerror(errno));
+      if (result == 0)
+        break;
+      done += static_cast<size_t>(result);
+    }
+    finished.push_back({tag, done});
+  }
+
+  unsigned int wait(size_t& bytesRead) override {
+    auto [tag, bytes] = finished.front();
+    finished.pop_front();
+    bytesRead = bytes;
+    return tag;
+  }
+
+  std::string method() const override { return directIo ? "pread, F_NOCACHE" : "pread"; }
+  bool direct() const override { return directIo; }
+
+private:
+  int fd;
+  bool directIo;
+  std::deque<std::pair<unsigned int, size_t>> finished;
+};
+} // namespace
+
+std::unique_ptr<Ingest::FileReader> Ingest::openReader(const std::string& path, unsigned int depth, bool direct) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw GPUMark::Error("Cannot open " + path + ": " + std::strerror(errno));
+  direct = fcntl(fd, F_NOCACHE, 1) == 0;
+  return std::make_unique<PreadReader>(fd, direct);
+}
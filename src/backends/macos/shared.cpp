@@ -1,6 +1,8 @@
 #include "../../shared/shared.hpp"
+#include <cstdint>
 #include <dlfcn.h>
 #include <sys/ioctl.h>
+#include <sys/sysctl.h>
 
 void closeLibrary(void* handle) {
   if (handle) {
@@ -14,3 +16,11 @@ int get_terminal_width() {
     return 80; // fallback
   return w.ws_col;
 }
+
+unsigned long long getPhysicalMemory() {
+  uint64_t bytes = 0;
+  size_t length = sizeof(bytes);
+  if (sysctlbyname("hw.memsize", &bytes, &length, nullptr, 0) != 0)
+    return 0;
+  return bytes;
+}
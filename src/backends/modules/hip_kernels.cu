@@ -1,4 +1,5 @@
 #include <cmath>
+#include <hip/hip_fp16.h>
 #include <hip/hip_runtime.h>
 
 extern "C" __global__ void linearSetKernel(float* data) {
@@ -24,19 +25,26 @@ extern "C" __global__ void fmaKernel(float* out, const unsigned int ITERATIONS)
   out[idx] = x;
 }
 
-extern "C" __global__ void sharedMemoryKernel(float* out, const unsigned int ITERATIONS) {
+// Shared memory traffic between threads. Each group of 32 threads reads two words at lane * stride, one in each half of
+// the tile, and writes where the next lane reads: stride 1 is conflict-free, stride 2^k a 2^k-way bank conflict up to
+// 32, and stride 0 a broadcast. volatile keeps every access in shared memory rather than in a register.
+extern "C" __global__ void sharedMemoryKernel(float* out, const unsigned int stride, const unsigned int ITERATIONS) {
   __shared__ float tile[4096];
-  int tid = threadIdx.x;
-  if (tid < 4096) {
-    tile[tid] = tid;
-    __syncthreads();
-  
-    for (int i = 0; i < ITERATIONS; i++) {
-      tile[tid] = fmaf(tile[tid], 1.0001f, 1.0f);
-    }
-    __syncthreads();
-    out[tid + blockIdx.x * blockDim.x] = tile[tid];
+  for (unsigned int i = threadIdx.x; i < 4096; i += blockDim.x) {
+    tile[i] = i;
   }
+  __syncthreads();
+
+  volatile float* shared = tile;
+  const unsigned int lane = threadIdx.x % 32, base = (threadIdx.x / 32) % 2 * 1024;
+  const unsigned int read = base + lane * stride, write = base + (lane + 1) % 32 * stride;
+  float a = 0.0f, b = 0.0f;
+  for (unsigned int i = 0; i < ITERATIONS; ++i) {
+    a = fmaf(a, 0.5f, shared[read]);
+    b = fmaf(b, 0.5f, shared[read + 2048]);
+    shared[write] = a + b;
+  }
+  out[blockIdx.x * blockDim.x + threadIdx.x] = a + b;
 }
 
 extern "C" __global__ void integerThroughputKernel(unsigned int* out, const unsigned int ITERATIONS) {
@@ -54,18 +62,631 @@ extern "C" __global__ void integerThroughputKernel(unsigned int* out, const unsi
   out[idx] = v;
 }
 
-extern "C" __global__ void sgemmKernel(const float* A, const float* B, float* C, const unsigned long long N, const unsigned int ITERATIONS) {
-  int row = blockIdx.y * blockDim.y + threadIdx.y;
-  int col = blockIdx.x * blockDim.x + threadIdx.x;
-
+// One thread per element of C, launched as a 2D grid of 16x16 blocks. Every operand comes from global memory.
+extern "C" __global__ void sgemmKernel(const float* A, const float* B, float* C, const unsigned int N) {
+  unsigned int row = blockIdx.y * blockDim.y + threadIdx.y;
+  unsigned int col = blockIdx.x * blockDim.x + threadIdx.x;
   if (row < N && col < N) {
     float value = 0.0f;
-    for (unsigned int iter = 0; iter < ITERATIONS; ++iter) {
-      value = 0.0f; // Reset value for each iteration
-      for (int k = 0; k < N; ++k) {
-        value += A[row * N + k] * B[k * N + col];
+    for (unsigned int k = 0; k < N; ++k) {
+      value += A[(size_t)row * N + k] * B[(size_t)k * N + col];
+    }
+    C[(size_t)row * N + col] = value;
+  }
+}
+
+// 16x16 tiles of A and B staged through shared memory, so every element loaded from global memory is used 16 times.
+// Launched as 16x16 blocks, one per 16x16 tile of C.
+extern "C" __global__ void sgemmTiledKernel(const float* A, const float* B, float* C, const unsigned int N) {
+  __shared__ float tileA[16][16];
+  __shared__ float tileB[16][16];
+  const unsigned int tx = threadIdx.x, ty = threadIdx.y;
+  const unsigned int row = blockIdx.y * 16 + ty;
+  const unsigned int col = blockIdx.x * 16 + tx;
+  float value = 0.0f;
+  for (unsigned int k0 = 0; k0 < N; k0 += 16) {
+    tileA[ty][tx] = row < N && k0 + tx < N ? A[(size_t)row * N + k0 + tx] : 0.0f;
+    tileB[ty][tx] = k0 + ty < N && col < N ? B[(size_t)(k0 + ty) * N + col] : 0.0f;
+    __syncthreads();
+    #pragma unroll
+    for (unsigned int k = 0; k < 16; ++k) {
+      value += tileA[ty][k] * tileB[k][tx];
+    }
+    __syncthreads();
+  }
+  if (row < N && col < N)
+    C[(size_t)row * N + col] = value;
+}
+
+// A 64x64 tile of C per 16x16 block, each thread accumulating a 4x4 patch in registers, so every shared memory load
+// feeds four FMAs. The rows and columns of a patch are 16 apart so neighbouring threads read neighbouring words. A is
+// stored transposed, with a padding column to spread its stores over the banks.
+extern "C" __global__ void sgemmRegisterKernel(const float* A, const float* B, float* C, const unsigned int N) {
+  __shared__ float tileA[16][65];
+  __shared__ float tileB[16][64];
+  const unsigned int tx = threadIdx.x, ty = threadIdx.y;
+  const unsigned int thread = ty * 16 + tx;
+  const unsigned int rowBase = blockIdx.y * 64, colBase = blockIdx.x * 64;
+  float sum[4][4] = {};
+  for (unsigned int k0 = 0; k0 < N; k0 += 16) {
+    #pragma unroll
+    for (unsigned int i = 0; i < 4; ++i) {
+      const unsigned int index = thread + i * 256;
+      const unsigned int rowA = rowBase + index / 16, kA = k0 + index % 16; // A tile: 64 rows of 16
+      tileA[index % 16][index / 16] = rowA < N && kA < N ? A[(size_t)rowA * N + kA] : 0.0f;
+      const unsigned int kB = k0 + index / 64, colB = colBase + index % 64; // B tile: 16 rows of 64
+      tileB[index / 64][index % 64] = kB < N && colB < N ? B[(size_t)kB * N + colB] : 0.0f;
+    }
+    __syncthreads();
+    #pragma unroll
+    for (unsigned int k = 0; k < 16; ++k) {
+      float a[4], b[4];
+      #pragma unroll
+      for (unsigned int i = 0; i < 4; ++i) {
+        a[i] = tileA[k][ty + i * 16];
+        b[i] = tileB[k][tx + i * 16];
+      }
+      #pragma unroll
+      for (unsigned int i = 0; i < 4; ++i) {
+        #pragma unroll
+        for (unsigned int j = 0; j < 4; ++j) {
+          sum[i][j] += a[i] * b[j];
+        }
+      }
+    }
+    __syncthreads();
+  }
+  #pragma unroll
+  for (unsigned int i = 0; i < 4; ++i) {
+    #pragma unroll
+    for (unsigned int j = 0; j < 4; ++j) {
+      const unsigned int row = rowBase + ty + i * 16, col = colBase + tx + j * 16;
+      if (row < N && col < N)
+        C[(size_t)row * N + col] = sum[i][j];
+    }
+  }
+}
+// Links every slot of the working set into one cycle. next = (multiplier * slot + increment) mod slots visits every slot
+// exactly once when slots is a power of two, increment is odd and multiplier % 4 == 1 (full-period LCG).
+extern "C" __global__ void pointerChaseInitKernel(unsigned int* chain, const unsigned long long slots, const unsigned int slotWords,
+                                                  const unsigned long long multiplier, const unsigned long long increment) {
+  unsigned long long slot = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x;
+  if (slot < slots) {
+    chain[slot * slotWords] = (unsigned int)(((multiplier * slot + increment) & (slots - 1)) * slotWords);
+  }
+}
+
+// One thread, every load depends on the previous one
+extern "C" __global__ void pointerChaseKernel(const unsigned int* chain, const unsigned int steps, unsigned int* out) {
+  unsigned int index = 0;
+  #pragma unroll 1
+  for (unsigned int i = 0; i < steps; ++i) {
+    index = chain[index];
+  }
+  out[0] = index;
+}
+
+// Each thread loads one element at offset + i * stride. The comparison is never true (the buffer is zeroed) but keeps the load.
+template <typename T>
+__device__ void stridedRead(const T* in, float* out, const unsigned long long n, const unsigned int stride, const unsigned int offset) {
+  unsigned long long i = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x;
+  if (i < n) {
+    T v = in[offset + i * stride];
+    // Use every component, or the compiler may narrow the load to the one that is compared
+    const float* components = reinterpret_cast<const float*>(&v);
+    float sum = 0.0f;
+    for (unsigned int c = 0; c < sizeof(T) / sizeof(float); ++c) {
+      sum += components[c];
+    }
+    if (sum == -1.0f)
+      out[0] = 1.0f;
+  }
+}
+
+extern "C" __global__ void stridedReadKernel4(const float* in, float* out, const unsigned long long n, const unsigned int stride,
+                                              const unsigned int offset) {
+  stridedRead(in, out, n, stride, offset);
+}
+
+extern "C" __global__ void stridedReadKernel8(const float2* in, float* out, const unsigned long long n, const unsigned int stride,
+                                              const unsigned int offset) {
+  stridedRead(in, out, n, stride, offset);
+}
+
+extern "C" __global__ void stridedReadKernel16(const float4* in, float* out, const unsigned long long n, const unsigned int stride,
+                                               const unsigned int offset) {
+  stridedRead(in, out, n, stride, offset);
+}
+
+// STREAM initial values: a = 1, b = 2, c = 0. n counts floats.
+extern "C" __global__ void streamInitKernel(float* a, float* b, float* c, const unsigned long long n) {
+  for (unsigned long long i = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x; i < n; i += (unsigned long long)gridDim.x * blockDim.x) {
+    a[i] = 1.0f;
+    b[i] = 2.0f;
+    c[i] = 0.0f;
+  }
+}
+
+// The four STREAM kernels as c = f(a, b) over n elements of T with a grid-stride loop. Every kernel takes the same arguments
+// so the host can drive them in one loop: Copy c = a, Scale c = scalar * a, Add c = a + b, Triad c = a + scalar * b.
+enum StreamOp { StreamCopy, StreamScale, StreamAdd, StreamTriad };
+
+template <StreamOp Op, typename T>
+__device__ void stream(const T* a, const T* b, T* c, const float scalar, const unsigned long long n) {
+  for (unsigned long long i = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x; i < n; i += (unsigned long long)gridDim.x * blockDim.x) {
+    T x = a[i];
+    T y;
+    if (Op == StreamAdd || Op == StreamTriad)
+      y = b[i];
+    const float* xs = reinterpret_cast<const float*>(&x);
+    const float* ys = reinterpret_cast<const float*>(&y);
+    T r;
+    float* rs = reinterpret_cast<float*>(&r);
+    for (unsigned int k = 0; k < sizeof(T) / sizeof(float); ++k) {
+      if (Op == StreamCopy)
+        rs[k] = xs[k];
+      else if (Op == StreamScale)
+        rs[k] = scalar * xs[k];
+      else if (Op == StreamAdd)
+        rs[k] = xs[k] + ys[k];
+      else
+        rs[k] = fmaf(scalar, ys[k], xs[k]);
+    }
+    c[i] = r;
+  }
+}
+
+#define STREAM_KERNEL(name, op, T, bytes)                                                                                                  \
+  extern "C" __global__ void name##bytes(const T* a, const T* b, T* c, const float scalar, const unsigned long long n) {                   \
+    stream<op>(a, b, c, scalar, n);                                                                                                       \
+  }
+#define STREAM_KERNELS(T, bytes)                                                                                                           \
+  STREAM_KERNEL(streamCopyKernel, StreamCopy, T, bytes)                                                                                   \
+  STREAM_KERNEL(streamScaleKernel, StreamScale, T, bytes)                                                                                 \
+  STREAM_KERNEL(streamAddKernel, StreamAdd, T, bytes)                                                                                     \
+  STREAM_KERNEL(streamTriadKernel, StreamTriad, T, bytes)
+
+STREAM_KERNELS(float, 4)
+STREAM_KERNELS(float2, 8)
+STREAM_KERNELS(float4, 16)
+
+// Adds one to every float. On managed memory the first device access to each page faults it in.
+extern "C" __global__ void managedIncrementKernel(float* data, const unsigned long long n) {
+  for (unsigned long long i = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x; i < n; i += (unsigned long long)gridDim.x * blockDim.x) {
+    data[i] += 1.0f;
+  }
+}
+
+// Copies a widthWords x height block of 32-bit words between two pitched 2D buffers, one row per grid row
+extern "C" __global__ void pitchedCopyKernel(const unsigned int* src, const unsigned long long srcPitch, unsigned int* dst,
+                                             const unsigned long long dstPitch, const unsigned int widthWords, const unsigned int height) {
+  unsigned int x = blockIdx.x * blockDim.x + threadIdx.x;
+  unsigned int y = blockIdx.y;
+  if (x < widthWords && y < height) {
+    const unsigned int* srcRow = reinterpret_cast<const unsigned int*>(reinterpret_cast<const char*>(src) + y * srcPitch);
+    unsigned int* dstRow = reinterpret_cast<unsigned int*>(reinterpret_cast<char*>(dst) + y * dstPitch);
+    dstRow[x] = srcRow[x];
+  }
+}
+
+// The 3D version, launched with one grid row per row and one grid layer per slice. Slices are srcSliceRows and
+// dstSliceRows rows apart, so a box can be cut out of a larger volume.
+extern "C" __global__ void volumeCopyKernel(const unsigned int* src, const unsigned long long srcPitch, const unsigned int srcSliceRows,
+                                            unsigned int* dst, const unsigned long long dstPitch, const unsigned int dstSliceRows,
+                                            const unsigned int widthWords) {
+  unsigned int x = blockIdx.x * blockDim.x + threadIdx.x;
+  unsigned long long y = blockIdx.y, z = blockIdx.z;
+  if (x < widthWords) {
+    const unsigned int* srcRow = reinterpret_cast<const unsigned int*>(reinterpret_cast<const char*>(src) + (z * srcSliceRows + y) * srcPitch);
+    unsigned int* dstRow = reinterpret_cast<unsigned int*>(reinterpret_cast<char*>(dst) + (z * dstSliceRows + y) * dstPitch);
+    dstRow[x] = srcRow[x];
+  }
+}
+
+// Sums one chunk of an out-of-core dataset into a running 64-bit checksum, one atomic per thread
+extern "C" __global__ void chunkChecksumKernel(const unsigned int* data, unsigned long long* checksum, const unsigned long long n) {
+  unsigned long long sum = 0;
+  for (unsigned long long i = (unsigned long long)blockIdx.x * blockDim.x + threadIdx.x; i < n; i += (unsigned long long)gridDim.x * blockDim.x) {
+    sum += data[i];
+  }
+  atomicAdd(checksum, sum);
+}
+
+// Formats of the precision test. AMD GPUs have packed fp16 math and int8 dot products (emulated by the device
+// library on targets without them), while bf16 goes through fp32 as the compiler does for most targets.
+
+// Two bf16 values in the halves of a 32-bit word, and one in 16 bits
+struct bfloat162 {
+  unsigned int bits;
+};
+struct bfloat16 {
+  unsigned short bits;
+};
+__device__ inline unsigned short toBfloat16(float v) {
+  unsigned int bits = __float_as_uint(v);
+  return (unsigned short)((bits + 0x7fff + ((bits >> 16) & 1)) >> 16); // Round to nearest even
+}
+
+template <typename T> __device__ T fromFloat(float v);
+template <> __device__ __half2 fromFloat<__half2>(float v) { return __float2half2_rn(v); }
+template <> __device__ bfloat162 fromFloat<bfloat162>(float v) { return {toBfloat16(v) * 0x10001u}; }
+template <> __device__ float fromFloat<float>(float v) { return v; }
+template <> __device__ double fromFloat<double>(float v) { return v; }
+// Four int8 lanes, each near v * 100
+template <> __device__ int fromFloat<int>(float v) { return (int)(v * 100.0f) * 0x01010101; }
+
+__device__ inline __half2 multiplyAdd(__half2 a, __half2 b, __half2 c) { return __hfma2(a, b, c); }
+__device__ inline bfloat162 multiplyAdd(bfloat162 a, bfloat162 b, bfloat162 c) {
+  float low = fmaf(__uint_as_float(a.bits << 16), __uint_as_float(b.bits << 16), __uint_as_float(c.bits << 16));
+  float high = fmaf(__uint_as_float(a.bits & 0xffff0000u), __uint_as_float(b.bits & 0xffff0000u), __uint_as_float(c.bits & 0xffff0000u));
+  return {toBfloat16(low) | ((unsigned int)toBfloat16(high) << 16)};
+}
+__device__ inline float multiplyAdd(float a, float b, float c) { return fmaf(a, b, c); }
+__device__ inline double multiplyAdd(double a, double b, double c) { return fma(a, b, c); }
+// Dot product of the four signed bytes of a and b, plus c
+__device__ inline int multiplyAdd(int a, int b, int c) {
+  char4 x, y;
+  __builtin_memcpy(&x, &a, sizeof(a));
+  __builtin_memcpy(&y, &b, sizeof(b));
+  return amd_mixed_dot(x, y, c, false);
+}
+
+__device__ inline float widen(__half v) { return __half2float(v); }
+__device__ inline float widen(bfloat16 v) { return __uint_as_float((unsigned int)v.bits << 16); }
+__device__ inline float widen(float v) { return v; }
+__device__ inline double widen(double v) { return v; }
+__device__ inline int widen(signed char v) { return v; }
+
+// Multiply-add x * m + c in every format of the precision test, eight independent chains per thread so the loop is
+// bound by throughput rather than latency. Packed formats do two (half2, bf16x2) or four (int8 dot product) per call.
+template <typename T>
+__device__ void multiplyAddChains(T* out, const unsigned int iterations) {
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  const T m = fromFloat<T>(0.999f), c = fromFloat<T>(0.001f);
+  T x[8];
+  #pragma unroll
+  for (int j = 0; j < 8; ++j) {
+    x[j] = fromFloat<T>(1.0f + 0.001f * ((idx + j) & 255));
+  }
+  #pragma unroll 1
+  for (unsigned int i = 0; i < iterations; ++i) {
+    #pragma unroll
+    for (int j = 0; j < 8; ++j) {
+      x[j] = multiplyAdd(x[j], m, c);
+    }
+  }
+  // Fold the chains so none of them is dead code
+  #pragma unroll
+  for (int j = 1; j < 8; ++j) {
+    x[0] = multiplyAdd(x[j], m, x[0]);
+  }
+  out[idx] = x[0];
+}
+
+extern "C" __global__ void fmaHalf2Kernel(__half2* out, const unsigned int ITERATIONS) { multiplyAddChains(out, ITERATIONS); }
+extern "C" __global__ void fmaBfloat162Kernel(bfloat162* out, const unsigned int ITERATIONS) { multiplyAddChains(out, ITERATIONS); }
+extern "C" __global__ void fmaFloatKernel(float* out, const unsigned int ITERATIONS) { multiplyAddChains(out, ITERATIONS); }
+extern "C" __global__ void fmaDoubleKernel(double* out, const unsigned int ITERATIONS) { multiplyAddChains(out, ITERATIONS); }
+extern "C" __global__ void dotInt8Kernel(int* out, const unsigned int ITERATIONS) { multiplyAddChains(out, ITERATIONS); }
+
+// C = A * B in 16x16 shared memory tiles like sgemmTiledKernel, with inputs of type In widened to Acc on load
+template <typename In, typename Acc>
+__device__ void tiledGemm(const In* A, const In* B, Acc* C, const unsigned int N) {
+  __shared__ Acc tileA[16][16];
+  __shared__ Acc tileB[16][16];
+  const unsigned int tx = threadIdx.x, ty = threadIdx.y;
+  const unsigned int row = blockIdx.y * 16 + ty;
+  const unsigned int col = blockIdx.x * 16 + tx;
+  Acc value = 0;
+  for (unsigned int k0 = 0; k0 < N; k0 += 16) {
+    tileA[ty][tx] = row < N && k0 + tx < N ? widen(A[(size_t)row * N + k0 + tx]) : Acc(0);
+    tileB[ty][tx] = k0 + ty < N && col < N ? widen(B[(size_t)(k0 + ty) * N + col]) : Acc(0);
+    __syncthreads();
+    #pragma unroll
+    for (unsigned int k = 0; k < 16; ++k) {
+      value += tileA[ty][k] * tileB[k][tx];
+    }
+    __syncthreads();
+  }
+  if (row < N && col < N)
+    C[(size_t)row * N + col] = value;
+}
+
+extern "C" __global__ void gemmHalfKernel(const __half* A, const __half* B, float* C, const unsigned int N) { tiledGemm(A, B, C, N); }
+extern "C" __global__ void gemmBfloat16Kernel(const bfloat16* A, const bfloat16* B, float* C, const unsigned int N) { tiledGemm(A, B, C, N); }
+extern "C" __global__ void gemmFloatKernel(const float* A, const float* B, float* C, const unsigned int N) { tiledGemm(A, B, C, N); }
+extern "C" __global__ void gemmDoubleKernel(const double* A, const double* B, double* C, const unsigned int N) { tiledGemm(A, B, C, N); }
+extern "C" __global__ void gemmInt8Kernel(const signed char* A, const signed char* B, int* C, const unsigned int N) { tiledGemm(A, B, C, N); }
+
+// Instruction mix: every operation is applied as a chain x = step(x, c). One dependent chain in a single thread gives its
+// latency from the shader clock, eight independent chains per thread over the whole device its throughput. c comes from the
+// host so nothing can be folded at compile time.
+namespace mix {
+struct SinFast {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return __sinf(x); }
+};
+struct Sin {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return sinf(x); }
+};
+// exp(-x) settles near 0.567 instead of overflowing; the negation is an operand modifier, not an instruction
+struct ExpFast {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return __expf(-x); }
+};
+struct Exp {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return expf(-x); }
+};
+struct RsqrtFast {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return rsqrtf(x); }
+};
+struct Rsqrt {
+  typedef float T;
+  __device__ static T constant(unsigned int seed) { return seed * 0.5f; }
+  __device__ static T step(T x, T) { return 1.0f / sqrtf(x); }
+};
+struct IntMul {
+  typedef unsigned int T;
+  __device__ static T constant(unsigned int seed) { return seed * 3u; }
+  __device__ static T step(T x, T c) { return x * c; }
+};
+struct IntMad {
+  typedef unsigned int T;
+  __device__ static T constant(unsigned int seed) { return seed * 3u; }
+  __device__ static T step(T x, T c) { return x * c + c; }
+};
+struct Popcount {
+  typedef unsigned int T;
+  __device__ static T constant(unsigned int seed) { return seed * 0x9e3779b9u; }
+  __device__ static T step(T x, T) { return __popc(x); }
+};
+struct Clz {
+  typedef unsigned int T;
+  __device__ static T constant(unsigned int seed) { return seed * 0x9e3779b9u; }
+  __device__ static T step(T x, T) { return __clz((int)x); }
+};
+// One step is a round trip, int to float and back
+struct IntFloat {
+  typedef int T;
+  __device__ static T constant(unsigned int seed) { return (int)(seed * 0x9e3779b9u); }
+  __device__ static T step(T x, T) { return (int)(float)x; }
+};
+struct Int64Mul {
+  typedef unsigned long long T;
+  __device__ static T constant(unsigned int seed) { return seed * 0x9e3779b97f4a7c15ull; }
+  __device__ static T step(T x, T c) { return x * c; }
+};
+struct Int64Mad {
+  typedef unsigned long long T;
+  __device__ static T constant(unsigned int seed) { return seed * 0x9e3779b97f4a7c15ull; }
+  __device__ static T step(T x, T c) { return x * c + c; }
+};
+} // namespace mix
+
+// Launched as a single thread. cycles[0] is the SM clock time of the whole chain.
+template <typename Op>
+__device__ void instructionLatency(void* out, long long* cycles, const unsigned int seed, const unsigned int iterations) {
+  const typename Op::T c = Op::constant(seed);
+  typename Op::T x = c;
+  long long start = clock64();
+  #pragma unroll 8
+  for (unsigned int i = 0; i < iterations; ++i) {
+    x = Op::step(x, c);
+  }
+  long long stop = clock64();
+  static_cast<typename Op::T*>(out)[0] = x;
+  cycles[0] = stop - start;
+}
+
+template <typename Op>
+__device__ void instructionThroughput(void* out, const unsigned int seed, const unsigned int iterations) {
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  const typename Op::T c = Op::constant(seed);
+  typename Op::T x[8];
+  #pragma unroll
+  for (int j = 0; j < 8; ++j) {
+    x[j] = c + (typename Op::T)((idx + j) & 7);
+  }
+  #pragma unroll 1
+  for (unsigned int i = 0; i < iterations; ++i) {
+    #pragma unroll
+    for (int j = 0; j < 8; ++j) {
+      x[j] = Op::step(x[j], c);
+    }
+  }
+  #pragma unroll
+  for (int j = 1; j < 8; ++j) {
+    x[0] += x[j];
+  }
+  static_cast<typename Op::T*>(out)[idx] = x[0];
+}
+
+#define INSTRUCTION_KERNELS(Op)                                                                                                            \
+  extern "C" __global__ void latency##Op##Kernel(void* out, long long* cycles, const unsigned int seed, const unsigned int iterations) {   \
+    instructionLatency<mix::Op>(out, cycles, seed, iterations);                                                                            \
+  }                                                                                                                                        \
+  extern "C" __global__ void throughput##Op##Kernel(void* out, const unsigned int seed, const unsigned int iterations) {                   \
+    instructionThroughput<mix::Op>(out, seed, iterations);                                                                                 \
+  }
+
+INSTRUCTION_KERNELS(SinFast)
+INSTRUCTION_KERNELS(Sin)
+INSTRUCTION_KERNELS(ExpFast)
+INSTRUCTION_KERNELS(Exp)
+INSTRUCTION_KERNELS(RsqrtFast)
+INSTRUCTION_KERNELS(Rsqrt)
+INSTRUCTION_KERNELS(IntMul)
+INSTRUCTION_KERNELS(IntMad)
+INSTRUCTION_KERNELS(Popcount)
+INSTRUCTION_KERNELS(Clz)
+INSTRUCTION_KERNELS(IntFloat)
+INSTRUCTION_KERNELS(Int64Mul)
+INSTRUCTION_KERNELS(Int64Mad)
+
+// Occupancy sweep. The host varies block size and the dynamic shared memory each block reserves (the kernels never touch
+// it); the Registers variants keep more values live per thread, so fewer blocks fit on a CU. occupancyMemory copies with
+// Loads float4 loads in flight per thread, occupancyCompute runs Chains independent FMA chains per thread.
+template <int Loads>
+__device__ void occupancyMemory(const float4* in, float4* out, const unsigned long long n) {
+  const unsigned long long stride = static_cast<unsigned long long>(gridDim.x) * blockDim.x;
+  for (unsigned long long base = blockIdx.x * blockDim.x + threadIdx.x; base < n; base += stride * Loads) {
+    float4 v[Loads];
+    #pragma unroll
+    for (int k = 0; k < Loads; ++k) {
+      v[k] = base + k * stride < n ? in[base + k * stride] : make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    #pragma unroll
+    for (int k = 0; k < Loads; ++k) {
+      if (base + k * stride < n)
+        out[base + k * stride] = v[k];
+    }
+  }
+}
+
+template <int Chains>
+__device__ void occupancyCompute(float* out, const unsigned int iterations) {
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  float x[Chains];
+  #pragma unroll
+  for (int j = 0; j < Chains; ++j) {
+    x[j] = 1.0f + 0.001f * ((idx + j) & 255);
+  }
+  #pragma unroll 1
+  for (unsigned int i = 0; i < iterations; ++i) {
+    #pragma unroll
+    for (int j = 0; j < Chains; ++j) {
+      x[j] = fmaf(x[j], 0.999f, 0.001f);
+    }
+  }
+  #pragma unroll
+  for (int j = 1; j < Chains; ++j) {
+    x[0] += x[j];
+  }
+  out[idx] = x[0];
+}
+
+extern "C" __global__ void occupancyMemoryKernel(const float4* in, float4* out, const unsigned long long n) { occupancyMemory<1>(in, out, n); }
+extern "C" __global__ void occupancyMemoryRegistersKernel(const float4* in, float4* out, const unsigned long long n) {
+  occupancyMemory<16>(in, out, n);
+}
+extern "C" __global__ void occupancyComputeKernel(float* out, const unsigned int iterations) { occupancyCompute<8>(out, iterations); }
+extern "C" __global__ void occupancyComputeRegistersKernel(float* out, const unsigned int iterations) { occupancyCompute<64>(out, iterations); }
+
+// Divergence: every thread runs `rounds` rounds of one of four FMA loops, picked by paths[idx]. The loops differ so the
+// compiler cannot merge them, and threads of one wavefront on different paths have to run them one after another.
+extern "C" __global__ void divergenceKernel(float* out, const unsigned int* paths, const unsigned int rounds) {
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  const unsigned int path = paths[idx];
+  float x = 1.0f + 0.001f * (idx & 255), y = 0.5f;
+  #pragma unroll 1
+  for (unsigned int r = 0; r < rounds; ++r) {
+    switch (path) {
+    case 0:
+      #pragma unroll
+      for (int i = 0; i < 32; ++i) {
+        x = fmaf(x, 0.999f, 0.001f);
+        y = fmaf(y, 0.999f, 0.002f);
+      }
+      break;
+    case 1:
+      #pragma unroll
+      for (int i = 0; i < 32; ++i) {
+        x = fmaf(x, 1.001f, -0.001f);
+        y = fmaf(y, 1.001f, -0.002f);
+      }
+      break;
+    case 2:
+      #pragma unroll
+      for (int i = 0; i < 32; ++i) {
+        x = fmaf(-x, 0.5f, 1.0f);
+        y = fmaf(-y, 0.25f, 1.0f);
       }
+      break;
+    default:
+      #pragma unroll
+      for (int i = 0; i < 32; ++i) {
+        x = fmaf(x, y, 0.25f);
+        y = fmaf(y, 0.5f, 0.125f);
+      }
+      break;
     }
-    C[row * N + col] = value;
   }
-}
\ No newline at end of file
+  out[idx] = x + y;
+}
+
+// Atomics: every thread repeats one atomic update on its counter, with the result unused as in histogram kernels. Float
+// adds to global memory become compare-and-swap loops on GPUs without native float atomics, unless built with
+// -munsafe-fp-atomics, which is then part of what the test measures.
+namespace atomics {
+struct AddInt {
+  typedef unsigned int T;
+  __device__ static void apply(T* counter) { atomicAdd(counter, 1u); }
+};
+struct AddLong {
+  typedef unsigned long long T;
+  __device__ static void apply(T* counter) { atomicAdd(counter, 1ull); }
+};
+struct AddFloat {
+  typedef float T;
+  __device__ static void apply(T* counter) { atomicAdd(counter, 1.0f); }
+};
+// Increment built from compare-and-swap, retried until no other thread got in between
+struct CasInt {
+  typedef unsigned int T;
+  __device__ static void apply(T* counter) {
+    T old = *counter, assumed;
+    do {
+      assumed = old;
+      old = atomicCAS(counter, assumed, assumed + 1);
+    } while (old != assumed);
+  }
+};
+} // namespace atomics
+
+// Thread idx updates counters[idx % addresses], or counters[idx] with addresses 0
+template <typename Op>
+__device__ void atomicGlobal(void* counters, const unsigned int addresses, const unsigned int iterations) {
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  typename Op::T* counter = static_cast<typename Op::T*>(counters) + (addresses ? idx % addresses : idx);
+  #pragma unroll 1
+  for (unsigned int i = 0; i < iterations; ++i) {
+    Op::apply(counter);
+  }
+}
+
+// The same on a shared memory tile per block (blocks of at most 1024 threads), written out to counters at the end
+template <typename Op>
+__device__ void atomicShared(void* counters, const unsigned int addresses, const unsigned int iterations) {
+  __shared__ typename Op::T tile[1024];
+  unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+  tile[threadIdx.x] = 0;
+  __syncthreads();
+  typename Op::T* counter = tile + (addresses ? threadIdx.x % addresses : threadIdx.x);
+  #pragma unroll 1
+  for (unsigned int i = 0; i < iterations; ++i) {
+    Op::apply(counter);
+  }
+  __syncthreads();
+  static_cast<typename Op::T*>(counters)[idx] = tile[threadIdx.x];
+}
+
+#define ATOMIC_KERNELS(Op)                                                                                                                 \
+  extern "C" __global__ void atomicGlobal##Op##Kernel(void* counters, const unsigned int addresses, const unsigned int iterations) {       \
+    atomicGlobal<atomics::Op>(counters, addresses, iterations);                                                                            \
+  }                                                                                                                                        \
+  extern "C" __global__ void atomicShared##Op##Kernel(void* counters, const unsigned int addresses, const unsigned int iterations) {       \
+    atomicShared<atomics::Op>(counters, addresses, iterations);                                                                            \
+  }
+
+ATOMIC_KERNELS(AddInt)
+ATOMIC_KERNELS(AddLong)
+ATOMIC_KERNELS(AddFloat)
+ATOMIC_KERNELS(CasInt)
@@ -21,21 +21,25 @@ __kernel void fmaKernel(__global float* out,
     out[idx] = x;
 }
 
-__kernel void sharedMemoryKernel(__global float* out, const uint ITERATIONS) {
+// Local memory traffic between work-items, as sharedMemoryKernel in the CUDA and HIP modules: each group of 32 reads
+// two words at lane * stride and writes where the next lane reads. Stride 0 is a broadcast.
+__kernel void sharedMemoryKernel(__global float* out, const uint stride, const uint ITERATIONS) {
     __local float tile[4096];
     uint tid = get_local_id(0);
-    
-    if (tid < 4096) {
-        tile[tid] = tid;
-        barrier(CLK_LOCAL_MEM_FENCE);
+    for (uint i = tid; i < 4096; i += get_local_size(0))
+        tile[i] = i;
+    barrier(CLK_LOCAL_MEM_FENCE);
 
-        for (uint i = 0; i < ITERATIONS; i++) {
-            tile[tid] = fma(tile[tid], 1.0001f, 1.0f);
-        }
-        barrier(CLK_LOCAL_MEM_FENCE);
-        uint globalIdx = get_group_id(0) * get_local_size(0) + tid;
-        out[globalIdx] = tile[tid];
+    volatile __local float* shared = tile;
+    const uint lane = tid % 32, base = (tid / 32) % 2 * 1024;
+    const uint read = base + lane * stride, write = base + (lane + 1) % 32 * stride;
+    float a = 0.0f, b = 0.0f;
+    for (uint i = 0; i < ITERATIONS; i++) {
+        a = fma(a, 0.5f, shared[read]);
+        b = fma(b, 0.5f, shared[read + 2048]);
+        shared[write] = a + b;
     }
+    out[get_global_id(0)] = a + b;
 }
 
 __kernel void integerThroughputKernel(__global uint* out, const uint ITERATIONS) {
@@ -51,19 +55,432 @@ __kernel void integerThroughputKernel(__global uint* out, const uint ITERATIONS)
     out[idx] = v;
 }
 
-__kernel void sgemmKernel(__global const float* A, __global const float* B, __global float* C, const ulong N, const uint reps) {
-    int row = get_global_id(1);
-    int col = get_global_id(0);
-
+// One work-item per element of C, enqueued as a 2D range in 16x16 work-groups. Every operand comes from global memory.
+__kernel void sgemmKernel(__global const float* A, __global const float* B, __global float* C, const uint N) {
+    uint row = get_global_id(1);
+    uint col = get_global_id(0);
     if (row < N && col < N) {
         float value = 0.0f;
-        for (ulong r = 0; r < reps; ++r) {
-            value = 0.0f;
-            for (int k = 0; k < N; ++k) {
-                value += A[row * N + k] * B[k * N + col];
+        for (uint k = 0; k < N; ++k) {
+            value += A[(size_t)row * N + k] * B[(size_t)k * N + col];
+        }
+        C[(size_t)row * N + col] = value;
+    }
+}
+
+// 16x16 tiles of A and B staged through local memory, so every element loaded from global memory is used 16 times.
+// Enqueued as 16x16 work-groups, one per 16x16 tile of C.
+__kernel void sgemmTiledKernel(__global const float* A, __global const float* B, __global float* C, const uint N) {
+    __local float tileA[16][16];
+    __local float tileB[16][16];
+    const uint tx = get_local_id(0), ty = get_local_id(1);
+    const uint row = get_group_id(1) * 16 + ty;
+    const uint col = get_group_id(0) * 16 + tx;
+    float value = 0.0f;
+    for (uint k0 = 0; k0 < N; k0 += 16) {
+        tileA[ty][tx] = row < N && k0 + tx < N ? A[(size_t)row * N + k0 + tx] : 0.0f;
+        tileB[ty][tx] = k0 + ty < N && col < N ? B[(size_t)(k0 + ty) * N + col] : 0.0f;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (uint k = 0; k < 16; ++k) {
+            value += tileA[ty][k] * tileB[k][tx];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (row < N && col < N)
+        C[(size_t)row * N + col] = value;
+}
+
+// A 64x64 tile of C per 16x16 work-group, each work-item accumulating a 4x4 patch in registers, so every local memory
+// load feeds four FMAs. The rows and columns of a patch are 16 apart so neighbouring work-items read neighbouring words.
+// A is stored transposed, with a padding column to spread its stores over the banks.
+__kernel void sgemmRegisterKernel(__global const float* A, __global const float* B, __global float* C, const uint N) {
+    __local float tileA[16][65];
+    __local float tileB[16][64];
+    const uint tx = get_local_id(0), ty = get_local_id(1);
+    const uint thread = ty * 16 + tx;
+    const uint rowBase = get_group_id(1) * 64, colBase = get_group_id(0) * 64;
+    float sum[4][4];
+    for (uint i = 0; i < 4; ++i) {
+        for (uint j = 0; j < 4; ++j) {
+            sum[i][j] = 0.0f;
+        }
+    }
+    for (uint k0 = 0; k0 < N; k0 += 16) {
+        for (uint i = 0; i < 4; ++i) {
+            const uint index = thread + i * 256;
+            const uint rowA = rowBase + index / 16, kA = k0 + index % 16; // A tile: 64 rows of 16
+            tileA[index % 16][index / 16] = rowA < N && kA < N ? A[(size_t)rowA * N + kA] : 0.0f;
+            const uint kB = k0 + index / 64, colB = colBase + index % 64; // B tile: 16 rows of 64
+            tileB[index / 64][index % 64] = kB < N && colB < N ? B[(size_t)kB * N + colB] : 0.0f;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (uint k = 0; k < 16; ++k) {
+            float a[4], b[4];
+            for (uint i = 0; i < 4; ++i) {
+                a[i] = tileA[k][ty + i * 16];
+                b[i] = tileB[k][tx + i * 16];
+            }
+            for (uint i = 0; i < 4; ++i) {
+                for (uint j = 0; j < 4; ++j) {
+                    sum[i][j] += a[i] * b[j];
+                }
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    for (uint i = 0; i < 4; ++i) {
+        for (uint j = 0; j < 4; ++j) {
+            const uint row = rowBase + ty + i * 16, col = colBase + tx + j * 16;
+            if (row < N && col < N)
+                C[(size_t)row * N + col] = sum[i][j];
+        }
+    }
+}
+
+
+// Links every slot of the working set into one cycle. next = (multiplier * slot + increment) mod slots visits every slot
+// exactly once when slots is a power of two, increment is odd and multiplier % 4 == 1 (full-period LCG).
+__kernel void pointerChaseInitKernel(__global uint* chain, const ulong slots, const uint slotWords, const ulong multiplier, const ulong increment) {
+    ulong slot = get_global_id(0);
+    if (slot < slots) {
+        chain[slot * slotWords] = (uint)(((multiplier * slot + increment) & (slots - 1)) * slotWords);
+    }
+}
+
+// One work-item, every load depends on the previous one
+__kernel void pointerChaseKernel(__global const uint* chain, const uint steps, __global uint* out) {
+    uint index = 0;
+    for (uint i = 0; i < steps; ++i) {
+        index = chain[index];
+    }
+    out[0] = index;
+}
+
+// Each work-item loads one element at offset + i * stride. The comparison is never true (the buffer is zeroed) but keeps the load.
+__kernel void stridedReadKernel4(__global const float* in, __global float* out, const ulong n, const uint stride, const uint offset) {
+    ulong i = get_global_id(0);
+    if (i < n && in[offset + i * stride] == -1.0f)
+        out[0] = 1.0f;
+}
+
+__kernel void stridedReadKernel8(__global const float2* in, __global float* out, const ulong n, const uint stride, const uint offset) {
+    ulong i = get_global_id(0);
+    if (i < n) {
+        float2 v = in[offset + i * stride];
+        // Use every component, or the compiler may narrow the load to the one that is compared
+        if (v.x + v.y == -1.0f)
+            out[0] = 1.0f;
+    }
+}
+
+__kernel void stridedReadKernel16(__global const float4* in, __global float* out, const ulong n, const uint stride, const uint offset) {
+    ulong i = get_global_id(0);
+    if (i < n) {
+        float4 v = in[offset + i * stride];
+        if (v.x + v.y + v.z + v.w == -1.0f)
+            out[0] = 1.0f;
+    }
+}
+
+// STREAM initial values: a = 1, b = 2, c = 0. n counts floats.
+__kernel void streamInitKernel(__global float* a, __global float* b, __global float* c, const ulong n) {
+    for (ulong i = get_global_id(0); i < n; i += get_global_size(0)) {
+        a[i] = 1.0f;
+        b[i] = 2.0f;
+        c[i] = 0.0f;
+    }
+}
+
+// The four STREAM kernels as c = f(a, b) over n elements of T with a grid-stride loop. Every kernel takes the same arguments
+// so the host can drive them in one loop.
+#define STREAM_KERNELS(T, bytes)                                                                                                           \
+    __kernel void streamCopyKernel##bytes(__global const T* a, __global const T* b, __global T* c, const float scalar, const ulong n) {   \
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0))                                                                   \
+            c[i] = a[i];                                                                                                                   \
+    }                                                                                                                                      \
+    __kernel void streamScaleKernel##bytes(__global const T* a, __global const T* b, __global T* c, const float scalar, const ulong n) {  \
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0))                                                                   \
+            c[i] = scalar * a[i];                                                                                                          \
+    }                                                                                                                                      \
+    __kernel void streamAddKernel##bytes(__global const T* a, __global const T* b, __global T* c, const float scalar, const ulong n) {    \
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0))                                                                   \
+            c[i] = a[i] + b[i];                                                                                                            \
+    }                                                                                                                                      \
+    __kernel void streamTriadKernel##bytes(__global const T* a, __global const T* b, __global T* c, const float scalar, const ulong n) {  \
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0))                                                                   \
+            c[i] = fma((T)scalar, b[i], a[i]);                                                                                             \
+    }
+
+STREAM_KERNELS(float, 4)
+STREAM_KERNELS(float2, 8)
+STREAM_KERNELS(float4, 16)
+
+// Multiply-add x * m + c in every format of the precision test, eight independent chains per work-item so the loop is
+// bound by throughput rather than latency. Packed formats do two (half2, bf16x2) or four (int8 dot product) per call.
+// fp16 and fp64 are only compiled where the device has the extension; the host does not create their kernels otherwise.
+#define MULTIPLY_ADD_KERNEL(name, T, FROM_FLOAT, MULTIPLY_ADD)                                                                             \
+    __kernel void name(__global T* out, const uint ITERATIONS) {                                                                           \
+        uint idx = get_global_id(0);                                                                                                       \
+        const T m = FROM_FLOAT(0.999f), c = FROM_FLOAT(0.001f);                                                                            \
+        T x[8];                                                                                                                            \
+        for (int j = 0; j < 8; ++j)                                                                                                        \
+            x[j] = FROM_FLOAT(1.0f + 0.001f * ((idx + j) & 255));                                                                          \
+        for (uint i = 0; i < ITERATIONS; ++i) {                                                                                            \
+            for (int j = 0; j < 8; ++j)                                                                                                    \
+                x[j] = MULTIPLY_ADD(x[j], m, c);                                                                                           \
+        }                                                                                                                                  \
+        for (int j = 1; j < 8; ++j)                                                                                                        \
+            x[0] = MULTIPLY_ADD(x[j], m, x[0]);                                                                                            \
+        out[idx] = x[0];                                                                                                                   \
+    }
+
+// C = A * B in 16x16 local memory tiles like sgemmTiledKernel, with inputs of type In widened to Acc on load
+#define TILED_GEMM_KERNEL(name, In, Acc, WIDEN)                                                                                            \
+    __kernel void name(__global const In* A, __global const In* B, __global Acc* C, const uint N) {                                       \
+        __local Acc tileA[16][16];                                                                                                         \
+        __local Acc tileB[16][16];                                                                                                         \
+        const uint tx = get_local_id(0), ty = get_local_id(1);                                                                             \
+        const uint row = get_group_id(1) * 16 + ty;                                                                                        \
+        const uint col = get_group_id(0) * 16 + tx;                                                                                        \
+        Acc value = 0;                                                                                                                     \
+        for (uint k0 = 0; k0 < N; k0 += 16) {                                                                                              \
+            tileA[ty][tx] = row < N && k0 + tx < N ? WIDEN(A[(size_t)row * N + k0 + tx]) : (Acc)0;                                         \
+            tileB[ty][tx] = k0 + ty < N && col < N ? WIDEN(B[(size_t)(k0 + ty) * N + col]) : (Acc)0;                                       \
+            barrier(CLK_LOCAL_MEM_FENCE);                                                                                                  \
+            for (uint k = 0; k < 16; ++k)                                                                                                  \
+                value += tileA[ty][k] * tileB[k][tx];                                                                                      \
+            barrier(CLK_LOCAL_MEM_FENCE);                                                                                                  \
+        }                                                                                                                                  \
+        if (row < N && col < N)                                                                                                            \
+            C[(size_t)row * N + col] = value;                                                                                              \
+    }
+
+// bf16 has no OpenCL type. Pairs live in the halves of a uint and go through fp32, as on most hardware.
+float bfloat16ToFloat(ushort v) { return as_float((uint)v << 16); }
+ushort floatToBfloat16(float v) {
+    uint bits = as_uint(v);
+    return (ushort)((bits + 0x7fff + ((bits >> 16) & 1)) >> 16); // Round to nearest even
+}
+uint bfloat162FromFloat(float v) { return (uint)floatToBfloat16(v) * 0x10001u; }
+uint bfloat162MultiplyAdd(uint a, uint b, uint c) {
+    float low = fma(as_float(a << 16), as_float(b << 16), as_float(c << 16));
+    float high = fma(as_float(a & 0xffff0000u), as_float(b & 0xffff0000u), as_float(c & 0xffff0000u));
+    return floatToBfloat16(low) | ((uint)floatToBfloat16(high) << 16);
+}
+float identityFloat(float v) { return v; }
+// Four int8 lanes, each near v * 100, and their dot product plus c
+int int8x4FromFloat(float v) { return (int)(v * 100.0f) * 0x01010101; }
+int int8x4Dot(int a, int b, int c) {
+    char4 x = as_char4(a), y = as_char4(b);
+    return c + x.x * y.x + x.y * y.y + x.z * y.z + x.w * y.w;
+}
+int widenInt8(char v) { return v; }
+
+MULTIPLY_ADD_KERNEL(fmaBfloat162Kernel, uint, bfloat162FromFloat, bfloat162MultiplyAdd)
+MULTIPLY_ADD_KERNEL(fmaFloatKernel, float, identityFloat, fma)
+MULTIPLY_ADD_KERNEL(dotInt8Kernel, int, int8x4FromFloat, int8x4Dot)
+TILED_GEMM_KERNEL(gemmBfloat16Kernel, ushort, float, bfloat16ToFloat)
+TILED_GEMM_KERNEL(gemmFloatKernel, float, float, identityFloat)
+TILED_GEMM_KERNEL(gemmInt8Kernel, char, int, widenInt8)
+
+#ifdef cl_khr_fp16
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+half2 half2FromFloat(float v) { return (half2)((half)v, (half)v); }
+float widenHalf(half v) { return (float)v; }
+MULTIPLY_ADD_KERNEL(fmaHalf2Kernel, half2, half2FromFloat, fma)
+TILED_GEMM_KERNEL(gemmHalfKernel, half, float, widenHalf)
+#endif
+
+#ifdef cl_khr_fp64
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+double doubleFromFloat(float v) { return v; }
+double widenDouble(double v) { return v; }
+MULTIPLY_ADD_KERNEL(fmaDoubleKernel, double, doubleFromFloat, fma)
+TILED_GEMM_KERNEL(gemmDoubleKernel, double, double, widenDouble)
+#endif
+
+// Instruction mix like the CUDA and HIP kernels, but OpenCL has no device clock: latency<name>Kernel runs one dependent
+// chain in a single work-item (ITERATIONS a multiple of 4) and is timed by the host, throughput<name>Kernel runs eight
+// independent chains per work-item. c comes from the host so nothing can be folded at compile time.
+#define INSTRUCTION_KERNELS(name, T, CONSTANT, STEP)                                                                                       \
+    __kernel void latency##name##Kernel(__global T* out, const uint seed, const uint ITERATIONS) {                                         \
+        const T c = CONSTANT(seed);                                                                                                        \
+        T x = c;                                                                                                                           \
+        for (uint i = 0; i < ITERATIONS; i += 4) {                                                                                         \
+            x = STEP(x, c);                                                                                                                \
+            x = STEP(x, c);                                                                                                                \
+            x = STEP(x, c);                                                                                                                \
+            x = STEP(x, c);                                                                                                                \
+        }                                                                                                                                  \
+        out[0] = x;                                                                                                                        \
+    }                                                                                                                                      \
+    __kernel void throughput##name##Kernel(__global T* out, const uint seed, const uint ITERATIONS) {                                      \
+        uint idx = get_global_id(0);                                                                                                       \
+        const T c = CONSTANT(seed);                                                                                                        \
+        T x[8];                                                                                                                            \
+        for (int j = 0; j < 8; ++j)                                                                                                        \
+            x[j] = c + (T)((idx + j) & 7);                                                                                                 \
+        for (uint i = 0; i < ITERATIONS; ++i) {                                                                                            \
+            for (int j = 0; j < 8; ++j)                                                                                                    \
+                x[j] = STEP(x[j], c);                                                                                                      \
+        }                                                                                                                                  \
+        for (int j = 1; j < 8; ++j)                                                                                                        \
+            x[0] += x[j];                                                                                                                  \
+        out[idx] = x[0];                                                                                                                   \
+    }
+
+float halfSeed(uint seed) { return seed * 0.5f; }
+uint tripleSeed(uint seed) { return seed * 3u; }
+uint hashSeed(uint seed) { return seed * 0x9e3779b9u; }
+int signedHashSeed(uint seed) { return (int)(seed * 0x9e3779b9u); }
+ulong longHashSeed(uint seed) { return seed * 0x9e3779b97f4a7c15UL; }
+float sinFastStep(float x, float c) { return native_sin(x); }
+float sinStep(float x, float c) { return sin(x); }
+// exp(-x) settles near 0.567 instead of overflowing
+float expFastStep(float x, float c) { return native_exp(-x); }
+float expStep(float x, float c) { return exp(-x); }
+float rsqrtFastStep(float x, float c) { return native_rsqrt(x); }
+float rsqrtStep(float x, float c) { return 1.0f / sqrt(x); }
+uint mulStep(uint x, uint c) { return x * c; }
+uint madStep(uint x, uint c) { return x * c + c; }
+uint popcountStep(uint x, uint c) { return popcount(x); }
+uint clzStep(uint x, uint c) { return clz(x); }
+// One step is a round trip, int to float and back
+int intFloatStep(int x, int c) { return (int)(float)x; }
+ulong mul64Step(ulong x, ulong c) { return x * c; }
+ulong mad64Step(ulong x, ulong c) { return x * c + c; }
+
+INSTRUCTION_KERNELS(SinFast, float, halfSeed, sinFastStep)
+INSTRUCTION_KERNELS(Sin, float, halfSeed, sinStep)
+INSTRUCTION_KERNELS(ExpFast, float, halfSeed, expFastStep)
+INSTRUCTION_KERNELS(Exp, float, halfSeed, expStep)
+INSTRUCTION_KERNELS(RsqrtFast, float, halfSeed, rsqrtFastStep)
+INSTRUCTION_KERNELS(Rsqrt, float, halfSeed, rsqrtStep)
+INSTRUCTION_KERNELS(IntMul, uint, tripleSeed, mulStep)
+INSTRUCTION_KERNELS(IntMad, uint, tripleSeed, madStep)
+INSTRUCTION_KERNELS(Popcount, uint, hashSeed, popcountStep)
+INSTRUCTION_KERNELS(Clz, uint, hashSeed, clzStep)
+INSTRUCTION_KERNELS(IntFloat, int, signedHashSeed, intFloatStep)
+INSTRUCTION_KERNELS(Int64Mul, ulong, longHashSeed, mul64Step)
+INSTRUCTION_KERNELS(Int64Mad, ulong, longHashSeed, mad64Step)
+
+// Occupancy sweep, as in the CUDA and HIP modules. `reserved` is the local memory the host sizes per work-group to limit
+// how many fit on a compute unit; the kernels never touch it. The Registers variants keep more values live per work-item.
+#define OCCUPANCY_MEMORY_KERNEL(name, LOADS)                                                                                               \
+    __kernel void name(__global const float4* in, __global float4* out, const ulong n, __local float* reserved) {                          \
+        const ulong stride = get_global_size(0);                                                                                           \
+        for (ulong base = get_global_id(0); base < n; base += stride * LOADS) {                                                            \
+            float4 v[LOADS];                                                                                                               \
+            for (int k = 0; k < LOADS; ++k)                                                                                                \
+                v[k] = base + k * stride < n ? in[base + k * stride] : (float4)(0.0f);                                                     \
+            for (int k = 0; k < LOADS; ++k) {                                                                                              \
+                if (base + k * stride < n)                                                                                                 \
+                    out[base + k * stride] = v[k];                                                                                         \
+            }                                                                                                                              \
+        }                                                                                                                                  \
+    }
+
+#define OCCUPANCY_COMPUTE_KERNEL(name, CHAINS)                                                                                             \
+    __kernel void name(__global float* out, const uint iterations, __local float* reserved) {                                              \
+        uint idx = get_global_id(0);                                                                                                       \
+        float x[CHAINS];                                                                                                                   \
+        for (int j = 0; j < CHAINS; ++j)                                                                                                   \
+            x[j] = 1.0f + 0.001f * ((idx + j) & 255);                                                                                      \
+        for (uint i = 0; i < iterations; ++i) {                                                                                            \
+            for (int j = 0; j < CHAINS; ++j)                                                                                               \
+                x[j] = fma(x[j], 0.999f, 0.001f);                                                                                          \
+        }                                                                                                                                  \
+        for (int j = 1; j < CHAINS; ++j)                                                                                                   \
+            x[0] += x[j];                                                                                                                  \
+        out[idx] = x[0];                                                                                                                   \
+    }
+
+OCCUPANCY_MEMORY_KERNEL(occupancyMemoryKernel, 1)
+OCCUPANCY_MEMORY_KERNEL(occupancyMemoryRegistersKernel, 16)
+OCCUPANCY_COMPUTE_KERNEL(occupancyComputeKernel, 8)
+OCCUPANCY_COMPUTE_KERNEL(occupancyComputeRegistersKernel, 64)
+
+// Divergence, as divergenceKernel in the CUDA and HIP modules: one of four FMA loops per work-item, picked by paths[idx]
+__kernel void divergenceKernel(__global float* out, __global const uint* paths, const uint rounds) {
+    uint idx = get_global_id(0);
+    const uint path = paths[idx];
+    float x = 1.0f + 0.001f * (idx & 255), y = 0.5f;
+    for (uint r = 0; r < rounds; ++r) {
+        switch (path) {
+        case 0:
+            for (int i = 0; i < 32; ++i) {
+                x = fma(x, 0.999f, 0.001f);
+                y = fma(y, 0.999f, 0.002f);
+            }
+            break;
+        case 1:
+            for (int i = 0; i < 32; ++i) {
+                x = fma(x, 1.001f, -0.001f);
+                y = fma(y, 1.001f, -0.002f);
+            }
+            break;
+        case 2:
+            for (int i = 0; i < 32; ++i) {
+                x = fma(-x, 0.5f, 1.0f);
+                y = fma(-y, 0.25f, 1.0f);
             }
+            break;
+        default:
+            for (int i = 0; i < 32; ++i) {
+                x = fma(x, y, 0.25f);
+                y = fma(y, 0.5f, 0.125f);
+            }
+            break;
         }
-        C[row * N + col] = value;
     }
+    out[idx] = x + y;
 }
 
+// Atomics like the CUDA and HIP kernels. OpenCL 1.2 has no float atomics, so float add is a compare-and-swap loop on the
+// counter's bits, the way OpenCL code has to write it. The counters are uint for it. UPDATE is a macro rather than a
+// function so it works on both __global and __local pointers.
+#define ATOMIC_KERNELS(name, T, UPDATE)                                                                                                    \
+    __kernel void atomicGlobal##name##Kernel(__global T* counters, const uint addresses, const uint ITERATIONS) {                          \
+        uint idx = get_global_id(0);                                                                                                       \
+        __global T* counter = counters + (addresses ? idx % addresses : idx);                                                              \
+        for (uint i = 0; i < ITERATIONS; ++i)                                                                                              \
+            UPDATE(counter);                                                                                                               \
+    }                                                                                                                                      \
+    __kernel void atomicShared##name##Kernel(__global T* counters, const uint addresses, const uint ITERATIONS) {                          \
+        __local T tile[1024];                                                                                                              \
+        uint lid = get_local_id(0);                                                                                                        \
+        tile[lid] = 0;                                                                                                                     \
+        barrier(CLK_LOCAL_MEM_FENCE);                                                                                                      \
+        __local T* counter = tile + (addresses ? lid % addresses : lid);                                                                   \
+        for (uint i = 0; i < ITERATIONS; ++i)                                                                                              \
+            UPDATE(counter);                                                                                                               \
+        barrier(CLK_LOCAL_MEM_FENCE);                                                                                                      \
+        counters[get_global_id(0)] = tile[lid];                                                                                            \
+    }
+
+#define ADD_INT(counter) atomic_add(counter, 1u)
+#define CAS_INT(counter)                                                                                                                   \
+    {                                                                                                                                      \
+        uint old = *counter, assumed;                                                                                                      \
+        do {                                                                                                                               \
+            assumed = old;                                                                                                                 \
+            old = atomic_cmpxchg(counter, assumed, assumed + 1);                                                                           \
+        } while (old != assumed);                                                                                                          \
+    }
+#define ADD_FLOAT(counter)                                                                                                                 \
+    {                                                                                                                                      \
+        uint old = *counter, assumed;                                                                                                      \
+        do {                                                                                                                               \
+            assumed = old;                                                                                                                 \
+            old = atomic_cmpxchg(counter, assumed, as_uint(as_float(assumed) + 1.0f));                                                     \
+        } while (old != assumed);                                                                                                          \
+    }
+ATOMIC_KERNELS(AddInt, uint, ADD_INT)
+ATOMIC_KERNELS(AddFloat, uint, ADD_FLOAT)
+ATOMIC_KERNELS(CasInt, uint, CAS_INT)
+
+#ifdef cl_khr_int64_base_atomics
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+#define ADD_LONG(counter) atom_add(counter, 1UL)
+ATOMIC_KERNELS(AddLong, ulong, ADD_LONG)
+#endif
@@ -1,10 +1,20 @@
 #include "opencl_backend.hpp"
+#include "../shared/gemm.hpp"
+#include "../shared/ingest.hpp"
+#include "../shared/microbench.hpp"
 #include "../shared/shared.hpp"
+#include "../shared/suite.hpp"
+#include "../shared/sweep.hpp"
+#include "../shared/trace.hpp"
 #include "modules/opencl_kernels.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 CLBackend::clGetDeviceInfo_t CLBackend::clGetDeviceInfo = nullptr;
@@ -28,19 +38,28 @@ CLBackend::clGetPlatformInfo_t CLBackend::clGetPlatformInfo = nullptr;
 CLBackend::clEnqueueReadBuffer_t CLBackend::clEnqueueReadBuffer = nullptr;
 CLBackend::clSetKernelArg_t CLBackend::clSetKernelArg = nullptr;
 CLBackend::clReleaseMemObject_t CLBackend::clReleaseMemObject = nullptr;
+CLBackend::clEnqueueWriteBuffer_t CLBackend::clEnqueueWriteBuffer = nullptr;
+CLBackend::clEnqueueMapBuffer_t CLBackend::clEnqueueMapBuffer = nullptr;
+CLBackend::clEnqueueUnmapMemObject_t CLBackend::clEnqueueUnmapMemObject = nullptr;
+CLBackend::clFinish_t CLBackend::clFinish = nullptr;
+CLBackend::clGetKernelWorkGroupInfo_t CLBackend::clGetKernelWorkGroupInfo = nullptr;
 
 #define CL_ERR(call)                                                                                                                                 \
   do {                                                                                                                                               \
     int err = call;                                                                                                                                  \
     if (err != 0) {                                                                                                                                  \
-      std::cerr << OPENCL << "OpenCL error at opencl_backend.cpp:" << __LINE__ << ": " << err << "\n";                                               \
-      exit(EXIT_FAILURE);                                                                                                                            \
+      throw GPUMark::Error("OpenCL error at opencl_backend.cpp:" + std::to_string(__LINE__) + ": " + std::to_string(err));                           \
     }                                                                                                                                                \
   } while (0)
 
 bool CLBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
   constexpr static const float slowMSThreshold = 50.0f;
   if (linearSetTime > slowMSThreshold || linearMultiplyTime > slowMSThreshold) {
+    if (!Suite::interactive()) {
+      std::cout << OPENCL << "The initial tests were slow. Skipping further benchmarks on this device.\n";
+      Suite::skipDevice("initial tests were slow");
+      return true;
+    }
     // These words are randomly selected to make sure that the user is paying attention! Seriously, these tests
     // may actually take forever, so the user better know what they're in for.
     static const char* confirmWords[] = {"YES", "OPENCL", "CONTINUE", "YEAH", "SURE", "GOAHEAD", "FINE", "WHYNOT", "AFFIRMATIVE", "LETSGO", "OKAY"};
@@ -56,6 +75,7 @@ bool CLBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
     std::cin >> userInput;
     if (!stringsRoughlyMatch(userInput, confirmWords[randIdx])) {
       std::cout << OPENCL << "Aborting further benchmarks on this device.\n";
+      Suite::skipDevice("aborted by user");
       return true;
     }
     return false;
@@ -63,6 +83,50 @@ bool CLBackend::slowBenchmarks(float linearSetTime, float linearMultiplyTime) {
   return false;
 }
 
+namespace {
+// Releases the device's program, queue and context however prepareDeviceForBenchmarking is left, including a test that
+// throws. Buffers and kernels a failed test still holds keep their own reference to the context.
+struct DeviceGuard {
+  CLBackend::cl_context context = nullptr;
+  CLBackend::cl_command_queue queue = nullptr;
+  CLBackend::cl_program program = nullptr;
+
+  DeviceGuard() = default;
+  DeviceGuard(const DeviceGuard&) = delete;
+  DeviceGuard& operator=(const DeviceGuard&) = delete;
+  ~DeviceGuard() {
+    if (program)
+      CLBackend::clReleaseProgram(program);
+    if (queue)
+      CLBackend::clReleaseCommandQueue(queue);
+    if (context)
+      CLBackend::clReleaseContext(context);
+  }
+};
+
+// Unmaps and releases the ingest test's pinned ring and its device copy if the test throws
+struct IngestRing {
+  CLBackend::cl_command_queue queue = nullptr;
+  CLBackend::cl_mem pinned = nullptr;
+  CLBackend::cl_mem device = nullptr;
+  void* mapped = nullptr;
+
+  IngestRing() = default;
+  IngestRing(const IngestRing&) = delete;
+  IngestRing& operator=(const IngestRing&) = delete;
+  ~IngestRing() {
+    if (mapped) {
+      CLBackend::clEnqueueUnmapMemObject(queue, pinned, mapped, 0, nullptr, nullptr);
+      CLBackend::clFinish(queue);
+    }
+    if (pinned)
+      CLBackend::clReleaseMemObject(pinned);
+    if (device)
+      CLBackend::clReleaseMemObject(device);
+  }
+};
+} // namespace
+
 void CLBackend::prepareDeviceForBenchmarking(cl_device_id dev) {
   char deviceName[256];
   CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_NAME, sizeof(deviceName), deviceName, nullptr));
@@ -70,33 +134,34 @@ void CLBackend::prepareDeviceForBenchmarking(cl_device_id dev) {
 
   const cl_device_id devices[] = {dev};
   // Create a context, program, and command queue
-  cl_context context = clCreateContext(nullptr, 1, devices, nullptr, nullptr, nullptr);
+  DeviceGuard device;
+  cl_context context = device.context = clCreateContext(nullptr, 1, devices, nullptr, nullptr, nullptr);
   if (context == nullptr) {
     std::cout << OPENCL << "Failed to create OpenCL context for this platform, skipping...\n";
+    Suite::skipDevice("context creation failed");
     return;
   }
   cl_queue_properties props[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
-  cl_command_queue queue = clCreateCommandQueueWithProperties(context, devices[0], props, nullptr);
+  cl_command_queue queue = device.queue = clCreateCommandQueueWithProperties(context, devices[0], props, nullptr);
   if (queue == nullptr) {
     std::cout << OPENCL << "Failed to create OpenCL command queue for this platform, skipping...\n";
-    clReleaseContext(context);
+    Suite::skipDevice("command queue creation failed");
     return;
   }
   // Create a program
-  cl_program program = clCreateProgramWithSource(context, 1, &opencl_kernels_cl, nullptr, nullptr);
+  Trace::Span buildSpan("Program build", "init");
+  cl_program program = device.program = clCreateProgramWithSource(context, 1, &opencl_kernels_cl, nullptr, nullptr);
   if (program == nullptr) {
     std::cout << OPENCL << "Failed to create OpenCL program for this platform, skipping...\n";
-    clReleaseCommandQueue(queue);
-    clReleaseContext(context);
+    Suite::skipDevice("program creation failed");
     return;
   }
   // Compile program
   int err = clBuildProgram(program, 1, devices, nullptr, nullptr, nullptr);
+  buildSpan.end();
   if (err != 0) {
     std::cout << OPENCL << "Failed to build OpenCL program for this platform, skipping...\n";
-    clReleaseProgram(program);
-    clReleaseCommandQueue(queue);
-    clReleaseContext(context);
+    Suite::skipDevice("program build failed");
     return;
   }
 
@@ -108,8 +173,11 @@ void CLBackend::prepareDeviceForBenchmarking(cl_device_id dev) {
   cl_kernel linearSetKernel = clCreateKernel(program, "linearSetKernel", nullptr);
   cl_kernel linearMultiplyKernel = clCreateKernel(program, "linearMultiplyKernel", nullptr);
   std::cout << OPENCL << "Running simple tests...\n";
-  float linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel, context, queue);
-  float linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel, context, queue);
+  float linearSetTime = 0.0f, linearMultiplyTime = 0.0f;
+  if (Suite::shouldRun("linear_set"))
+    linearSetTime = runLinearSetBenchmark(threadsPerBlock, linearSetKernel, context, queue);
+  if (Suite::shouldRun("linear_multiply"))
+    linearMultiplyTime = runLinearMultiplyBenchmark(threadsPerBlock, linearMultiplyKernel, context, queue);
 
   if (slowBenchmarks(linearSetTime, linearMultiplyTime)) {
     clReleaseKernel(linearMultiplyKernel);
@@ -122,58 +190,233 @@ void CLBackend::prepareDeviceForBenchmarking(cl_device_id dev) {
   cl_kernel integerThroughputKernel = clCreateKernel(program, "integerThroughputKernel", nullptr);
   cl_kernel sharedMemoryKernel = clCreateKernel(program, "sharedMemoryKernel", nullptr);
   cl_kernel sgemmKernel = clCreateKernel(program, "sgemmKernel", nullptr);
-  runFmaBenchmark(threadsPerBlock, fmaKernel, context, queue);
-  runIntegerThroughputBenchmark(threadsPerBlock, integerThroughputKernel, context, queue);
-  runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel, context, queue);
-  runSgemmBenchmark(threadsPerBlock, sgemmKernel, context, queue);
+  cl_kernel sgemmTiledKernel = clCreateKernel(program, "sgemmTiledKernel", nullptr);
+  cl_kernel sgemmRegisterKernel = clCreateKernel(program, "sgemmRegisterKernel", nullptr);
+  if (Suite::shouldRun("fma"))
+    runFmaBenchmark(threadsPerBlock, fmaKernel, context, queue);
+  if (Suite::shouldRun("integer"))
+    runIntegerThroughputBenchmark(threadsPerBlock, integerThroughputKernel, context, queue);
+  if (Suite::shouldRun("shared_memory")) {
+    unsigned int computeUnits = 0, clockMegahertz = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(clockMegahertz), &clockMegahertz, nullptr));
+    runSharedMemoryBenchmark(threadsPerBlock, sharedMemoryKernel, clockMegahertz, computeUnits, context, queue);
+  }
+  if (Suite::shouldRun("sgemm"))
+    runSgemmBenchmark(threadsPerBlock, sgemmKernel, sgemmTiledKernel, sgemmRegisterKernel, context, queue);
+  if (Suite::shouldRun("pointer_chase")) {
+    unsigned long long globalMemory = 0, maxAllocation = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, nullptr));
+    cl_kernel pointerChaseInitKernel = clCreateKernel(program, "pointerChaseInitKernel", nullptr);
+    cl_kernel pointerChaseKernel = clCreateKernel(program, "pointerChaseKernel", nullptr);
+    runPointerChaseBenchmark(pointerChaseInitKernel, pointerChaseKernel, globalMemory, maxAllocation, threadsPerBlock, context, queue);
+    clReleaseKernel(pointerChaseInitKernel);
+    clReleaseKernel(pointerChaseKernel);
+  }
+  if (Suite::shouldRun("strided_access")) {
+    unsigned long long globalMemory = 0, maxAllocation = 0;
+    unsigned int cacheLineSize = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE, sizeof(cacheLineSize), &cacheLineSize, nullptr));
+    std::array<cl_kernel, 3> stridedReadKernels = {clCreateKernel(program, "stridedReadKernel4", nullptr),
+                                                   clCreateKernel(program, "stridedReadKernel8", nullptr),
+                                                   clCreateKernel(program, "stridedReadKernel16", nullptr)};
+    // Devices without a global memory cache report 0
+    runStridedAccessBenchmark(threadsPerBlock, stridedReadKernels, globalMemory, maxAllocation, cacheLineSize ? cacheLineSize : 64, context, queue);
+    for (cl_kernel kernel : stridedReadKernels) {
+      clReleaseKernel(kernel);
+    }
+  }
+  if (Suite::shouldRun("stream")) {
+    unsigned long long globalMemory = 0, maxAllocation = 0;
+    unsigned int computeUnits = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    cl_kernel streamInitKernel = clCreateKernel(program, "streamInitKernel", nullptr);
+    std::array<cl_kernel, 12> streamKernels;
+    for (size_t k = 0; k < streamKernels.size(); ++k) {
+      streamKernels[k] = clCreateKernel(program, Sweep::streamKernelName(k).c_str(), nullptr);
+    }
+    runStreamBenchmark(threadsPerBlock, streamInitKernel, streamKernels, globalMemory, maxAllocation, computeUnits, context, queue);
+    clReleaseKernel(streamInitKernel);
+    for (cl_kernel kernel : streamKernels) {
+      clReleaseKernel(kernel);
+    }
+  }
+  if (Suite::shouldRun("zero_copy")) {
+    unsigned long long globalMemory = 0, maxAllocation = 0;
+    unsigned int computeUnits = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    cl_kernel scaleKernel = clCreateKernel(program, "streamScaleKernel16", nullptr);
+    runZeroCopyBenchmark(threadsPerBlock, scaleKernel, globalMemory, maxAllocation, computeUnits, context, queue);
+    clReleaseKernel(scaleKernel);
+  }
+  if (Suite::shouldRun("ingest"))
+    runIngestBenchmark(context, queue);
+  if (Suite::shouldRun("precision")) {
+    unsigned int computeUnits = 0;
+    size_t extensionsSize = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_EXTENSIONS, 0, nullptr, &extensionsSize));
+    std::string extensions(extensionsSize, '\0');
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_EXTENSIONS, extensionsSize, extensions.data(), nullptr));
+    std::array<cl_kernel, 5> multiplyAddKernels{}, gemmKernels{};
+    for (Gemm::Format format : Gemm::formats) {
+      // The fp16 and fp64 kernels are only compiled where the device has the extension
+      if ((format == Gemm::Format::Half && extensions.find("cl_khr_fp16") == std::string::npos) ||
+          (format == Gemm::Format::Double && extensions.find("cl_khr_fp64") == std::string::npos))
+        continue;
+      multiplyAddKernels[static_cast<size_t>(format)] = clCreateKernel(program, Gemm::multiplyAddKernelName(format).c_str(), nullptr);
+      gemmKernels[static_cast<size_t>(format)] = clCreateKernel(program, Gemm::gemmKernelName(format).c_str(), nullptr);
+    }
+    runPrecisionBenchmark(threadsPerBlock, multiplyAddKernels, gemmKernels, computeUnits, context, queue);
+    for (size_t f = 0; f < multiplyAddKernels.size(); ++f) {
+      if (multiplyAddKernels[f])
+        clReleaseKernel(multiplyAddKernels[f]);
+      if (gemmKernels[f])
+        clReleaseKernel(gemmKernels[f]);
+    }
+  }
+  if (Suite::shouldRun("instruction_mix")) {
+    unsigned int computeUnits = 0, clockMegahertz = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(clockMegahertz), &clockMegahertz, nullptr));
+    std::vector<cl_kernel> latencyKernels, throughputKernels;
+    for (const Microbench::Instruction& instruction : Microbench::instructions()) {
+      latencyKernels.push_back(clCreateKernel(program, ("latency" + std::string(instruction.kernel) + "Kernel").c_str(), nullptr));
+      throughputKernels.push_back(clCreateKernel(program, ("throughput" + std::string(instruction.kernel) + "Kernel").c_str(), nullptr));
+    }
+    runInstructionMixBenchmark(threadsPerBlock, latencyKernels, throughputKernels, clockMegahertz, computeUnits, context, queue);
+    for (size_t i = 0; i < latencyKernels.size(); ++i) {
+      clReleaseKernel(latencyKernels[i]);
+      clReleaseKernel(throughputKernels[i]);
+    }
+  }
+  if (Suite::shouldRun("occupancy")) {
+    unsigned long long globalMemory = 0, maxAllocation = 0;
+    unsigned int computeUnits = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAllocation), &maxAllocation, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    std::vector<cl_kernel> occupancyKernels;
+    for (const Microbench::OccupancyKernel& kernel : Microbench::occupancyKernels()) {
+      occupancyKernels.push_back(clCreateKernel(program, kernel.kernel, nullptr));
+    }
+    runOccupancyBenchmark(occupancyKernels, dev, globalMemory, maxAllocation, computeUnits, context, queue);
+    for (cl_kernel kernel : occupancyKernels) {
+      clReleaseKernel(kernel);
+    }
+  }
+  if (Suite::shouldRun("divergence")) {
+    unsigned int computeUnits = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    cl_kernel divergenceKernel = clCreateKernel(program, "divergenceKernel", nullptr);
+    runDivergenceBenchmark(threadsPerBlock, divergenceKernel, dev, computeUnits, context, queue);
+    clReleaseKernel(divergenceKernel);
+  }
+  if (Suite::shouldRun("atomics")) {
+    unsigned int computeUnits = 0;
+    size_t extensionsSize = 0;
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, nullptr));
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_EXTENSIONS, 0, nullptr, &extensionsSize));
+    std::string extensions(extensionsSize, '\0');
+    CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_EXTENSIONS, extensionsSize, extensions.data(), nullptr));
+    std::vector<cl_kernel> globalKernels, sharedKernels;
+    for (const Microbench::AtomicOperation& operation : Microbench::atomicOperations()) {
+      // The int64 kernels are only compiled where the device has 64-bit atomics
+      if (operation.bytes == 8 && extensions.find("cl_khr_int64_base_atomics") == std::string::npos) {
+        globalKernels.push_back(nullptr);
+        sharedKernels.push_back(nullptr);
+        continue;
+      }
+      globalKernels.push_back(clCreateKernel(program, ("atomicGlobal" + std::string(operation.kernel) + "Kernel").c_str(), nullptr));
+      sharedKernels.push_back(clCreateKernel(program, ("atomicShared" + std::string(operation.kernel) + "Kernel").c_str(), nullptr));
+    }
+    runAtomicsBenchmark(threadsPerBlock, globalKernels, sharedKernels, computeUnits, context, queue);
+    for (size_t o = 0; o < globalKernels.size(); ++o) {
+      if (globalKernels[o])
+        clReleaseKernel(globalKernels[o]);
+      if (sharedKernels[o])
+        clReleaseKernel(sharedKernels[o]);
+    }
+  }
   // Release kernels
   clReleaseKernel(fmaKernel);
   clReleaseKernel(integerThroughputKernel);
   clReleaseKernel(sharedMemoryKernel);
   clReleaseKernel(sgemmKernel);
+  clReleaseKernel(sgemmTiledKernel);
+  clReleaseKernel(sgemmRegisterKernel);
   clReleaseKernel(linearMultiplyKernel);
   clReleaseKernel(linearSetKernel);
-
-  clReleaseProgram(program);
-  clReleaseCommandQueue(queue);
-  clReleaseContext(context);
 }
 
-void CLBackend::runBenchmark() {
-  int platformCount = 0;
-  CL_ERR(clGetPlatformIDs(0, nullptr, (unsigned int*)&platformCount));
-  if (platformCount == 0) {
-    std::cout << OPENCL << "No OpenCL platforms found.\n";
-    return;
-  }
+// Every device on every platform, paired with its platform name. Device indices are positions in this list.
+static std::vector<std::pair<std::string, CLBackend::cl_device_id>> listDevices() {
+  using namespace CLBackend;
+  std::vector<std::pair<std::string, cl_device_id>> result;
+  unsigned int platformCount = 0;
+  CL_ERR(clGetPlatformIDs(0, nullptr, &platformCount));
   std::vector<cl_platform_id> platforms(platformCount);
-  CL_ERR(clGetPlatformIDs(platformCount, platforms.data(), nullptr));
-  for (int p = 0; p < platformCount; ++p) {
+  if (platformCount > 0)
+    CL_ERR(clGetPlatformIDs(platformCount, platforms.data(), nullptr));
+  for (cl_platform_id platform : platforms) {
     char platformName[256];
-    CL_ERR(clGetPlatformInfo(platforms[p], CL_PLATFORM_NAME, sizeof(platformName), platformName, nullptr));
-    std::cout << OPENCL << "Platform " << p << ": " << platformName << "\n";
-
-    int deviceCount = 0;
-    CL_ERR(clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_ALL, 0, nullptr, (unsigned int*)&deviceCount));
-    if (deviceCount == 0) {
-      std::cout << OPENCL << "No OpenCL devices found on this platform, skipping...\n";
+    CL_ERR(clGetPlatformInfo(platform, CL_PLATFORM_NAME, sizeof(platformName), platformName, nullptr));
+    unsigned int deviceCount = 0;
+    // Platforms without devices report an error here, so the result is intentionally not checked
+    clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, nullptr, &deviceCount);
+    if (deviceCount == 0)
       continue;
-    }
-    // Ask the user if they want to benchmark this platform.
-    // This is becuase some platforms have repeats of devices (like rust_icl and ROCm)
-    std::cout << OPENCL << "Do you want to benchmark this platform? (y/n): ";
-    std::string userInput;
-    std::cin >> userInput;
-    if (!stringsRoughlyMatch(userInput, "y") && !stringsRoughlyMatch(userInput, "yes")) {
-      std::cout << OPENCL << "Skipping benchmarks on this platform.\n";
-      continue;
-    }
     std::vector<cl_device_id> devices(deviceCount);
-    CL_ERR(clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_ALL, deviceCount, devices.data(), nullptr));
-    for (int d = 0; d < deviceCount; ++d) {
-      prepareDeviceForBenchmarking(devices[d]);
+    CL_ERR(clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, deviceCount, devices.data(), nullptr));
+    for (cl_device_id dev : devices) {
+      result.emplace_back(platformName, dev);
     }
   }
+  return result;
+}
+
+std::vector<GPUMark::Device> CLBackend::enumerateDevices() {
+  std::vector<GPUMark::Device> devices;
+  if (!clGetPlatformIDs)
+    return devices;
+
+  auto listed = listDevices();
+  for (size_t i = 0; i < listed.size(); ++i) {
+    char deviceName[256];
+    unsigned long long globalMemory = 0;
+    CL_ERR(clGetDeviceInfo(listed[i].second, CL_DEVICE_NAME, sizeof(deviceName), deviceName, nullptr));
+    CL_ERR(clGetDeviceInfo(listed[i].second, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(globalMemory), &globalMemory, nullptr));
+    devices.push_back({GPUMark::Backend::OpenCL, static_cast<int>(i), deviceName, globalMemory, listed[i].first});
+  }
+  return devices;
+}
+
+CLBackend::cl_device_id CLBackend::getDeviceId(int index) {
+  auto listed = listDevices();
+  if (index < 0 || static_cast<size_t>(index) >= listed.size())
+    throw GPUMark::Error("OpenCL device index " + std::to_string(index) + " out of range");
+  return listed[index].second;
+}
+
+// Ask the user if they want to benchmark this platform.
+// This is becuase some platforms have repeats of devices (like rust_icl and ROCm)
+bool CLBackend::confirmPlatform(const std::string& platformName) {
+  std::cout << OPENCL << "Platform: " << platformName << "\n";
+  std::cout << OPENCL << "Do you want to benchmark this platform? (y/n): ";
+  std::string userInput;
+  std::cin >> userInput;
+  if (!stringsRoughlyMatch(userInput, "y") && !stringsRoughlyMatch(userInput, "yes")) {
+    std::cout << OPENCL << "Skipping benchmarks on this platform.\n";
+    return false;
+  }
+  return true;
 }
 
 #define OPENCL_BENCHMARK_KERNEL_1D(kernel, globalSize, localSize, milliseconds)                                                                      \
@@ -181,6 +424,7 @@ void CLBackend::runBenchmark() {
     cl_event __ocl_evt = nullptr;                                                                                                                    \
     size_t __glob = (globalSize);                                                                                                                    \
     size_t __loc = (localSize);                                                                                                                      \
+    Trace::Span __kernelSpan("Kernel launch + sync", "kernel");                                                                                      \
     int __err = clEnqueueNDRangeKernel(commandQueue, (kernel), 1, nullptr, &__glob, &__loc, 0, nullptr, &__ocl_evt);                                 \
     if (__err != 0) {                                                                                                                                \
       std::cerr << "Failed to enqueue kernel (clEnqueueNDRangeKernel): " << __err << "\n";                                                           \
@@ -195,6 +439,9 @@ void CLBackend::runBenchmark() {
         clGetEventProfilingInfo(__ocl_evt, CL_PROFILING_COMMAND_START, sizeof(__start), (void**)&__start, nullptr);                                  \
         clGetEventProfilingInfo(__ocl_evt, CL_PROFILING_COMMAND_END, sizeof(__end), (void**)&__end, nullptr);                                        \
         milliseconds = (double)(__end - __start) * 1e-6; /* ns -> ms */                                                                              \
+        __kernelSpan.end();                                                                                                                          \
+        if (Trace::enabled())                                                                                                                        \
+          Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", __kernelSpan.started(), milliseconds);                                         \
       }                                                                                                                                              \
       clReleaseEvent(__ocl_evt);                                                                                                                     \
     }                                                                                                                                                \
@@ -202,6 +449,7 @@ void CLBackend::runBenchmark() {
 
 float CLBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel linearSetFunc, cl_context context, cl_command_queue commandQueue) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
+  TRACE_SCOPE("1) Linear Set", "test");
   std::cout << OPENCL << "1) Linear Set (~" << N / 1000000 << "M elements)..." << std::flush;
 
   float* h_data = new float[N];
@@ -219,8 +467,11 @@ float CLBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel l
   std::cout << "\r" << OPENCL << "1) Linear Set (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   OPENCL_BENCHMARK_KERNEL_1D(linearSetFunc, globalSize, threadsPerBlock, milliseconds);
   std::cout << "\r" << OPENCL << "1) Linear Set (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   CL_ERR(clEnqueueReadBuffer(commandQueue, d_data, 1, 0, N * sizeof(float), h_data, 0, nullptr, nullptr));
+  downloadSpan.end();
 
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     if (h_data[i] != static_cast<float>(i)) {
@@ -229,6 +480,7 @@ float CLBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel l
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << OPENCL << "1) Linear Set (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -237,6 +489,7 @@ float CLBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel l
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
 
+  Suite::record("linear_set", milliseconds, valid);
   CL_ERR(clReleaseMemObject(d_data));
   delete[] h_data;
   return valid ? milliseconds : 0.0f;
@@ -245,6 +498,7 @@ float CLBackend::runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel l
 float CLBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_kernel linearMultiplyFunc, cl_context context,
                                             cl_command_queue commandQueue) {
   constexpr const unsigned long long N = (1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
+  TRACE_SCOPE("2) Linear Multiply", "test");
   std::cout << OPENCL << "2) Linear Multiply (~" << N / 1000000 << "M elements)..." << std::flush;
 
   float* h_data = new float[N];
@@ -274,7 +528,10 @@ float CLBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_ker
   std::cout << "\r" << OPENCL << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Running..." << std::flush;
   OPENCL_BENCHMARK_KERNEL_1D(linearMultiplyFunc, globalSize, threadsPerBlock, milliseconds);
   std::cout << "\r" << OPENCL << "2) Linear Multiply (~" << N / 1000000 << "M elements)... Verifying..." << std::flush;
+  Trace::Span downloadSpan("Download results", "transfer");
   CL_ERR(clEnqueueReadBuffer(commandQueue, d_out, 1, 0, N * sizeof(float), h_out, 0, nullptr, nullptr));
+  downloadSpan.end();
+  Trace::Span verifySpan("Verify", "verify");
   bool valid = true;
   for (unsigned long long i = 0ull; i < N; ++i) {
     float expected = static_cast<float>(i) * static_cast<float>(i) / 2;
@@ -285,6 +542,7 @@ float CLBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_ker
       break;
     }
   }
+  verifySpan.end();
   std::cout << "\r" << OPENCL << "2) Linear Multiply (~" << N / 1000000 << "M elements)...";
   if (valid) {
     std::cout << GREEN << " PASSED" << RESET;
@@ -293,6 +551,7 @@ float CLBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_ker
   }
   std::cout << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
 
+  Suite::record("linear_multiply", milliseconds, valid);
   CL_ERR(clReleaseMemObject(d_dataA));
   CL_ERR(clReleaseMemObject(d_dataB));
   CL_ERR(clReleaseMemObject(d_out));
@@ -305,6 +564,7 @@ float CLBackend::runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_ker
 float CLBackend::runFmaBenchmark(unsigned int threadsPerBlock, cl_kernel fmaFunc, cl_context context, cl_command_queue commandQueue) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(float); // 2GB worth of floats
   constexpr const unsigned int totalIterations = 3000;
+  TRACE_SCOPE("3) FMA", "test");
   std::cout << OPENCL << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Preparing..." << std::flush;
   float* h_out = new float[N];
   cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, N * sizeof(float), nullptr, nullptr);
@@ -325,6 +585,7 @@ float CLBackend::runFmaBenchmark(unsigned int threadsPerBlock, cl_kernel fmaFunc
   // which if we reached this point, it is.
   std::cout << "\r" << OPENCL << "3) FMA (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
   std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("fma", milliseconds);
   CL_ERR(clReleaseMemObject(d_out));
   delete[] h_out;
   return milliseconds;
@@ -334,6 +595,7 @@ float CLBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, cl_
                                                cl_command_queue commandQueue) {
   constexpr const unsigned long long N = (2ull * 1024 * 1024 * 1024) / sizeof(unsigned int); // 2GB worth of uints
   constexpr const unsigned int totalIterations = 5000;
+  TRACE_SCOPE("4) Integer Throughput", "test");
   std::cout << OPENCL << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Preparing..."
             << std::flush;
   unsigned int* h_out = new unsigned int[N];
@@ -355,86 +617,1033 @@ float CLBackend::runIntegerThroughputBenchmark(unsigned int threadsPerBlock, cl_
   // which if we reached this point, it is.
   std::cout << "\r" << OPENCL << "4) Integer Throughput (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
   std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  Suite::record("integer", milliseconds);
   CL_ERR(clReleaseMemObject(d_out));
   delete[] h_out;
   return milliseconds;
 }
 
-float CLBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, cl_kernel sharedMemoryFunc, cl_context context,
-                                          cl_command_queue commandQueue) {
-  constexpr const unsigned long long N = (1024 * 1024 * 1024) / sizeof(float); // 1GB worth of floats
-  constexpr const unsigned int totalIterations = 2000;
-  std::cout << OPENCL << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Preparing..."
+// Local memory reads and writes between work-items at every stride of Microbench::sharedMemoryStrides(), from
+// conflict-free to every lane of a group of 32 in the same bank. All strides run the iterations that take stride 1 20 ms.
+float CLBackend::runSharedMemoryBenchmark(unsigned int threadsPerBlock, cl_kernel sharedMemoryFunc, unsigned int clockMegahertz,
+                                          unsigned int computeUnits, cl_context context, cl_command_queue commandQueue) {
+  const std::vector<unsigned int>& strides = Microbench::sharedMemoryStrides();
+  TRACE_SCOPE("5) Shared Memory Bandwidth", "test");
+  std::cout << OPENCL << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)..." << std::flush;
+  const size_t threads = static_cast<size_t>(computeUnits) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, threads * sizeof(float), nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  auto timed = [&](unsigned int stride, unsigned int iterations) {
+    CL_ERR(clSetKernelArg(sharedMemoryFunc, 0, sizeof(cl_mem), &d_out));
+    CL_ERR(clSetKernelArg(sharedMemoryFunc, 1, sizeof(stride), &stride));
+    CL_ERR(clSetKernelArg(sharedMemoryFunc, 2, sizeof(iterations), &iterations));
+    size_t globalSize = threads, localSize = threadsPerBlock;
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, sharedMemoryFunc, 1, nullptr, &globalSize, &localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  unsigned int iterations = 256;
+  while (timed(1, iterations) < 20.0 && iterations < (1u << 24)) {
+    iterations *= 2;
+  }
+  std::vector<Microbench::SharedAccess> accesses;
+  for (unsigned int stride : strides) {
+    std::cout << "\r" << OPENCL << "5) Shared Memory Bandwidth (stride " << stride << ")...   " << std::flush;
+    double bytes = static_cast<double>(threads) * iterations * Microbench::sharedMemoryBytesPerIteration;
+    accesses.push_back({stride, bytes, timed(stride, iterations)});
+  }
+  CL_ERR(clReleaseMemObject(d_out));
+
+  std::cout << "\r" << OPENCL << "5) Shared Memory Bandwidth (" << strides.size() << " strides, 1 to 32 words and broadcast)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportSharedMemory(OPENCL, "shared_memory", accesses, clockMegahertz * 1e6, computeUnits);
+  float milliseconds = static_cast<float>(Microbench::conflictFreeMilliseconds(accesses));
+  Suite::record("shared_memory", milliseconds);
+  return milliseconds;
+}
+
+// C = A * B with three kernels over a sweep of sizes: one thread per element straight from global memory, 16x16
+// tiles in local memory, and 64x64 tiles with a 4x4 patch of C per thread in registers. Each kernel's result is checked
+// against the CPU on sampled elements at every size.
+float CLBackend::runSgemmBenchmark(unsigned int threadsPerBlock, cl_kernel naiveFunc, cl_kernel tiledFunc, cl_kernel registerFunc, cl_context context,
+                                     cl_command_queue commandQueue) {
+  const std::vector<unsigned int>& sizes = Gemm::sizes();
+  const size_t maxBytes = static_cast<size_t>(sizes.back()) * sizes.back() * sizeof(float);
+  TRACE_SCOPE("6) SGEMM", "test");
+  std::cout << OPENCL << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)..."
             << std::flush;
-  float* h_out = new float[N];
-  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, N * sizeof(float), nullptr, nullptr);
-  if (d_out == nullptr) {
-    std::cerr << OPENCL << "Failed to create device buffer for Shared Memory Bandwidth benchmark.\n";
-    delete[] h_out;
+  // Every kernel works in 16x16 work-groups
+  if (threadsPerBlock < 256) {
+    std::cout << " Skipped, needs work-groups of 256\n";
     return 0.0f;
   }
-  clSetKernelArg(sharedMemoryFunc, 0, sizeof(cl_mem), &d_out);
-  clSetKernelArg(sharedMemoryFunc, 1, sizeof(totalIterations), &totalIterations);
-  // clSetKernelArg(sharedMemoryFunc, 2, sizeof(N), &N);
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_A = clCreateBuffer(context, CL_MEM_READ_ONLY, maxBytes, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_B = clCreateBuffer(context, CL_MEM_READ_ONLY, maxBytes, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_C = clCreateBuffer(context, CL_MEM_READ_WRITE, maxBytes, nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  // One 2D range of 16x16 work-groups covering C, timed with the event's profiling info
+  auto launch = [&](cl_kernel function, unsigned int tile, unsigned int n) {
+    CL_ERR(clSetKernelArg(function, 0, sizeof(cl_mem), &d_A));
+    CL_ERR(clSetKernelArg(function, 1, sizeof(cl_mem), &d_B));
+    CL_ERR(clSetKernelArg(function, 2, sizeof(cl_mem), &d_C));
+    CL_ERR(clSetKernelArg(function, 3, sizeof(n), &n));
+    size_t groups = (n + tile - 1) / tile;
+    size_t globalSize[2] = {groups * 16, groups * 16};
+    size_t localSize[2] = {16, 16};
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, function, 2, nullptr, globalSize, localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    unsigned long start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  struct Variant {
+    cl_kernel function;
+    unsigned int tile; // Edge of the tile of C one block computes
+  };
+  const Variant variants[] = {{naiveFunc, 16}, {tiledFunc, 16}, {registerFunc, 64}};
+  std::vector<Gemm::Curve> curves = {{"Naive", "naive", {}}, {"Tiled 16x16", "tiled", {}}, {"Register 4x4", "register", {}}};
+  for (unsigned int n : sizes) {
+    TRACE_SCOPE("SGEMM size", "kernel");
+    const size_t bytes = static_cast<size_t>(n) * n * sizeof(float);
+    std::vector<float> h_A = Gemm::randomMatrix(n, 1), h_B = Gemm::randomMatrix(n, 2), h_C(static_cast<size_t>(n) * n);
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_A, true, 0, bytes, h_A.data(), 0, nullptr, nullptr));
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_B, true, 0, bytes, h_B.data(), 0, nullptr, nullptr));
+    for (size_t v = 0; v < std::size(variants); ++v) {
+      Gemm::Curve& curve = curves[v];
+      // Once a variant went over the budget (or was skipped), larger sizes are skipped too
+      if (!curve.milliseconds.empty() && (curve.milliseconds.back() == 0.0 || curve.milliseconds.back() > Gemm::timeBudgetMilliseconds)) {
+        curve.milliseconds.push_back(0.0);
+        continue;
+      }
+      std::cout << "\r" << OPENCL << "6) SGEMM (" << n << "x" << n << ", " << curve.name << ")..." << std::flush;
+      std::fill(h_C.begin(), h_C.end(), 0.0f);
+      CL_ERR(clEnqueueWriteBuffer(commandQueue, d_C, true, 0, bytes, h_C.data(), 0, nullptr, nullptr));
+      double best = launch(variants[v].function, variants[v].tile, n);
+      CL_ERR(clEnqueueReadBuffer(commandQueue, d_C, true, 0, bytes, h_C.data(), 0, nullptr, nullptr));
+      curve.valid = curve.valid && Gemm::verifySamples(h_A, h_B, h_C, n);
+      for (int run = 0; run < 2 && best < Gemm::timeBudgetMilliseconds; ++run) {
+        best = std::min(best, launch(variants[v].function, variants[v].tile, n));
+      }
+      curve.milliseconds.push_back(best);
+    }
+  }
+  CL_ERR(clReleaseMemObject(d_A));
+  CL_ERR(clReleaseMemObject(d_B));
+  CL_ERR(clReleaseMemObject(d_C));
+
+  bool valid = std::all_of(curves.begin(), curves.end(), [](const Gemm::Curve& curve) { return curve.valid; });
+  std::cout << "\r" << OPENCL << "6) SGEMM (" << sizes.front() << " to " << sizes.back() << " square matrices, naive, tiled and register-blocked)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  for (const Gemm::Curve& curve : curves) {
+    if (!curve.valid)
+      std::cout << OPENCL << curve.name << " does not match the CPU result\n";
+  }
+  Gemm::report(OPENCL, "sgemm", sizes, curves);
+  // The register-blocked kernel at 1024 (or the largest size it reached), as close as the sweep gets to the single
+  // 1024x1024 run this test used to time
+  float milliseconds = static_cast<float>(Gemm::millisecondsAt(sizes, curves.back(), 1024));
+  Suite::record("sgemm", milliseconds, valid);
+  return milliseconds;
+}
+// Dependent loads over a pseudo-randomly linked working set, from 1 KB up to half of VRAM. Every link lands on a different
+// 64-byte slot, so latency steps up each time the working set outgrows a cache level (or, at the largest sizes, the TLB).
+float CLBackend::runPointerChaseBenchmark(cl_kernel initFunc, cl_kernel chaseFunc, size_t totalMemory, size_t maxAllocation,
+                                           unsigned int threadsPerBlock, cl_context context, cl_command_queue commandQueue) {
+  constexpr size_t minBytes = 1024;
+  // Chain entries are 32-bit word offsets, so the largest working set is 16 GB
+  const size_t maxLimit = std::min<size_t>({totalMemory / 2, maxAllocation, 16ull * 1024 * 1024 * 1024});
+  size_t maxBytes = minBytes;
+  while (maxBytes * 2 <= maxLimit) {
+    maxBytes *= 2;
+  }
+  // Kernel arguments, so not const
+  unsigned int slotWords = 64 / sizeof(unsigned int);
+  unsigned int steps = 1u << 18;
+  unsigned long long multiplier = 6364136223846793005ull; // % 4 == 1
+  unsigned long long increment = 1442695040888963407ull;  // Odd
+  TRACE_SCOPE("13) Pointer-Chase Latency", "test");
+  std::cout << OPENCL << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", " << steps
+            << " dependent loads per size)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  cl_mem d_chain = clCreateBuffer(context, CL_MEM_READ_WRITE, maxBytes, nullptr, nullptr);
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(unsigned int), nullptr, nullptr);
+  allocSpan.end();
+  if (d_chain == nullptr || d_out == nullptr) {
+    std::cerr << OPENCL << "Failed to create device buffers for pointer-chase benchmark.\n";
+    if (d_chain)
+      clReleaseMemObject(d_chain);
+    if (d_out)
+      clReleaseMemObject(d_out);
+    return 0.0f;
+  }
+  CL_ERR(clSetKernelArg(initFunc, 0, sizeof(cl_mem), &d_chain));
+  CL_ERR(clSetKernelArg(initFunc, 2, sizeof(slotWords), &slotWords));
+  CL_ERR(clSetKernelArg(initFunc, 3, sizeof(multiplier), &multiplier));
+  CL_ERR(clSetKernelArg(initFunc, 4, sizeof(increment), &increment));
+  CL_ERR(clSetKernelArg(chaseFunc, 0, sizeof(cl_mem), &d_chain));
+  CL_ERR(clSetKernelArg(chaseFunc, 1, sizeof(steps), &steps));
+  CL_ERR(clSetKernelArg(chaseFunc, 2, sizeof(cl_mem), &d_out));
+
+  std::vector<double> sizes, nanoseconds;
   float milliseconds = 0;
-  size_t globalSize = ((size_t)N + threadsPerBlock - 1) / threadsPerBlock * threadsPerBlock;
-  std::cout << "\r" << OPENCL << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)... Running..."
-            << std::flush;
-  OPENCL_BENCHMARK_KERNEL_1D(sharedMemoryFunc, globalSize, threadsPerBlock, milliseconds);
-  // There is no more verifications after this benchmark. The first two were to make sure the device is working correctly,
-  // which if we reached this point, it is.
-  std::cout << "\r" << OPENCL << "5) Shared Memory Bandwidth (~" << N / 1000000 << "M elements, " << totalIterations << " iterations)...";
-  std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    unsigned long long slots = bytes / (slotWords * sizeof(unsigned int));
+    CL_ERR(clSetKernelArg(initFunc, 1, sizeof(slots), &slots));
+    size_t initGlobalSize = (slots + threadsPerBlock - 1) / threadsPerBlock * threadsPerBlock;
+    OPENCL_BENCHMARK_KERNEL_1D(initFunc, initGlobalSize, threadsPerBlock, milliseconds);
+    // One untimed walk first, so the timed one starts with whatever part of the set fits already cached
+    OPENCL_BENCHMARK_KERNEL_1D(chaseFunc, 1, 1, milliseconds);
+    OPENCL_BENCHMARK_KERNEL_1D(chaseFunc, 1, 1, milliseconds);
+    sizes.push_back(static_cast<double>(bytes));
+    nanoseconds.push_back(milliseconds * 1e6 / steps);
+  }
+  std::cout << "\r" << OPENCL << "13) Pointer-Chase Latency (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes) << ", "
+            << steps << " dependent loads per size)... Done\n";
+  Sweep::reportLatencyCurve(OPENCL, "pointer_chase", sizes, nanoseconds);
+  Suite::record("pointer_chase", milliseconds);
+
+  CL_ERR(clReleaseMemObject(d_chain));
   CL_ERR(clReleaseMemObject(d_out));
-  delete[] h_out;
   return milliseconds;
 }
 
-float CLBackend::runSgemmBenchmark(unsigned int threadsPerBlock, cl_kernel sgemmFunc, cl_context context, cl_command_queue commandQueue) {
-  constexpr const unsigned long long N = 1024; // 1024x1024 matrices
-  constexpr const unsigned int totalIterations = 5000;
-  std::cout << OPENCL << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations << " iterations)..." << std::flush;
-  float* h_A = new float[N * N];
-  float* h_B = new float[N * N];
-  float* h_C = new float[N * N];
-  // Initialize matrices
-  for (unsigned long long i = 0; i < N * N; ++i) {
-    h_A[i] = static_cast<float>(i % 100) / 100.0f;
-    h_B[i] = static_cast<float>((i * 3) % 100) / 100.0f;
-    h_C[i] = 0.0f;
-  }
-  cl_mem d_A = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, N * N * sizeof(float), h_A, nullptr);
-  cl_mem d_B = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, N * N * sizeof(float), h_B, nullptr);
-  cl_mem d_C = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, N * N * sizeof(float), h_C, nullptr);
-  if (d_A == nullptr || d_B == nullptr || d_C == nullptr) {
-    std::cerr << OPENCL << "Failed to create device buffers for SGEMM benchmark.\n";
-    delete[] h_A;
-    delete[] h_B;
-    delete[] h_C;
+// linearSetKernel and linearMultiplyKernel only read perfectly coalesced, unit-stride data. This sweeps stride, misalignment
+// and element width to show what gather-like data layouts cost.
+float CLBackend::runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<cl_kernel, 3>& kernels, size_t totalMemory,
+                                           size_t maxAllocation, unsigned int cacheLineSize, cl_context context, cl_command_queue commandQueue) {
+  constexpr unsigned int widths[] = {4, 8, 16};
+  constexpr unsigned int strides[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+  constexpr unsigned int offsets[] = {0, 1};
+  constexpr unsigned long long maxElements = 16ull * 1024 * 1024;
+  const size_t bytes = std::min<size_t>({1ull << 30, totalMemory / 4, maxAllocation});
+  TRACE_SCOPE("14) Strided Access", "test");
+  std::cout << OPENCL << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  // Zeroed on creation, so the kernels' never-true comparison stays never true
+  std::vector<char> zeros(bytes, 0);
+  cl_mem d_in = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, zeros.data(), nullptr);
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(float), nullptr, nullptr);
+  allocSpan.end();
+  if (d_in == nullptr || d_out == nullptr) {
+    std::cerr << OPENCL << "Failed to create device buffers for strided access benchmark.\n";
+    if (d_in)
+      clReleaseMemObject(d_in);
+    if (d_out)
+      clReleaseMemObject(d_out);
     return 0.0f;
   }
-  clSetKernelArg(sgemmFunc, 0, sizeof(cl_mem), &d_A);
-  clSetKernelArg(sgemmFunc, 1, sizeof(cl_mem), &d_B);
-  clSetKernelArg(sgemmFunc, 2, sizeof(cl_mem), &d_C);
-  clSetKernelArg(sgemmFunc, 3, sizeof(N), &N);
-  clSetKernelArg(sgemmFunc, 4, sizeof(totalIterations), &totalIterations);
-  float milliseconds = 0;
-  // Although we could dispatch in 2D, we stick to 1D for parity with the other APIs.
-  size_t globalSize = ((size_t)N + threadsPerBlock - 1) / threadsPerBlock * threadsPerBlock;
-  size_t localSize = threadsPerBlock;
-  std::cout << "\r" << OPENCL << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations
-            << " iterations)... Running..." << std::flush;
-  OPENCL_BENCHMARK_KERNEL_1D(sgemmFunc, globalSize, localSize, milliseconds);
-  // There is no more verifications after this benchmark. The first two were to make sure the device is working correctly,
-  // which if we reached this point, it is.
-  std::cout << "\r" << OPENCL << "6) SGEMM/Matrix multiplication (" << N << "x" << N << " matrices, " << totalIterations << " iterations)...";
-  std::cout << GREEN << " PASSED" << RESET << " in " << std::fixed << std::setprecision(5) << milliseconds << " ms\n";
+  for (cl_kernel kernel : kernels) {
+    CL_ERR(clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_in));
+    CL_ERR(clSetKernelArg(kernel, 1, sizeof(cl_mem), &d_out));
+  }
+
+  std::vector<Sweep::AccessPattern> patterns;
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(widths); ++w) {
+    {
+      // The first launch of each kernel pays for building it, keep that out of the table
+      unsigned long long n = threadsPerBlock;
+      unsigned int stride = 1, offset = 0;
+      CL_ERR(clSetKernelArg(kernels[w], 2, sizeof(n), &n));
+      CL_ERR(clSetKernelArg(kernels[w], 3, sizeof(stride), &stride));
+      CL_ERR(clSetKernelArg(kernels[w], 4, sizeof(offset), &offset));
+      float milliseconds = 0;
+      OPENCL_BENCHMARK_KERNEL_1D(kernels[w], threadsPerBlock, threadsPerBlock, milliseconds);
+    }
+    for (unsigned int stride : strides) {
+      for (unsigned int offset : offsets) {
+        unsigned long long n = std::min<unsigned long long>(maxElements, (bytes / widths[w] - offset) / stride);
+        CL_ERR(clSetKernelArg(kernels[w], 2, sizeof(n), &n));
+        CL_ERR(clSetKernelArg(kernels[w], 3, sizeof(stride), &stride));
+        CL_ERR(clSetKernelArg(kernels[w], 4, sizeof(offset), &offset));
+        size_t globalSize = (n + threadsPerBlock - 1) / threadsPerBlock * threadsPerBlock;
+        float milliseconds = 0;
+        OPENCL_BENCHMARK_KERNEL_1D(kernels[w], globalSize, threadsPerBlock, milliseconds);
+        patterns.push_back({widths[w], stride, offset, static_cast<double>(n), milliseconds});
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  std::cout << "\r" << OPENCL << "14) Strided Access (stride 1-1024, offset 0/1, 4/8/16-byte elements)... Done\n";
+  Sweep::reportAccessPatterns(OPENCL, "strided_access", patterns, 32, cacheLineSize);
+  Suite::record("strided_access", totalMilliseconds);
+
+  CL_ERR(clReleaseMemObject(d_in));
+  CL_ERR(clReleaseMemObject(d_out));
+  return totalMilliseconds;
+}
+
+// STREAM (McCalpin): Copy, Scale, Add and Triad over arrays far larger than any cache, each repeated and reported by its
+// fastest run, in scalar, float2 and float4 loads/stores to show how much wider accesses help.
+float CLBackend::runStreamBenchmark(unsigned int threadsPerBlock, cl_kernel initFunc, const std::array<cl_kernel, 12>& kernels, size_t totalMemory,
+                                    size_t maxAllocation, unsigned int computeUnits, cl_context context, cl_command_queue commandQueue) {
+  constexpr int trials = 10; // STREAM's NTIMES, the first run of every kernel is a warm-up
+  constexpr const char* functions[] = {"Copy", "Scale", "Add", "Triad"};
+  constexpr unsigned int arrays[] = {2, 2, 3, 3}; // Arrays each function reads plus writes
+  constexpr const char* types[] = {"float", "float2", "float4"};
+  constexpr unsigned int widths[] = {4, 8, 16};
+  // STREAM asks for arrays at least 4x the last-level cache. 256 MB is far past that on any GPU.
+  const size_t bytes = std::min<size_t>({256ull << 20, totalMemory / 8, maxAllocation}) / 16 * 16;
+  unsigned long long floats = bytes / sizeof(float);
+  float scalar = 3.0f;
+  TRACE_SCOPE("15) STREAM", "test");
+  std::cout << OPENCL << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")..." << std::flush;
+
+  Trace::Span allocSpan("Allocate", "alloc");
+  cl_mem d_a = clCreateBuffer(context, CL_MEM_READ_WRITE, bytes, nullptr, nullptr);
+  cl_mem d_b = clCreateBuffer(context, CL_MEM_READ_WRITE, bytes, nullptr, nullptr);
+  cl_mem d_c = clCreateBuffer(context, CL_MEM_READ_WRITE, bytes, nullptr, nullptr);
+  allocSpan.end();
+  if (d_a == nullptr || d_b == nullptr || d_c == nullptr) {
+    std::cerr << OPENCL << "Failed to create device buffers for STREAM benchmark.\n";
+    for (cl_mem buffer : {d_a, d_b, d_c}) {
+      if (buffer)
+        clReleaseMemObject(buffer);
+    }
+    return 0.0f;
+  }
+  {
+    CL_ERR(clSetKernelArg(initFunc, 0, sizeof(cl_mem), &d_a));
+    CL_ERR(clSetKernelArg(initFunc, 1, sizeof(cl_mem), &d_b));
+    CL_ERR(clSetKernelArg(initFunc, 2, sizeof(cl_mem), &d_c));
+    CL_ERR(clSetKernelArg(initFunc, 3, sizeof(floats), &floats));
+    float milliseconds = 0;
+    OPENCL_BENCHMARK_KERNEL_1D(initFunc, static_cast<size_t>(computeUnits) * 32 * threadsPerBlock, threadsPerBlock, milliseconds);
+  }
+  for (cl_kernel kernel : kernels) {
+    CL_ERR(clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_a));
+    CL_ERR(clSetKernelArg(kernel, 1, sizeof(cl_mem), &d_b));
+    CL_ERR(clSetKernelArg(kernel, 2, sizeof(cl_mem), &d_c));
+    CL_ERR(clSetKernelArg(kernel, 3, sizeof(scalar), &scalar));
+  }
+
+  std::vector<Sweep::Trials> results(std::size(functions) * std::size(types));
+  float totalMilliseconds = 0;
+  for (size_t w = 0; w < std::size(types); ++w) {
+    unsigned long long n = bytes / widths[w];
+    // Enough blocks to fill the device, the grid-stride loop covers the rest
+    unsigned long long blocks = std::min<unsigned long long>((n + threadsPerBlock - 1) / threadsPerBlock, computeUnits * 32ull);
+    for (size_t f = 0; f < std::size(functions); ++f) {
+      Sweep::Trials& result = results[f * std::size(types) + w];
+      result.name = std::string(functions[f]) + " " + types[w];
+      result.key = tolower(functions[f]) + "_" + types[w];
+      result.bytes = static_cast<double>(arrays[f]) * bytes;
+    }
+    // STREAM runs the four functions in turn on every trial, so each one starts with the others' data out of cache
+    for (int trial = 0; trial < trials; ++trial) {
+      for (size_t f = 0; f < std::size(functions); ++f) {
+        cl_kernel kernel = kernels[w * std::size(functions) + f];
+        CL_ERR(clSetKernelArg(kernel, 4, sizeof(n), &n));
+        float milliseconds = 0;
+        OPENCL_BENCHMARK_KERNEL_1D(kernel, blocks * threadsPerBlock, threadsPerBlock, milliseconds);
+        if (trial > 0)
+          results[f * std::size(types) + w].milliseconds.push_back(milliseconds);
+        totalMilliseconds += milliseconds;
+      }
+    }
+  }
+
+  // Triad ran last: c = a + scalar * b = 1 + 3 * 2
+  bool valid = true;
+  for (unsigned long long i : {0ull, floats / 2, floats - 1}) {
+    float value = 0.0f;
+    CL_ERR(clEnqueueReadBuffer(commandQueue, d_c, 1, i * sizeof(float), sizeof(float), &value, 0, nullptr, nullptr));
+    if (value != 7.0f) {
+      valid = false;
+      std::cerr << " Data verification failed at index " << i << ": expected 7, got " << value << "\n";
+      break;
+    }
+  }
+  std::cout << "\r" << OPENCL << "15) STREAM (" << Sweep::formatBytes(bytes) << " per array, best of " << trials - 1 << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::reportBestOfN(OPENCL, "stream", results);
+  Suite::record("stream", totalMilliseconds, valid);
+
+  CL_ERR(clReleaseMemObject(d_a));
+  CL_ERR(clReleaseMemObject(d_b));
+  CL_ERR(clReleaseMemObject(d_c));
+  return valid ? totalMilliseconds : 0.0f;
+}
+
+// Kernels that read and write mapped pinned host memory directly, with no copies, against the usual upload, kernel and
+// download. Zero-copy wins while the copies' fixed costs dominate, and loses once every byte crossing the bus twice
+// at kernel access granularity costs more than bulk DMA.
+float CLBackend::runZeroCopyBenchmark(unsigned int threadsPerBlock, cl_kernel scaleFunc, size_t totalMemory, size_t maxAllocation,
+                                      unsigned int computeUnits, cl_context context, cl_command_queue commandQueue) {
+  constexpr size_t minBytes = 4ull * 1024;                                // 4 KB
+  const size_t maxBytes = std::min<size_t>({256ull << 20, totalMemory / 8, maxAllocation}); // 256 MB, or an eighth of VRAM on small devices
+  float scalar = 3.0f;
+  TRACE_SCOPE("16) Zero-Copy", "test");
+  std::cout << OPENCL << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  // CL_MEM_ALLOC_HOST_PTR asks for host-accessible memory the device can reach without a copy
+  cl_mem m_in = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, maxBytes, nullptr, nullptr);
+  cl_mem m_out = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, maxBytes, nullptr, nullptr);
+  cl_mem d_in = clCreateBuffer(context, CL_MEM_READ_WRITE, maxBytes, nullptr, nullptr);
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, maxBytes, nullptr, nullptr);
+  allocSpan.end();
+  if (m_in == nullptr || m_out == nullptr || d_in == nullptr || d_out == nullptr) {
+    std::cerr << OPENCL << "Failed to create buffers for zero-copy benchmark.\n";
+    for (cl_mem buffer : {m_in, m_out, d_in, d_out}) {
+      if (buffer)
+        clReleaseMemObject(buffer);
+    }
+    return 0.0f;
+  }
+  std::vector<float> h_in(maxBytes / sizeof(float), 1.0f), h_out(maxBytes / sizeof(float));
+  CL_ERR(clEnqueueWriteBuffer(commandQueue, m_in, 1, 0, maxBytes, h_in.data(), 0, nullptr, nullptr));
+
+  // streamScaleKernel16: out = scalar * in, as float4 so every bus transaction is as wide as a work-item can make it
+  CL_ERR(clSetKernelArg(scaleFunc, 3, sizeof(scalar), &scalar));
+  auto launch = [&](cl_mem in, cl_mem out, size_t bytes) {
+    unsigned long long n = bytes / 16;
+    size_t groups = std::min<size_t>((n + threadsPerBlock - 1) / threadsPerBlock, computeUnits * 32ull);
+    size_t globalSize = groups * threadsPerBlock, localSize = threadsPerBlock;
+    CL_ERR(clSetKernelArg(scaleFunc, 0, sizeof(cl_mem), &in));
+    CL_ERR(clSetKernelArg(scaleFunc, 1, sizeof(cl_mem), &in));
+    CL_ERR(clSetKernelArg(scaleFunc, 2, sizeof(cl_mem), &out));
+    CL_ERR(clSetKernelArg(scaleFunc, 4, sizeof(n), &n));
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, scaleFunc, 1, nullptr, &globalSize, &localSize, 0, nullptr, nullptr));
+  };
+  // The OpenCL way to hand a buffer to the host and back: map before the host writes or reads it, unmap before a kernel uses it
+  auto runZeroCopy = [&](size_t bytes) {
+    int mapErr = 0;
+    void* input = clEnqueueMapBuffer(commandQueue, m_in, 1, CL_MAP_WRITE_INVALIDATE_REGION, 0, bytes, 0, nullptr, nullptr, &mapErr);
+    CL_ERR(mapErr);
+    CL_ERR(clEnqueueUnmapMemObject(commandQueue, m_in, input, 0, nullptr, nullptr));
+    launch(m_in, m_out, bytes);
+    void* output = clEnqueueMapBuffer(commandQueue, m_out, 1, CL_MAP_READ, 0, bytes, 0, nullptr, nullptr, &mapErr);
+    CL_ERR(mapErr);
+    CL_ERR(clEnqueueUnmapMemObject(commandQueue, m_out, output, 0, nullptr, nullptr));
+    CL_ERR(clFinish(commandQueue));
+  };
+  auto runExplicitCopy = [&](size_t bytes) {
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_in, 0, 0, bytes, h_in.data(), 0, nullptr, nullptr));
+    launch(d_in, d_out, bytes);
+    CL_ERR(clEnqueueReadBuffer(commandQueue, d_out, 1, 0, bytes, h_out.data(), 0, nullptr, nullptr));
+  };
+
+  using clock = std::chrono::steady_clock;
+  auto timeRuns = [&](size_t bytes, auto&& run) {
+    int reps = Sweep::repetitions(bytes, 256ull * 1024 * 1024, 3, 1000);
+    // Warm up so lazy driver setup for this size is not timed
+    run(bytes);
+    auto start = clock::now();
+    for (int i = 0; i < reps; ++i) {
+      run(bytes);
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count() / reps;
+    return Sweep::Point{static_cast<double>(bytes), milliseconds};
+  };
+
+  std::vector<Sweep::Point> zeroCopy, explicitCopy;
+  for (size_t bytes : Sweep::powersOfTwo(minBytes, maxBytes)) {
+    TRACE_SCOPE("Zero-copy size step", "transfer");
+    zeroCopy.push_back(timeRuns(bytes, runZeroCopy));
+    explicitCopy.push_back(timeRuns(bytes, runExplicitCopy));
+  }
+
+  // Mapping the input for writing invalidated it, so put the ones back before checking
+  CL_ERR(clEnqueueWriteBuffer(commandQueue, m_in, 1, 0, maxBytes, h_in.data(), 0, nullptr, nullptr));
+  launch(m_in, m_out, maxBytes);
+  int mapErr = 0;
+  float* output = static_cast<float*>(clEnqueueMapBuffer(commandQueue, m_out, 1, CL_MAP_READ, 0, maxBytes, 0, nullptr, nullptr, &mapErr));
+  CL_ERR(mapErr);
+  bool valid = std::all_of(output, output + maxBytes / sizeof(float), [](float value) { return value == 3.0f; });
+  CL_ERR(clEnqueueUnmapMemObject(commandQueue, m_out, output, 0, nullptr, nullptr));
+  CL_ERR(clFinish(commandQueue));
+  std::cout << "\r" << OPENCL << "16) Zero-Copy (" << Sweep::formatBytes(minBytes) << " to " << Sweep::formatBytes(maxBytes)
+            << ", mapped host memory vs copy + kernel)...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  } else {
+    std::cout << RED << " FAILED" << RESET << "\n";
+  }
+  Sweep::printTable(OPENCL, {"Zero-copy", "Copy + kernel"}, {zeroCopy, explicitCopy});
+  double crossover = Sweep::crossoverBytes(zeroCopy, explicitCopy);
+  if (crossover == 0.0) {
+    std::cout << OPENCL << "Zero-copy is faster at every size measured\n";
+  } else if (crossover == zeroCopy.front().bytes) {
+    std::cout << OPENCL << "Copy + kernel is faster at every size measured\n";
+  } else {
+    std::cout << OPENCL << "Zero-copy stops winning at " << Sweep::formatBytes(crossover) << "\n";
+  }
+  float milliseconds = static_cast<float>(zeroCopy.back().milliseconds);
+  Suite::record("zero_copy", milliseconds, valid);
+  Suite::metric("zero_copy", "crossover_bytes", crossover);
+  Sweep::record("zero_copy", "zero_copy", zeroCopy);
+  Sweep::record("zero_copy", "explicit_copy", explicitCopy);
+
+  for (cl_mem buffer : {m_in, m_out, d_in, d_out}) {
+    CL_ERR(clReleaseMemObject(buffer));
+  }
+  return milliseconds;
+}
+
+// Reads a file into device memory through a ring of pinned buffers, each read uploaded as soon as it lands while the
+// next reads are in flight. Disk, staging and PCIe are also timed on their own to show which one the pipeline runs into.
+float CLBackend::runIngestBenchmark(cl_context context, cl_command_queue commandQueue) {
+  constexpr size_t chunkBytes = 8ull << 20; // 8 MB
+  constexpr unsigned int ringSlots = 4;
+  std::string path = Suite::ingestFile();
+  const bool temporary = path.empty();
+  TRACE_SCOPE("22) File Ingest", "test");
+  std::cout << OPENCL << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")..." << std::flush;
+  Trace::Span allocSpan("Allocate", "alloc");
+  if (temporary)
+    path = Suite::temporaryIngestFile();
+  const unsigned long long fileBytes = Ingest::fileSize(path);
+  if (fileBytes == 0)
+    throw GPUMark::Error(path + " is empty");
+  // A host-accessible buffer kept mapped for the whole test is how OpenCL hands out pinned memory
+  IngestRing buffers;
+  buffers.queue = commandQueue;
+  buffers.pinned = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, chunkBytes * ringSlots, nullptr, nullptr);
+  buffers.device = clCreateBuffer(context, CL_MEM_READ_WRITE, chunkBytes * ringSlots, nullptr, nullptr);
+  if (buffers.pinned == nullptr || buffers.device == nullptr) {
+    std::cerr << OPENCL << "Failed to create buffers for ingest benchmark.\n";
+    return 0.0f;
+  }
+  cl_mem m_ring = buffers.pinned, d_ring = buffers.device;
+  int mapErr = 0;
+  buffers.mapped = clEnqueueMapBuffer(commandQueue, m_ring, 1, CL_MAP_WRITE, 0, chunkBytes * ringSlots, 0, nullptr, nullptr, &mapErr);
+  CL_ERR(mapErr);
+  char* h_ring = static_cast<char*>(buffers.mapped);
+  // Direct I/O needs the buffers on a block boundary, which OpenCL does not promise for mapped memory
+  const bool aligned = reinterpret_cast<uintptr_t>(h_ring) % Ingest::directAlignment == 0;
+  std::vector<void*> ring;
+  for (unsigned int slot = 0; slot < ringSlots; ++slot) {
+    ring.push_back(h_ring + slot * chunkBytes);
+  }
+  allocSpan.end();
+
+  // Uploads run in order on the one queue, and each slot keeps the event of its last upload
+  std::vector<void*> uploads(ringSlots, nullptr);
+  auto waitUpload = [&](unsigned int slot) {
+    if (uploads[slot]) {
+      CL_ERR(clWaitForEvents(1, (const void**)&uploads[slot]));
+      CL_ERR(clReleaseEvent(uploads[slot]));
+      uploads[slot] = nullptr;
+    }
+  };
+  auto upload = [&](unsigned int slot, size_t bytes, unsigned long long) {
+    waitUpload(slot);
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_ring, 0, slot * chunkBytes, bytes, ring[slot], 0, nullptr, &uploads[slot]));
+  };
+
+  using clock = std::chrono::steady_clock;
+  Ingest::Stages stages{};
+  stages.bytes = fileBytes;
+  {
+    Trace::Span span("Disk", "transfer");
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, aligned);
+    stages.method = reader->method();
+    stages.direct = reader->direct();
+    stages.diskMilliseconds = Ingest::readMilliseconds(*reader, ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Staging", "transfer");
+    stages.stagingMilliseconds = Ingest::stagingMilliseconds(ring, chunkBytes, fileBytes);
+  }
+  {
+    Trace::Span span("Upload", "transfer");
+    auto start = clock::now();
+    unsigned int slot = 0;
+    for (unsigned long long offset = 0; offset < fileBytes; offset += chunkBytes) {
+      upload(slot, static_cast<size_t>(std::min<unsigned long long>(chunkBytes, fileBytes - offset)), offset);
+      slot = (slot + 1) % ringSlots;
+    }
+    for (unsigned int s = 0; s < ringSlots; ++s) {
+      waitUpload(s);
+    }
+    stages.uploadMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+  unsigned int lastSlot = 0;
+  {
+    Trace::Span span("Pipeline", "transfer");
+    // Opened again so no pages from the disk pass are left in the cache
+    std::unique_ptr<Ingest::FileReader> reader = Ingest::openReader(path, ringSlots, aligned);
+    auto start = clock::now();
+    lastSlot = Ingest::pipeline(*reader, ring, chunkBytes, fileBytes, upload, waitUpload);
+    stages.pipelineMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+  // The last chunk is still in its device slot, and has to match the end of the file
+  const unsigned long long lastOffset = (fileBytes - 1) / chunkBytes * chunkBytes;
+  std::vector<char> lastChunk(static_cast<size_t>(fileBytes - lastOffset));
+  CL_ERR(clEnqueueReadBuffer(commandQueue, d_ring, 1, lastSlot * chunkBytes, lastChunk.size(), lastChunk.data(), 0, nullptr, nullptr));
+  bool valid = Ingest::matchesFile(path, lastOffset, lastChunk.data(), lastChunk.size());
+  std::cout << "\r" << OPENCL << "22) File Ingest (" << (temporary ? "temporary file" : path) << ")...";
+  if (valid) {
+    std::cout << GREEN << " PASSED" << RESET;
+  } else {
+    std::cout << RED << " FAILED" << RESET;
+  }
+  std::cout << " " << Sweep::formatBytes(static_cast<double>(fileBytes)) << " in " << Sweep::formatBytes(chunkBytes) << " chunks, " << ringSlots
+            << " pinned buffers\n";
+  Ingest::reportStages(OPENCL, "ingest", stages);
+  Suite::record("ingest", static_cast<float>(stages.pipelineMilliseconds), valid);
+
+  CL_ERR(clEnqueueUnmapMemObject(commandQueue, m_ring, std::exchange(buffers.mapped, nullptr), 0, nullptr, nullptr));
+  CL_ERR(clFinish(commandQueue));
+  CL_ERR(clReleaseMemObject(std::exchange(buffers.pinned, nullptr)));
+  CL_ERR(clReleaseMemObject(std::exchange(buffers.device, nullptr)));
+  return static_cast<float>(stages.pipelineMilliseconds);
+}
+
+// Multiply-add and GEMM throughput in every format: fp16 (half2), bf16 (pairs), fp32, fp64 and int8 (4-way dot products).
+// The GEMMs multiply small integers, which every format holds exactly, so their results are compared exactly.
+float CLBackend::runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<cl_kernel, 5>& multiplyAddFuncs,
+                                       const std::array<cl_kernel, 5>& gemmFuncs, unsigned int computeUnits, cl_context context,
+                                       cl_command_queue commandQueue) {
+  constexpr unsigned int n = 2048;
+  TRACE_SCOPE("24) Precision", "test");
+  std::cout << OPENCL << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)..." << std::flush;
+  // The GEMMs work in 16x16 work-groups
+  if (threadsPerBlock < 256) {
+    std::cout << " Skipped, needs work-groups of 256\n";
+    return 0.0f;
+  }
+  const size_t threads = static_cast<size_t>(computeUnits) * 32 * threadsPerBlock;
+  const size_t matrixBytes = static_cast<size_t>(n) * n * sizeof(double);
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, threads * sizeof(double), nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_A = clCreateBuffer(context, CL_MEM_READ_ONLY, matrixBytes, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_B = clCreateBuffer(context, CL_MEM_READ_ONLY, matrixBytes, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_C = clCreateBuffer(context, CL_MEM_READ_WRITE, matrixBytes, nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  auto timed = [&](cl_kernel function, unsigned int dimensions, const size_t* globalSize, const size_t* localSize) {
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, function, dimensions, nullptr, globalSize, localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+  auto multiplyAdd = [&](cl_kernel function, unsigned int iterations) {
+    CL_ERR(clSetKernelArg(function, 0, sizeof(cl_mem), &d_out));
+    CL_ERR(clSetKernelArg(function, 1, sizeof(iterations), &iterations));
+    size_t globalSize = threads, localSize = threadsPerBlock;
+    return timed(function, 1, &globalSize, &localSize);
+  };
+  auto gemm = [&](cl_kernel function) {
+    unsigned int size = n;
+    CL_ERR(clSetKernelArg(function, 0, sizeof(cl_mem), &d_A));
+    CL_ERR(clSetKernelArg(function, 1, sizeof(cl_mem), &d_B));
+    CL_ERR(clSetKernelArg(function, 2, sizeof(cl_mem), &d_C));
+    CL_ERR(clSetKernelArg(function, 3, sizeof(size), &size));
+    size_t globalSize[2] = {n, n}, localSize[2] = {16, 16};
+    return timed(function, 2, globalSize, localSize);
+  };
+
+  const std::vector<int> A = Gemm::integerMatrix(n, 1), B = Gemm::integerMatrix(n, 2);
+  std::vector<Gemm::FormatRate> rates;
+  for (Gemm::Format format : Gemm::formats) {
+    TRACE_SCOPE("Precision format", "kernel");
+    const size_t f = static_cast<size_t>(format);
+    Gemm::FormatRate rate{format, 0.0, 0.0, n, 0.0};
+    // Kernels of formats the device has no extension for were not created
+    if (!multiplyAddFuncs[f] || !gemmFuncs[f]) {
+      rate.note = "not supported by the device";
+      rates.push_back(rate);
+      continue;
+    }
+    std::cout << "\r" << OPENCL << "24) Precision (" << Gemm::formatName(format) << ")..." << std::flush;
+    // Double the iterations until one launch takes 20 ms, so the slow formats stay short
+    unsigned int iterations = 256;
+    double milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = multiplyAdd(multiplyAddFuncs[f], iterations);
+    }
+    rate.multiplyAddOps = static_cast<double>(threads) * iterations * 8 * Gemm::opsPerMultiplyAdd(format);
+    rate.multiplyAddMilliseconds = milliseconds;
+
+    const std::vector<unsigned char> h_A = Gemm::encode(format, A), h_B = Gemm::encode(format, B);
+    std::vector<unsigned char> h_C(static_cast<size_t>(n) * n * Gemm::outputBytes(format));
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_A, true, 0, h_A.size(), h_A.data(), 0, nullptr, nullptr));
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_B, true, 0, h_B.size(), h_B.data(), 0, nullptr, nullptr));
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_C, true, 0, h_C.size(), h_C.data(), 0, nullptr, nullptr));
+    rate.gemmMilliseconds = gemm(gemmFuncs[f]);
+    CL_ERR(clEnqueueReadBuffer(commandQueue, d_C, true, 0, h_C.size(), h_C.data(), 0, nullptr, nullptr));
+    rate.valid = Gemm::verifyExact(format, A, B, h_C, n);
+    for (int run = 0; run < 2; ++run) {
+      rate.gemmMilliseconds = std::min(rate.gemmMilliseconds, gemm(gemmFuncs[f]));
+    }
+    if (format == Gemm::Format::Bfloat16)
+      rate.note = "through fp32";
+    rates.push_back(rate);
+  }
+  CL_ERR(clReleaseMemObject(d_out));
   CL_ERR(clReleaseMemObject(d_A));
   CL_ERR(clReleaseMemObject(d_B));
   CL_ERR(clReleaseMemObject(d_C));
-  delete[] h_A;
-  delete[] h_B;
-  delete[] h_C;
+
+  bool valid = std::all_of(rates.begin(), rates.end(), [](const Gemm::FormatRate& rate) { return rate.valid; });
+  std::cout << "\r" << OPENCL << "24) Precision (fp16, bf16, fp32, fp64 and int8 multiply-add, " << n << "x" << n << " GEMM)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Gemm::reportFormats(OPENCL, "precision", rates);
+
+  float milliseconds = static_cast<float>(rates[static_cast<size_t>(Gemm::Format::Float)].gemmMilliseconds);
+  Suite::record("precision", milliseconds, valid);
+  return milliseconds;
+}
+
+// Latency and throughput of transcendental, integer and conversion instructions. Without a device clock, latency is
+// the time of one dependent chain in a single work-item at the reported clock; throughput comes from eight independent
+// chains per work-item on every compute unit.
+float CLBackend::runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<cl_kernel>& latencyFuncs,
+                                            const std::vector<cl_kernel>& throughputFuncs, unsigned int clockMegahertz, unsigned int computeUnits,
+                                            cl_context context, cl_command_queue commandQueue) {
+  TRACE_SCOPE("25) Instruction Mix", "test");
+  std::cout << OPENCL << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)..." << std::flush;
+  const size_t threads = static_cast<size_t>(computeUnits) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_READ_WRITE, threads * sizeof(unsigned long long), nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  unsigned int seed = 1;
+  auto timed = [&](cl_kernel function, unsigned int iterations, size_t globalSize, size_t localSize) {
+    CL_ERR(clSetKernelArg(function, 0, sizeof(cl_mem), &d_out));
+    CL_ERR(clSetKernelArg(function, 1, sizeof(seed), &seed));
+    CL_ERR(clSetKernelArg(function, 2, sizeof(iterations), &iterations));
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, function, 1, nullptr, &globalSize, &localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  const std::vector<Microbench::Instruction>& instructions = Microbench::instructions();
+  std::vector<Microbench::InstructionRate> rates;
+  double totalMilliseconds = 0.0;
+  bool valid = true;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    TRACE_SCOPE("Instruction", "kernel");
+    std::cout << "\r" << OPENCL << "25) Instruction Mix (" << instructions[i].name << ")..." << std::flush;
+    // Long enough that launch overhead is lost in the chain, and the first launch warms the instruction cache
+    unsigned int latencyIterations = 4096;
+    double latencyMilliseconds = timed(latencyFuncs[i], latencyIterations, 1, 1);
+    while (latencyMilliseconds < 2.0 && latencyIterations < (1u << 24)) {
+      latencyIterations *= 2;
+      latencyMilliseconds = timed(latencyFuncs[i], latencyIterations, 1, 1);
+    }
+
+    // Double the iterations until one launch takes 20 ms, so the slow instructions stay short
+    unsigned int iterations = 256;
+    double milliseconds = timed(throughputFuncs[i], iterations, threads, threadsPerBlock);
+    while (milliseconds < 20.0 && iterations < (1u << 24)) {
+      iterations *= 2;
+      milliseconds = timed(throughputFuncs[i], iterations, threads, threadsPerBlock);
+    }
+    totalMilliseconds += milliseconds;
+    double latency = latencyMilliseconds * 1e-3 * clockMegahertz * 1e6 / latencyIterations;
+    valid = valid && latency > 0.0 && milliseconds > 0.0;
+    rates.push_back({instructions[i].name, instructions[i].key, latency, static_cast<double>(threads) * iterations * 8, milliseconds});
+  }
+  CL_ERR(clReleaseMemObject(d_out));
+
+  std::cout << "\r" << OPENCL << "25) Instruction Mix (" << latencyFuncs.size() << " instructions, latency and throughput)...";
+  if (valid)
+    std::cout << GREEN << " PASSED" << RESET << "\n";
+  else
+    std::cout << RED << " FAILED" << RESET << "\n";
+  Microbench::reportInstructionMix(OPENCL, "instruction_mix", rates, clockMegahertz * 1e6, computeUnits);
+  Suite::record("instruction_mix", static_cast<float>(totalMilliseconds), valid);
+  return static_cast<float>(totalMilliseconds);
+}
+
+// A copy and an FMA loop, each plain and with high register pressure, at every work-group size up to the kernel's
+// CL_KERNEL_WORK_GROUP_SIZE and every local memory reservation that fits. OpenCL cannot say how many work-groups are
+// resident, so the report has no occupancy column; a lower CL_KERNEL_WORK_GROUP_SIZE for the register-heavy kernels is
+// the driver's sign that they limit it.
+float CLBackend::runOccupancyBenchmark(const std::vector<cl_kernel>& funcs, cl_device_id dev, unsigned long long totalMemory,
+                                       unsigned long long maxAllocation, unsigned int computeUnits, cl_context context,
+                                       cl_command_queue commandQueue) {
+  const std::vector<Microbench::OccupancyKernel>& kernels = Microbench::occupancyKernels();
+  TRACE_SCOPE("26) Occupancy", "test");
+  std::cout << OPENCL << "26) Occupancy (" << kernels.size() << " kernels, work-group size and local memory sweep)..." << std::flush;
+  const size_t threads = static_cast<size_t>(computeUnits) * 2048;
+  unsigned long long elements = std::min<unsigned long long>({256ull << 20, totalMemory / 8, maxAllocation}) / 16;
+  unsigned long long localMemory = 0;
+  CL_ERR(clGetDeviceInfo(dev, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(localMemory), &localMemory, nullptr));
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_in = clCreateBuffer(context, CL_MEM_READ_ONLY, elements * 16, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_WRITE_ONLY, elements * 16, nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_results = clCreateBuffer(context, CL_MEM_WRITE_ONLY, threads * sizeof(float), nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  auto timed = [&](cl_kernel function, size_t localSize) {
+    size_t globalSize = threads;
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, function, 1, nullptr, &globalSize, &localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  std::vector<Microbench::OccupancyCurve> curves;
+  double totalMilliseconds = 0.0;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    TRACE_SCOPE("Occupancy kernel", "kernel");
+    size_t maxBlockSize = 0;
+    unsigned long long kernelLocalMemory = 0;
+    CL_ERR(clGetKernelWorkGroupInfo(funcs[k], dev, CL_KERNEL_WORK_GROUP_SIZE, sizeof(maxBlockSize), &maxBlockSize, nullptr));
+    CL_ERR(clGetKernelWorkGroupInfo(funcs[k], dev, CL_KERNEL_LOCAL_MEM_SIZE, sizeof(kernelLocalMemory), &kernelLocalMemory, nullptr));
+    Microbench::OccupancyCurve curve{&kernels[k], -1, maxBlockSize, {}};
+    unsigned int iterations = Microbench::occupancyFmasPerThread / kernels[k].perThread;
+    unsigned int reservedArg = 2;
+    if (kernels[k].compute) {
+      CL_ERR(clSetKernelArg(funcs[k], 0, sizeof(cl_mem), &d_results));
+      CL_ERR(clSetKernelArg(funcs[k], 1, sizeof(iterations), &iterations));
+    } else {
+      CL_ERR(clSetKernelArg(funcs[k], 0, sizeof(cl_mem), &d_in));
+      CL_ERR(clSetKernelArg(funcs[k], 1, sizeof(cl_mem), &d_out));
+      CL_ERR(clSetKernelArg(funcs[k], 2, sizeof(elements), &elements));
+      reservedArg = 3;
+    }
+    const double work = kernels[k].compute ? static_cast<double>(threads) * Microbench::occupancyFmasPerThread * 2 : elements * 16.0 * 2;
+    for (unsigned int blockSize : Microbench::occupancyBlockSizes()) {
+      if (blockSize > maxBlockSize)
+        continue;
+      std::cout << "\r" << OPENCL << "26) Occupancy (" << kernels[k].name << ", work-groups of " << blockSize << ")...          " << std::flush;
+      for (size_t sharedBytes : Microbench::occupancySharedBytes()) {
+        if (sharedBytes + kernelLocalMemory > localMemory)
+          continue;
+        // A __local argument cannot be empty, so the smallest reservation is one float
+        CL_ERR(clSetKernelArg(funcs[k], reservedArg, std::max<size_t>(sharedBytes, sizeof(float)), nullptr));
+        double milliseconds = std::min(timed(funcs[k], blockSize), timed(funcs[k], blockSize));
+        totalMilliseconds += milliseconds;
+        curve.points.push_back({blockSize, sharedBytes, -1.0, work, milliseconds});
+      }
+    }
+    curves.push_back(curve);
+  }
+  CL_ERR(clReleaseMemObject(d_in));
+  CL_ERR(clReleaseMemObject(d_out));
+  CL_ERR(clReleaseMemObject(d_results));
+
+  std::cout << "\r" << OPENCL << "26) Occupancy (" << kernels.size() << " kernels, work-group size and local memory sweep)...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportOccupancy(OPENCL, "occupancy", curves);
+  Suite::record("occupancy", static_cast<float>(totalMilliseconds));
+  return static_cast<float>(totalMilliseconds);
+}
+
+// divergenceKernel with the work-items split over its four paths in every pattern of Microbench::divergencePatterns().
+// OpenCL has no warp size, so the kernel's CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE stands in for it; CPU
+// implementations report their vector width (or 1, without vectorization) and show little divergence cost.
+float CLBackend::runDivergenceBenchmark(unsigned int threadsPerBlock, cl_kernel divergenceFunc, cl_device_id dev, unsigned int computeUnits,
+                                        cl_context context, cl_command_queue commandQueue) {
+  const std::vector<Microbench::DivergencePattern>& patterns = Microbench::divergencePatterns();
+  size_t width = 0;
+  CL_ERR(clGetKernelWorkGroupInfo(divergenceFunc, dev, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(width), &width, nullptr));
+  TRACE_SCOPE("27) Divergence", "test");
+  std::cout << OPENCL << "27) Divergence (" << patterns.size() << " patterns, SIMD width " << width << ")..." << std::flush;
+  const size_t threads = static_cast<size_t>(computeUnits) * 32 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  cl_mem d_out = clCreateBuffer(context, CL_MEM_WRITE_ONLY, threads * sizeof(float), nullptr, &status);
+  CL_ERR(status);
+  cl_mem d_paths = clCreateBuffer(context, CL_MEM_READ_ONLY, threads * sizeof(unsigned int), nullptr, &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  unsigned int rounds = 16;
+  auto timed = [&]() {
+    CL_ERR(clSetKernelArg(divergenceFunc, 0, sizeof(cl_mem), &d_out));
+    CL_ERR(clSetKernelArg(divergenceFunc, 1, sizeof(cl_mem), &d_paths));
+    CL_ERR(clSetKernelArg(divergenceFunc, 2, sizeof(rounds), &rounds));
+    size_t globalSize = threads, localSize = threadsPerBlock;
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, divergenceFunc, 1, nullptr, &globalSize, &localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  std::vector<Microbench::DivergenceResult> results;
+  for (size_t p = 0; p < patterns.size(); ++p) {
+    std::cout << "\r" << OPENCL << "27) Divergence (" << patterns[p].name << ")...          " << std::flush;
+    const std::vector<unsigned int> paths = Microbench::divergencePaths(p, threads, static_cast<unsigned int>(width));
+    CL_ERR(clEnqueueWriteBuffer(commandQueue, d_paths, true, 0, paths.size() * sizeof(unsigned int), paths.data(), 0, nullptr, nullptr));
+    double milliseconds = timed();
+    while (p == 0 && milliseconds < 20.0 && rounds < (1u << 20)) {
+      rounds *= 2;
+      milliseconds = timed();
+    }
+    double fmas = static_cast<double>(threads) * rounds * Microbench::divergenceFmasPerRound;
+    results.push_back({&patterns[p], Microbench::pathsPerWarp(paths, static_cast<unsigned int>(width)), fmas, milliseconds});
+  }
+  CL_ERR(clReleaseMemObject(d_out));
+  CL_ERR(clReleaseMemObject(d_paths));
+
+  std::cout << "\r" << OPENCL << "27) Divergence (" << patterns.size() << " patterns, SIMD width " << width << ")...";
+  std::cout << GREEN << " PASSED" << RESET << "\n";
+  Microbench::reportDivergence(OPENCL, "divergence", results, static_cast<unsigned int>(width));
+  float milliseconds = static_cast<float>(results[0].milliseconds);
+  Suite::record("divergence", milliseconds);
+  return milliseconds;
+}
+
+// Every operation of Microbench::atomicOperations() on global and on local memory counters, at every contention of
+// Microbench::atomicContentions(). Null kernels (int64 without cl_khr_int64_base_atomics) are reported as "-". Global
+// compare-and-swap loops on few addresses run as one work-group, as on CUDA and HIP.
+float CLBackend::runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<cl_kernel>& globalFuncs,
+                                     const std::vector<cl_kernel>& sharedFuncs, unsigned int computeUnits, cl_context context,
+                                     cl_command_queue commandQueue) {
+  const std::vector<Microbench::AtomicOperation>& operations = Microbench::atomicOperations();
+  const std::vector<Microbench::AtomicContention>& contentions = Microbench::atomicContentions();
+  TRACE_SCOPE("28) Atomics", "test");
+  std::cout << OPENCL << "28) Atomics (" << operations.size() << " operations, global and local)..." << std::flush;
+  const size_t threads = static_cast<size_t>(computeUnits) * 2 * threadsPerBlock;
+  Trace::Span allocSpan("Allocate", "alloc");
+  int status = 0;
+  std::vector<unsigned long long> zeros(threads, 0);
+  cl_mem d_counters =
+      clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, threads * sizeof(unsigned long long), zeros.data(), &status);
+  CL_ERR(status);
+  allocSpan.end();
+
+  auto timed = [&](cl_kernel func, size_t launched, unsigned int addresses, unsigned int iterations) {
+    CL_ERR(clSetKernelArg(func, 0, sizeof(cl_mem), &d_counters));
+    CL_ERR(clSetKernelArg(func, 1, sizeof(addresses), &addresses));
+    CL_ERR(clSetKernelArg(func, 2, sizeof(iterations), &iterations));
+    size_t globalSize = launched, localSize = threadsPerBlock;
+    cl_event event = nullptr;
+    Trace::Span kernelSpan("Kernel launch + sync", "kernel");
+    CL_ERR(clEnqueueNDRangeKernel(commandQueue, func, 1, nullptr, &globalSize, &localSize, 0, nullptr, &event));
+    CL_ERR(clWaitForEvents(1, (const void**)&event));
+    cl_ulong start = 0, end = 0;
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), (void**)&start, nullptr));
+    CL_ERR(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), (void**)&end, nullptr));
+    CL_ERR(clReleaseEvent(event));
+    double milliseconds = (end - start) * 1e-6;
+    kernelSpan.end();
+    if (Trace::enabled())
+      Trace::recordDeviceSpan("OpenCL queue", "Kernel", "kernel", kernelSpan.started(), milliseconds);
+    return milliseconds;
+  };
+
+  std::vector<Microbench::AtomicResult> results;
+  for (bool shared : {false, true}) {
+    for (size_t o = 0; o < operations.size(); ++o) {
+      cl_kernel func = shared ? sharedFuncs[o] : globalFuncs[o];
+      // OpenCL has no float atomics, so its float add is a compare-and-swap loop as well
+      const bool casLoop = operations[o].casLoop || std::string_view(operations[o].kernel) == "AddFloat";
+      for (const Microbench::AtomicContention& contention : contentions) {
+        // A work-group has at most threadsPerBlock local counters, so larger counts repeat "1 per thread"
+        if (!func || (shared && contention.addresses >= threadsPerBlock)) {
+          results.push_back({&operations[o], shared, &contention, 0.0, 0.0, false});
+          continue;
+        }
+        std::cout << "\r" << OPENCL << "28) Atomics (" << (shared ? "local " : "global ") << operations[o].name << ", " << contention.name
+                  << ")...          " << std::flush;
+        const bool oneBlock = !shared && casLoop && contention.addresses != 0 &&
+                              contention.addresses <= Microbench::casLoopBlockAddresses;
+        const size_t launched = oneBlock ? threadsPerBlock : threads;
+        unsigned int iterations = 1;
+        double milliseconds = timed(func, launched, contention.addresses, iterations);
+        while (milliseconds < 20.0 && iterations < (1u << 16)) {
+          iterations *= 2;
+          milliseconds = timed(func, launched, contention.addresses, iterations);
+        }
+        results.push_back({&operations[o], shared, &contention, static_cast<double>(launched) * iterations, milliseconds, oneBlock});
+      }
+    }
+  }
+  CL_ERR(clReleaseMemObject(d_counters));
+
+  std::cout << "\r" << OPENCL << "28) Atomics (" << operations.size() << " operations, global and local)...";
+  std::cout << GREEN << " PASSED" << RESET << "                    \n";
+  Microbench::reportAtomics(OPENCL, "atomics", results);
+  float milliseconds = static_cast<float>(Microbench::histogramMilliseconds(results));
+  Suite::record("atomics", milliseconds);
   return milliseconds;
 }
 
@@ -459,6 +1668,11 @@ void CLBackend::shutdown() {
   clGetPlatformInfo = nullptr;
   clEnqueueReadBuffer = nullptr;
   clReleaseMemObject = nullptr;
+  clEnqueueWriteBuffer = nullptr;
+  clEnqueueMapBuffer = nullptr;
+  clEnqueueUnmapMemObject = nullptr;
+  clFinish = nullptr;
+  clGetKernelWorkGroupInfo = nullptr;
 
   closeLibrary(clHandle);
   clHandle = nullptr;
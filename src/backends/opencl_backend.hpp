@@ -1,7 +1,11 @@
 #pragma once
 
+#include "../gpumark.hpp"
+#include <array>
 #include <cstddef>
 #include <stdint.h>
+#include <string>
+#include <vector>
 namespace CLBackend {
 static void* clHandle = nullptr;
 
@@ -14,24 +18,58 @@ typedef void* cl_kernel;
 typedef void* cl_mem;
 typedef void* cl_event;
 typedef unsigned long cl_queue_properties;
+typedef unsigned long long cl_ulong; // 64 bits on every platform, unlike unsigned long on Windows
 
 bool init();
 bool slowBenchmarks(float linearSetTime, float linearMultiplyTime);
 void prepareDeviceForBenchmarking(cl_device_id dev);
-void runBenchmark();
+std::vector<GPUMark::Device> enumerateDevices();
+cl_device_id getDeviceId(int index);
+bool confirmPlatform(const std::string& platformName);
 void shutdown();
 
 float runLinearSetBenchmark(unsigned int threadsPerBlock, cl_kernel linearSetFunc, cl_context context, cl_command_queue commandQueue);
 float runLinearMultiplyBenchmark(unsigned int threadsPerBlock, cl_kernel linearMultiplyFunc, cl_context context, cl_command_queue commandQueue);
 float runFmaBenchmark(unsigned int threadsPerBlock, cl_kernel fmaFunc, cl_context context, cl_command_queue commandQueue);
 float runIntegerThroughputBenchmark(unsigned int threadsPerBlock, cl_kernel integerThroughputFunc, cl_context context, cl_command_queue commandQueue);
-float runSharedMemoryBenchmark(unsigned int threadsPerBlock, cl_kernel sharedMemoryFunc, cl_context context, cl_command_queue commandQueue);
-float runSgemmBenchmark(unsigned int threadsPerBlock, cl_kernel sgemmFunc, cl_context context, cl_command_queue commandQueue);
+float runSharedMemoryBenchmark(unsigned int threadsPerBlock, cl_kernel sharedMemoryFunc, unsigned int clockMegahertz, unsigned int computeUnits,
+                               cl_context context, cl_command_queue commandQueue);
+float runSgemmBenchmark(unsigned int threadsPerBlock, cl_kernel naiveFunc, cl_kernel tiledFunc, cl_kernel registerFunc, cl_context context,
+                        cl_command_queue commandQueue);
+float runPointerChaseBenchmark(cl_kernel initFunc, cl_kernel chaseFunc, size_t totalMemory, size_t maxAllocation, unsigned int threadsPerBlock,
+                               cl_context context, cl_command_queue commandQueue);
+float runStridedAccessBenchmark(unsigned int threadsPerBlock, const std::array<cl_kernel, 3>& kernels, size_t totalMemory, size_t maxAllocation,
+                                unsigned int cacheLineSize, cl_context context, cl_command_queue commandQueue);
+float runStreamBenchmark(unsigned int threadsPerBlock, cl_kernel initFunc, const std::array<cl_kernel, 12>& kernels, size_t totalMemory,
+                         size_t maxAllocation, unsigned int computeUnits, cl_context context, cl_command_queue commandQueue);
+float runZeroCopyBenchmark(unsigned int threadsPerBlock, cl_kernel scaleFunc, size_t totalMemory, size_t maxAllocation, unsigned int computeUnits,
+                           cl_context context, cl_command_queue commandQueue);
+float runIngestBenchmark(cl_context context, cl_command_queue commandQueue);
+float runPrecisionBenchmark(unsigned int threadsPerBlock, const std::array<cl_kernel, 5>& multiplyAddFuncs, const std::array<cl_kernel, 5>& gemmFuncs,
+                            unsigned int computeUnits, cl_context context, cl_command_queue commandQueue);
+float runDivergenceBenchmark(unsigned int threadsPerBlock, cl_kernel divergenceFunc, cl_device_id dev, unsigned int computeUnits, cl_context context,
+                             cl_command_queue commandQueue);
+float runAtomicsBenchmark(unsigned int threadsPerBlock, const std::vector<cl_kernel>& globalFuncs, const std::vector<cl_kernel>& sharedFuncs,
+                          unsigned int computeUnits, cl_context context, cl_command_queue commandQueue);
+float runInstructionMixBenchmark(unsigned int threadsPerBlock, const std::vector<cl_kernel>& latencyFuncs,
+                                 const std::vector<cl_kernel>& throughputFuncs, unsigned int clockMegahertz, unsigned int computeUnits,
+                                 cl_context context, cl_command_queue commandQueue);
+float runOccupancyBenchmark(const std::vector<cl_kernel>& funcs, cl_device_id dev, unsigned long long totalMemory, unsigned long long maxAllocation,
+                            unsigned int computeUnits, cl_context context, cl_command_queue commandQueue);
 
 #define CL_DEVICE_GLOBAL_MEM_SIZE 0x101F
 #define CL_DEVICE_GLOBAL_MEM_CACHE_SIZE 0x101E
+#define CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE 0x101D
 #define CL_DEVICE_NAME 0x102B
+#define CL_DEVICE_MAX_MEM_ALLOC_SIZE 0x1010
+#define CL_DEVICE_MAX_COMPUTE_UNITS 0x1002
+#define CL_DEVICE_MAX_CLOCK_FREQUENCY 0x100C
+#define CL_DEVICE_LOCAL_MEM_SIZE 0x1023
+#define CL_KERNEL_WORK_GROUP_SIZE 0x11B0
+#define CL_KERNEL_LOCAL_MEM_SIZE 0x11B2
+#define CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE 0x11B3
 #define CL_DEVICE_MAX_WORK_GROUP_SIZE 0x1004
+#define CL_DEVICE_EXTENSIONS 0x1030
 #define CL_PLATFORM_NAME 0x0902
 #define CL_DEVICE_TYPE_ALL 0xFFFFFFFF
 #define CL_QUEUE_PROPERTIES 0x1093
@@ -40,7 +78,11 @@ float runSgemmBenchmark(unsigned int threadsPerBlock, cl_kernel sgemmFunc, cl_co
 #define CL_PROFILING_COMMAND_END 0x1283
 #define CL_MEM_READ_WRITE (1 << 0)
 #define CL_MEM_READ_ONLY (1 << 2)
+#define CL_MEM_ALLOC_HOST_PTR (1 << 4)
 #define CL_MEM_COPY_HOST_PTR (1 << 5)
+#define CL_MAP_READ (1 << 0)
+#define CL_MAP_WRITE (1 << 1)
+#define CL_MAP_WRITE_INVALIDATE_REGION (1 << 2)
 #define CL_MEM_WRITE_ONLY (1 << 1)
 
 
@@ -67,6 +109,11 @@ typedef cl_mem (*clCreateBuffer_t)(cl_context, unsigned long, size_t, void*, int
 typedef int (*clEnqueueReadBuffer_t)(cl_command_queue, cl_mem, unsigned int, size_t, size_t, void*, unsigned int, const void*, void**);
 typedef int (*clReleaseMemObject_t)(cl_mem);
 typedef int (*clSetKernelArg_t)(cl_kernel, unsigned int, size_t, const void*);
+typedef int (*clEnqueueWriteBuffer_t)(cl_command_queue, cl_mem, unsigned int, size_t, size_t, const void*, unsigned int, const void*, void**);
+typedef void* (*clEnqueueMapBuffer_t)(cl_command_queue, cl_mem, unsigned int, unsigned long, size_t, size_t, unsigned int, const void*, void**, int*);
+typedef int (*clEnqueueUnmapMemObject_t)(cl_command_queue, cl_mem, void*, unsigned int, const void*, void**);
+typedef int (*clFinish_t)(cl_command_queue);
+typedef int (*clGetKernelWorkGroupInfo_t)(cl_kernel, cl_device_id, unsigned int, size_t, void*, size_t*);
 
 extern clGetDeviceInfo_t clGetDeviceInfo;
 extern clGetPlatformIDs_t clGetPlatformIDs;
@@ -89,5 +136,10 @@ extern clGetPlatformInfo_t clGetPlatformInfo;
 extern clEnqueueReadBuffer_t clEnqueueReadBuffer;
 extern clSetKernelArg_t clSetKernelArg;
 extern clReleaseMemObject_t clReleaseMemObject;
+extern clEnqueueWriteBuffer_t clEnqueueWriteBuffer;
+extern clEnqueueMapBuffer_t clEnqueueMapBuffer;
+extern clEnqueueUnmapMemObject_t clEnqueueUnmapMemObject;
+extern clFinish_t clFinish;
+extern clGetKernelWorkGroupInfo_t clGetKernelWorkGroupInfo;
 
 } // namespace CLBackend
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "../../shared/host_memory.hpp"
+#include "../../gpumark.hpp"
+#include <string>
+#include <windows.h>
+
+// Large pages need the "Lock pages in memory" privilege, which benchmark users rarely have, so only placement is
+// handled here. Windows does not report which node a PCI device is on without SetupAPI.
+
+int HostMemory::deviceNode(int, int, int) { return -1; }
+
+std::vector<int> HostMemory::nodes() {
+  ULONG highest = 0;
+  if (!GetNumaHighestNodeNumber(&highest))
+    return {0};
+  std::vector<int> result;
+  for (ULONG node = 0; node <= highest; ++node) {
+    result.push_back(static_cast<int>(node));
+  }
+  return result;
+}
+
+void* HostMemory::allocate(size_t bytes, int node, bool, Placement* placement) {
+  void* data = nullptr;
+  if (node >= 0)
+    data = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, static_cast<DWORD>(node));
+  bool bound = data != nullptr;
+  if (!data)
+    data = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (!data)
+    throw GPUMark::Error("Cannot allocate " + std::to_string(bytes) + " bytes of host memory: " + std::to_string(GetLastError()));
+  for (size_t offset = 0; offset < bytes; offset += 4096) {
+    static_cast<volatile char*>(data)[offset] = 0;
+  }
+  if (placement)
+    *placement = {Pages::Small, bound};
+  return data;
+}
+
+void HostMemory::release(void* data, size_t) {
+  if (data)
+    VirtualFree(data, 0, MEM_RELEASE);
+}
+
+HostMemory::ThreadPin::ThreadPin(int node) {
+  if (node < 0)
+    return;
+  GROUP_AFFINITY wanted = {}, current = {};
+  if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &wanted) || !SetThreadGroupAffinity(GetCurrentThread(), &wanted, &current))
+    return;
+  previous.assign(reinterpret_cast<unsigned char*>(&current), reinterpret_cast<unsigned char*>(&current) + sizeof(current));
+  active = true;
+}
+
+HostMemory::ThreadPin::~ThreadPin() {
+  if (active)
+    SetThreadGroupAffinity(GetCurrentThread(), reinterpret_cast<const GROUP_AFFINITY*>(previous.data()), nullptr);
+}
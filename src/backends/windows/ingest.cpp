@@ -0,0 +1,60 @@
+#include "../../shared/ingest.hpp"
+#include "../../gpumark.hpp"
+#include <deque>
+#include <windows.h>
+
+namespace {
+// One synchronous ReadFile per submit. FILE_FLAG_NO_BUFFERING is the Windows equivalent of O_DIRECT.
+class ReadFileReader : public Ingest::FileReader {
+public:
+  ReadFileReader(HANDLE file, bool directIo) : file(file), directIo(directIo) {}
+  ~ReadFileReader() override { CloseHandle(file); }
+
+  void submit(void* buffer, size_t bytes, unsigned long long offset, unsigned int tag) override {
+    size_t done = 0;
+    while (done < bytes) {
+      OVERLAPPED position = {};
+      position.Offset = static_cast<DWORD>(offset + done);
+      position.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+      DWORD result = 0;
+      if (!ReadFile(file, static_cast<char*>(buffer) + done, static_cast<DWORD>(bytes - done), &result, &position)) {
+        if (GetLastError() == ERROR_HANDLE_EOF)
+          break;
+        throw GPUMark::Error("ReadFile failed: " + std::to_string(GetLastError()));
+      }
+      if (result == 0)
+        break;
+      done += result;
+    }
+    finished.push_back({tag, done});
+  }
+
+  unsigned int wait(size_t& bytesRead) override {
+    auto [tag, bytes] = finished.front();
+    finished.pop_front();
+    bytesRead = bytes;
+    return tag;
+  }
+
+  std::string method() const override { return directIo ? "ReadFile, unbuffered" : "ReadFile"; }
+  bool direct() const override { return directIo; }
+
+private:
+  HANDLE file;
+  bool directIo;
+  std::deque<std::pair<unsigned int, size_t>> finished;
+};
+} // namespace
+
+std::unique_ptr<Ingest::FileReader> Ingest::openReader(const std::string& path, unsigned int depth, bool direct) {
+  HANDLE file = INVALID_HANDLE_VALUE;
+  if (direct)
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    direct = false;
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  }
+  if (file == INVALID_HANDLE_VALUE)
+    throw GPUMark::Error("Cannot open " + path + ": " + std::to_string(GetLastError()));
+  return std::make_unique<ReadFileReader>(file, direct);
+}
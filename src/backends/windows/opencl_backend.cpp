@@ -40,6 +40,11 @@ bool CLBackend::init() {
   LOAD_CL_SYMBOL(clEnqueueReadBuffer);
   LOAD_CL_SYMBOL(clReleaseMemObject);
   LOAD_CL_SYMBOL(clSetKernelArg);
+  LOAD_CL_SYMBOL(clEnqueueWriteBuffer);
+  LOAD_CL_SYMBOL(clEnqueueMapBuffer);
+  LOAD_CL_SYMBOL(clEnqueueUnmapMemObject);
+  LOAD_CL_SYMBOL(clFinish);
+  LOAD_CL_SYMBOL(clGetKernelWorkGroupInfo);
 
 #undef LOAD_CL_SYMBOL
 
@@ -16,3 +16,11 @@ int get_terminal_width() {
   }
   return columns;
 }
+
+unsigned long long getPhysicalMemory() {
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (!GlobalMemoryStatusEx(&status))
+    return 0;
+  return status.ullTotalPhys;
+}
@@ -0,0 +1,288 @@
+#include "gpumark.hpp"
+#include "backends/cuda_backend.hpp"
+#include "backends/hip_backend.hpp"
+#include "backends/opencl_backend.hpp"
+#include "shared/shared.hpp"
+#include "shared/suite.hpp"
+#include "shared/trace.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace {
+// Swallows everything written to it, for RunOptions::verbose = false
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+// Points std::cout at a NullBuffer until destroyed, so it is restored however run() is left
+class SilencedCout {
+public:
+  explicit SilencedCout(bool silence) : previous(silence ? std::cout.rdbuf(&nullBuffer) : nullptr) {}
+  ~SilencedCout() {
+    if (previous)
+      std::cout.rdbuf(previous);
+  }
+  SilencedCout(const SilencedCout&) = delete;
+  SilencedCout& operator=(const SilencedCout&) = delete;
+
+private:
+  NullBuffer nullBuffer;
+  std::streambuf* previous;
+};
+
+bool initBackend(GPUMark::Backend backend) {
+  switch (backend) {
+  case GPUMark::Backend::CUDA: {
+    TRACE_SCOPE("CUDA init", "init");
+    return CudaBackend::init();
+  }
+  case GPUMark::Backend::HIP: {
+    TRACE_SCOPE("HIP init", "init");
+    return HIPBackend::init();
+  }
+  case GPUMark::Backend::OpenCL: {
+    TRACE_SCOPE("OpenCL init", "init");
+    return CLBackend::init();
+  }
+  }
+  return false;
+}
+
+void shutdownBackend(GPUMark::Backend backend) {
+  switch (backend) {
+  case GPUMark::Backend::CUDA:
+    CudaBackend::shutdown();
+    break;
+  case GPUMark::Backend::HIP:
+    HIPBackend::shutdown();
+    break;
+  case GPUMark::Backend::OpenCL:
+    CLBackend::shutdown();
+    break;
+  }
+}
+
+std::vector<GPUMark::Device> listBackendDevices(GPUMark::Backend backend) {
+  switch (backend) {
+  case GPUMark::Backend::CUDA:
+    return CudaBackend::enumerateDevices();
+  case GPUMark::Backend::HIP:
+    return HIPBackend::enumerateDevices();
+  case GPUMark::Backend::OpenCL:
+    return CLBackend::enumerateDevices();
+  }
+  return {};
+}
+
+void benchmarkDevice(const GPUMark::Device& device) {
+  switch (device.backend) {
+  case GPUMark::Backend::CUDA:
+    CudaBackend::prepareDeviceForBenchmarking(device.index);
+    break;
+  case GPUMark::Backend::HIP:
+    HIPBackend::prepareDeviceForBenchmarking(device.index);
+    break;
+  case GPUMark::Backend::OpenCL:
+    CLBackend::prepareDeviceForBenchmarking(CLBackend::getDeviceId(device.index));
+    break;
+  }
+}
+
+// Backends without a peer copy API (OpenCL) return no links
+std::vector<GPUMark::PeerLink> measurePeerLinks(GPUMark::Backend backend, const std::vector<int>& devices) {
+  switch (backend) {
+  case GPUMark::Backend::CUDA:
+    return CudaBackend::runPeerToPeerBenchmark(devices);
+  case GPUMark::Backend::HIP:
+    return HIPBackend::runPeerToPeerBenchmark(devices);
+  case GPUMark::Backend::OpenCL:
+    break;
+  }
+  return {};
+}
+
+std::string_view backendPrefix(GPUMark::Backend backend) {
+  switch (backend) {
+  case GPUMark::Backend::CUDA:
+    return CUDA;
+  case GPUMark::Backend::HIP:
+    return HIP;
+  case GPUMark::Backend::OpenCL:
+    return OPENCL;
+  }
+  return ORCHESTRATOR;
+}
+
+// Rows are sources, columns destinations. Staged pairs are marked with an asterisk.
+void printPeerMatrix(GPUMark::Backend backend, const std::vector<int>& devices, const std::vector<GPUMark::PeerLink>& links) {
+  std::string_view prefix = backendPrefix(backend);
+  auto printTable = [&](const char* title, auto&& value) {
+    std::cout << prefix << std::setw(12) << title;
+    for (int dst : devices) {
+      std::cout << std::setw(10) << ("dst " + std::to_string(dst));
+    }
+    std::cout << "\n";
+    for (int src : devices) {
+      std::cout << prefix << std::setw(12) << ("src " + std::to_string(src));
+      for (int dst : devices) {
+        auto link = std::find_if(links.begin(), links.end(), [&](const GPUMark::PeerLink& l) { return l.source == src && l.destination == dst; });
+        if (link == links.end()) {
+          std::cout << std::setw(10) << "-";
+          continue;
+        }
+        std::ostringstream cell;
+        cell << std::fixed << std::setprecision(2) << value(*link) << (link->peerAccess ? " " : "*");
+        std::cout << std::setw(10) << cell.str();
+      }
+      std::cout << "\n";
+    }
+  };
+  printTable("GB/s", [](const GPUMark::PeerLink& link) { return link.gigabytesPerSecond; });
+  printTable("Latency (us)", [](const GPUMark::PeerLink& link) { return link.latencyMicroseconds; });
+  std::cout << prefix << "* No peer access, staged through host memory\n";
+}
+
+bool isSelected(const GPUMark::Device& device, const std::vector<GPUMark::Device>& selection) {
+  if (selection.empty())
+    return true;
+  return std::any_of(selection.begin(), selection.end(), [&](const GPUMark::Device& selected) {
+    return selected.backend == device.backend && selected.index == device.index;
+  });
+}
+} // namespace
+
+const char* GPUMark::backendName(Backend backend) {
+  switch (backend) {
+  case Backend::CUDA:
+    return "CUDA";
+  case Backend::HIP:
+    return "HIP";
+  case Backend::OpenCL:
+    return "OpenCL";
+  }
+  return "Unknown";
+}
+
+std::vector<std::string> GPUMark::testNames() {
+  return {
+      "linear_set",
+      "linear_multiply",
+      "fma",
+      "integer",
+      "shared_memory",
+      "sgemm",
+      "pcie",
+      "stream_overhead",
+      "transfer_sweep",
+      "pcie_bidirectional",
+      "copy_compute_overlap",
+      "peer_to_peer",
+      "pointer_chase",
+      "strided_access",
+      "stream",
+      "zero_copy",
+      "host_registration",
+      "managed_memory",
+      "allocation",
+      "copy_engine",
+      "out_of_core",
+      "ingest",
+      "numa_placement",
+      "precision",
+      "instruction_mix",
+      "occupancy",
+      "divergence",
+      "atomics",
+  };
+}
+
+std::vector<GPUMark::Device> GPUMark::enumerateDevices(const std::vector<Backend>& backends) {
+  std::vector<Device> devices;
+  for (Backend backend : backends) {
+    if (!initBackend(backend))
+      continue;
+    try {
+      std::vector<Device> found = listBackendDevices(backend);
+      devices.insert(devices.end(), found.begin(), found.end());
+    } catch (const std::exception& e) {
+      std::cerr << ORCHESTRATOR << e.what() << "\n";
+    }
+    shutdownBackend(backend);
+  }
+  return devices;
+}
+
+std::vector<GPUMark::DeviceReport> GPUMark::run(const RunOptions& options) {
+  SilencedCout silencedCout(!options.verbose);
+
+  std::vector<DeviceReport> reports;
+  Suite::begin(options);
+  for (Backend backend : options.backends) {
+    if (!initBackend(backend))
+      continue;
+
+    std::vector<Device> devices;
+    try {
+      devices = listBackendDevices(backend);
+    } catch (const std::exception& e) {
+      std::cerr << ORCHESTRATOR << e.what() << "\n";
+    }
+
+    std::set<std::string> declinedPlatforms, acceptedPlatforms;
+    for (const Device& device : devices) {
+      if (!isSelected(device, options.devices))
+        continue;
+      // Some OpenCL platforms expose the same devices twice (like rust_icl and ROCm), so ask once per platform
+      if (options.interactive && !device.platform.empty() && !acceptedPlatforms.count(device.platform)) {
+        if (declinedPlatforms.count(device.platform))
+          continue;
+        if (!CLBackend::confirmPlatform(device.platform)) {
+          declinedPlatforms.insert(device.platform);
+          continue;
+        }
+        acceptedPlatforms.insert(device.platform);
+      }
+
+      reports.push_back({});
+      DeviceReport& report = reports.back();
+      report.device = device;
+      Suite::beginDevice(&report);
+      try {
+        benchmarkDevice(device);
+      } catch (const std::exception& e) {
+        std::cerr << ORCHESTRATOR << backendName(backend) << " device " << device.index << ": " << e.what() << "\n";
+        report.error = e.what();
+      }
+      Suite::endDevice();
+    }
+
+    // Pairs need every device at once, so this runs after the per-device tests
+    std::vector<int> peerDevices;
+    for (const DeviceReport& report : reports) {
+      if (report.device.backend == backend && report.error.empty())
+        peerDevices.push_back(report.device.index);
+    }
+    if (peerDevices.size() > 1 && Suite::shouldRun("peer_to_peer")) {
+      try {
+        std::vector<PeerLink> links = measurePeerLinks(backend, peerDevices);
+        if (!links.empty())
+          printPeerMatrix(backend, peerDevices, links);
+        for (DeviceReport& report : reports) {
+          for (const PeerLink& link : links) {
+            if (report.device.backend == backend && report.device.index == link.source)
+              report.peers.push_back(link);
+          }
+        }
+      } catch (const std::exception& e) {
+        std::cerr << ORCHESTRATOR << backendName(backend) << " peer-to-peer: " << e.what() << "\n";
+      }
+    }
+    shutdownBackend(backend);
+  }
+  Suite::end();
+  return reports;
+}
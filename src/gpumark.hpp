@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// In-process API for GPUMark. The gpumark executable is a thin client of this library,
+// so anything it can measure is also available to services that link libgpumark.
+namespace GPUMark {
+enum class Backend { CUDA, HIP, OpenCL };
+const char* backendName(Backend backend);
+
+struct Device {
+  Backend backend;
+  int index;                            // Ordinal within the backend (OpenCL devices are numbered across all platforms)
+  std::string name;
+  unsigned long long totalMemory = 0;   // Bytes
+  std::string platform;                 // OpenCL platform name, empty for CUDA/HIP
+};
+
+struct TestResult {
+  std::string name;                     // One of testNames()
+  bool passed = true;
+  float milliseconds = 0.0f;            // The headline time the test prints
+  std::map<std::string, double> metrics; // Derived numbers, e.g. "htod_mb_per_s"
+};
+
+// Copies from one device to another device of the same backend
+struct PeerLink {
+  int source;                           // Device::index of the sending device
+  int destination;                      // Device::index of the receiving device
+  bool peerAccess = false;              // Direct peer copy (NVLink/xGMI/PCIe P2P), otherwise staged through pinned host memory
+  double gigabytesPerSecond = 0.0;
+  double latencyMicroseconds = 0.0;     // One 4-byte copy, end to end
+};
+
+struct DeviceReport {
+  Device device;
+  bool skipped = false;                 // The device was busy, too small, too slow or out of budget
+  std::string skipReason;
+  std::string error;                    // Driver error that stopped the run on this device
+  std::vector<TestResult> results;
+  std::vector<PeerLink> peers;          // Links to every other selected device of the same backend (CUDA and HIP only)
+};
+
+// One size in the mix the allocation test draws from
+struct AllocationSize {
+  size_t bytes;
+  double weight;                        // Relative frequency
+};
+
+struct RunOptions {
+  std::vector<Backend> backends = {Backend::CUDA, Backend::HIP};
+  std::vector<Device> devices;          // Empty runs every device of the selected backends
+  std::vector<std::string> tests;       // Empty runs every test
+  double budgetSeconds = 0.0;           // No new test starts once this is used up. 0 means no limit
+  bool interactive = false;             // Ask before slow devices/OpenCL platforms instead of skipping/accepting them
+  bool verbose = true;                  // Print progress to stdout like the gpumark executable
+  // Sizes the allocation test allocates and frees, a mix of small temporaries and a few large buffers by default
+  std::vector<AllocationSize> allocationSizes = {{256, 20}, {4096, 30}, {65536, 25}, {1 << 20, 15}, {16 << 20, 8}, {256 << 20, 2}};
+  // File the ingest test reads into device memory. Empty writes a 1 GB file to the temp directory, once per run, and deletes it when the run ends
+  std::string ingestFile;
+};
+
+// Thrown by the backends when a driver call fails. run() catches it, like any other std::exception a test throws, and
+// records it in DeviceReport::error.
+class Error : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+std::vector<std::string> testNames();
+std::vector<Device> enumerateDevices(const std::vector<Backend>& backends = {Backend::CUDA, Backend::HIP, Backend::OpenCL});
+// Benchmarks every selected device in turn. Not reentrant and not thread-safe: the run's state is global, and std::cout's
+// buffer is swapped out for the whole run unless options.verbose is set.
+std::vector<DeviceReport> run(const RunOptions& options = {});
+} // namespace GPUMark
@@ -1,24 +1,57 @@
-#include "backends/cuda_backend.hpp"
-#include "backends/hip_backend.hpp"
-#include "backends/opencl_backend.hpp"
 #include "backends/opengl_backend.hpp"
 #include "backends/vulkan_backend.hpp"
+#include "gpumark.hpp"
 #include "shared/shared.hpp"
+#include "shared/trace.hpp"
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+
+// "bytes:weight,bytes:weight,..." as in GPUMARK_ALLOC_SIZES=4096:10,1048576:1
+static std::vector<GPUMark::AllocationSize> parseAllocationSizes(const std::string& text) {
+  std::vector<GPUMark::AllocationSize> sizes;
+  std::istringstream entries(text);
+  std::string entry;
+  while (std::getline(entries, entry, ',')) {
+    size_t colon = entry.find(':');
+    try {
+      size_t bytes = std::stoull(entry.substr(0, colon));
+      double weight = colon == std::string::npos ? 1.0 : std::stod(entry.substr(colon + 1));
+      if (bytes > 0 && weight > 0.0)
+        sizes.push_back({bytes, weight});
+    } catch (const std::exception&) {
+      std::cerr << ORCHESTRATOR << "Ignoring allocation size '" << entry << "', expected bytes:weight\n";
+    }
+  }
+  return sizes;
+}
 
 int main() {
   std::cout << ORCHESTRATOR << "GPU Benchmark starting...\n";
-
-  // CUDA
-  if (CudaBackend::init()) {
-    CudaBackend::runBenchmark();
-    CudaBackend::shutdown();
+  // Set GPUMARK_TRACE=<file.json> to record every benchmark phase for Perfetto/chrome://tracing
+  if (const char* tracePath = std::getenv("GPUMARK_TRACE")) {
+    Trace::start(tracePath);
   }
 
-  // HIP
-  if (HIPBackend::init()) {
-    HIPBackend::runBenchmark();
-    HIPBackend::shutdown();
+  GPUMark::RunOptions options;
+  options.interactive = true;
+  // Set GPUMARK_ALLOC_SIZES to the size mix of your own workload for the allocation test
+  if (const char* allocationSizes = std::getenv("GPUMARK_ALLOC_SIZES")) {
+    std::vector<GPUMark::AllocationSize> sizes = parseAllocationSizes(allocationSizes);
+    if (!sizes.empty())
+      options.allocationSizes = sizes;
+  }
+  // Set GPUMARK_INGEST_FILE to a dataset shard on the disk you train from for the ingest test
+  if (const char* ingestFile = std::getenv("GPUMARK_INGEST_FILE")) {
+    options.ingestFile = ingestFile;
+  }
+  // // OpenCL
+  // options.backends.push_back(GPUMark::Backend::OpenCL);
+  std::vector<GPUMark::DeviceReport> reports = GPUMark::run(options);
+  for (const GPUMark::DeviceReport& report : reports) {
+    if (!report.error.empty())
+      std::cout << ORCHESTRATOR << RED << GPUMark::backendName(report.device.backend) << " device " << report.device.index
+                << " (" << report.device.name << ") stopped: " << report.error << RESET << "\n";
   }
 
   // // Vulkan
@@ -28,15 +61,10 @@ int main() {
   //     vk.shutdown();
   // }
 
-  // // OpenCL
-  // if (CLBackend::init()) {
-  //   CLBackend::runBenchmark();
-  //   CLBackend::shutdown();
-  // }
-
   // OpenGL
   // GLBackend::runBenchmark();
 
+  Trace::finish();
   std::cout << "All benchmarks done.\n";
   return 0;
 }
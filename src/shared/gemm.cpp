@@ -0,0 +1,290 @@
+#include "gemm.hpp"
+#include "suite.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+const std::vector<unsigned int>& Gemm::sizes() {
+  static const std::vector<unsigned int> sizes = {256, 512, 1024, 2048, 4096};
+  return sizes;
+}
+
+std::vector<float> Gemm::randomMatrix(unsigned int n, unsigned int seed) {
+  std::vector<float> matrix(static_cast<size_t>(n) * n);
+  unsigned int state = seed * 2654435761u + 1u;
+  for (float& value : matrix) {
+    state = state * 1664525u + 1013904223u;
+    value = static_cast<float>(state >> 8) / static_cast<float>(1u << 23) - 1.0f;
+  }
+  return matrix;
+}
+
+bool Gemm::verifySamples(const std::vector<float>& A, const std::vector<float>& B, const std::vector<float>& C, unsigned int n,
+                         unsigned int samples) {
+  const float epsilon = std::numeric_limits<float>::epsilon();
+  unsigned int state = n;
+  for (unsigned int sample = 0; sample < samples; ++sample) {
+    size_t row = 0, col = 0;
+    if (sample < 4) {
+      row = sample & 1 ? n - 1 : 0;
+      col = sample & 2 ? n - 1 : 0;
+    } else {
+      state = state * 1664525u + 1013904223u;
+      row = (state >> 8) % n;
+      state = state * 1664525u + 1013904223u;
+      col = (state >> 8) % n;
+    }
+    double expected = 0.0, magnitude = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+      double product = static_cast<double>(A[row * n + k]) * B[k * n + col];
+      expected += product;
+      magnitude += std::fabs(product);
+    }
+    // Rounding errors of a length-n fp32 sum grow like sqrt(n) in practice, and the order differs between variants. A
+    // wrong tile or a missed k-step is off by far more.
+    if (std::fabs(C[row * n + col] - expected) > 4.0 * std::sqrt(static_cast<double>(n)) * epsilon * magnitude + epsilon)
+      return false;
+  }
+  return true;
+}
+
+double Gemm::gigaflops(unsigned int n, double milliseconds) {
+  return milliseconds > 0.0 ? 2.0 * n * n * n / (milliseconds * 1e6) : 0.0;
+}
+
+double Gemm::millisecondsAt(const std::vector<unsigned int>& sizes, const Curve& curve, unsigned int n) {
+  size_t index = static_cast<size_t>(std::find(sizes.begin(), sizes.end(), n) - sizes.begin());
+  if (index < curve.milliseconds.size() && curve.milliseconds[index] > 0.0)
+    return curve.milliseconds[index];
+  auto ran = std::find_if(curve.milliseconds.rbegin(), curve.milliseconds.rend(), [](double milliseconds) { return milliseconds > 0.0; });
+  return ran != curve.milliseconds.rend() ? *ran : 0.0;
+}
+
+void Gemm::report(std::string_view prefix, const char* test, const std::vector<unsigned int>& sizes, const std::vector<Curve>& curves) {
+  std::cout << prefix << std::setw(8) << "Size";
+  for (const Curve& curve : curves) {
+    std::cout << std::setw(18) << curve.name;
+  }
+  std::cout << "   (GFLOP/s)\n" << std::fixed << std::setprecision(1);
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    std::cout << prefix << std::setw(8) << sizes[i];
+    for (const Curve& curve : curves) {
+      double rate = gigaflops(sizes[i], curve.milliseconds[i]);
+      if (rate > 0.0) {
+        std::cout << std::setw(18) << rate;
+        Suite::metric(test, curve.key + "_" + std::to_string(sizes[i]) + "_gflops", rate);
+      } else {
+        std::cout << std::setw(18) << "-";
+      }
+    }
+    std::cout << "\n";
+  }
+  const Curve* best = nullptr;
+  double bestRate = 0.0, baselineRate = 0.0;
+  for (const Curve& curve : curves) {
+    double peak = 0.0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      peak = std::max(peak, gigaflops(sizes[i], curve.milliseconds[i]));
+    }
+    Suite::metric(test, curve.key + "_peak_gflops", peak);
+    if (&curve == &curves.front())
+      baselineRate = peak;
+    if (peak > bestRate) {
+      bestRate = peak;
+      best = &curve;
+    }
+  }
+  if (best) {
+    std::cout << prefix << "Best: " << best->name << " at " << bestRate << " GFLOP/s";
+    if (baselineRate > 0.0 && best != &curves.front())
+      std::cout << ", " << bestRate / baselineRate << "x " << curves.front().name;
+    std::cout << "\n";
+  }
+}
+
+const char* Gemm::formatName(Format format) {
+  switch (format) {
+  case Format::Half:
+    return "fp16";
+  case Format::Bfloat16:
+    return "bf16";
+  case Format::Float:
+    return "fp32";
+  case Format::Double:
+    return "fp64";
+  case Format::Int8:
+    return "int8";
+  }
+  return "unknown";
+}
+
+std::string Gemm::multiplyAddKernelName(Format format) {
+  static const char* names[] = {"fmaHalf2Kernel", "fmaBfloat162Kernel", "fmaFloatKernel", "fmaDoubleKernel", "dotInt8Kernel"};
+  return names[static_cast<int>(format)];
+}
+
+std::string Gemm::gemmKernelName(Format format) {
+  static const char* names[] = {"gemmHalfKernel", "gemmBfloat16Kernel", "gemmFloatKernel", "gemmDoubleKernel", "gemmInt8Kernel"};
+  return names[static_cast<int>(format)];
+}
+
+double Gemm::opsPerMultiplyAdd(Format format) {
+  switch (format) {
+  case Format::Half:
+  case Format::Bfloat16:
+    return 4.0;
+  case Format::Int8:
+    return 8.0;
+  default:
+    return 2.0;
+  }
+}
+
+size_t Gemm::inputBytes(Format format) {
+  switch (format) {
+  case Format::Half:
+  case Format::Bfloat16:
+    return 2;
+  case Format::Double:
+    return 8;
+  case Format::Int8:
+    return 1;
+  default:
+    return 4;
+  }
+}
+
+size_t Gemm::outputBytes(Format format) { return format == Format::Double ? 8 : 4; }
+
+std::vector<int> Gemm::integerMatrix(unsigned int n, unsigned int seed) {
+  std::vector<int> matrix(static_cast<size_t>(n) * n);
+  unsigned int state = seed * 2654435761u + 1u;
+  for (int& value : matrix) {
+    state = state * 1664525u + 1013904223u;
+    value = static_cast<int>((state >> 16) % 5) - 2;
+  }
+  return matrix;
+}
+
+namespace {
+// Small integers only, which fp16 holds exactly: sign, biased exponent and the bits below the leading one
+unsigned short halfBits(int value) {
+  if (value == 0)
+    return 0;
+  unsigned short sign = value < 0 ? 0x8000 : 0;
+  unsigned int magnitude = static_cast<unsigned int>(value < 0 ? -value : value);
+  int exponent = 0;
+  while (magnitude >> (exponent + 1))
+    ++exponent;
+  unsigned int mantissa = (magnitude << (10 - exponent)) & 0x3ff;
+  return static_cast<unsigned short>(sign | ((exponent + 15) << 10) | mantissa);
+}
+
+// bf16 is the upper half of an fp32, which is exact for small integers
+unsigned short bfloat16Bits(int value) {
+  float f = static_cast<float>(value);
+  unsigned int bits = 0;
+  std::memcpy(&bits, &f, sizeof(bits));
+  return static_cast<unsigned short>(bits >> 16);
+}
+} // namespace
+
+std::vector<unsigned char> Gemm::encode(Format format, const std::vector<int>& values) {
+  std::vector<unsigned char> bytes(values.size() * inputBytes(format));
+  for (size_t i = 0; i < values.size(); ++i) {
+    unsigned char* element = bytes.data() + i * inputBytes(format);
+    switch (format) {
+    case Format::Half: {
+      unsigned short bits = halfBits(values[i]);
+      std::memcpy(element, &bits, sizeof(bits));
+      break;
+    }
+    case Format::Bfloat16: {
+      unsigned short bits = bfloat16Bits(values[i]);
+      std::memcpy(element, &bits, sizeof(bits));
+      break;
+    }
+    case Format::Float: {
+      float value = static_cast<float>(values[i]);
+      std::memcpy(element, &value, sizeof(value));
+      break;
+    }
+    case Format::Double: {
+      double value = values[i];
+      std::memcpy(element, &value, sizeof(value));
+      break;
+    }
+    case Format::Int8:
+      *element = static_cast<unsigned char>(static_cast<signed char>(values[i]));
+      break;
+    }
+  }
+  return bytes;
+}
+
+bool Gemm::verifyExact(Format format, const std::vector<int>& A, const std::vector<int>& B, const std::vector<unsigned char>& C, unsigned int n,
+                       unsigned int samples) {
+  unsigned int state = n;
+  for (unsigned int sample = 0; sample < samples; ++sample) {
+    size_t row = 0, col = 0;
+    if (sample < 4) {
+      row = sample & 1 ? n - 1 : 0;
+      col = sample & 2 ? n - 1 : 0;
+    } else {
+      state = state * 1664525u + 1013904223u;
+      row = (state >> 8) % n;
+      state = state * 1664525u + 1013904223u;
+      col = (state >> 8) % n;
+    }
+    long long expected = 0;
+    for (size_t k = 0; k < n; ++k) {
+      expected += static_cast<long long>(A[row * n + k]) * B[k * n + col];
+    }
+    const unsigned char* element = C.data() + (row * n + col) * outputBytes(format);
+    double actual = 0.0;
+    if (format == Format::Double) {
+      std::memcpy(&actual, element, sizeof(actual));
+    } else if (format == Format::Int8) {
+      int value = 0;
+      std::memcpy(&value, element, sizeof(value));
+      actual = value;
+    } else {
+      float value = 0.0f;
+      std::memcpy(&value, element, sizeof(value));
+      actual = value;
+    }
+    if (actual != static_cast<double>(expected))
+      return false;
+  }
+  return true;
+}
+
+void Gemm::reportFormats(std::string_view prefix, const char* test, const std::vector<FormatRate>& rates) {
+  double floatRate = 0.0;
+  for (const FormatRate& rate : rates) {
+    if (rate.format == Format::Float)
+      floatRate = rate.multiplyAddOps / (rate.multiplyAddMilliseconds * 1e6);
+  }
+  std::cout << prefix << std::setw(8) << "Format" << std::setw(16) << "Multiply-add" << std::setw(10) << "vs fp32" << std::setw(16) << "GEMM"
+            << "   (GOPS, a multiply-add counts as 2)\n";
+  std::cout << std::fixed;
+  for (const FormatRate& rate : rates) {
+    const std::string key = formatName(rate.format);
+    double multiplyAdd = rate.multiplyAddMilliseconds > 0.0 ? rate.multiplyAddOps / (rate.multiplyAddMilliseconds * 1e6) : 0.0;
+    double gemm = gigaflops(rate.gemmSize, rate.gemmMilliseconds);
+    std::cout << prefix << std::setw(8) << key << std::setprecision(1) << std::setw(16) << multiplyAdd << std::setprecision(2) << std::setw(9)
+              << (floatRate > 0.0 ? multiplyAdd / floatRate : 0.0) << "x" << std::setprecision(1) << std::setw(16) << gemm;
+    if (!rate.valid)
+      std::cout << "   GEMM result is wrong";
+    if (!rate.note.empty())
+      std::cout << "   " << rate.note;
+    std::cout << "\n";
+    Suite::metric(test, key + "_multiply_add_gops", multiplyAdd);
+    Suite::metric(test, key + "_gemm_gops", gemm);
+    if (floatRate > 0.0)
+      Suite::metric(test, key + "_to_fp32_ratio", multiplyAdd / floatRate);
+  }
+}
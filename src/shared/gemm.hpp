@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Square matrix multiplications C = A * B over a sweep of sizes: inputs, checking results against the CPU and reporting
+// the rate of every kernel variant.
+namespace Gemm {
+// Matrix sizes to sweep, each a multiple of the largest tile (64) so every variant covers C exactly
+const std::vector<unsigned int>& sizes();
+// A variant whose single launch takes longer than this is not run at larger sizes, as each doubling costs 8x more
+constexpr double timeBudgetMilliseconds = 1000.0;
+
+// n x n row-major values in [-1, 1), the same for the same seed
+std::vector<float> randomMatrix(unsigned int n, unsigned int seed);
+// Recomputes `samples` elements of C in double precision, including all four corners, and checks each is within the
+// rounding error of an fp32 dot product of length n
+bool verifySamples(const std::vector<float>& A, const std::vector<float>& B, const std::vector<float>& C, unsigned int n,
+                   unsigned int samples = 64);
+double gigaflops(unsigned int n, double milliseconds);
+
+// One kernel variant timed at every size
+struct Curve {
+  std::string name;
+  std::string key;                  // Metric prefix
+  std::vector<double> milliseconds; // Best launch per size, 0 where it was not run
+  bool valid = true;                // Every size that ran passed verifySamples
+};
+// The curve's time at n x n. Falls back to the largest size that ran when n was skipped for the time budget or is not
+// swept, and is 0 only if nothing ran.
+double millisecondsAt(const std::vector<unsigned int>& sizes, const Curve& curve, unsigned int n);
+// Prints GFLOP/s per size and variant, with the best variant and its speedup over the first one, and records
+// "<key>_<n>_gflops" and "<key>_peak_gflops" as metrics
+void report(std::string_view prefix, const char* test, const std::vector<unsigned int>& sizes, const std::vector<Curve>& curves);
+
+// Number formats of the precision test, in the order its kernels are passed around
+enum class Format { Half, Bfloat16, Float, Double, Int8 };
+constexpr Format formats[] = {Format::Half, Format::Bfloat16, Format::Float, Format::Double, Format::Int8};
+const char* formatName(Format format);
+// Module names: fmaHalf2Kernel etc. (eight independent multiply-add chains per thread), gemmHalfKernel etc. (16x16 tiles)
+std::string multiplyAddKernelName(Format format);
+std::string gemmKernelName(Format format);
+// Operations one multiply-add of the format does: 2, 4 for packed pairs of 16-bit values, 8 for a 4-way int8 dot product
+double opsPerMultiplyAdd(Format format);
+// Bytes of one element of A and B, and of C. The 16-bit formats accumulate into fp32 and int8 into int32.
+size_t inputBytes(Format format);
+size_t outputBytes(Format format);
+// n x n integers in [-2, 2]. They and every product sum up to n = 4096 are exact in all formats, so results compare exactly.
+std::vector<int> integerMatrix(unsigned int n, unsigned int seed);
+// The matrix as raw elements of the format, ready to upload
+std::vector<unsigned char> encode(Format format, const std::vector<int>& values);
+// Checks `samples` elements of C (raw elements of the format's output), including all four corners, against A * B
+bool verifyExact(Format format, const std::vector<int>& A, const std::vector<int>& B, const std::vector<unsigned char>& C, unsigned int n,
+                 unsigned int samples = 64);
+
+// Throughput of one format from the multiply-add loop and the tiled GEMM
+struct FormatRate {
+  Format format;
+  double multiplyAddOps;
+  double multiplyAddMilliseconds;
+  unsigned int gemmSize;
+  double gemmMilliseconds;
+  bool valid = true; // The GEMM matched the CPU
+  std::string note;  // Why the rate may not be the hardware's, e.g. emulated through fp32
+};
+// Prints ops/s of every format and its ratio to fp32, and records "<format>_multiply_add_gops", "<format>_gemm_gops"
+// and "<format>_to_fp32_ratio" as metrics
+void reportFormats(std::string_view prefix, const char* test, const std::vector<FormatRate>& rates);
+} // namespace Gemm
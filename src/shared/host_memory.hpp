@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Large host buffers placed next to the device: backed by huge pages where the OS has them, on the NUMA node the
+// device is attached to, with the benchmark thread pinned to that node. Per OS in src/backends/<os>/host_memory.cpp.
+namespace HostMemory {
+enum class Pages { Huge, Transparent, Small };
+
+inline const char* pagesName(Pages pages) {
+  switch (pages) {
+  case Pages::Huge:
+    return "huge pages";
+  case Pages::Transparent:
+    return "transparent huge pages";
+  case Pages::Small:
+    return "4 KB pages";
+  }
+  return "unknown pages";
+}
+
+// NUMA node the PCI device is attached to, -1 if the host has a single node or the OS does not say
+int deviceNode(int pciDomain, int pciBus, int pciDevice);
+// Nodes the host has online, just node 0 without NUMA
+std::vector<int> nodes();
+
+// What an allocation actually got
+struct Placement {
+  Pages pages = Pages::Small;
+  bool bound = false; // Pages were bound to the node asked for, rather than left to the first touch
+};
+// Page-aligned host memory on `node` (-1 leaves placement to the OS), backed by explicit huge pages if the node has
+// enough free, else transparent huge pages. With hugePages false it gets the default page size. Every page is touched,
+// so the memory is resident on return. Throws GPUMark::Error if it cannot be allocated.
+void* allocate(size_t bytes, int node, bool hugePages = true, Placement* placement = nullptr);
+void release(void* data, size_t bytes);
+
+// Keeps the calling thread, and any thread it starts, on the CPUs of `node` until destroyed
+class ThreadPin {
+public:
+  explicit ThreadPin(int node);
+  ~ThreadPin();
+  ThreadPin(const ThreadPin&) = delete;
+  ThreadPin& operator=(const ThreadPin&) = delete;
+
+  bool pinned() const { return active; }
+
+private:
+  std::vector<unsigned char> previous; // The OS's affinity mask from before
+  bool active = false;
+};
+} // namespace HostMemory
@@ -0,0 +1,166 @@
+#include "ingest.hpp"
+#include "../gpumark.hpp"
+#include "suite.hpp"
+#include "sweep.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+double millisecondsSince(clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); }
+
+// Direct reads must cover whole blocks, so the last chunk is rounded up and comes back short
+size_t readSize(size_t chunkBytes, unsigned long long remaining) {
+  unsigned long long rounded = (remaining + Ingest::directAlignment - 1) / Ingest::directAlignment * Ingest::directAlignment;
+  return static_cast<size_t>(std::min<unsigned long long>(chunkBytes, rounded));
+}
+} // namespace
+
+Ingest::TestFile::TestFile(unsigned long long bytes) {
+  // Several runs may share the temp directory, so the name is drawn until it is free
+  std::filesystem::path path;
+  std::random_device random;
+  do {
+    path = std::filesystem::temp_directory_path() / ("gpumark_ingest_" + std::to_string(random()) + ".bin");
+  } while (std::filesystem::exists(path));
+  filePath = path.string();
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw GPUMark::Error("Cannot create " + filePath);
+  std::vector<unsigned int> block(8 << 20 >> 2);
+  unsigned int word = 0;
+  for (unsigned long long written = 0; written < bytes && file; written += block.size() * sizeof(unsigned int)) {
+    for (unsigned int& value : block) {
+      value = word++;
+    }
+    size_t size = static_cast<size_t>(std::min<unsigned long long>(block.size() * sizeof(unsigned int), bytes - written));
+    file.write(reinterpret_cast<const char*>(block.data()), size);
+  }
+  if (!file) {
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    throw GPUMark::Error("Cannot write " + filePath);
+  }
+}
+
+Ingest::TestFile::~TestFile() {
+  std::error_code error;
+  std::filesystem::remove(filePath, error);
+}
+
+unsigned long long Ingest::fileSize(const std::string& path) {
+  std::error_code error;
+  unsigned long long size = std::filesystem::file_size(path, error);
+  if (error)
+    throw GPUMark::Error("Cannot read " + path + ": " + error.message());
+  return size;
+}
+
+bool Ingest::matchesFile(const std::string& path, unsigned long long offset, const void* data, size_t bytes) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<char> expected(bytes);
+  file.seekg(static_cast<std::streamoff>(offset));
+  file.read(expected.data(), static_cast<std::streamsize>(bytes));
+  return file && std::memcmp(expected.data(), data, bytes) == 0;
+}
+
+double Ingest::readMilliseconds(FileReader& reader, const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes) {
+  auto start = clock::now();
+  unsigned long long submitted = 0;
+  unsigned int inFlight = 0;
+  for (unsigned int slot = 0; slot < ring.size() && submitted < fileBytes; ++slot, ++inFlight) {
+    reader.submit(ring[slot], readSize(chunkBytes, fileBytes - submitted), submitted, slot);
+    submitted += chunkBytes;
+  }
+  while (inFlight > 0) {
+    size_t bytesRead = 0;
+    unsigned int slot = reader.wait(bytesRead);
+    --inFlight;
+    if (submitted < fileBytes) {
+      reader.submit(ring[slot], readSize(chunkBytes, fileBytes - submitted), submitted, slot);
+      submitted += chunkBytes;
+      ++inFlight;
+    }
+  }
+  return millisecondsSince(start);
+}
+
+double Ingest::stagingMilliseconds(const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes) {
+  std::vector<char> pageable(chunkBytes, 1);
+  auto start = clock::now();
+  unsigned int slot = 0;
+  for (unsigned long long copied = 0; copied < fileBytes; copied += chunkBytes) {
+    std::memcpy(ring[slot], pageable.data(), static_cast<size_t>(std::min<unsigned long long>(chunkBytes, fileBytes - copied)));
+    slot = (slot + 1) % ring.size();
+  }
+  return millisecondsSince(start);
+}
+
+unsigned int Ingest::pipeline(FileReader& reader, const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes,
+                              const std::function<void(unsigned int, size_t, unsigned long long)>& upload,
+                              const std::function<void(unsigned int)>& waitUpload) {
+  enum class SlotState { Free, Reading, Uploading };
+  std::vector<SlotState> state(ring.size(), SlotState::Free);
+  std::vector<unsigned long long> offsets(ring.size(), 0);
+  const unsigned long long chunks = (fileBytes + chunkBytes - 1) / chunkBytes;
+  unsigned long long nextChunk = 0, uploaded = 0;
+  unsigned int lastSlot = 0;
+  // Chunk c always goes to slot c % slots, so a slot is refilled once its upload is done and the reads stay in order
+  auto refill = [&] {
+    while (nextChunk < chunks && state[nextChunk % ring.size()] != SlotState::Reading) {
+      unsigned int slot = static_cast<unsigned int>(nextChunk % ring.size());
+      if (state[slot] == SlotState::Uploading)
+        waitUpload(slot);
+      offsets[slot] = nextChunk * chunkBytes;
+      reader.submit(ring[slot], readSize(chunkBytes, fileBytes - offsets[slot]), offsets[slot], slot);
+      state[slot] = SlotState::Reading;
+      ++nextChunk;
+    }
+  };
+  refill();
+  while (uploaded < chunks) {
+    size_t bytesRead = 0;
+    unsigned int slot = reader.wait(bytesRead);
+    upload(slot, bytesRead, offsets[slot]);
+    state[slot] = SlotState::Uploading;
+    if (offsets[slot] / chunkBytes == chunks - 1)
+      lastSlot = slot;
+    ++uploaded;
+    refill();
+  }
+  for (unsigned int slot = 0; slot < ring.size(); ++slot) {
+    if (state[slot] == SlotState::Uploading)
+      waitUpload(slot);
+  }
+  return lastSlot;
+}
+
+void Ingest::reportStages(std::string_view prefix, const char* test, const Stages& stages) {
+  double disk = Sweep::gigabytesPerSecond({static_cast<double>(stages.bytes), stages.diskMilliseconds});
+  double staging = Sweep::gigabytesPerSecond({static_cast<double>(stages.bytes), stages.stagingMilliseconds});
+  double upload = Sweep::gigabytesPerSecond({static_cast<double>(stages.bytes), stages.uploadMilliseconds});
+  double pipeline = Sweep::gigabytesPerSecond({static_cast<double>(stages.bytes), stages.pipelineMilliseconds});
+  // Reads land straight in the pinned ring, so staging only shows what a pageable read path would add
+  double limit = std::min(disk, upload);
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << prefix << "Disk (file -> pinned):        " << std::setw(10) << disk << " GB/s, " << stages.method
+            << (stages.direct ? "\n" : ", may include the page cache\n");
+  std::cout << prefix << "Staging (pageable -> pinned): " << std::setw(10) << staging << " GB/s\n";
+  std::cout << prefix << "PCIe (pinned -> device):      " << std::setw(10) << upload << " GB/s\n";
+  std::cout << prefix << "File -> device, overlapped:   " << std::setw(10) << pipeline << " GB/s, " << std::setprecision(1)
+            << (limit > 0.0 ? 100.0 * pipeline / limit : 0.0) << "% of the " << (disk < upload ? "disk" : "PCIe") << " limit\n"
+            << std::setprecision(2);
+  Suite::metric(test, "disk_gb_per_s", disk);
+  Suite::metric(test, "staging_gb_per_s", staging);
+  Suite::metric(test, "pcie_gb_per_s", upload);
+  Suite::metric(test, "pipeline_gb_per_s", pipeline);
+  Suite::metric(test, "direct_io", stages.direct ? 1.0 : 0.0);
+}
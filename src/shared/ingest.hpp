@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reading a file into device memory: a reader that keeps several chunk reads in flight, and the pipeline that hands
+// each chunk to the device as soon as it lands. The readers are per OS (src/backends/<os>/ingest.cpp).
+namespace Ingest {
+// Buffers for direct I/O must start on this boundary, and every read is a multiple of it
+constexpr size_t directAlignment = 4096;
+
+// Reads a file into caller-owned buffers, with up to `depth` reads queued at once
+class FileReader {
+public:
+  virtual ~FileReader() = default;
+  // Queues a read of `bytes` at `offset` into `buffer`. `tag` is handed back by wait() when the read finishes.
+  virtual void submit(void* buffer, size_t bytes, unsigned long long offset, unsigned int tag) = 0;
+  // Blocks until any queued read has finished and returns its tag. bytesRead is short only at the end of the file.
+  virtual unsigned int wait(size_t& bytesRead) = 0;
+  // How the file is read, e.g. "io_uring, O_DIRECT"
+  virtual std::string method() const = 0;
+  // False if reads may be served from the page cache
+  virtual bool direct() const = 0;
+};
+// Opens `path` for reading. With `direct` the page cache is bypassed where the file system allows it, otherwise
+// cached pages of the file are dropped first so reads still reach the disk. Throws GPUMark::Error if it cannot be opened.
+std::unique_ptr<FileReader> openReader(const std::string& path, unsigned int depth, bool direct);
+
+// A file of `bytes` 32-bit word offsets under a unique name in the temp directory, removed again when destroyed
+class TestFile {
+public:
+  explicit TestFile(unsigned long long bytes);
+  ~TestFile();
+  TestFile(const TestFile&) = delete;
+  TestFile& operator=(const TestFile&) = delete;
+  const std::string& path() const { return filePath; }
+
+private:
+  std::string filePath;
+};
+unsigned long long fileSize(const std::string& path);
+// True if `bytes` at `offset` in the file match `data`
+bool matchesFile(const std::string& path, unsigned long long offset, const void* data, size_t bytes);
+
+// Reads the whole file through `ring`, one chunk per slot, without touching the device
+double readMilliseconds(FileReader& reader, const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes);
+// Copies fileBytes from pageable memory into the ring, what a reader that cannot target pinned memory adds
+double stagingMilliseconds(const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes);
+// Reads the file chunk by chunk into `ring` and calls upload(slot, bytes, offset) as soon as each chunk lands.
+// A slot is read into again only after waitUpload(slot) has returned. Returns the last chunk's slot.
+unsigned int pipeline(FileReader& reader, const std::vector<void*>& ring, size_t chunkBytes, unsigned long long fileBytes,
+                      const std::function<void(unsigned int, size_t, unsigned long long)>& upload,
+                      const std::function<void(unsigned int)>& waitUpload);
+
+struct Stages {
+  unsigned long long bytes;
+  std::string method;          // FileReader::method()
+  bool direct;
+  double diskMilliseconds;     // File into the pinned ring
+  double stagingMilliseconds;  // Pageable memory into the pinned ring
+  double uploadMilliseconds;   // Pinned ring to the device, back to back
+  double pipelineMilliseconds; // File to the device with reads and uploads overlapped
+};
+// Prints the throughput of every stage and of the pipeline, which stage limits it, and records them as metrics
+void reportStages(std::string_view prefix, const char* test, const Stages& stages);
+} // namespace Ingest
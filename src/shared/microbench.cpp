@@ -0,0 +1,299 @@
+#include "microbench.hpp"
+#include "suite.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+const std::vector<Microbench::Instruction>& Microbench::instructions() {
+  static const std::vector<Instruction> instructions = {
+      {"sin (fast)", "SinFast", "sin_fast"},
+      {"sin", "Sin", "sin"},
+      {"exp (fast)", "ExpFast", "exp_fast"},
+      {"exp", "Exp", "exp"},
+      {"rsqrt (fast)", "RsqrtFast", "rsqrt_fast"},
+      {"1 / sqrt", "Rsqrt", "rsqrt"},
+      {"int32 mul", "IntMul", "int32_mul"},
+      {"int32 mad", "IntMad", "int32_mad"},
+      {"popcount", "Popcount", "popcount"},
+      {"clz", "Clz", "clz"},
+      {"int -> float -> int", "IntFloat", "int_float_int"},
+      {"int64 mul", "Int64Mul", "int64_mul"},
+      {"int64 mad", "Int64Mad", "int64_mad"},
+  };
+  return instructions;
+}
+
+void Microbench::reportInstructionMix(std::string_view prefix, const char* test, const std::vector<InstructionRate>& rates, double clockHz,
+                                      unsigned int computeUnits) {
+  std::cout << prefix << std::setw(22) << "Instruction" << std::setw(18) << "Latency (cycles)" << std::setw(12) << "GOPS" << std::setw(17)
+            << "Ops/clock/unit" << "\n";
+  std::cout << std::fixed;
+  for (const InstructionRate& rate : rates) {
+    double gops = rate.milliseconds > 0.0 ? rate.operations / (rate.milliseconds * 1e6) : 0.0;
+    double perClock = clockHz > 0.0 && computeUnits > 0 ? gops * 1e9 / clockHz / computeUnits : 0.0;
+    std::cout << prefix << std::setw(22) << rate.name << std::setprecision(1) << std::setw(18) << rate.latencyCycles << std::setw(12) << gops
+              << std::setw(17) << perClock << "\n";
+    Suite::metric(test, rate.key + "_latency_cycles", rate.latencyCycles);
+    Suite::metric(test, rate.key + "_gops", gops);
+    Suite::metric(test, rate.key + "_ops_per_clock", perClock);
+  }
+  std::cout << prefix << "Per-clock rates assume the reported " << std::setprecision(0) << clockHz * 1e-6
+            << " MHz clock, a device that boosts past it looks faster per clock\n";
+}
+
+const std::vector<unsigned int>& Microbench::sharedMemoryStrides() {
+  static const std::vector<unsigned int> strides = {0, 1, 2, 3, 4, 8, 16, 32};
+  return strides;
+}
+
+void Microbench::reportSharedMemory(std::string_view prefix, const char* test, const std::vector<SharedAccess>& accesses, double clockHz,
+                                    unsigned int computeUnits) {
+  auto unit = std::find_if(accesses.begin(), accesses.end(), [](const SharedAccess& access) { return access.stride == 1; });
+  const double conflictFree = unit != accesses.end() ? unit->milliseconds : 0.0;
+  std::cout << prefix << std::setw(12) << "Stride" << std::setw(12) << "GB/s" << std::setw(18) << "Bytes/clock/unit" << std::setw(12)
+            << "Slowdown" << "\n";
+  std::cout << std::fixed;
+  for (const SharedAccess& access : accesses) {
+    const std::string key = access.stride == 0 ? "broadcast" : "stride_" + std::to_string(access.stride);
+    double gigabytes = access.milliseconds > 0.0 ? access.bytes / (access.milliseconds * 1e6) : 0.0;
+    double perClock = clockHz > 0.0 && computeUnits > 0 ? gigabytes * 1e9 / clockHz / computeUnits : 0.0;
+    double slowdown = conflictFree > 0.0 ? access.milliseconds / conflictFree : 0.0;
+    std::cout << prefix << std::setw(12) << (access.stride == 0 ? std::string("broadcast") : std::to_string(access.stride) + " words")
+              << std::setprecision(1) << std::setw(12) << gigabytes << std::setw(18) << perClock << std::setprecision(2) << std::setw(11)
+              << slowdown << "x\n";
+    Suite::metric(test, key + "_gb_per_s", gigabytes);
+    Suite::metric(test, key + "_bytes_per_clock", perClock);
+    Suite::metric(test, key + "_slowdown", slowdown);
+  }
+}
+
+double Microbench::conflictFreeMilliseconds(const std::vector<SharedAccess>& accesses) {
+  auto unit = std::find_if(accesses.begin(), accesses.end(), [](const SharedAccess& access) { return access.stride == 1; });
+  if (unit != accesses.end() && unit->milliseconds > 0.0)
+    return unit->milliseconds;
+  auto ran = std::find_if(accesses.rbegin(), accesses.rend(), [](const SharedAccess& access) { return access.milliseconds > 0.0; });
+  return ran != accesses.rend() ? ran->milliseconds : 0.0;
+}
+
+const std::vector<Microbench::OccupancyKernel>& Microbench::occupancyKernels() {
+  static const std::vector<OccupancyKernel> kernels = {
+      {"Copy", "occupancyMemoryKernel", "copy", false, 1},
+      {"Copy, 16 loads in flight", "occupancyMemoryRegistersKernel", "copy_registers", false, 16},
+      {"FMA", "occupancyComputeKernel", "fma", true, 8},
+      {"FMA, 64 chains", "occupancyComputeRegistersKernel", "fma_registers", true, 64},
+  };
+  return kernels;
+}
+
+const std::vector<unsigned int>& Microbench::occupancyBlockSizes() {
+  static const std::vector<unsigned int> sizes = {64, 128, 256, 512, 1024};
+  return sizes;
+}
+
+const std::vector<size_t>& Microbench::occupancySharedBytes() {
+  static const std::vector<size_t> bytes = {0, 16 << 10, 32 << 10, 48 << 10};
+  return bytes;
+}
+
+void Microbench::reportOccupancy(std::string_view prefix, const char* test, const std::vector<OccupancyCurve>& curves) {
+  std::cout << std::fixed;
+  for (const OccupancyCurve& curve : curves) {
+    const OccupancyKernel& kernel = *curve.kernel;
+    const char* unit = kernel.compute ? "GFLOP/s" : "GB/s";
+    std::cout << prefix << kernel.name;
+    if (curve.registers >= 0)
+      std::cout << " (" << curve.registers << " registers per thread, blocks up to " << curve.maxBlockSize << ")\n";
+    else
+      std::cout << " (blocks up to " << curve.maxBlockSize << ")\n";
+    if (curve.points.empty())
+      continue;
+    std::cout << prefix << std::setw(10) << "Block" << std::setw(10) << "Shared" << std::setw(12) << "Occupancy" << std::setw(12) << unit
+              << std::setw(10) << "Of best" << "\n";
+    double best = 0.0;
+    const OccupancyPoint* bestPoint = nullptr;
+    for (const OccupancyPoint& point : curve.points) {
+      double rate = point.milliseconds > 0.0 ? point.work / (point.milliseconds * 1e6) : 0.0;
+      if (rate > best) {
+        best = rate;
+        bestPoint = &point;
+      }
+    }
+    // Lowest occupancy of any configuration within 10% of the best
+    double enough = -1.0;
+    for (const OccupancyPoint& point : curve.points) {
+      double rate = point.milliseconds > 0.0 ? point.work / (point.milliseconds * 1e6) : 0.0;
+      std::cout << prefix << std::setw(10) << point.blockSize << std::setw(8) << (point.sharedBytes >> 10) << "KB";
+      if (point.occupancy >= 0.0)
+        std::cout << std::setprecision(0) << std::setw(11) << point.occupancy * 100.0 << "%";
+      else
+        std::cout << std::setw(12) << "-";
+      std::cout << std::setprecision(1) << std::setw(12) << rate << std::setprecision(0) << std::setw(9) << (best > 0.0 ? 100.0 * rate / best : 0.0)
+                << "%\n";
+      Suite::metric(test, std::string(kernel.key) + "_b" + std::to_string(point.blockSize) + "_s" + std::to_string(point.sharedBytes >> 10) + "_rate",
+                    rate);
+      if (point.occupancy >= 0.0 && rate >= 0.9 * best && (enough < 0.0 || point.occupancy < enough))
+        enough = point.occupancy;
+    }
+    if (!bestPoint)
+      continue;
+    std::cout << prefix << "Best: " << std::setprecision(1) << best << " " << unit << " with blocks of " << bestPoint->blockSize << " and "
+              << (bestPoint->sharedBytes >> 10) << " KB shared";
+    if (enough >= 0.0)
+      std::cout << ", 90% of it from " << std::setprecision(0) << enough * 100.0 << "% occupancy";
+    std::cout << "\n";
+    Suite::metric(test, std::string(kernel.key) + "_best_rate", best);
+    Suite::metric(test, std::string(kernel.key) + "_best_block_size", bestPoint->blockSize);
+    if (enough >= 0.0)
+      Suite::metric(test, std::string(kernel.key) + "_occupancy_for_90pct", enough);
+  }
+}
+
+const std::vector<Microbench::DivergencePattern>& Microbench::divergencePatterns() {
+  static const std::vector<DivergencePattern> patterns = {
+      {"Uniform", "uniform"},
+      {"Per warp", "per_warp"},
+      {"1 lane per warp", "one_per_warp"},
+      {"Half-warps", "half_warp"},
+      {"Alternate lanes", "alternate"},
+      {"4 paths by lane", "four_by_lane"},
+      {"Random, 2 paths", "random_2"},
+      {"Random, 4 paths", "random_4"},
+  };
+  return patterns;
+}
+
+std::vector<unsigned int> Microbench::divergencePaths(size_t pattern, size_t threads, unsigned int width) {
+  width = std::max(width, 1u);
+  const unsigned int halfWidth = std::max(width / 2, 1u);
+  std::vector<unsigned int> paths(threads, 0);
+  unsigned int state = 12345;
+  for (size_t t = 0; t < threads; ++t) {
+    const unsigned int lane = static_cast<unsigned int>(t % width);
+    state = state * 1664525u + 1013904223u;
+    switch (pattern) {
+    case 1:
+      paths[t] = static_cast<unsigned int>(t / width % 4);
+      break;
+    case 2:
+      paths[t] = lane == 0 ? 1 : 0;
+      break;
+    case 3:
+      paths[t] = lane / halfWidth;
+      break;
+    case 4:
+      paths[t] = lane % 2;
+      break;
+    case 5:
+      paths[t] = lane % 4;
+      break;
+    case 6:
+      paths[t] = state >> 31;
+      break;
+    case 7:
+      paths[t] = state >> 30;
+      break;
+    default:
+      break;
+    }
+  }
+  return paths;
+}
+
+double Microbench::pathsPerWarp(const std::vector<unsigned int>& paths, unsigned int width) {
+  if (paths.empty() || width == 0)
+    return 0.0;
+  double total = 0.0;
+  size_t warps = 0;
+  for (size_t first = 0; first < paths.size(); first += width, ++warps) {
+    std::set<unsigned int> taken(paths.begin() + first, paths.begin() + std::min(paths.size(), first + width));
+    total += static_cast<double>(taken.size());
+  }
+  return total / warps;
+}
+
+void Microbench::reportDivergence(std::string_view prefix, const char* test, const std::vector<DivergenceResult>& results, unsigned int width) {
+  if (results.empty())
+    return;
+  const double uniform = results[0].milliseconds;
+  std::cout << prefix << std::setw(20) << "Pattern" << std::setw(12) << "GFLOP/s" << std::setw(12) << "Slowdown" << std::setw(14)
+            << "Paths/warp" << "\n";
+  std::cout << std::fixed;
+  for (const DivergenceResult& result : results) {
+    double gflops = result.milliseconds > 0.0 ? result.fmas * 2 / (result.milliseconds * 1e6) : 0.0;
+    double slowdown = uniform > 0.0 ? result.milliseconds / uniform : 0.0;
+    std::cout << prefix << std::setw(20) << result.pattern->name << std::setprecision(1) << std::setw(12) << gflops << std::setprecision(2)
+              << std::setw(11) << slowdown << "x" << std::setw(14) << result.expectedSlowdown << "\n";
+    Suite::metric(test, std::string(result.pattern->key) + "_gflops", gflops);
+    Suite::metric(test, std::string(result.pattern->key) + "_slowdown", slowdown);
+  }
+  std::cout << prefix << "Paths/warp counts the distinct paths in every " << width
+            << " threads, the slowdown if a warp runs each of its paths in turn\n";
+}
+
+const std::vector<Microbench::AtomicOperation>& Microbench::atomicOperations() {
+  static const std::vector<AtomicOperation> operations = {
+      {"int32 add", "AddInt", "add_int32", 4, false},
+      {"int64 add", "AddLong", "add_int64", 8, false},
+      {"float add", "AddFloat", "add_float", 4, false},
+      {"int32 CAS loop", "CasInt", "cas_int32", 4, true},
+  };
+  return operations;
+}
+
+const std::vector<Microbench::AtomicContention>& Microbench::atomicContentions() {
+  static const std::vector<AtomicContention> contentions = {
+      {1, "1 address", "one_address"},
+      {32, "32 addresses", "32_addresses"},
+      {1024, "1024 addresses", "1024_addresses"},
+      {0, "1 per thread", "distributed"},
+  };
+  return contentions;
+}
+
+void Microbench::reportAtomics(std::string_view prefix, const char* test, const std::vector<AtomicResult>& results) {
+  if (results.empty())
+    return;
+  std::cout << prefix << std::setw(24) << "Gops/s";
+  for (const AtomicContention& contention : atomicContentions()) {
+    std::cout << std::setw(16) << contention.name;
+  }
+  std::cout << "\n" << std::fixed << std::setprecision(2);
+  const AtomicOperation* row = nullptr;
+  bool rowShared = false, anyOneBlock = false;
+  for (const AtomicResult& result : results) {
+    if (result.operation != row || result.shared != rowShared) {
+      if (row)
+        std::cout << "\n";
+      row = result.operation;
+      rowShared = result.shared;
+      std::cout << prefix << std::setw(24) << (std::string(result.shared ? "Shared " : "Global ") + result.operation->name);
+    }
+    if (result.milliseconds <= 0.0) {
+      std::cout << std::setw(16) << "-";
+      continue;
+    }
+    double gops = result.operations / (result.milliseconds * 1e6);
+    if (result.oneBlock) {
+      std::cout << std::setw(15) << gops << "*";
+      anyOneBlock = true;
+    } else {
+      std::cout << std::setw(16) << gops;
+    }
+    Suite::metric(test, std::string(result.shared ? "shared_" : "global_") + result.operation->key + "_" + result.contention->key + "_gops", gops);
+  }
+  std::cout << "\n" << prefix << "Shared memory counters are per block, so there the addresses are shared by one block's threads only\n";
+  if (anyOneBlock)
+    std::cout << prefix << "* Compare-and-swap loop on " << casLoopBlockAddresses
+              << " global counters or fewer, run and counted as a single block, as the whole device on them would take minutes\n";
+}
+
+double Microbench::histogramMilliseconds(const std::vector<AtomicResult>& results) {
+  auto histogram = std::find_if(results.begin(), results.end(), [](const AtomicResult& result) {
+    return !result.shared && std::string_view(result.operation->kernel) == "AddInt" && result.contention->addresses == 0;
+  });
+  if (histogram != results.end() && histogram->milliseconds > 0.0)
+    return histogram->milliseconds;
+  auto ran = std::find_if(results.rbegin(), results.rend(), [](const AtomicResult& result) { return result.milliseconds > 0.0; });
+  return ran != results.rend() ? ran->milliseconds : 0.0;
+}
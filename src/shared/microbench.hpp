@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Microbenchmarks of a single compute unit (SM on NVIDIA, CU on AMD): what its instructions cost, and reporting them
+// per clock so devices of different sizes and clocks compare.
+namespace Microbench {
+// One operation of the instruction-mix test
+struct Instruction {
+  const char* name;
+  const char* kernel; // Module names are latency<kernel>Kernel and throughput<kernel>Kernel
+  const char* key;    // Metric prefix
+};
+// Fast (hardware approximation) and precise sin, exp and rsqrt, 32-bit multiply and multiply-add, popcount, count
+// leading zeros, an int -> float -> int round trip and 64-bit multiply and multiply-add
+const std::vector<Instruction>& instructions();
+
+struct InstructionRate {
+  std::string name;
+  std::string key;
+  double latencyCycles;    // One step of a dependent chain
+  double operations;       // Steps done by the throughput launch, over every thread
+  double milliseconds;     // Of the throughput launch
+};
+// Prints latency and ops/clock per compute unit (from the throughput launches, at clockHz) of every instruction, and
+// records "<key>_latency_cycles", "<key>_gops" and "<key>_ops_per_clock" as metrics
+void reportInstructionMix(std::string_view prefix, const char* test, const std::vector<InstructionRate>& rates, double clockHz,
+                          unsigned int computeUnits);
+
+// Word strides of the shared memory test. 0 is a broadcast, every lane of a group of 32 reading the same word.
+const std::vector<unsigned int>& sharedMemoryStrides();
+// Bytes one thread of sharedMemoryKernel moves per iteration: two 4-byte reads and a write
+constexpr double sharedMemoryBytesPerIteration = 12.0;
+
+struct SharedAccess {
+  unsigned int stride;
+  double bytes;        // Read plus written by the whole launch
+  double milliseconds;
+};
+// Prints bandwidth and bytes/clock per compute unit of every stride, and how much slower it is than stride 1 (no bank
+// conflicts). Records "stride_<n>_gb_per_s", "stride_<n>_bytes_per_clock" and "stride_<n>_slowdown", with "broadcast"
+// in place of "stride_0".
+void reportSharedMemory(std::string_view prefix, const char* test, const std::vector<SharedAccess>& accesses, double clockHz,
+                        unsigned int computeUnits);
+// Time of stride 1, the shared memory test's recorded result, or of the last stride that ran if it is missing
+double conflictFreeMilliseconds(const std::vector<SharedAccess>& accesses);
+
+// One kernel of the occupancy sweep
+struct OccupancyKernel {
+  const char* name;
+  const char* kernel;     // Module name
+  const char* key;        // Metric prefix
+  bool compute;           // FMA chains (GFLOP/s) rather than a copy (GB/s)
+  unsigned int perThread; // float4 loads in flight, or independent FMA chains, per thread
+};
+// A copy and an FMA loop, each plain and with enough values live per thread to take a large share of the register file
+const std::vector<OccupancyKernel>& occupancyKernels();
+const std::vector<unsigned int>& occupancyBlockSizes();
+// Dynamic shared memory each block reserves, to limit how many blocks fit on a compute unit
+const std::vector<size_t>& occupancySharedBytes();
+// FMAs every thread of a compute kernel does, split over its chains
+constexpr unsigned int occupancyFmasPerThread = 4096;
+
+struct OccupancyPoint {
+  unsigned int blockSize;
+  size_t sharedBytes;
+  double occupancy;    // Resident threads per compute unit over the most it can hold, -1 where the driver cannot say
+  double work;         // Bytes or FLOPs of the launch
+  double milliseconds;
+};
+struct OccupancyCurve {
+  const OccupancyKernel* kernel;
+  int registers;                      // Per thread, -1 where the driver cannot say
+  size_t maxBlockSize;                // Largest block the kernel can be launched with
+  std::vector<OccupancyPoint> points; // Only configurations that can be launched
+};
+// Prints the rate of every configuration of every kernel next to its theoretical occupancy, the best configuration, and
+// the lowest occupancy that still reaches 90% of the best rate. Records "<key>_b<block>_s<KB>_rate",
+// "<key>_best_rate", "<key>_best_block_size" and "<key>_occupancy_for_90pct" as metrics.
+void reportOccupancy(std::string_view prefix, const char* test, const std::vector<OccupancyCurve>& curves);
+
+// How the threads of the divergence test are split over its four paths
+struct DivergencePattern {
+  const char* name;
+  const char* key;
+};
+// Uniform, a different path per warp, 1 lane per warp off the path, half-warps, alternating lanes, four paths by lane,
+// and two and four paths at random
+const std::vector<DivergencePattern>& divergencePatterns();
+// Path (0 to 3) of each of `threads` threads in the pattern-th pattern, for warps of `width` threads
+std::vector<unsigned int> divergencePaths(size_t pattern, size_t threads, unsigned int width);
+// Distinct paths per group of `width` consecutive threads, on average: the slowdown if every path a warp takes runs
+// one after another
+double pathsPerWarp(const std::vector<unsigned int>& paths, unsigned int width);
+// FMAs one round of divergenceKernel does on every path
+constexpr unsigned int divergenceFmasPerRound = 64;
+
+struct DivergenceResult {
+  const DivergencePattern* pattern;
+  double expectedSlowdown; // pathsPerWarp at the device's warp width
+  double fmas;
+  double milliseconds;
+};
+// Prints throughput of every pattern, its slowdown against the first (uniform) one and the slowdown serialized paths
+// would give at `width` threads per warp. Records "<key>_gflops" and "<key>_slowdown" as metrics.
+void reportDivergence(std::string_view prefix, const char* test, const std::vector<DivergenceResult>& results, unsigned int width);
+
+// Update every thread of the atomics test repeats, as atomicGlobal<kernel>Kernel and atomicShared<kernel>Kernel
+struct AtomicOperation {
+  const char* name;
+  const char* kernel;
+  const char* key;
+  size_t bytes; // Counter size
+  bool casLoop; // Built from a compare-and-swap loop, which retries as often as the threads on its counter
+};
+// int32, int64 and float add, and an int32 increment built from a compare-and-swap loop
+const std::vector<AtomicOperation>& atomicOperations();
+// How many counters the threads spread over: all on one, one per warp lane, 1024, and one per thread
+struct AtomicContention {
+  unsigned int addresses; // 0 for one per thread
+  const char* name;
+  const char* key;
+};
+const std::vector<AtomicContention>& atomicContentions();
+// Global compare-and-swap loops on this many counters or fewer run as a single block. With every thread of the device on
+// a few counters the retries grow with the square of the threads, and one launch would take minutes.
+constexpr unsigned int casLoopBlockAddresses = 32;
+
+struct AtomicResult {
+  const AtomicOperation* operation;
+  bool shared;                        // Counters in shared (local) memory, per block
+  const AtomicContention* contention;
+  double operations;
+  double milliseconds;                // 0 where the device cannot run the combination
+  bool oneBlock;                      // Ran as a single block, see casLoopBlockAddresses
+};
+// Prints the rate of every operation, in global and then shared memory, at every contention, marking single-block ones. Records
+// "<global|shared>_<key>_<contention>_gops" as metrics.
+void reportAtomics(std::string_view prefix, const char* test, const std::vector<AtomicResult>& results);
+// Time of global int32 adds with one counter per thread (the histogram case), the atomics test's recorded result, or of
+// the last combination that ran if it is missing
+double histogramMilliseconds(const std::vector<AtomicResult>& results);
+} // namespace Microbench
@@ -24,4 +24,6 @@ std::string removeUnreadable(const std::string& str);
 bool stringsRoughlyMatch(const std::string& a, const std::string& b);
 int get_terminal_width();
 void wrapped_print(const std::string& prefix, const std::string& text);
-void closeLibrary(void* handle);
\ No newline at end of file
+void closeLibrary(void* handle);
+// Installed RAM in bytes, 0 if it cannot be determined
+unsigned long long getPhysicalMemory();
\ No newline at end of file
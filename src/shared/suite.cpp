@@ -0,0 +1,87 @@
+#include "suite.hpp"
+#include "ingest.hpp"
+#include "shared.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+namespace {
+GPUMark::RunOptions options;
+GPUMark::DeviceReport* current = nullptr;
+std::chrono::steady_clock::time_point started;
+bool budgetExhausted = false;
+std::unique_ptr<Ingest::TestFile> ingestTestFile;
+
+GPUMark::TestResult& resultFor(const char* test) {
+  for (GPUMark::TestResult& result : current->results) {
+    if (result.name == test)
+      return result;
+  }
+  current->results.push_back({});
+  current->results.back().name = test;
+  return current->results.back();
+}
+} // namespace
+
+void Suite::begin(const GPUMark::RunOptions& runOptions) {
+  options = runOptions;
+  started = std::chrono::steady_clock::now();
+  budgetExhausted = false;
+}
+
+void Suite::end() {
+  current = nullptr;
+  options = {};
+  ingestTestFile.reset();
+}
+
+void Suite::beginDevice(GPUMark::DeviceReport* report) { current = report; }
+
+void Suite::endDevice() { current = nullptr; }
+
+bool Suite::interactive() { return options.interactive; }
+
+const std::vector<GPUMark::AllocationSize>& Suite::allocationSizes() { return options.allocationSizes; }
+
+const std::string& Suite::ingestFile() { return options.ingestFile; }
+
+const std::string& Suite::temporaryIngestFile() {
+  if (!ingestTestFile)
+    ingestTestFile = std::make_unique<Ingest::TestFile>(1ull << 30); // 1 GB
+  return ingestTestFile->path();
+}
+
+bool Suite::shouldRun(const char* test) {
+  if (!options.tests.empty() && std::find(options.tests.begin(), options.tests.end(), test) == options.tests.end())
+    return false;
+  if (options.budgetSeconds > 0.0 && !budgetExhausted) {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (elapsed > options.budgetSeconds) {
+      budgetExhausted = true;
+      std::cout << ORCHESTRATOR << "Time budget of " << options.budgetSeconds << " s used up, skipping remaining tests.\n";
+    }
+  }
+  return !budgetExhausted;
+}
+
+void Suite::skipDevice(const std::string& reason) {
+  if (!current)
+    return;
+  current->skipped = true;
+  current->skipReason = reason;
+}
+
+void Suite::record(const char* test, float milliseconds, bool passed) {
+  if (!current)
+    return;
+  GPUMark::TestResult& result = resultFor(test);
+  result.milliseconds = milliseconds;
+  result.passed = passed;
+}
+
+void Suite::metric(const char* test, const std::string& key, double value) {
+  if (!current)
+    return;
+  resultFor(test).metrics[key] = value;
+}
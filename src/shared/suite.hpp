@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../gpumark.hpp"
+#include <string>
+#include <vector>
+
+// State of the run in progress: which tests were selected, how much of the time budget is left,
+// and the report that results are written to. Backends only talk to the library through here.
+namespace Suite {
+void begin(const GPUMark::RunOptions& options);
+void end();
+void beginDevice(GPUMark::DeviceReport* report);
+void endDevice();
+
+bool interactive();
+const std::vector<GPUMark::AllocationSize>& allocationSizes();
+const std::string& ingestFile();
+// The file the ingest test reads when none was given: written once, on first use, and removed by end()
+const std::string& temporaryIngestFile();
+// True if the test was selected and the budget has not run out. A test that has started always finishes.
+bool shouldRun(const char* test);
+void skipDevice(const std::string& reason);
+void record(const char* test, float milliseconds, bool passed = true);
+void metric(const char* test, const std::string& key, double value);
+} // namespace Suite
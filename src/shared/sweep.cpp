@@ -0,0 +1,435 @@
+#include "sweep.hpp"
+#include "shared.hpp"
+#include "suite.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+
+std::vector<size_t> Sweep::powersOfTwo(size_t minBytes, size_t maxBytes) {
+  std::vector<size_t> sizes;
+  for (size_t bytes = minBytes; bytes <= maxBytes; bytes *= 2) {
+    sizes.push_back(bytes);
+  }
+  return sizes;
+}
+
+int Sweep::repetitions(size_t bytes, size_t targetBytes, int minReps, int maxReps) {
+  size_t reps = targetBytes / std::max<size_t>(bytes, 1);
+  return static_cast<int>(std::clamp<size_t>(reps, minReps, maxReps));
+}
+
+std::string Sweep::formatBytes(double bytes) {
+  static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+  int unit = 0;
+  while (bytes >= 1024.0 && unit < 4) {
+    bytes /= 1024.0;
+    ++unit;
+  }
+  std::ostringstream out;
+  out << std::setprecision(bytes < 10.0 && std::floor(bytes) != bytes ? 2 : 4) << bytes << " " << units[unit];
+  return out.str();
+}
+
+double Sweep::gigabytesPerSecond(const Point& point) {
+  if (point.milliseconds <= 0.0)
+    return 0.0;
+  return point.bytes / (point.milliseconds / 1000.0) / (1024.0 * 1024.0 * 1024.0);
+}
+
+double Sweep::peakGigabytesPerSecond(const std::vector<Point>& curve) {
+  double peak = 0.0;
+  for (const Point& point : curve) {
+    peak = std::max(peak, gigabytesPerSecond(point));
+  }
+  return peak;
+}
+
+double Sweep::halfBandwidthBytes(const std::vector<Point>& curve) {
+  double half = peakGigabytesPerSecond(curve) / 2.0;
+  for (size_t i = 0; i < curve.size(); ++i) {
+    double bandwidth = gigabytesPerSecond(curve[i]);
+    if (bandwidth < half)
+      continue;
+    if (i == 0)
+      return curve[0].bytes;
+    double previous = gigabytesPerSecond(curve[i - 1]);
+    double t = (half - previous) / (bandwidth - previous);
+    return std::exp2(std::log2(curve[i - 1].bytes) + t * (std::log2(curve[i].bytes) - std::log2(curve[i - 1].bytes)));
+  }
+  return 0.0;
+}
+
+double Sweep::crossoverBytes(const std::vector<Point>& incumbent, const std::vector<Point>& challenger) {
+  double crossover = 0.0;
+  for (size_t i = incumbent.size(); i-- > 0;) {
+    if (challenger[i].milliseconds >= incumbent[i].milliseconds)
+      break;
+    crossover = challenger[i].bytes;
+  }
+  return crossover;
+}
+
+std::vector<Sweep::CacheLevel> Sweep::detectCacheLevels(const std::vector<double>& sizes, const std::vector<double>& nanoseconds) {
+  std::vector<CacheLevel> levels;
+  if (nanoseconds.empty())
+    return levels;
+  size_t plateauStart = 0;
+  double plateau = nanoseconds[0];
+  for (size_t i = 1; i < nanoseconds.size(); ++i) {
+    if (nanoseconds[i] <= plateau * 1.3) {
+      continue;
+    }
+    // Caches with random or pseudo-LRU replacement degrade over a few sizes, so walk back to where the rise started
+    size_t riseStart = i;
+    while (riseStart > plateauStart + 1 && nanoseconds[riseStart - 1] > plateau * 1.1) {
+      --riseStart;
+    }
+    levels.push_back({sizes[riseStart - 1], plateau});
+    // ...and forward to where it levels off again
+    while (i + 1 < nanoseconds.size() && nanoseconds[i + 1] > nanoseconds[i] * 1.1) {
+      ++i;
+    }
+    plateauStart = i;
+    plateau = nanoseconds[i];
+  }
+  levels.push_back({0.0, plateau});
+  return levels;
+}
+
+void Sweep::reportLatencyCurve(std::string_view prefix, const char* test, const std::vector<double>& sizes,
+                               const std::vector<double>& nanoseconds) {
+  std::cout << std::fixed << std::setprecision(2);
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    std::cout << prefix << std::setw(10) << formatBytes(sizes[i]) << std::setw(12) << nanoseconds[i] << " ns/load\n";
+    Suite::metric(test, "ns_per_load_" + std::to_string(static_cast<unsigned long long>(sizes[i])), nanoseconds[i]);
+  }
+
+  std::vector<CacheLevel> levels = detectCacheLevels(sizes, nanoseconds);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    bool last = i + 1 == levels.size();
+    // Only call it DRAM if the sweep got past at least one cache
+    std::string name = last && i > 0 ? "DRAM" : "L" + std::to_string(i + 1);
+    std::string key = tolower(name);
+    std::cout << prefix << std::setw(10) << name << std::setw(12) << levels[i].nanoseconds << " ns";
+    if (!last) {
+      std::cout << ", up to " << formatBytes(levels[i].capacityBytes);
+      Suite::metric(test, key + "_capacity_bytes", levels[i].capacityBytes);
+    }
+    std::cout << "\n";
+    Suite::metric(test, key + "_ns", levels[i].nanoseconds);
+  }
+}
+
+double Sweep::accessEfficiency(const AccessPattern& pattern, unsigned int lanes, unsigned int segmentBytes) {
+  std::set<unsigned long long> segments;
+  for (unsigned int lane = 0; lane < lanes; ++lane) {
+    unsigned long long first = (pattern.offset + static_cast<unsigned long long>(lane) * pattern.stride) * pattern.width;
+    for (unsigned long long segment = first / segmentBytes; segment <= (first + pattern.width - 1) / segmentBytes; ++segment) {
+      segments.insert(segment);
+    }
+  }
+  return static_cast<double>(lanes) * pattern.width / (static_cast<double>(segments.size()) * segmentBytes);
+}
+
+void Sweep::reportAccessPatterns(std::string_view prefix, const char* test, const std::vector<AccessPattern>& patterns, unsigned int lanes,
+                                 unsigned int segmentBytes) {
+  std::cout << prefix << std::setw(7) << "Width" << std::setw(8) << "Stride" << std::setw(8) << "Offset" << std::setw(16) << "Effective GB/s"
+            << std::setw(14) << "Wasted GB/s" << std::setw(12) << "Efficiency" << "\n";
+  std::cout << std::fixed << std::setprecision(2);
+  for (const AccessPattern& pattern : patterns) {
+    double effective = gigabytesPerSecond({pattern.elements * pattern.width, pattern.milliseconds});
+    double efficiency = accessEfficiency(pattern, lanes, segmentBytes);
+    // Fetched = effective / efficiency, and everything fetched beyond the useful bytes is waste
+    double wasted = effective / efficiency - effective;
+    std::cout << prefix << std::setw(6) << pattern.width << "B" << std::setw(8) << pattern.stride << std::setw(8) << pattern.offset
+              << std::setw(16) << effective << std::setw(14) << wasted << std::setw(11) << efficiency * 100.0 << "%\n";
+    std::string key = "w" + std::to_string(pattern.width) + "_s" + std::to_string(pattern.stride) + "_o" + std::to_string(pattern.offset);
+    Suite::metric(test, key + "_gb_per_s", effective);
+    Suite::metric(test, key + "_wasted_gb_per_s", wasted);
+  }
+}
+
+void Sweep::reportBestOfN(std::string_view prefix, const char* test, const std::vector<Trials>& trials) {
+  std::cout << prefix << std::setw(16) << "Function" << std::setw(16) << "Best Rate GB/s" << std::setw(12) << "Avg time" << std::setw(12)
+            << "Min time" << std::setw(12) << "Max time" << "   (ms)\n";
+  std::cout << std::fixed;
+  for (const Trials& trial : trials) {
+    if (trial.milliseconds.empty())
+      continue;
+    auto [fastest, slowest] = std::minmax_element(trial.milliseconds.begin(), trial.milliseconds.end());
+    double average = 0.0;
+    for (double milliseconds : trial.milliseconds) {
+      average += milliseconds / trial.milliseconds.size();
+    }
+    double best = gigabytesPerSecond({trial.bytes, *fastest});
+    std::cout << prefix << std::setw(16) << trial.name << std::setprecision(2) << std::setw(16) << best << std::setprecision(4)
+              << std::setw(12) << average << std::setw(12) << *fastest << std::setw(12) << *slowest << "\n";
+    Suite::metric(test, trial.key + "_gb_per_s", best);
+    Suite::metric(test, trial.key + "_avg_ms", average);
+  }
+}
+
+std::string Sweep::streamKernelName(size_t k) {
+  static const char* functions[] = {"Copy", "Scale", "Add", "Triad"};
+  static const char* widths[] = {"4", "8", "16"};
+  return std::string("stream") + functions[k % std::size(functions)] + "Kernel" + widths[k / std::size(functions)];
+}
+
+void Sweep::reportPinningCosts(std::string_view prefix, const char* test, const std::vector<PinningCost>& costs) {
+  std::cout << prefix << std::setw(10) << "Size" << std::setw(12) << "Register" << std::setw(12) << "Unregister" << std::setw(12) << "Alloc"
+            << std::setw(12) << "Free" << "   (ms)" << std::setw(11) << "Pageable" << std::setw(10) << "Pinned" << std::setw(12) << "Pin+copy"
+            << "   (GB/s)" << std::setw(12) << "Break-even" << "\n";
+  for (const PinningCost& cost : costs) {
+    double pinning = cost.registerMilliseconds + cost.unregisterMilliseconds;
+    double pageable = gigabytesPerSecond({cost.bytes, cost.pageableMilliseconds});
+    double pinned = gigabytesPerSecond({cost.bytes, cost.pinnedMilliseconds});
+    double lazy = gigabytesPerSecond({cost.bytes, cost.pinnedMilliseconds + pinning});
+    // Copies of this buffer after which pinning it on the fly has saved more than it cost
+    double saved = cost.pageableMilliseconds - cost.pinnedMilliseconds;
+    std::string breakEven = saved > 0.0 ? std::to_string(static_cast<unsigned long long>(std::ceil(pinning / saved))) : "never";
+    std::cout << prefix << std::setw(10) << formatBytes(cost.bytes) << std::fixed << std::setprecision(4) << std::setw(12)
+              << cost.registerMilliseconds << std::setw(12) << cost.unregisterMilliseconds << std::setw(12) << cost.allocMilliseconds
+              << std::setw(12) << cost.freeMilliseconds << std::setprecision(2) << std::setw(18) << pageable << std::setw(10) << pinned
+              << std::setw(12) << lazy << std::setw(21) << breakEven << "\n";
+    std::string size = std::to_string(static_cast<unsigned long long>(cost.bytes));
+    Suite::metric(test, "register_ms_" + size, cost.registerMilliseconds);
+    Suite::metric(test, "unregister_ms_" + size, cost.unregisterMilliseconds);
+    Suite::metric(test, "alloc_host_ms_" + size, cost.allocMilliseconds);
+    Suite::metric(test, "free_host_ms_" + size, cost.freeMilliseconds);
+    Suite::metric(test, "pageable_gb_per_s_" + size, pageable);
+    Suite::metric(test, "pinned_gb_per_s_" + size, pinned);
+    Suite::metric(test, "pin_copy_unpin_gb_per_s_" + size, lazy);
+    if (saved > 0.0)
+      Suite::metric(test, "break_even_copies_" + size, std::ceil(pinning / saved));
+  }
+}
+
+void Sweep::reportManagedMemory(std::string_view prefix, const char* test, const ManagedMemoryTimes& times) {
+  const double pages = times.bytes / 4096.0;
+  auto microsecondsPerPage = [&](double milliseconds) { return std::max(milliseconds, 0.0) * 1000.0 / pages; };
+  // Migration bandwidth is what the pass took beyond the same pass over resident pages
+  auto migration = [&](double milliseconds, double residentMilliseconds) {
+    return gigabytesPerSecond({times.bytes, milliseconds - residentMilliseconds});
+  };
+  std::cout << std::fixed << std::setprecision(2);
+  double firstTouch = microsecondsPerPage(times.firstTouchMilliseconds - times.residentMilliseconds);
+  std::cout << prefix << "First touch on device:  " << std::setw(10) << times.firstTouchMilliseconds << " ms, " << firstTouch
+            << " us/page to populate\n";
+  double toDevice = migration(times.deviceFaultMilliseconds, times.residentMilliseconds);
+  double toHost = migration(times.hostFaultMilliseconds, times.hostResidentMilliseconds);
+  std::cout << prefix << "Faulting host->device: " << std::setw(10) << toDevice << " GB/s\n";
+  std::cout << prefix << "Faulting device->host: " << std::setw(10) << toHost << " GB/s\n";
+  Suite::metric(test, "first_touch_us_per_page", firstTouch);
+  Suite::metric(test, "fault_htod_gb_per_s", toDevice);
+  Suite::metric(test, "fault_dtoh_gb_per_s", toHost);
+  if (times.prefetchToDeviceMilliseconds > 0.0) {
+    double prefetchToDevice = gigabytesPerSecond({times.bytes, times.prefetchToDeviceMilliseconds});
+    double prefetchToHost = gigabytesPerSecond({times.bytes, times.prefetchToHostMilliseconds});
+    // Faulting moves the same pages as a prefetch followed by a resident pass, anything beyond that is handling faults
+    double faultOverhead =
+        microsecondsPerPage(times.deviceFaultMilliseconds - times.prefetchToDeviceMilliseconds - times.residentMilliseconds);
+    std::cout << prefix << "Prefetch host->device: " << std::setw(10) << prefetchToDevice << " GB/s\n";
+    std::cout << prefix << "Prefetch device->host: " << std::setw(10) << prefetchToHost << " GB/s\n";
+    std::cout << prefix << "Fault handling:        " << std::setw(10) << faultOverhead << " us/page over prefetching\n";
+    Suite::metric(test, "prefetch_htod_gb_per_s", prefetchToDevice);
+    Suite::metric(test, "prefetch_dtoh_gb_per_s", prefetchToHost);
+    Suite::metric(test, "fault_overhead_us_per_page", faultOverhead);
+  }
+  if (times.oversubscribedFirstMilliseconds > 0.0) {
+    double first = gigabytesPerSecond({times.oversubscribedBytes, times.oversubscribedFirstMilliseconds});
+    double second = gigabytesPerSecond({times.oversubscribedBytes, times.oversubscribedSecondMilliseconds});
+    std::cout << prefix << "Oversubscribed (" << formatBytes(times.oversubscribedBytes) << "): " << first << " GB/s populating, " << second
+              << " GB/s with eviction\n";
+    Suite::metric(test, "oversubscribed_first_gb_per_s", first);
+    Suite::metric(test, "oversubscribed_second_gb_per_s", second);
+  }
+}
+
+std::vector<Sweep::AllocationOp> Sweep::allocationChurn(const std::vector<GPUMark::AllocationSize>& sizes, size_t steps, size_t maxBytes) {
+  std::vector<size_t> candidates;
+  std::vector<double> weights;
+  for (const GPUMark::AllocationSize& size : sizes) {
+    if (size.bytes <= maxBytes / 4) {
+      candidates.push_back(size.bytes);
+      weights.push_back(size.weight);
+    }
+  }
+  std::vector<AllocationOp> ops;
+  if (candidates.empty())
+    return ops;
+
+  // Fixed seed, so every device and backend runs the same sequence
+  std::mt19937_64 random(42);
+  std::discrete_distribution<size_t> pickSize(weights.begin(), weights.end());
+  std::vector<size_t> live; // Slots in use
+  std::vector<size_t> freeSlots;
+  std::vector<size_t> slotBytes;
+  size_t liveBytes = 0;
+  for (size_t step = 0; step < steps; ++step) {
+    size_t bytes = candidates[pickSize(random)];
+    // Lean towards allocating until a few dozen buffers are live, so frees leave holes between live buffers
+    bool allocate = live.empty() || (liveBytes + bytes <= maxBytes && random() % 100 < (live.size() < 64 ? 70u : 50u));
+    if (allocate) {
+      size_t slot = slotBytes.size();
+      if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        slotBytes[slot] = bytes;
+      } else {
+        slotBytes.push_back(bytes);
+      }
+      live.push_back(slot);
+      liveBytes += bytes;
+      ops.push_back({true, bytes, slot});
+    } else {
+      size_t victim = random() % live.size();
+      size_t slot = live[victim];
+      live[victim] = live.back();
+      live.pop_back();
+      freeSlots.push_back(slot);
+      liveBytes -= slotBytes[slot];
+      ops.push_back({false, slotBytes[slot], slot});
+    }
+  }
+  for (size_t slot : live) {
+    ops.push_back({false, slotBytes[slot], slot});
+  }
+  return ops;
+}
+
+size_t Sweep::allocationSlots(const std::vector<AllocationOp>& ops) {
+  size_t slots = 0;
+  for (const AllocationOp& op : ops) {
+    slots = std::max(slots, op.slot + 1);
+  }
+  return slots;
+}
+
+void Sweep::reportLatencyPercentiles(std::string_view prefix, const char* test, const std::vector<LatencySamples>& operations) {
+  std::cout << prefix << std::setw(16) << "Operation" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(12) << "Max" << "   (us)" << std::setw(14) << "ops/s" << "\n";
+  for (const LatencySamples& operation : operations) {
+    if (operation.microseconds.empty())
+      continue;
+    std::vector<double> sorted = operation.microseconds;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+    double total = 0.0;
+    for (double value : sorted) {
+      total += value;
+    }
+    double opsPerSecond = total > 0.0 ? sorted.size() / (total / 1e6) : 0.0;
+    std::cout << prefix << std::setw(16) << operation.name << std::fixed << std::setprecision(2) << std::setw(10) << percentile(0.5)
+              << std::setw(10) << percentile(0.9) << std::setw(10) << percentile(0.99) << std::setw(12) << sorted.back()
+              << std::setprecision(0) << std::setw(21) << opsPerSecond << "\n";
+    Suite::metric(test, operation.key + "_p50_us", percentile(0.5));
+    Suite::metric(test, operation.key + "_p90_us", percentile(0.9));
+    Suite::metric(test, operation.key + "_p99_us", percentile(0.99));
+    Suite::metric(test, operation.key + "_max_us", sorted.back());
+    Suite::metric(test, operation.key + "_ops_per_s", opsPerSecond);
+  }
+}
+
+void Sweep::reportPitchedCopies(std::string_view prefix, const char* test, const std::vector<PitchedCopy>& copies) {
+  std::cout << prefix << std::setw(19) << "Shape" << std::setw(11) << "Alignment" << std::setw(8) << "Pitch" << std::setw(13) << "Driver copy"
+            << std::setw(13) << "Copy kernel" << "   (GB/s)\n";
+  std::cout << std::fixed << std::setprecision(2);
+  for (const PitchedCopy& copy : copies) {
+    double bytes = static_cast<double>(copy.widthBytes) * copy.height * copy.depth;
+    double driver = gigabytesPerSecond({bytes, copy.copyMilliseconds});
+    double kernel = gigabytesPerSecond({bytes, copy.kernelMilliseconds});
+    std::string shape = std::to_string(copy.widthBytes) + "B x " + std::to_string(copy.height);
+    if (copy.depth > 1)
+      shape += " x " + std::to_string(copy.depth);
+    std::string alignment = copy.alignment ? std::to_string(copy.alignment) : "driver";
+    std::cout << prefix << std::setw(19) << shape << std::setw(11) << alignment << std::setw(8) << copy.pitch << std::setw(13) << driver
+              << std::setw(13) << kernel << "\n";
+    std::string key = "w" + std::to_string(copy.widthBytes) + "_a" + alignment;
+    if (copy.depth > 1)
+      key += "_d" + std::to_string(copy.depth);
+    Suite::metric(test, key + (copy.depth > 1 ? "_copy3d_gb_per_s" : "_copy2d_gb_per_s"), driver);
+    Suite::metric(test, key + "_kernel_gb_per_s", kernel);
+  }
+}
+
+void Sweep::reportHostPlacements(std::string_view prefix, const char* test, const std::vector<HostPlacement>& placements) {
+  if (placements.empty())
+    return;
+  std::cout << prefix << std::setw(30) << "Host buffer" << std::setw(24) << "Pages" << std::setw(10) << "HtoD" << std::setw(10) << "DtoH"
+            << "   (GB/s)\n";
+  std::cout << std::fixed << std::setprecision(2);
+  double localHtoD = gigabytesPerSecond({placements[0].bytes, placements[0].htodMilliseconds});
+  double worstRemote = 0.0;
+  for (const HostPlacement& host : placements) {
+    double htod = gigabytesPerSecond({host.bytes, host.htodMilliseconds});
+    double dtoh = gigabytesPerSecond({host.bytes, host.dtohMilliseconds});
+    std::cout << prefix << std::setw(30) << host.name << std::setw(24) << HostMemory::pagesName(host.placement.pages) << std::setw(10) << htod
+              << std::setw(10) << dtoh << (host.local || host.placement.bound ? "\n" : "   (unbound, the OS placed it)\n");
+    Suite::metric(test, host.key + "_htod_gb_per_s", htod);
+    Suite::metric(test, host.key + "_dtoh_gb_per_s", dtoh);
+    // An unbound buffer may well have landed on the local node, so it says nothing about remote memory
+    if (!host.local && host.placement.bound && (worstRemote == 0.0 || htod < worstRemote))
+      worstRemote = htod;
+  }
+  if (worstRemote > 0.0 && localHtoD > 0.0) {
+    std::cout << prefix << "Remote host memory reaches " << std::setprecision(1) << 100.0 * worstRemote / localHtoD
+              << "% of local host-to-device bandwidth\n";
+    Suite::metric(test, "remote_htod_fraction", worstRemote / localHtoD);
+  }
+}
+
+void Sweep::printTable(std::string_view prefix, const std::vector<std::string>& columns, const std::vector<std::vector<Point>>& curves) {
+  if (curves.empty() || curves[0].empty())
+    return;
+  constexpr int sizeWidth = 10;
+  std::vector<int> widths;
+  for (const std::string& column : columns) {
+    widths.push_back(std::max<int>(column.size(), 10) + 2);
+  }
+
+  std::cout << prefix << std::setw(sizeWidth) << "Size";
+  for (size_t c = 0; c < columns.size(); ++c) {
+    std::cout << std::setw(widths[c]) << columns[c];
+  }
+  std::cout << "   (GB/s)\n" << std::fixed << std::setprecision(2);
+  for (size_t row = 0; row < curves[0].size(); ++row) {
+    std::cout << prefix << std::setw(sizeWidth) << formatBytes(curves[0][row].bytes);
+    for (size_t c = 0; c < curves.size(); ++c) {
+      std::cout << std::setw(widths[c]) << gigabytesPerSecond(curves[c][row]);
+    }
+    std::cout << "\n";
+  }
+
+  std::cout << prefix << std::setw(sizeWidth) << "Latency";
+  for (size_t c = 0; c < curves.size(); ++c) {
+    std::ostringstream cell;
+    cell << std::fixed << std::setprecision(2) << curves[c][0].milliseconds * 1000.0 << " us";
+    std::cout << std::setw(widths[c]) << cell.str();
+  }
+  std::cout << "   (" << formatBytes(curves[0][0].bytes) << ")\n";
+  std::cout << prefix << std::setw(sizeWidth) << "Peak";
+  for (size_t c = 0; c < curves.size(); ++c) {
+    std::cout << std::setw(widths[c]) << peakGigabytesPerSecond(curves[c]);
+  }
+  std::cout << "\n";
+  std::cout << prefix << std::setw(sizeWidth) << "n1/2";
+  for (size_t c = 0; c < curves.size(); ++c) {
+    std::cout << std::setw(widths[c]) << formatBytes(halfBandwidthBytes(curves[c]));
+  }
+  std::cout << "\n";
+}
+
+void Sweep::record(const char* test, const std::string& key, const std::vector<Point>& curve) {
+  if (curve.empty())
+    return;
+  Suite::metric(test, key + "_peak_gb_per_s", peakGigabytesPerSecond(curve));
+  Suite::metric(test, key + "_latency_us", curve[0].milliseconds * 1000.0);
+  Suite::metric(test, key + "_n_half_bytes", halfBandwidthBytes(curve));
+  for (const Point& point : curve) {
+    Suite::metric(test, key + "_gb_per_s_" + std::to_string(static_cast<unsigned long long>(point.bytes)), gigabytesPerSecond(point));
+  }
+}
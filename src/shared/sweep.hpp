@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../gpumark.hpp"
+#include "host_memory.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Helpers for benchmarks that measure one operation across a range of sizes and report a curve instead of a single number.
+namespace Sweep {
+struct Point {
+  double bytes;
+  double milliseconds; // Time for one operation of this size
+};
+
+// Sizes from minBytes to maxBytes (inclusive), doubling each step
+std::vector<size_t> powersOfTwo(size_t minBytes, size_t maxBytes);
+// How many times to repeat an operation of this size so the timed region moves roughly targetBytes in total
+int repetitions(size_t bytes, size_t targetBytes, int minReps, int maxReps);
+std::string formatBytes(double bytes);
+
+double gigabytesPerSecond(const Point& point);
+double peakGigabytesPerSecond(const std::vector<Point>& curve);
+// n½: the smallest size that reaches half of the curve's peak bandwidth, interpolated between measured sizes on a log scale
+double halfBandwidthBytes(const std::vector<Point>& curve);
+// The smallest size from which `challenger` is faster than `incumbent` at every larger size, or 0 if it never pulls ahead
+// for good. Both curves must have been measured at the same sizes.
+double crossoverBytes(const std::vector<Point>& incumbent, const std::vector<Point>& challenger);
+
+// A plateau of a latency-vs-working-set curve. The last level has no capacity (it is the memory behind every cache).
+struct CacheLevel {
+  double capacityBytes; // Largest working set that still got this level's latency, 0 for the last level
+  double nanoseconds;   // Latency on the plateau
+};
+// Finds the knees of a latency curve: a new level starts where latency rises 30% above the current plateau,
+// and its capacity is the last size before the rise began. sizes and nanoseconds must be sorted by size.
+std::vector<CacheLevel> detectCacheLevels(const std::vector<double>& sizes, const std::vector<double>& nanoseconds);
+// Prints latency at every size and the detected levels (L1, L2, ... and DRAM), and records both as metrics
+void reportLatencyCurve(std::string_view prefix, const char* test, const std::vector<double>& sizes, const std::vector<double>& nanoseconds);
+
+// One strided read pattern: every thread loads one element of `width` bytes at (offset + i * stride) elements
+struct AccessPattern {
+  unsigned int width;
+  unsigned int stride;
+  unsigned int offset;
+  double elements;     // Elements loaded
+  double milliseconds;
+};
+// Fraction of the bytes the memory system moves that a pattern actually uses. Models one warp/wavefront of `lanes`
+// threads, where every distinct segment of `segmentBytes` a lane touches is fetched whole (32-byte sectors on NVIDIA).
+double accessEfficiency(const AccessPattern& pattern, unsigned int lanes, unsigned int segmentBytes);
+// Prints effective (useful bytes) and wasted (fetched but unused) bandwidth for every pattern, and records them as metrics
+void reportAccessPatterns(std::string_view prefix, const char* test, const std::vector<AccessPattern>& patterns, unsigned int lanes,
+                          unsigned int segmentBytes);
+
+// Repeated runs of one kernel over a fixed amount of data
+struct Trials {
+  std::string name;
+  std::string key;                  // Metric prefix
+  double bytes;                     // Bytes read plus bytes written by one run
+  std::vector<double> milliseconds; // Every timed run, warm-up excluded
+};
+// Prints best rate (from the fastest run) and average/min/max time like the reference STREAM benchmark, and records
+// "<key>_gb_per_s" and "<key>_avg_ms" as metrics
+void reportBestOfN(std::string_view prefix, const char* test, const std::vector<Trials>& trials);
+// Module name of the k-th STREAM kernel: the 4, 8 and 16-byte widths in turn, each as Copy, Scale, Add and Triad
+std::string streamKernelName(size_t k);
+
+// What pinning one buffer costs, and what it buys for copies to the device
+struct PinningCost {
+  double bytes;
+  double registerMilliseconds;   // Pin an existing pageable buffer
+  double unregisterMilliseconds;
+  double allocMilliseconds;      // Allocate a new pinned buffer
+  double freeMilliseconds;
+  double pageableMilliseconds;   // One copy from the buffer before it is pinned
+  double pinnedMilliseconds;     // One copy from the buffer while it is pinned
+};
+// Prints the costs with pageable, pinned and pin-copy-unpin bandwidth, and how many copies it takes for pinning on
+// the fly to pay for itself, and records them as metrics
+void reportPinningCosts(std::string_view prefix, const char* test, const std::vector<PinningCost>& costs);
+
+// One managed allocation moved between host and device, by faulting and by prefetching. Prefetch and
+// oversubscription times are 0 where the device cannot fault concurrently with the host.
+struct ManagedMemoryTimes {
+  double bytes;
+  double firstTouchMilliseconds;     // Device pass over pages that exist nowhere yet
+  double residentMilliseconds;       // Device pass over pages already on the device
+  double deviceFaultMilliseconds;    // Device pass over pages on the host, migrated on demand
+  double hostFaultMilliseconds;      // Host pass over pages on the device, migrated on demand
+  double hostResidentMilliseconds;   // Host pass over pages already on the host
+  double prefetchToDeviceMilliseconds;
+  double prefetchToHostMilliseconds;
+  double oversubscribedBytes;
+  double oversubscribedFirstMilliseconds;  // Device pass that populates an allocation larger than VRAM
+  double oversubscribedSecondMilliseconds; // ...and one that has to evict to get every page back
+};
+// Prints migration bandwidth and fault-handling overhead per 4 KB page for every phase, and records them as metrics
+void reportManagedMemory(std::string_view prefix, const char* test, const ManagedMemoryTimes& times);
+
+// One step of an allocate/free churn. Live allocations are kept in numbered slots.
+struct AllocationOp {
+  bool allocate; // Otherwise free the allocation in `slot`
+  size_t bytes;
+  size_t slot;
+};
+// A random, repeatable sequence of `steps` allocations and frees drawn from `sizes` (larger sizes than maxBytes / 4
+// are left out), keeping at most maxBytes live. Everything still live at the end is freed by trailing steps.
+std::vector<AllocationOp> allocationChurn(const std::vector<GPUMark::AllocationSize>& sizes, size_t steps, size_t maxBytes);
+// Number of slots a churn needs
+size_t allocationSlots(const std::vector<AllocationOp>& ops);
+// Every timed call of one operation
+struct LatencySamples {
+  std::string name;
+  std::string key; // Metric prefix
+  std::vector<double> microseconds;
+};
+// Prints p50/p90/p99/max latency and throughput of every operation, and records them as "<key>_p50_us" etc.
+void reportLatencyPercentiles(std::string_view prefix, const char* test, const std::vector<LatencySamples>& operations);
+
+// One 2D or 3D copy between two buffers with the same row pitch
+struct PitchedCopy {
+  unsigned int widthBytes;
+  unsigned int height;
+  unsigned int alignment;      // Pitch was rounded up to this, 0 when the driver chose it
+  size_t pitch;
+  double copyMilliseconds;     // The driver's 2D or 3D copy
+  double kernelMilliseconds;   // A kernel that copies one row per grid row
+  unsigned int depth = 1;      // Slices, more than 1 for a 3D copy
+};
+// Prints bandwidth (of the widthBytes x height x depth bytes moved) of both copies for every shape and pitch, and records them as metrics
+void reportPitchedCopies(std::string_view prefix, const char* test, const std::vector<PitchedCopy>& copies);
+
+// Copies between the device and one host buffer placement
+struct HostPlacement {
+  std::string name;
+  std::string key;             // Metric prefix
+  bool local;                  // On the device's node, or placement left to the OS
+  HostMemory::Placement placement;
+  double bytes;
+  double htodMilliseconds;
+  double dtohMilliseconds;
+};
+// Prints bandwidth both ways for every placement, and how much of the first (local) placement's bandwidth the bound remote
+// ones reach; unbound ones are marked and left out. Records "<key>_htod_gb_per_s", "<key>_dtoh_gb_per_s" and "remote_htod_fraction".
+void reportHostPlacements(std::string_view prefix, const char* test, const std::vector<HostPlacement>& placements);
+
+// Prints one row per size with the bandwidth of every curve, followed by latency at the smallest size, peak and n½.
+// Every curve must have been measured at the same sizes.
+void printTable(std::string_view prefix, const std::vector<std::string>& columns, const std::vector<std::vector<Point>>& curves);
+// Records peak bandwidth, smallest-size latency, n½ and the bandwidth at every size as metrics named "<key>_..."
+void record(const char* test, const std::string& key, const std::vector<Point>& curve);
+} // namespace Sweep
@@ -0,0 +1,109 @@
+#include "trace.hpp"
+#include "shared.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::active{false};
+
+namespace {
+struct TraceEvent {
+  std::string name;
+  const char* category;
+  uint64_t start;
+  uint64_t duration;
+  uint32_t tid;
+};
+
+// Device tracks are numbered above the host threads so they sort below them in the viewer
+constexpr uint32_t firstDeviceTrack = 1000;
+
+std::mutex eventsMutex;
+std::vector<TraceEvent> events;
+std::map<std::string, uint32_t> deviceTracks;
+std::string outputPath;
+std::chrono::steady_clock::time_point origin;
+std::atomic<uint32_t> nextHostThread{1};
+
+uint32_t hostThreadId() {
+  thread_local uint32_t tid = nextHostThread.fetch_add(1);
+  return tid;
+}
+
+std::string escape(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+} // namespace
+
+void Trace::start(const std::string& path) {
+  std::lock_guard<std::mutex> lock(eventsMutex);
+  outputPath = path;
+  origin = std::chrono::steady_clock::now();
+  events.clear();
+  deviceTracks.clear();
+  active = true;
+}
+
+uint64_t Trace::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Trace::recordSpan(const char* name, const char* category, uint64_t start, uint64_t end) {
+  if (!active)
+    return;
+  uint32_t tid = hostThreadId();
+  std::lock_guard<std::mutex> lock(eventsMutex);
+  events.push_back({name, category, start, end - start, tid});
+}
+
+void Trace::recordDeviceSpan(const std::string& track, const char* name, const char* category, uint64_t submitted, double milliseconds) {
+  if (!active)
+    return;
+  std::lock_guard<std::mutex> lock(eventsMutex);
+  auto it = deviceTracks.find(track);
+  if (it == deviceTracks.end())
+    it = deviceTracks.emplace(track, firstDeviceTrack + static_cast<uint32_t>(deviceTracks.size())).first;
+  events.push_back({name, category, submitted, static_cast<uint64_t>(milliseconds * 1000.0), it->second});
+}
+
+void Trace::finish() {
+  if (!active)
+    return;
+  std::lock_guard<std::mutex> lock(eventsMutex);
+  active = false;
+
+  std::ofstream out(outputPath);
+  if (!out) {
+    std::cerr << ORCHESTRATOR << "Failed to write trace to '" << outputPath << "'\n";
+    return;
+  }
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gpumark\"}}";
+  for (uint32_t tid = 1; tid < nextHostThread.load(); ++tid) {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"Host thread " << tid << "\"}}";
+  }
+  for (const auto& [track, tid] : deviceTracks) {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"" << escape(track) << "\"}}";
+  }
+  for (const TraceEvent& event : events) {
+    out << ",\n{\"name\":\"" << escape(event.name) << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start
+        << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":" << event.tid << "}";
+  }
+  out << "\n]}\n";
+  std::cout << ORCHESTRATOR << "Wrote " << events.size() << " trace events to '" << outputPath << "'\n";
+  events.clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Records timestamped spans for every benchmark phase and writes them as Chrome Trace Event JSON,
+// which can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+// Tracing is off unless Trace::start() is called; every recording call then returns after a single branch.
+namespace Trace {
+extern std::atomic<bool> active;
+
+inline bool enabled() { return active; }
+void start(const std::string& outputPath);
+// Writes the trace file and stops recording. Safe to call when tracing never started.
+void finish();
+
+// Microseconds since Trace::start(), on the same clock as every recorded span.
+uint64_t now();
+// A span on the calling host thread.
+void recordSpan(const char* name, const char* category, uint64_t start, uint64_t end);
+// A span on a device stream/queue. Device timers only report durations, so the span is anchored at the host
+// time the work was submitted.
+void recordDeviceSpan(const std::string& track, const char* name, const char* category, uint64_t submitted, double milliseconds);
+
+// Scoped host span. Ends at destruction, or earlier with end() to trace sequential phases.
+class Span {
+public:
+  Span(const char* name, const char* category) : name(name), category(category), begin(active ? now() : 0), open(active) {}
+  ~Span() { end(); }
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  uint64_t started() const { return begin; }
+
+  void end() {
+    if (open) {
+      recordSpan(name, category, begin, now());
+      open = false;
+    }
+  }
+
+private:
+  const char* name;
+  const char* category;
+  uint64_t begin;
+  bool open;
+};
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name, category)